@@ -0,0 +1,583 @@
+// Suíte de desempenho: microbenchmarks dos caminhos quentes e missões
+// headless de ponta a ponta. Os resultados saem em JSON (no arquivo
+// informado ou na saída padrão) para comparação entre versões.
+//
+// Ligado com -Wl,--wrap para malloc, calloc, realloc e aligned_alloc: as
+// alocações feitas pelo código do simulador são contadas. As da libc e do
+// ncurses não passam pelo wrap.
+
+#include "common.h"
+#include "efemerides.h"
+#include "estado_compartilhado.h"
+#include "executivo.h"
+#include "fila_telemetria.h"
+#include "linha_tempo.h"
+#include "physics_engine.h"
+#include "snapshot_estado.h"
+#include "telemetria_binaria.h"
+#include "telemetry_ui.h"
+#include "veiculos.h"
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_VERSAO 3
+
+// Rodadas de cada microbenchmark; o relatório traz a mediana e o mínimo
+#define RODADAS 7
+
+// --- Contagem de alocações ---
+
+void *__real_malloc(size_t tamanho);
+void *__real_calloc(size_t n, size_t tamanho);
+void *__real_realloc(void *ptr, size_t tamanho);
+void *__real_aligned_alloc(size_t alinhamento, size_t tamanho);
+
+static atomic_ullong alocacoes;
+static atomic_ullong bytes_alocados;
+
+static inline void contar_alocacao(size_t tamanho) {
+  atomic_fetch_add_explicit(&alocacoes, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&bytes_alocados, tamanho, memory_order_relaxed);
+}
+
+void *__wrap_malloc(size_t tamanho) {
+  contar_alocacao(tamanho);
+  return __real_malloc(tamanho);
+}
+
+void *__wrap_calloc(size_t n, size_t tamanho) {
+  contar_alocacao(n * tamanho);
+  return __real_calloc(n, tamanho);
+}
+
+void *__wrap_realloc(void *ptr, size_t tamanho) {
+  contar_alocacao(tamanho);
+  return __real_realloc(ptr, tamanho);
+}
+
+void *__wrap_aligned_alloc(size_t alinhamento, size_t tamanho) {
+  contar_alocacao(tamanho);
+  return __real_aligned_alloc(alinhamento, tamanho);
+}
+
+typedef struct {
+  unsigned long long alocacoes;
+  unsigned long long bytes;
+} ContagemAlocacoes;
+
+static ContagemAlocacoes ler_alocacoes(void) {
+  return (ContagemAlocacoes){atomic_load(&alocacoes),
+                             atomic_load(&bytes_alocados)};
+}
+
+// --- Saída JSON ---
+
+static FILE *saida;
+static int resultados_emitidos;
+
+static void json_inicio(void) {
+  fprintf(saida,
+          "{\n  \"versao\": %d,\n  \"compilador\": \"%s\",\n"
+          "  \"resultados\": [",
+          BENCH_VERSAO, __VERSION__);
+}
+
+static void json_resultado(const char *nome) {
+  fprintf(saida, "%s\n    {\"nome\": \"%s\"", resultados_emitidos ? "," : "",
+          nome);
+  resultados_emitidos++;
+}
+
+// Medidas com 9 algarismos significativos; contagens exatas, como inteiros
+static void json_metrica(const char *chave, double valor) {
+  fprintf(saida, ", \"%s\": %.9g", chave, valor);
+}
+
+static void json_contador(const char *chave, unsigned long long valor) {
+  fprintf(saida, ", \"%s\": %llu", chave, valor);
+}
+
+static void json_fim_resultado(void) { fprintf(saida, "}"); }
+
+static void json_fim(void) { fprintf(saida, "\n  ]\n}\n"); }
+
+// --- Medição ---
+
+static double relogio_s(void) {
+  struct timespec agora;
+  clock_gettime(CLOCK_MONOTONIC, &agora);
+  return (double)agora.tv_sec + (double)agora.tv_nsec * 1e-9;
+}
+
+static int comparar_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+typedef double (*FuncaoBench)(void *dados, long iteracoes);
+
+// Executa RODADAS vezes e emite a mediana e o mínimo em ns por operação.
+// A função devolve um valor derivado do trabalho feito, para que o
+// compilador não o elimine.
+static volatile double sumidouro;
+
+static void medir(const char *nome, FuncaoBench funcao, void *dados,
+                  long iteracoes) {
+  double ns[RODADAS];
+  funcao(dados, iteracoes / 10); // aquecimento
+  for (int r = 0; r < RODADAS; r++) {
+    double inicio = relogio_s();
+    sumidouro += funcao(dados, iteracoes);
+    ns[r] = (relogio_s() - inicio) * 1e9 / (double)iteracoes;
+  }
+  qsort(ns, RODADAS, sizeof(double), comparar_double);
+
+  json_resultado(nome);
+  json_metrica("ns_por_op_mediana", ns[RODADAS / 2]);
+  json_metrica("ns_por_op_minimo", ns[0]);
+  json_contador("iteracoes", (unsigned long long)iteracoes);
+  json_fim_resultado();
+}
+
+// --- Microbenchmarks ---
+
+// Posições entre a órbita baixa e a Lua, para exercitar os dois termos, e
+// instantes espalhados pela janela das efemérides (um a cada 10 min)
+#define N_POSICOES 1024
+#define INTERVALO_INSTANTES 600.0
+
+typedef struct {
+  const Vetor3D *posicoes;
+  NivelGravidade nivel;
+} DadosGravidade;
+
+static double bench_gravidade(void *dados, long iteracoes) {
+  const DadosGravidade *gravidade = dados;
+  double soma = 0.0;
+  for (long i = 0; i < iteracoes; i++) {
+    long j = i & (N_POSICOES - 1);
+    Vetor3D acel = calcular_aceleracao_gravitacional(
+        gravidade->posicoes[j], (double)j * INTERVALO_INSTANTES,
+        gravidade->nivel);
+    soma += acel.x + acel.y + acel.z;
+  }
+  return soma;
+}
+
+static double bench_efemerides(void *dados, long iteracoes) {
+  Vetor3D (*consulta)(double) = *(Vetor3D (**)(double))dados;
+  double soma = 0.0;
+  for (long i = 0; i < iteracoes; i++) {
+    Vetor3D lua =
+        consulta((double)(i & (N_POSICOES - 1)) * INTERVALO_INSTANTES);
+    soma += lua.x + lua.y + lua.z;
+  }
+  return soma;
+}
+
+static double bench_rk4(void *dados, long iteracoes) {
+  EstadoNave *nave = dados;
+  for (long i = 0; i < iteracoes; i++)
+    atualizar_fisica_rk4(nave, 0.01);
+  return nave->posicao.x;
+}
+
+// Um passo da tabela cheia, na taxa da propulsão. Os veículos estão em
+// órbitas circulares: nenhum é destruído durante a medição.
+static double bench_veiculos(void *dados, long iteracoes) {
+  TabelaVeiculos *tabela = dados;
+  for (long i = 0; i < iteracoes; i++)
+    veiculos_avancar(tabela, tabela->tempo + 0.05);
+  return tabela->px[0];
+}
+
+static void bench_tabela_veiculos(void) {
+  TabelaVeiculos *tabela = aligned_alloc(TAM_LINHA_CACHE, sizeof(*tabela));
+  veiculos_inicializar(tabela, 0.0, TRANSITO_LUNAR);
+  for (int i = 0; i < VEICULOS_MAX; i++) {
+    double raio = 6.7e6 + i * 1.0e5;
+    double angulo = i * 2.0 * M_PI / VEICULOS_MAX;
+    double v = sqrt(G * M_TERRA / raio);
+    veiculos_criar(tabela, VEICULO_SIVB,
+                   (Vetor3D){raio * cos(angulo), raio * sin(angulo), 0.0},
+                   (Vetor3D){-v * sin(angulo), v * cos(angulo), 0.0}, 1.0e4);
+  }
+  medir("passo_veiculos_64", bench_veiculos, tabela, 200000);
+  free(tabela);
+}
+
+// Eventos mantidos programados na linha do tempo, com atrasos de até
+// 2^20 passos (cerca de 3 h a 0,01 s)
+#define EVENTOS_LINHA_TEMPO 2000
+#define MASCARA_ATRASO ((1u << 20) - 1)
+
+typedef struct {
+  LinhaTempo linha;
+  uint64_t passo;
+  uint32_t semente;
+} DadosLinhaTempo;
+
+static uint32_t atraso_aleatorio(uint32_t *semente) {
+  *semente = *semente * 1664525u + 1013904223u;
+  return 1 + ((*semente >> 8) & MASCARA_ATRASO);
+}
+
+// Um passo do sequenciador: retira o que venceu e reprograma cada evento
+// adiante, mantendo a linha cheia
+static double bench_linha_tempo(void *dados, long iteracoes) {
+  DadosLinhaTempo *d = dados;
+  double retirados = 0.0;
+  for (long i = 0; i < iteracoes; i++) {
+    d->passo++;
+    EventoProgramado evento;
+    while (linha_tempo_retirar(&d->linha, d->passo, &evento)) {
+      linha_tempo_programar(&d->linha,
+                            d->passo + atraso_aleatorio(&d->semente),
+                            evento.tipo, evento.valor);
+      retirados += 1.0;
+    }
+  }
+  return retirados;
+}
+
+typedef struct {
+  EscritorTelemetria *escritor;
+  double valores[TELEMETRIA_N_CANAIS];
+  EstadoNave nave;
+} DadosEscritor;
+
+// Amostragem e codificação de uma amostra na thread do executivo
+static double bench_escritor(void *dados, long iteracoes) {
+  DadosEscritor *d = dados;
+  for (long i = 0; i < iteracoes; i++) {
+    atualizar_fisica_rk4(&d->nave, 0.01);
+    telemetria_amostrar(&d->nave, d->valores);
+    telemetria_escrever(d->escritor, d->valores);
+  }
+  return d->valores[CANAL_POS_X];
+}
+
+typedef struct {
+  ExportacaoEstado exportacao;
+  LeitorEstado leitor;
+  EstadoNave nave;
+  EstadoExportado copia;
+} DadosEstadoCompartilhado;
+
+// Publicação do estado ao vivo, feita pelo executivo a cada ciclo
+static double bench_exportar_estado(void *dados, long iteracoes) {
+  DadosEstadoCompartilhado *d = dados;
+  for (long i = 0; i < iteracoes; i++)
+    exportacao_publicar(&d->exportacao, &d->nave, (unsigned long long)i);
+  return d->nave.posicao.x;
+}
+
+// Leitura por outro processo, pelo mapeamento só de leitura
+static double bench_ler_estado(void *dados, long iteracoes) {
+  DadosEstadoCompartilhado *d = dados;
+  double soma = 0.0;
+  for (long i = 0; i < iteracoes; i++)
+    if (leitor_estado_ler(&d->leitor, &d->copia, NULL))
+      soma += d->copia.nave.posicao.x;
+  return soma;
+}
+
+static void bench_estado_compartilhado(const EstadoNave *nave) {
+  char nome[64];
+  snprintf(nome, sizeof(nome), "/apollo_bench_%d", (int)getpid());
+  DadosEstadoCompartilhado *d =
+      aligned_alloc(TAM_LINHA_CACHE, sizeof(DadosEstadoCompartilhado));
+  d->nave = *nave;
+  if (exportacao_abrir(&d->exportacao, nome)) {
+    exportacao_publicar(&d->exportacao, &d->nave, 0);
+    if (leitor_estado_abrir(&d->leitor, nome)) {
+      medir("exportar_estado", bench_exportar_estado, d, 2000000);
+      medir("ler_estado_exportado", bench_ler_estado, d, 2000000);
+      leitor_estado_fechar(&d->leitor);
+    }
+    exportacao_fechar(&d->exportacao);
+  }
+  free(d);
+}
+
+// Vazão da fila até o disco, usando o próprio telemetry_logger como
+// consumidor
+static void bench_logger(long amostras) {
+  FilaTelemetria fila;
+  if (!fila_criar(&fila, CAPACIDADE_FILA_TELEMETRIA))
+    return;
+  char caminho[] = "/tmp/apollo_bench_XXXXXX";
+  int fd = mkstemp(caminho);
+  if (fd >= 0)
+    close(fd);
+  EscritorTelemetria *escritor = malloc(sizeof(EscritorTelemetria));
+  if (!escritor || !telemetria_abrir_escrita(escritor, caminho)) {
+    free(escritor);
+    unlink(caminho);
+    fila_destruir(&fila);
+    return;
+  }
+  ConfiguracaoLogger config = {.escritor = escritor, .fila = &fila};
+
+  EstadoNave nave;
+  inicializar_nave(&nave);
+  AmostraTelemetria amostra;
+
+  double inicio = relogio_s();
+  pthread_t logger;
+  pthread_create(&logger, NULL, telemetry_logger, &config);
+  for (long i = 0; i < amostras; i++) {
+    nave.tempo_missao += 0.01;
+    nave.posicao.y += 0.5;
+    telemetria_amostrar(&nave, amostra.valores);
+    // Mede a vazão sustentada: com a fila cheia o produtor espera em vez
+    // de descartar
+    while (!fila_enfileirar(&fila, &amostra))
+      sched_yield();
+  }
+  fila_fechar(&fila);
+  pthread_join(logger, NULL);
+  double duracao = relogio_s() - inicio;
+
+  json_resultado("logger_fila");
+  json_metrica("amostras_por_s", (double)config.gravadas / duracao);
+  json_contador("gravadas", (unsigned long long)config.gravadas);
+  json_contador("fila_cheia",
+                (unsigned long long)atomic_load(&fila.descartadas));
+  json_contador("ocupacao_max", (unsigned long long)fila.ocupacao_max);
+  json_fim_resultado();
+
+  free(escritor);
+  fila_destruir(&fila);
+  unlink(caminho);
+}
+
+// --- Contenção entre a interface e o executivo ---
+
+typedef struct {
+  Executivo *executivo;
+  atomic_bool parar;
+  unsigned long long pedidos;
+  double espera_total;
+  double espera_max;
+} Disputante;
+
+// Pede um checkpoint a cada 1 ms, como a interface com a tecla [C], e mede
+// quanto o executivo leva para atendê-lo. A interface não bloqueia nessa
+// espera: segue desenhando e grava quando o pedido fica pronto. Aqui a
+// consulta é a cada 50 us, dormindo, para não tirar a CPU do executivo em
+// máquinas com poucos núcleos.
+static void *disputar_estado(void *arg) {
+  Disputante *d = arg;
+  Checkpoint *checkpoint = aligned_alloc(TAM_LINHA_CACHE, sizeof(Checkpoint));
+  while (!atomic_load(&d->parar)) {
+    double antes = relogio_s();
+    executivo_pedir_checkpoint(d->executivo, checkpoint);
+    while (executivo_checkpoint_resultado(d->executivo) ==
+           CHECKPOINT_PENDENTE)
+      usleep(50);
+    double espera = relogio_s() - antes;
+
+    d->pedidos++;
+    d->espera_total += espera;
+    if (espera > d->espera_max)
+      d->espera_max = espera;
+    usleep(1000);
+  }
+  free(checkpoint);
+  return NULL;
+}
+
+static void configurar_executivo(ConfiguracaoExecutivo *config, double dt,
+                                 TipoIntegrador integrador) {
+  memset(config, 0, sizeof(*config));
+  config->modo = EXECUTIVO_MAXIMA_VELOCIDADE;
+  config->dt = dt;
+  config->duracao_max = 8 * 86400.0;
+  config->semente = 1969;
+  configuracao_integrador_padrao(&config->integrador);
+  config->integrador.tipo = integrador;
+}
+
+static void bench_contencao(void) {
+  ConfiguracaoExecutivo config;
+  configurar_executivo(&config, 0.001, INTEGRADOR_RK4);
+  EstadoNave nave;
+  inicializar_nave(&nave);
+  Executivo *executivo = aligned_alloc(TAM_LINHA_CACHE, sizeof(Executivo));
+  executivo_inicializar(executivo, &nave, &config);
+
+  Disputante disputante = {.executivo = executivo};
+  pthread_t thread;
+  pthread_create(&thread, NULL, disputar_estado, &disputante);
+  executivo_executar(executivo);
+  atomic_store(&disputante.parar, true);
+
+  // O último pedido pode ter chegado depois do último ciclo
+  atomic_store(&executivo->canal.encerrado, true);
+  pthread_join(thread, NULL);
+  executivo_finalizar(executivo);
+
+  json_resultado("contencao_estado");
+  json_contador("ciclos_executivo", (unsigned long long)executivo->ciclos);
+  json_metrica("ns_por_passo", executivo->ctx.passos
+                                   ? executivo->tempo_real * 1e9 /
+                                         (double)executivo->ctx.passos
+                                   : 0.0);
+  json_contador("pedidos_disputante", (unsigned long long)disputante.pedidos);
+  json_metrica("espera_media_disputante_us",
+               disputante.pedidos ? disputante.espera_total * 1e6 /
+                                        (double)disputante.pedidos
+                                  : 0.0);
+  json_metrica("espera_max_disputante_us", disputante.espera_max * 1e6);
+  json_fim_resultado();
+  free(executivo);
+}
+
+// --- Missão de ponta a ponta ---
+
+static void bench_missao(const char *nome, double dt, TipoIntegrador integrador,
+                         bool gravar_telemetria) {
+  ContagemAlocacoes antes = ler_alocacoes();
+
+  ConfiguracaoExecutivo config;
+  configurar_executivo(&config, dt, integrador);
+  char caminho[] = "/tmp/apollo_bench_XXXXXX";
+  if (gravar_telemetria) {
+    int fd = mkstemp(caminho);
+    if (fd >= 0)
+      close(fd);
+    config.escritor = malloc(sizeof(EscritorTelemetria));
+    if (!config.escritor ||
+        !telemetria_abrir_escrita(config.escritor, caminho)) {
+      free(config.escritor);
+      return;
+    }
+  }
+
+  EstadoNave nave;
+  inicializar_nave(&nave);
+  Executivo *executivo = aligned_alloc(TAM_LINHA_CACHE, sizeof(Executivo));
+  executivo_inicializar(executivo, &nave, &config);
+  executivo_executar(executivo);
+  executivo_finalizar(executivo);
+
+  if (gravar_telemetria) {
+    telemetria_fechar_escrita(config.escritor);
+    free(config.escritor);
+    unlink(caminho);
+  }
+  ContagemAlocacoes depois = ler_alocacoes();
+
+  const ContextoSimulacao *ctx = &executivo->ctx;
+  double tempo_real = executivo->tempo_real;
+  json_resultado(nome);
+  json_metrica("tempo_simulado_s", nave.tempo_missao);
+  json_metrica("tempo_real_s", tempo_real);
+  json_metrica("simulados_por_s",
+               tempo_real > 0.0 ? nave.tempo_missao / tempo_real : 0.0);
+  json_contador("passos", (unsigned long long)ctx->passos);
+  json_metrica("ns_por_passo",
+               ctx->passos ? tempo_real * 1e9 / (double)ctx->passos : 0.0);
+  json_contador("passos_integrador",
+                (unsigned long long)ctx->estado_integrador.passos_aceitos);
+  json_contador("avaliacoes_forca",
+                (unsigned long long)ctx->estado_integrador.avaliacoes);
+  json_contador("alocacoes",
+                (unsigned long long)(depois.alocacoes - antes.alocacoes));
+  json_contador("bytes_alocados",
+                (unsigned long long)(depois.bytes - antes.bytes));
+  json_fim_resultado();
+  free(executivo);
+}
+
+int main(int argc, char *argv[]) {
+  saida = stdout;
+  if (argc > 1) {
+    saida = fopen(argv[1], "w");
+    if (!saida) {
+      perror(argv[1]);
+      return 1;
+    }
+  }
+  json_inicio();
+
+  efemerides_inicializar(8 * 86400.0, NULL);
+
+  // Série de Chebyshev contra a teoria analítica que ela substitui
+  Vetor3D (*consulta)(double) = efemerides_lua;
+  medir("efemerides_lua", bench_efemerides, &consulta, 10000000);
+  consulta = efemerides_lua_analitica;
+  medir("efemerides_lua_analitica", bench_efemerides, &consulta, 200000);
+
+  static Vetor3D posicoes[N_POSICOES];
+  for (int i = 0; i < N_POSICOES; i++) {
+    double fracao = (double)i / N_POSICOES;
+    double raio = 6.7e6 + fracao * 3.8e8;
+    double angulo = fracao * 2.0 * M_PI;
+    posicoes[i] = (Vetor3D){raio * cos(angulo), raio * sin(angulo), 1.0e5};
+  }
+  // Massa pontual, J2..J6 e o campo 6x6 completo
+  gravidade_configurar(GRAVIDADE_GRAU_MAX, GRAVIDADE_GRAU_MAX);
+  DadosGravidade gravidade = {posicoes, GRAVIDADE_PONTUAL};
+  medir("gravidade", bench_gravidade, &gravidade, 10000000);
+  gravidade.nivel = GRAVIDADE_ZONAL;
+  medir("gravidade_zonal", bench_gravidade, &gravidade, 5000000);
+  gravidade.nivel = GRAVIDADE_HARMONICA;
+  medir("gravidade_harmonica", bench_gravidade, &gravidade, 5000000);
+
+  EstadoNave nave;
+  inicializar_nave(&nave);
+  nave.posicao = (Vetor3D){0.0, 6.7e6, 0.0};
+  nave.velocidade = (Vetor3D){7.7e3, 0.0, 0.0};
+  medir("passo_rk4", bench_rk4, &nave, 2000000);
+  bench_tabela_veiculos();
+
+  DadosLinhaTempo *linha = malloc(sizeof(DadosLinhaTempo));
+  linha_tempo_inicializar(&linha->linha, 1);
+  linha->passo = 0;
+  linha->semente = 1;
+  for (int i = 0; i < EVENTOS_LINHA_TEMPO; i++)
+    linha_tempo_programar(&linha->linha, atraso_aleatorio(&linha->semente),
+                          0, 0.0);
+  medir("linha_tempo_2000", bench_linha_tempo, linha, 10000000);
+  free(linha);
+
+  char caminho[] = "/tmp/apollo_bench_XXXXXX";
+  int fd = mkstemp(caminho);
+  if (fd >= 0)
+    close(fd);
+  DadosEscritor *dados =
+      aligned_alloc(TAM_LINHA_CACHE, sizeof(DadosEscritor));
+  dados->escritor = malloc(sizeof(EscritorTelemetria));
+  if (telemetria_abrir_escrita(dados->escritor, caminho)) {
+    inicializar_nave(&dados->nave);
+    dados->nave.posicao = nave.posicao;
+    dados->nave.velocidade = (Vetor3D){7.7e3, 0.0, 0.0};
+    medir("escritor_telemetria", bench_escritor, dados, 1000000);
+    telemetria_fechar_escrita(dados->escritor);
+  }
+  unlink(caminho);
+  free(dados->escritor);
+  free(dados);
+
+  bench_estado_compartilhado(&nave);
+  bench_logger(2000000);
+  bench_contencao();
+
+  bench_missao("missao_rk4", 0.001, INTEGRADOR_RK4, false);
+  bench_missao("missao_rk4_telemetria", 0.001, INTEGRADOR_RK4, true);
+  bench_missao("missao_dp54", 0.001, INTEGRADOR_DP54, false);
+
+  json_fim();
+  if (saida != stdout)
+    fclose(saida);
+  return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef BUSCA_TLI_H
+#define BUSCA_TLI_H
+
+#include "common.h"
+
+// Busca da queima de injeção translunar (TLI) a partir da órbita de
+// estacionamento: início, duração e direção do empuxo que levam a nave a
+// uma periapside lunar alvo.
+//
+// Uma varredura em grade espalha os candidatos pelo pool de threads; cada
+// um é propagado com o passo RK4 de physics_engine e abandonado assim que
+// não puder mais encontrar a Lua (energia insuficiente após a queima,
+// apogeu passado longe da Lua, impacto na Terra). Os melhores candidatos
+// seguem para um corretor diferencial (Newton na duração da queima), também
+// em paralelo.
+
+typedef struct {
+  // Órbita de estacionamento circular no plano da eclíptica, passando pelo
+  // eixo X em tempo_inicial; as ignições varrem um período a partir daí
+  double altitude_estacionamento; // m
+  double tempo_inicial;           // s desde o lançamento
+
+  // Estágio da queima (S-IVB)
+  double empuxo;             // N
+  double impulso_especifico; // s
+  double massa_inicial;      // kg
+
+  // Alvo: altitude da periapside lunar e tolerância do corretor
+  double periapside_alvo; // m acima do raio da Lua
+  double tolerancia;      // m
+
+  // Grade: n pontos em [min, max] (arfagem e guinada simétricas, em graus,
+  // relativas à velocidade no plano da órbita e fora dele)
+  int n_ignicao;
+  int n_duracao;
+  double duracao_min, duracao_max; // s
+  int n_arfagem;
+  double arfagem_max;
+  int n_guinada;
+  double guinada_max;
+
+  double tempo_voo_max; // s após o fim da queima
+  int sementes;         // candidatos da grade refinados pelo corretor
+  int threads;          // trabalhadores no pool (0 = todos os núcleos)
+} ConfiguracaoBuscaTLI;
+
+void configuracao_busca_tli_padrao(ConfiguracaoBuscaTLI *config);
+
+// Último instante que a busca pode consultar nas efemérides
+double busca_tli_horizonte(const ConfiguracaoBuscaTLI *config);
+
+// Executa a busca e imprime as soluções encontradas. Retorna 0 se alguma
+// convergiu.
+int executar_busca_tli(const ConfiguracaoBuscaTLI *config);
+
+#endif // BUSCA_TLI_H
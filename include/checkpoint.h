@@ -0,0 +1,76 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "gravidade_harmonica.h"
+#include "simulacao.h"
+#include <stdint.h>
+
+// Checkpoint binário versionado de uma simulação (.ckpt)
+//
+//   [CabecalhoCheckpoint][Checkpoint]
+//
+// Guarda todo o estado necessário para continuar a missão exatamente de onde
+// parou: a nave, o controle de propulsão (incluindo o integrador e o erro
+// anterior do PID de descida), as sementes dos subsistemas, a linha do tempo
+// do sequenciador e do roteiro, a configuração e o estado do integrador
+// (passo sugerido e cache FSAL), a tabela de veículos secundários, o
+// relógio do contexto e a configuração global da física (campo da Terra e
+// janela das efemérides). O arquivo só é aceito pelo mesmo layout que o
+// gravou.
+
+#define CHECKPOINT_MAGICA "APCKPT\0\0"
+#define CHECKPOINT_VERSAO 9
+#define ARQUIVO_CHECKPOINT_PADRAO "checkpoint.ckpt"
+
+typedef struct {
+  char magica[8];
+  uint32_t versao;
+  uint32_t tamanho_nave;     // sizeof(EstadoNave) de quem gravou
+  uint32_t tamanho_contexto; // sizeof(ContextoSimulacao) de quem gravou
+  uint32_t reservado;
+  uint64_t soma_verificacao; // FNV-1a do Checkpoint
+} CabecalhoCheckpoint;
+
+// Física fixada antes das threads, fora do contexto: --gravidade,
+// --grau-gravidade, --ordem-gravidade e a duração que define a janela das
+// efemérides
+typedef struct {
+  int32_t grau_gravidade;
+  int32_t ordem_gravidade;
+  NivelGravidade niveis_gravidade[N_ESTADOS_MISSAO];
+  double duracao_efemerides;
+} ConfiguracaoFisica;
+
+typedef struct {
+  EstadoNave nave;
+  ContextoSimulacao contexto; // contexto.nave não é gravado
+  ConfiguracaoFisica fisica;
+} Checkpoint;
+
+// Copia o contexto e sua nave. O chamador sincroniza o acesso.
+void checkpoint_capturar(Checkpoint *checkpoint, const ContextoSimulacao *ctx);
+
+// Restaura o checkpoint em ctx, usando nave como armazenamento da nave
+void checkpoint_restaurar(const Checkpoint *checkpoint, ContextoSimulacao *ctx,
+                          EstadoNave *nave);
+
+// Configuração em vigor no processo
+void configuracao_fisica_capturar(ConfiguracaoFisica *fisica);
+
+bool configuracao_gravidade_igual(const ConfiguracaoFisica *a,
+                                  const ConfiguracaoFisica *b);
+
+// Reconfigura a gravidade e, se a duração for outra, reajusta as efemérides
+// (usando o cache caminho, se não nulo). Deve ser chamado antes de criar as
+// threads da simulação. Retorna false se a configuração for inválida ou
+// faltar memória.
+bool configuracao_fisica_aplicar(const ConfiguracaoFisica *fisica,
+                                 const char *caminho_efemerides);
+
+bool checkpoint_salvar(const Checkpoint *checkpoint, const char *caminho);
+
+// Retorna false se o arquivo não existir, estiver corrompido ou tiver sido
+// gravado por outra versão ou layout
+bool checkpoint_carregar(Checkpoint *checkpoint, const char *caminho);
+
+#endif // CHECKPOINT_H
@@ -1,8 +1,7 @@
 #ifndef COMMON_H
 #define COMMON_H
 
-#include <pthread.h>
-#include <stdatomic.h>
+#include <stdalign.h>
 #include <stdbool.h>
 
 // Estados da missão
@@ -28,51 +27,71 @@ typedef struct {
   double z;
 } Vetor3D;
 
-// Estrutura para armazenar o estado da nave
-typedef struct {
-  // Posição e movimento
-  Vetor3D posicao;
-  Vetor3D velocidade;
-  Vetor3D aceleracao;
-  Vetor3D orientacao;
+// Tamanho de uma linha de cache: dados escritos por threads diferentes não
+// devem dividir uma
+#define TAM_LINHA_CACHE 64
 
-  // Estado da missão
-  EstadoMissao estado_missao;
-  double tempo_missao; // em segundos desde o lançamento
+// Estado da nave, em blocos por subsistema. Cada bloco começa numa linha de
+// cache própria e tem um único escritor no quadro do executivo; um
+// subsistema lê os blocos dos outros, mas o que precisa mudar fora do seu
+// bloco passa por um campo de passagem lido pelo dono (energia_esgotada). A
+// exceção é o corte de empuxo no esgotamento do combustível, que a física
+// aplica no instante do evento, dentro do próprio passo.
+//
+// A nave pertence à thread do executivo: as outras leem o snapshot publicado
+// (snapshot_estado.h) e agem sobre a missão pelo canal de comandos do
+// executivo (executivo.h).
+typedef struct {
+  // Dinâmica: escrita pela física
+  struct {
+    alignas(TAM_LINHA_CACHE) Vetor3D posicao;
+    Vetor3D velocidade;
+    Vetor3D aceleracao;
+    Vetor3D orientacao;
+    double tempo_missao; // em segundos desde o lançamento
+  };
 
-  // Propulsão e Massa
-  double massa_vazia;           // em kg
-  double combustivel_principal; // em kg
-  double combustivel_rcs;       // em kg
-  double empuxo_principal;      // em Newtons
-  double empuxo_rcs;            // em Newtons
+  // Estado da missão: escrito pelo sequenciador
+  struct {
+    alignas(TAM_LINHA_CACHE) EstadoMissao estado_missao;
+    bool emergencia;
+  };
 
-  // Energia
-  double energia_principal; // em Watts-hora
-  double energia_reserva;   // em Watts-hora
-  double consumo_energia;   // em Watts
+  // Propulsão e Massa: escritos pela propulsão
+  struct {
+    alignas(TAM_LINHA_CACHE) double massa_vazia; // em kg
+    double combustivel_principal;                // em kg
+    double combustivel_rcs;                      // em kg
+    double empuxo_principal;                     // em Newtons
+    double empuxo_rcs;                           // em Newtons
+  };
 
-  // Ambiente
-  double temperatura_interna; // em Celsius
-  double pressao_interna;     // em kPa
-  double radiacao;            // em mSv/h
+  // Energia e ambiente: escritos pela energia
+  struct {
+    alignas(TAM_LINHA_CACHE) double energia_principal; // em Watts-hora
+    double energia_reserva;                            // em Watts-hora
+    double consumo_energia;                            // em Watts
+    double temperatura_interna;                        // em Celsius
+    double pressao_interna;                            // em kPa
+    double radiacao;                                   // em mSv/h
+    bool energia_esgotada; // pede ao sequenciador a emergência
+  };
 
   // Comunicação
-  bool comunicacao_ativa;
-  double forca_sinal; // em dB
-
-  // Flags de controle (Thread-safe)
-  atomic_bool sistema_ativo;
-  bool emergencia;
-  atomic_int simulacao_acelerada; // fator de aceleração
+  struct {
+    alignas(TAM_LINHA_CACHE) bool comunicacao_ativa;
+    double forca_sinal; // em dB
+  };
 } EstadoNave;
 
 extern EstadoNave estado_nave;
-extern pthread_mutex_t mutex_estado;
 
 // Funções globais básicas
 const char *obter_nome_estado(EstadoMissao estado);
-void acionar_emergencia(const char *motivo);
-void avancar_estado_missao();
+
+// Operam sobre uma nave específica, na thread que a possui
+void inicializar_nave(EstadoNave *nave);
+void entrar_emergencia(EstadoNave *nave);
+void avancar_estado(EstadoNave *nave);
 
 #endif // COMMON_H
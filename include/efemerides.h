@@ -0,0 +1,77 @@
+#ifndef EFEMERIDES_H
+#define EFEMERIDES_H
+
+#include "common.h"
+#include <stdint.h>
+
+// Efemérides da Lua e do Sol em polinômios de Chebyshev por segmento.
+//
+// As posições vêm de teorias analíticas (ELP-2000/82 truncada para a Lua,
+// teoria solar de baixa precisão para o Sol, ambas de Meeus) caras demais
+// para avaliar em cada estágio do integrador. Por isso elas são ajustadas
+// uma única vez, no início, sobre a janela da missão: cada segmento guarda
+// GRAU+1 coeficientes por eixo, e uma consulta custa um número fixo de
+// operações (recorrência de Clenshaw), independente do tempo consultado.
+//
+// Referencial: geocêntrico, com o plano XY na eclíptica média da data e o
+// eixo X apontando para a longitude da Lua no lançamento; t = 0 é o
+// lançamento da Apollo 11 (1969-07-16 13:32 UTC). Unidades em metros.
+
+#define EFEMERIDES_EPOCA_JD 2440419.0644 // lançamento, em TT
+
+// Lua: segmentos de 1/2 dia, grau 10 (erro de ajuste < 1 m)
+#define EFEMERIDES_SEGMENTO_LUA 43200.0
+#define EFEMERIDES_GRAU_LUA 10
+// Sol: segmentos de 8 dias, grau 7 (erro de ajuste < 1 km)
+#define EFEMERIDES_SEGMENTO_SOL 691200.0
+#define EFEMERIDES_GRAU_SOL 7
+
+// Folga além da duração da missão, para os estágios do integrador que
+// avaliam o fim de um passo depois do último quadro
+#define EFEMERIDES_FOLGA 86400.0
+
+#define EFEMERIDES_MAGICA "APEPHEM\0"
+#define EFEMERIDES_VERSAO 1
+
+typedef struct {
+  double inicio;             // s desde o lançamento
+  double inverso_segmento;   // 1 / duração de um segmento
+  uint32_t n_segmentos;
+  uint32_t grau;
+  double *coeficientes;      // [segmento][grau + 1][3]
+} SerieChebyshev;
+
+// Posição dos corpos perturbadores em um instante, e a aceleração indireta
+// (a da própria Terra, atraída por eles) a subtrair no referencial
+// geocêntrico
+typedef struct {
+  Vetor3D lua;
+  Vetor3D sol;
+  Vetor3D indireta;
+} CorposPerturbadores;
+
+// Ajusta as séries para [0, duracao + EFEMERIDES_FOLGA]. Com caminho não
+// nulo, reaproveita o arquivo se ele cobrir a janela, ou grava as séries
+// nele. Deve ser chamado antes de criar as threads da simulação. Retorna
+// false apenas se faltar memória.
+bool efemerides_inicializar(double duracao, const char *caminho);
+void efemerides_liberar(void);
+
+// Fim da janela coberta; consultas fora dela usam a teoria analítica
+double efemerides_fim_janela(void);
+// Duração passada a efemerides_inicializar (0 antes dela)
+double efemerides_duracao(void);
+
+Vetor3D efemerides_lua(double tempo);
+Vetor3D efemerides_sol(double tempo);
+Vetor3D efemerides_velocidade_lua(double tempo); // m/s
+void efemerides_corpos(double tempo, CorposPerturbadores *corpos);
+
+// Longitude eclíptica (rad) do eixo X do referencial
+double efemerides_longitude_referencia(void);
+
+// Teorias analíticas usadas no ajuste (lentas; para validação)
+Vetor3D efemerides_lua_analitica(double tempo);
+Vetor3D efemerides_sol_analitica(double tempo);
+
+#endif // EFEMERIDES_H
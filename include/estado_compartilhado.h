@@ -0,0 +1,104 @@
+#ifndef ESTADO_COMPARTILHADO_H
+#define ESTADO_COMPARTILHADO_H
+
+#include "common.h"
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+// Exportação do estado ao vivo em memória compartilhada POSIX.
+//
+// O executivo publica a nave principal, a cada ciclo, em um segmento
+// (shm_open) que outros processos mapeiam só para leitura. A publicação é o
+// mesmo seqlock do snapshot da interface (snapshot_estado.h), agora entre
+// processos: o escritor nunca espera, e um leitor obtém uma cópia
+// consistente sem locks nem chamadas de sistema, apenas lendo a memória
+// mapeada e repetindo a leitura se ela cruzar uma publicação.
+//
+//   [CabecalhoEstadoCompartilhado][sequência][palavras do EstadoExportado]
+//
+// O layout só é aceito por leitores compilados com a mesma versão e o mesmo
+// tamanho de EstadoNave.
+
+#define ESTADO_COMPARTILHADO_MAGICA 0x41504c4553544144ULL // "APLESTAD"
+#define ESTADO_COMPARTILHADO_VERSAO 1
+#define NOME_ESTADO_PADRAO "/apollo_estado"
+#define NOME_ESTADO_MAX 256
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "o seqlock entre processos requer atômicos de 64 bits sem "
+              "lock");
+
+// O que cada publicação contém
+typedef struct {
+  EstadoNave nave;      // nave principal no relógio do contexto
+  uint64_t passos;      // quadros menores executados
+  uint64_t instante_ns; // CLOCK_MONOTONIC da publicação
+} EstadoExportado;
+
+#define PALAVRAS_ESTADO_EXPORTADO (sizeof(EstadoExportado) / sizeof(uint64_t))
+
+static_assert(sizeof(EstadoExportado) % sizeof(uint64_t) == 0,
+              "EstadoExportado deve ocupar um número inteiro de palavras");
+
+typedef struct {
+  // Escrita por último, quando o resto do cabeçalho já é válido
+  _Atomic uint64_t magica;
+  uint32_t versao;
+  uint32_t tamanho_nave;     // sizeof(EstadoNave) do escritor
+  uint32_t tamanho_segmento; // sizeof(SegmentoEstado) do escritor
+  int32_t pid;               // processo do simulador
+  // O simulador terminou: o estado não muda mais
+  atomic_bool encerrado;
+} CabecalhoEstadoCompartilhado;
+
+typedef struct {
+  CabecalhoEstadoCompartilhado cabecalho;
+  // Ímpar durante a escrita, 0 antes da primeira publicação. Sequência e
+  // palavras começam numa linha de cache própria, longe do cabeçalho.
+  alignas(TAM_LINHA_CACHE) _Atomic uint64_t sequencia;
+  _Atomic uint64_t palavras[PALAVRAS_ESTADO_EXPORTADO];
+} SegmentoEstado;
+
+// Lado do simulador
+typedef struct {
+  SegmentoEstado *segmento;
+  char nome[NOME_ESTADO_MAX];
+} ExportacaoEstado;
+
+// Cria o segmento nome ("/apollo_estado"), substituindo um que tenha sobrado
+// de uma execução anterior cujo processo não existe mais. Retorna false com
+// errno EEXIST se o segmento pertence a um simulador ainda em execução, ou
+// com o errno da falha.
+bool exportacao_abrir(ExportacaoEstado *exportacao, const char *nome);
+
+// Publica uma cópia da nave. Deve ser chamado por um único escritor.
+void exportacao_publicar(ExportacaoEstado *exportacao, const EstadoNave *nave,
+                         unsigned long long passos);
+
+// Marca o segmento como encerrado e remove o nome. Leitores que já o
+// mapearam continuam lendo o último estado.
+void exportacao_fechar(ExportacaoEstado *exportacao);
+
+// Lado dos leitores (outros processos)
+typedef struct {
+  const SegmentoEstado *segmento;
+} LeitorEstado;
+
+// Mapeia o segmento nome só para leitura. Retorna false com errno ENOENT se
+// ele não existe, EAGAIN se o escritor ainda o está criando e EPROTO se o
+// layout é de outra versão.
+bool leitor_estado_abrir(LeitorEstado *leitor, const char *nome);
+void leitor_estado_fechar(LeitorEstado *leitor);
+
+// Copia a última publicação para destino e, se não for NULL, a sua
+// sequência (cresce a cada publicação) para sequencia. Retorna false se
+// nada foi publicado ainda ou se o escritor parou no meio de uma escrita.
+bool leitor_estado_ler(const LeitorEstado *leitor, EstadoExportado *destino,
+                       uint64_t *sequencia);
+
+// O simulador terminou e fechou a exportação
+bool leitor_estado_encerrado(const LeitorEstado *leitor);
+
+#endif // ESTADO_COMPARTILHADO_H
@@ -0,0 +1,98 @@
+#ifndef EVENTOS_H
+#define EVENTOS_H
+
+#include "common.h"
+
+// Eventos físicos localizados dentro dos passos do integrador.
+//
+// Cada evento é o zero de uma função g(t, posição, velocidade). Depois de
+// cada passo, o integrador compara o sinal de g nas duas pontas; entre elas
+// o estado vem de uma interpolação de Hermite cúbica (posições e
+// velocidades das pontas, sem avaliações extras de força), e o instante do
+// cruzamento é refinado por regula falsi (Illinois) sobre esse polinômio.
+// Quando |g| nas pontas é menor do que o quanto g pode variar no passo, o
+// polinômio também é amostrado por dentro, para que um par de cruzamentos
+// (entrar e sair) num passo longo não passe despercebido.
+//
+// Eventos terminais mudam a dinâmica (contato com a superfície, corte do
+// motor): o passo é refeito até o instante do evento e a ação é aplicada
+// ali. Os demais só são registrados.
+
+#define EVENTOS_MAX 8
+#define NOME_EVENTO_MAX 24
+#define RAIO_SOI_LUA 6.61e7 // esfera de influência da Lua (m)
+
+typedef enum {
+  EVENTO_ALTITUDE_TERRA, // |r| - (raio da Terra + valor)
+  EVENTO_ALTITUDE_LUA,   // |r - r_lua(t)| - (raio da Lua + valor)
+  EVENTO_SOI_LUA,        // |r - r_lua(t)| - RAIO_SOI_LUA
+  EVENTO_APSIDE_TERRA,   // r · v: sobe na periapside, desce na apoapside
+  EVENTO_COMBUSTIVEL,    // tempo_esgotamento - t
+  N_TIPOS_EVENTO
+} TipoEvento;
+
+typedef enum {
+  CRUZAMENTO_QUALQUER,
+  CRUZAMENTO_SUBINDO, // g passa de negativo a positivo
+  CRUZAMENTO_DESCENDO // g passa de positivo a negativo
+} SentidoEvento;
+
+typedef enum {
+  ACAO_REGISTRAR,
+  ACAO_CONTATO_TERRA, // pousa: na superfície, sem velocidade para dentro
+  ACAO_CONTATO_LUA,   // pousa: na superfície, parada em relação à Lua
+  ACAO_CORTE_EMPUXO   // combustível esgotado: motor principal desligado
+} AcaoEvento;
+
+typedef struct {
+  char nome[NOME_EVENTO_MAX];
+  TipoEvento tipo;
+  SentidoEvento sentido;
+  AcaoEvento acao; // qualquer ação diferente de registrar é terminal
+  double valor;    // parâmetro do tipo (altitude em m)
+} DefinicaoEvento;
+
+// Eventos de uma simulação e o que já ocorreu. Sem ponteiros: é copiado
+// junto com o contexto nos checkpoints.
+typedef struct {
+  int n;
+  DefinicaoEvento definicoes[EVENTOS_MAX];
+
+  // Um evento que acabou de ocorrer fica desarmado até |g| se afastar de
+  // zero; assim uma nave pousada não volta a disparar o contato a cada passo
+  bool desarmado[EVENTOS_MAX];
+
+  // Instante em que o combustível acaba na queima atual (INFINITY se não
+  // acaba), informado pela propulsão
+  double tempo_esgotamento;
+
+  unsigned long ocorrencias[EVENTOS_MAX];
+  double ultimo_tempo[EVENTOS_MAX];
+  unsigned int pendentes; // bit i: evento i ocorreu e não foi consumido
+} ContextoEventos;
+
+// Contato com a Terra e a Lua, entrada na esfera de influência da Lua,
+// periapside e apoapside terrestres e esgotamento do combustível
+void eventos_padrao(ContextoEventos *eventos);
+
+// Procura eventos no passo de (t0, p0, v0) a (t1, p1, v1). Registra os não
+// terminais que ocorrem antes do primeiro terminal; se houver um terminal,
+// retorna seu índice e o instante em *tempo_evento, sem registrá-lo (o
+// chamador refaz o passo até lá e chama eventos_aplicar). Retorna -1 se não
+// houver evento terminal no passo.
+int eventos_localizar(ContextoEventos *eventos, double t0, Vetor3D p0,
+                      Vetor3D v0, double t1, Vetor3D p1, Vetor3D v1,
+                      double *tempo_evento);
+
+// Registra o evento terminal e aplica sua ação sobre a nave
+void eventos_aplicar(ContextoEventos *eventos, int indice, EstadoNave *nave);
+
+// Rearma os eventos cujo |g| no estado atual da nave passou do limiar
+void eventos_rearmar(ContextoEventos *eventos, const EstadoNave *nave);
+
+// Retorna true e limpa a pendência se um evento com o tipo e o sentido dados
+// ocorreu desde a última consulta
+bool eventos_consumir(ContextoEventos *eventos, TipoEvento tipo,
+                      SentidoEvento sentido);
+
+#endif // EVENTOS_H
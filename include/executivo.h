@@ -0,0 +1,183 @@
+#ifndef EXECUTIVO_H
+#define EXECUTIVO_H
+
+#include "checkpoint.h"
+#include "estado_compartilhado.h"
+#include "fila_telemetria.h"
+#include "simulacao.h"
+#include "telemetria_binaria.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+
+// Executivo cíclico de grupos de taxa.
+//
+// Uma única thread executa a missão em quadros menores de dt segundos
+// simulados. Em cada quadro rodam, nesta ordem, a propulsão (20 Hz) e a
+// energia (5 Hz) quando vencem, a física e o sequenciador. O quadro maior
+// (0,2 s simulados) contém todos os grupos. A ordem depende apenas do
+// contador de quadros, então a mesma semente e o mesmo dt reproduzem a
+// mesma missão em qualquer modo e em qualquer fator de aceleração.
+
+// Período de relógio entre ciclos do modo de tempo real, em ns
+#define PERIODO_CICLO_TEMPO_REAL 1000000L
+
+// Quadros executados por ciclo (entre publicações do snapshot e consultas
+// aos comandos) no modo de máxima velocidade
+#define QUADROS_POR_LOTE 1024
+
+typedef enum {
+  EXECUTIVO_TEMPO_REAL,         // simulado = real × simulacao_acelerada
+  EXECUTIVO_MAXIMA_VELOCIDADE,  // tão rápido quanto a CPU permitir
+  EXECUTIVO_TEMPO_REAL_ESTRITO  // um quadro por prazo absoluto de dt
+} ModoExecutivo;
+
+// Estatísticas de prazos do modo de tempo real estrito. O atraso de
+// liberação (jitter) é a diferença entre o despertar e o prazo pedido.
+typedef struct {
+  unsigned long long ciclos;          // quadros executados
+  unsigned long long prazos_perdidos; // quadros que terminaram após o prazo
+  unsigned long long ciclos_saltados; // prazos pulados para manter a fase
+  double jitter_soma;                 // s
+  double jitter_soma_quadrados;       // s²
+  double jitter_max;                  // s
+  double execucao_max;                // maior duração de um quadro (s)
+} EstatisticasPrazos;
+
+typedef struct {
+  ModoExecutivo modo;
+  double dt;            // quadro menor em segundos simulados
+  double duracao_max;   // limite de tempo simulado em segundos
+  unsigned int semente; // semente dos geradores dos subsistemas
+  ConfiguracaoIntegrador integrador;
+  ModoSequenciador sequenciador;
+  bool separacoes; // veículos secundários nas transições da missão
+  // Interativo: a emergência não encerra o executivo, que continua
+  // simulando e exibindo o estado até sair ou o limite de tempo
+  bool continuar_em_emergencia;
+
+  // Destino da telemetria (no máximo um): fila para a thread de gravação,
+  // ou escritor chamado na própria thread do executivo
+  FilaTelemetria *fila;
+  EscritorTelemetria *escritor;
+  unsigned int decimacao; // uma amostra a cada N quadros (0 ou 1 = todos)
+  // Cópia de cada amostra para o servidor de telemetria ao vivo, ou NULL.
+  // Também nunca bloqueia.
+  FilaTelemetria *fila_servidor;
+  // Veículo amostrado: a nave principal (VEICULO_APOLLO) ou o primeiro
+  // secundário do tipo, sem amostras enquanto ele não existir
+  TipoVeiculo veiculo_telemetria;
+  // Segmento onde a nave principal é publicada a cada ciclo para outros
+  // processos, ou NULL
+  ExportacaoEstado *exportacao;
+  // Ações programadas carregadas na linha do tempo do contexto, ou NULL
+  const RoteiroMissao *roteiro;
+
+  // Escalonamento da thread do executivo (executivo_missao)
+  bool fixar_cpu;      // prende a thread ao núcleo cpu
+  int cpu;
+  int prioridade_fifo; // prioridade SCHED_FIFO, ou 0 para a política padrão
+} ConfiguracaoExecutivo;
+
+// Comandos de outras threads, atendidos pelo executivo no início de um ciclo
+typedef enum {
+  COMANDO_AVANCAR,         // avança o estado da missão
+  COMANDO_EMERGENCIA,      // declara emergência
+  COMANDO_CHECKPOINT,      // captura o contexto em destino_checkpoint
+  COMANDO_PROXIMO_VEICULO, // exibe o próximo veículo da tabela
+  COMANDO_SALTAR,          // tempo real: vai ao próximo evento programado
+  N_COMANDOS
+} TipoComando;
+
+// Canal entre a interface e o executivo. A nave e o contexto só são
+// escritos pelo executivo; a interface pede e ele atende entre quadros, sem
+// lock. Cada grupo de campos ocupa sua própria linha de cache e tem um único
+// escritor: os pedidos são contadores que só crescem, e o executivo publica
+// quantos já atendeu, então nenhuma variável é escrita pelas duas threads e
+// consultar o canal a cada quadro não invalida linha alguma.
+typedef struct {
+  // Escritos pela interface
+  alignas(TAM_LINHA_CACHE) atomic_bool sistema_ativo;
+  alignas(TAM_LINHA_CACHE) atomic_int simulacao_acelerada; // fator
+  alignas(TAM_LINHA_CACHE) atomic_uint pedidos[N_COMANDOS];
+  _Atomic uint64_t instante_pedido_ns[N_COMANDOS]; // CLOCK_MONOTONIC
+  Checkpoint *destino_checkpoint;
+
+  // Escritos pelo executivo
+  alignas(TAM_LINHA_CACHE) atomic_uint atendidos[N_COMANDOS];
+  atomic_bool encerrado; // não atende mais: o contexto está livre
+} CanalComandos;
+
+typedef struct {
+  ContextoSimulacao ctx;
+  ConfiguracaoExecutivo config;
+  unsigned int quadros_desde_amostra;
+  IdVeiculo veiculo_exibido; // publicado no snapshot
+  // Salto em curso: quadros sem esperar o relógio até passos chegar aqui
+  unsigned long long passo_salto;
+  CanalComandos canal;
+
+  // Estatísticas
+  unsigned long long amostras;           // entregues à telemetria
+  unsigned long long ciclos;             // consultas aos comandos
+  unsigned long long ciclos_sobrecarga;  // ciclos que não alcançaram o relógio
+  unsigned long long comandos;           // comandos atendidos
+  double espera_max_comando;             // maior espera de um pedido (s)
+  double tempo_real;                     // duração de executivo_executar (s)
+  EstatisticasPrazos prazos;             // só no modo estrito
+  bool cpu_fixada;                       // pedidos de escalonamento atendidos
+  bool sched_fifo;
+} Executivo;
+
+// Prepara o executivo para simular nave. Retorna false se o roteiro da
+// configuração não cabe na linha do tempo; o executivo fica inicializado,
+// mas sem o roteiro.
+bool executivo_inicializar(Executivo *executivo, EstadoNave *nave,
+                           const ConfiguracaoExecutivo *config);
+
+// Substitui o contexto e a nave pelos do checkpoint, que já traz o dt e o
+// integrador com que foi gravado e o que restava da sua linha do tempo. O
+// roteiro da configuração é acrescentado a partir do instante restaurado;
+// retorna false se ele não cabe.
+bool executivo_restaurar(Executivo *executivo, const Checkpoint *checkpoint);
+
+// Executa um quadro menor e captura a telemetria se devida. O chamador
+// sincroniza o acesso à nave.
+void executivo_quadro(Executivo *executivo);
+
+// Executa quadros até a missão terminar, atingir duracao_max ou
+// sistema_ativo ser desligado. Atende os comandos no início de cada ciclo e
+// publica o snapshot do veículo exibido ao fim dele (a nave principal se ele
+// deixar de existir).
+void executivo_executar(Executivo *executivo);
+
+// Integra a física pendente do DP54 até o relógio do contexto e publica o
+// estado final. Depois disso o contexto não é mais bit a bit o mesmo de uma
+// execução que continuasse: checkpoints devem ser capturados antes.
+void executivo_finalizar(Executivo *executivo);
+
+// Ponto de entrada da thread do executivo no modo interativo. arg:
+// Executivo*. Atende os últimos comandos antes de finalizar e fecha as filas
+// de telemetria ao terminar.
+void *executivo_missao(void *arg);
+
+// Lado da interface do canal: nunca bloqueiam. Um comando pedido depois que
+// o executivo encerrou não tem efeito.
+void executivo_comandar(Executivo *executivo, TipoComando comando);
+
+typedef enum {
+  CHECKPOINT_PENDENTE,
+  CHECKPOINT_CAPTURADO,
+  CHECKPOINT_CANCELADO // o executivo encerrou sem atender o pedido
+} ResultadoCheckpoint;
+
+// Pede a captura de um checkpoint em destino, que não deve ser tocado
+// enquanto executivo_checkpoint_resultado retornar CHECKPOINT_PENDENTE. Um
+// pedido por vez.
+void executivo_pedir_checkpoint(Executivo *executivo, Checkpoint *destino);
+
+// Os pedidos feitos antes de sistema_ativo ser desligado são atendidos
+// antes da finalização. Um pedido que chega depois que o executivo encerrou
+// é cancelado: o contexto final já não continua a missão.
+ResultadoCheckpoint executivo_checkpoint_resultado(Executivo *executivo);
+
+#endif // EXECUTIVO_H
@@ -0,0 +1,66 @@
+#ifndef FILA_TELEMETRIA_H
+#define FILA_TELEMETRIA_H
+
+#include "telemetria_binaria.h"
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+
+// Fila circular sem travas de produtor único e consumidor único (SPSC) para
+// amostras de telemetria.
+//
+// O produtor (o executivo) nunca bloqueia: com a fila cheia a amostra é
+// descartada e contada em descartadas. O consumidor lê lotes contíguos
+// diretamente do buffer e os libera de uma vez.
+
+// Capacidade da fila do modo interativo: ~16 s de passos da física a 1 kHz
+#define CAPACIDADE_FILA_TELEMETRIA 16384
+
+typedef struct {
+  double valores[TELEMETRIA_N_CANAIS];
+} AmostraTelemetria;
+
+typedef struct {
+  // Lado do produtor
+  alignas(TAM_LINHA_CACHE) atomic_size_t cabeca; // próxima posição a escrever
+  size_t cauda_cache; // última cauda observada pelo produtor
+  unsigned long long enfileiradas;
+
+  // Lado do consumidor
+  alignas(TAM_LINHA_CACHE) atomic_size_t cauda; // próxima posição a ler
+  size_t cabeca_cache; // última cabeça observada pelo consumidor
+  size_t ocupacao_max;
+
+  // Compartilhado, raramente escrito
+  alignas(TAM_LINHA_CACHE) atomic_ullong descartadas;
+  atomic_bool fechada; // o produtor não enfileirará mais amostras
+  size_t mascara;      // capacidade - 1 (capacidade é potência de 2)
+  AmostraTelemetria *amostras;
+} FilaTelemetria;
+
+// Aloca a fila com capacidade arredondada para a próxima potência de 2
+bool fila_criar(FilaTelemetria *fila, size_t capacidade);
+void fila_destruir(FilaTelemetria *fila);
+
+// Produtor: enfileira uma amostra sem bloquear. Retorna false (e conta o
+// descarte) se a fila estiver cheia.
+bool fila_enfileirar(FilaTelemetria *fila, const AmostraTelemetria *amostra);
+
+// Produtor: sinaliza que não haverá mais amostras
+void fila_fechar(FilaTelemetria *fila);
+
+// Consumidor: expõe o maior lote contíguo disponível em *lote e retorna seu
+// tamanho. As amostras permanecem válidas até fila_liberar.
+size_t fila_lote(FilaTelemetria *fila, const AmostraTelemetria **lote);
+
+// Consumidor: devolve ao produtor as n primeiras amostras do lote
+void fila_liberar(FilaTelemetria *fila, size_t n);
+
+// Consumidor: true quando o produtor fechou a fila e ela está vazia
+bool fila_encerrada(FilaTelemetria *fila);
+
+static inline size_t fila_capacidade(const FilaTelemetria *fila) {
+  return fila->mascara + 1;
+}
+
+#endif // FILA_TELEMETRIA_H
@@ -0,0 +1,61 @@
+#ifndef GRAVIDADE_HARMONICA_H
+#define GRAVIDADE_HARMONICA_H
+
+#include "common.h"
+
+// Campo gravitacional da Terra em harmônicos esféricos.
+//
+// Os coeficientes C̄nm/S̄nm (EGM2008, normalizados) são desnormalizados uma
+// vez em gravidade_configurar, junto com os fatores da recorrência de
+// Legendre (V/W de Cunningham, Montenbruck & Gill 3.2); cada avaliação faz
+// só a recorrência e a soma. O resultado é a perturbação além da massa
+// pontual, que continua em calcular_aceleracao_gravitacional.
+//
+// O nível de fidelidade é escolhido por EstadoMissao: perto da Terra vale o
+// campo completo, no espaço profundo a massa pontual basta.
+
+#define GRAVIDADE_GRAU_MAX 6
+#define RAIO_REFERENCIA_TERRA 6378136.3 // m, do EGM2008
+#define VELOCIDADE_ROTACAO_TERRA 7.2921159e-5 // rad/s
+#define N_ESTADOS_MISSAO (EMERGENCIA + 1) // entradas da tabela de níveis
+
+typedef enum {
+  GRAVIDADE_PONTUAL,   // só massas pontuais
+  GRAVIDADE_ZONAL,     // J2..Jn: simétrico em torno do eixo, sem rotação
+  GRAVIDADE_HARMONICA, // grau e ordem configurados, com a rotação da Terra
+  N_NIVEIS_GRAVIDADE
+} NivelGravidade;
+
+// Rotação do referencial da missão para o referencial do cálculo (fixo na
+// Terra, ou equatorial no nível zonal). Depende só do instante: um passo
+// RK4 calcula uma por instante distinto e a reusa nos estágios.
+typedef struct {
+  double m[3][3];
+} OrientacaoTerra;
+
+// Grau de 2 a GRAVIDADE_GRAU_MAX e ordem de 0 ao grau. Deve ser chamado
+// antes de criar as threads da simulação; até lá todo estado usa
+// GRAVIDADE_PONTUAL.
+bool gravidade_configurar(int grau, int ordem);
+// Os configurados, ou 0 antes de gravidade_configurar
+int gravidade_grau(void);
+int gravidade_ordem(void);
+
+// Nível por estado da missão: a tabela padrão ou um nível único para todos
+void gravidade_niveis_por_estado(void);
+void gravidade_nivel_unico(NivelGravidade nivel);
+void gravidade_definir_nivel(EstadoMissao estado, NivelGravidade nivel);
+NivelGravidade gravidade_nivel(EstadoMissao estado);
+
+void gravidade_orientacao(double tempo, NivelGravidade nivel,
+                          OrientacaoTerra *orientacao);
+
+// Aceleração além da massa pontual, no referencial da missão
+Vetor3D gravidade_harmonica(Vetor3D pos, const OrientacaoTerra *orientacao,
+                            NivelGravidade nivel);
+
+// "pontual", "zonal" ou "harmonica"
+NivelGravidade obter_nivel_gravidade(const char *nome, bool *valido);
+const char *obter_nome_nivel_gravidade(NivelGravidade nivel);
+
+#endif // GRAVIDADE_HARMONICA_H
@@ -0,0 +1,29 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "checkpoint.h"
+#include "common.h"
+#include "integrador.h"
+#include "simulacao.h"
+
+// Configuração do modo headless (sem ncurses, passo fixo em tempo simulado)
+typedef struct {
+  double dt;            // passo fixo de integração em segundos simulados
+  double duracao_max;   // limite de tempo simulado em segundos
+  unsigned int semente; // semente dos geradores dos subsistemas
+  ConfiguracaoIntegrador integrador;
+  ModoSequenciador sequenciador;
+  bool separacoes; // veículos secundários nas transições da missão
+  const char *arquivo_telemetria; // log binário de cada passo, ou NULL
+  unsigned int decimacao_telemetria; // grava a cada N passos (0 ou 1 = todos)
+  TipoVeiculo veiculo_telemetria;    // veículo gravado no log
+  const RoteiroMissao *roteiro;      // ações programadas, ou NULL
+  const Checkpoint *checkpoint_inicial; // ponto de partida, ou NULL
+  const char *arquivo_checkpoint;       // checkpoint salvo ao final, ou NULL
+} ConfiguracaoHeadless;
+
+// Executa a missão a partir de estado_nave, tão rápido quanto a CPU permitir,
+// e imprime o relatório de desempenho ao final. Retorna 0 em sucesso.
+int executar_headless(const ConfiguracaoHeadless *config);
+
+#endif // HEADLESS_H
@@ -0,0 +1,87 @@
+#ifndef INDICE_TELEMETRIA_H
+#define INDICE_TELEMETRIA_H
+
+#include "telemetria_binaria.h"
+#include <stdint.h>
+
+// Índice esparso de um log binário de telemetria, guardado ao lado do log
+// (<log>.idx) e montado uma única vez:
+//
+//   [CabecalhoIndice][EntradaIndice × n_blocos][TransicaoEstado × n_trans.]
+//
+// Uma entrada por bloco (deslocamento, primeira amostra e intervalo de
+// tempo) permite localizar qualquer instante com busca binária, sem
+// percorrer o log; a lista de transições de EstadoMissao permite saltar
+// direto para cada fase da missão. O índice é refeito quando o tamanho ou a
+// data de modificação do log não conferem.
+
+#define INDICE_MAGICA "APTIDX\0\0"
+#define INDICE_VERSAO 1
+
+typedef struct {
+  char magica[8];
+  uint32_t versao;
+  uint32_t versao_log; // TELEMETRIA_VERSAO do log indexado
+  uint64_t tamanho_log;
+  int64_t modificacao_log_s;
+  int64_t modificacao_log_ns;
+  uint64_t n_blocos;
+  uint64_t n_amostras;
+  uint64_t n_transicoes;
+} CabecalhoIndice;
+
+typedef struct {
+  uint64_t deslocamento;
+  uint64_t primeira_amostra;
+  double tempo_inicial;
+  double tempo_final;
+} EntradaIndice;
+
+typedef struct {
+  double tempo;     // tempo da primeira amostra no novo estado
+  uint64_t amostra; // índice dessa amostra
+  int32_t estado_anterior;
+  int32_t estado_novo;
+} TransicaoEstado;
+
+// Log aberto com seu índice e um bloco decodificado em cache
+typedef struct {
+  LeitorTelemetria leitor;
+  EntradaIndice *blocos;
+  uint64_t n_blocos;
+  TransicaoEstado *transicoes;
+  uint64_t n_transicoes;
+  bool indice_reaproveitado; // false quando o índice foi (re)montado
+
+  int64_t bloco_em_cache; // -1 = nenhum
+  uint32_t amostras_em_cache;
+  double colunas[TELEMETRIA_N_CANAIS][TELEMETRIA_AMOSTRAS_POR_BLOCO];
+} LogIndexado;
+
+// Abre o log usando <caminho>.idx, montando e gravando o índice se ele não
+// existir ou estiver desatualizado
+bool log_indexado_abrir(LogIndexado *log, const char *caminho);
+void log_indexado_fechar(LogIndexado *log);
+
+static inline uint64_t log_indexado_amostras(const LogIndexado *log) {
+  return log->leitor.n_amostras;
+}
+
+// Índice da última amostra com tempo <= tempo (0 se tempo for anterior ao
+// início do log). O(log n).
+uint64_t log_indexado_buscar_tempo(LogIndexado *log, double tempo);
+
+// Copia os canais da amostra informada. Retorna false se ela não existir ou
+// o bloco estiver corrompido.
+bool log_indexado_ler_amostra(LogIndexado *log, uint64_t amostra,
+                              double valores[TELEMETRIA_N_CANAIS]);
+
+// Primeira transição estritamente depois de tempo, ou NULL
+const TransicaoEstado *log_indexado_proxima_transicao(const LogIndexado *log,
+                                                      double tempo);
+
+// Última transição estritamente antes de tempo, ou NULL
+const TransicaoEstado *log_indexado_transicao_anterior(const LogIndexado *log,
+                                                       double tempo);
+
+#endif // INDICE_TELEMETRIA_H
@@ -0,0 +1,105 @@
+#ifndef INSTRUMENTACAO_H
+#define INSTRUMENTACAO_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// Instrumentação dos caminhos quentes: histogramas de latência por thread.
+//
+// Cada thread registrada possui seu próprio conjunto de histogramas, escrito
+// apenas por ela (sem operações atômicas de leitura-modificação-escrita); o
+// painel de diagnóstico e o relatório de saída apenas os leem. Os
+// histogramas têm baldes logarítmicos no estilo HDR: 16 sub-baldes por
+// potência de 2, ou seja, erro relativo abaixo de 6,25% de 1 ns a ~584 anos.
+//
+// Só existe quando compilado com -DAPOLLO_INSTRUMENTACAO (make
+// INSTRUMENTACAO=1). Sem a flag, as macros INSTR_* não geram código.
+
+// Relatório gravado ao final da execução quando nenhum arquivo é informado
+#define ARQUIVO_INSTRUMENTACAO_PADRAO "instrumentacao.txt"
+
+typedef enum {
+  METRICA_PERIODO,        // intervalo entre iterações do laço da thread
+  METRICA_TRABALHO,       // tempo de computação de uma unidade de trabalho
+  METRICA_ATRASO_SONO,    // quanto o despertar passou do instante pedido
+  METRICA_ESPERA_COMANDO, // do pedido da interface ao atendimento
+  N_METRICAS
+} MetricaInstrumentacao;
+
+#ifdef APOLLO_INSTRUMENTACAO
+
+#define HIST_BITS_SUB 4
+#define HIST_SUB_BALDES (1 << HIST_BITS_SUB)
+#define HIST_N_BALDES ((64 - HIST_BITS_SUB + 1) * HIST_SUB_BALDES)
+
+typedef struct {
+  _Atomic uint64_t baldes[HIST_N_BALDES];
+  _Atomic uint64_t total;
+  _Atomic uint64_t soma_ns;
+  _Atomic uint64_t max_ns;
+} Histograma;
+
+typedef struct ConjuntoInstrumentacao {
+  char nome[16];
+  Histograma metricas[N_METRICAS];
+  struct ConjuntoInstrumentacao *proximo;
+} ConjuntoInstrumentacao;
+
+// Resumo de um histograma em ns
+typedef struct {
+  uint64_t total;
+  double media;
+  uint64_t p50, p99, p999, max;
+} ResumoHistograma;
+
+// Cria o conjunto da thread chamadora. Threads não registradas não medem.
+void instr_registrar_thread(const char *nome);
+
+void instr_registrar(MetricaInstrumentacao metrica, uint64_t ns);
+
+static inline uint64_t instr_relogio_ns(void) {
+  struct timespec agora;
+  clock_gettime(CLOCK_MONOTONIC, &agora);
+  return (uint64_t)agora.tv_sec * 1000000000ULL + (uint64_t)agora.tv_nsec;
+}
+
+// Registra o quanto um sono de pedido_ns iniciado em inicio passou do prazo
+static inline void instr_registrar_atraso(uint64_t inicio, uint64_t pedido_ns) {
+  uint64_t dormido = instr_relogio_ns() - inicio;
+  instr_registrar(METRICA_ATRASO_SONO,
+                  dormido > pedido_ns ? dormido - pedido_ns : 0);
+}
+
+// Lista de conjuntos registrados, do mais recente ao mais antigo. Os
+// conjuntos nunca são liberados.
+const ConjuntoInstrumentacao *instr_conjuntos(void);
+void instr_resumir(const Histograma *histograma, ResumoHistograma *resumo);
+const char *obter_nome_metrica(MetricaInstrumentacao metrica);
+
+// Grava o resumo e os baldes não vazios de todos os histogramas
+bool instr_despejar(const char *caminho);
+
+#define INSTR_THREAD(nome) instr_registrar_thread(nome)
+#define INSTR_INICIO(var) uint64_t var = instr_relogio_ns()
+#define INSTR_FIM(metrica, var)                                                \
+  instr_registrar((metrica), instr_relogio_ns() - (var))
+#define INSTR_VALOR(metrica, ns) instr_registrar((metrica), (ns))
+#define INSTR_ATRASO_SONO(var, pedido_ns)                                      \
+  instr_registrar_atraso((var), (pedido_ns))
+#define INSTR_DESPEJAR(caminho) instr_despejar(caminho)
+
+#else
+
+#define INSTR_THREAD(nome) ((void)0)
+#define INSTR_INICIO(var) ((void)0)
+#define INSTR_FIM(metrica, var) ((void)0)
+#define INSTR_VALOR(metrica, ns) ((void)0)
+#define INSTR_ATRASO_SONO(var, pedido_ns) ((void)0)
+#define INSTR_DESPEJAR(caminho) ((void)(caminho), true)
+
+#endif // APOLLO_INSTRUMENTACAO
+
+#endif // INSTRUMENTACAO_H
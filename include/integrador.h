@@ -0,0 +1,63 @@
+#ifndef INTEGRADOR_H
+#define INTEGRADOR_H
+
+#include "common.h"
+#include "eventos.h"
+#include "gravidade_harmonica.h"
+
+// Métodos de integração disponíveis para a dinâmica de translação
+typedef enum {
+  INTEGRADOR_RK4, // passo fixo: um passo RK4 por intervalo
+  INTEGRADOR_DP54 // Dormand-Prince 5(4) adaptativo com controle de erro
+} TipoIntegrador;
+
+// Seleção do integrador e tolerâncias do controle de passo (DP54)
+typedef struct {
+  TipoIntegrador tipo;
+  double tol_abs;   // tolerância absoluta (m e m/s)
+  double tol_rel;   // tolerância relativa
+  double passo_min; // passo mínimo em segundos simulados
+  double passo_max; // passo máximo em segundos simulados
+
+  // Voo balístico em cônicas (0 = desligado): sem empuxo e com a
+  // perturbação abaixo desta fração da atração do corpo dominante, a nave
+  // segue a solução de Kepler em vez dos passos numéricos
+  double limiar_kepler;
+} ConfiguracaoIntegrador;
+
+// Estado persistente entre chamadas e estatísticas de custo
+typedef struct {
+  double passo_sugerido;          // próximo passo proposto pelo controle
+  unsigned long long avaliacoes;  // avaliações do modelo de forças
+  unsigned long long passos_aceitos;
+  unsigned long long passos_rejeitados;
+  unsigned long long segmentos_conicos; // trechos propagados por Kepler
+
+  // Cache FSAL (first same as last): a última avaliação de um passo aceito
+  // é a primeira do seguinte se o instante, o estado, o empuxo e o nível de
+  // gravidade não mudaram
+  bool fsal_valido;
+  NivelGravidade fsal_nivel;
+  double fsal_tempo;
+  double fsal_estado[6];
+  Vetor3D fsal_empuxo;
+  double fsal_derivada[6];
+} EstadoIntegrador;
+
+void configuracao_integrador_padrao(ConfiguracaoIntegrador *config);
+void inicializar_estado_integrador(EstadoIntegrador *estado);
+TipoIntegrador obter_tipo_integrador(const char *nome, bool *valido);
+const char *obter_nome_integrador(TipoIntegrador tipo);
+
+// Avança a nave exatamente `intervalo` segundos simulados com o integrador
+// configurado. Com DP54 o intervalo é subdividido em passos adaptativos.
+// Com eventos (pode ser NULL), cada passo é verificado: um evento terminal
+// encurta o passo até o instante dele, aplica a ação e a integração segue
+// dali até o fim do intervalo. Com limiar_kepler, os trechos balísticos
+// pouco perturbados são cônicas em torno da Terra ou da Lua, trocando de
+// corpo na esfera de influência.
+void integrar_intervalo(EstadoNave *nave, double intervalo,
+                        const ConfiguracaoIntegrador *config,
+                        EstadoIntegrador *estado, ContextoEventos *eventos);
+
+#endif // INTEGRADOR_H
@@ -0,0 +1,20 @@
+#ifndef KEPLER_H
+#define KEPLER_H
+
+#include "common.h"
+
+// Propagação kepleriana (problema de dois corpos) em variáveis universais.
+//
+// A mesma formulação vale para órbitas elípticas, parabólicas e
+// hiperbólicas: a equação de Kepler universal é resolvida por Newton na
+// anomalia universal χ, com as funções de Stumpff C(z) e S(z), e o estado
+// final sai dos coeficientes de Lagrange f, g, ḟ e ġ (Curtis, cap. 3.7;
+// Vallado, alg. 8). O custo não depende de dt.
+
+// Avança posição e velocidade, relativas ao corpo central de parâmetro
+// gravitacional mu (m³/s²), por dt segundos (dt pode ser negativo). Retorna
+// false, sem alterar o estado, se a iteração não convergir.
+bool kepler_propagar(Vetor3D *posicao, Vetor3D *velocidade, double mu,
+                     double dt);
+
+#endif // KEPLER_H
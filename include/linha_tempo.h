@@ -0,0 +1,83 @@
+#ifndef LINHA_TEMPO_H
+#define LINHA_TEMPO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Linha do tempo de eventos programados por passo: roda de temporização
+// hierárquica (timer wheel).
+//
+// São LINHA_TEMPO_NIVEIS níveis de 64 posições. O nível 0 tem uma posição
+// por passo; cada posição do nível n cobre 64^n passos. Um evento entra no
+// nível em que o seu vencimento cabe a partir do passo atual e, quando o
+// passo alcança o início da sua posição, desce (em cascata) para um nível
+// mais fino, até vencer no nível 0. Programar e cancelar custam O(1), e
+// cada evento desce no máximo LINHA_TEMPO_NIVEIS - 1 vezes. Vencimentos
+// além do horizonte (64^5 passos) esperam em uma lista à parte.
+//
+// Um bitmap de posições ocupadas por nível dá o próximo passo em que há
+// algo a fazer (um vencimento ou uma cascata). Até ele, consultar a linha
+// é uma comparação, com milhares de eventos programados ou nenhum.
+//
+// Os eventos ficam em um pool fixo ligado por índices, sem ponteiros nem
+// alocação: a linha é copiada junto com o contexto nos checkpoints.
+
+#define LINHA_TEMPO_NIVEIS 5
+#define LINHA_TEMPO_BITS 6
+#define LINHA_TEMPO_POSICOES (1 << LINHA_TEMPO_BITS)
+#define LINHA_TEMPO_EVENTOS_MAX 2048
+#define SEM_EVENTO (-1)
+
+typedef struct {
+  uint64_t vencimento; // passo em que vence
+  uint32_t ordem;      // ordem de programação: desempata o mesmo passo
+  int32_t proximo;     // na mesma lista, ou SEM_EVENTO
+  uint32_t tipo;       // significado definido por quem programa
+  uint32_t lista;      // onde está: nível * 64 + posição, ou uma das listas
+  double valor;
+} EventoProgramado;
+
+typedef struct {
+  uint64_t agora;            // primeiro passo ainda não processado
+  uint64_t proximo_trabalho; // primeiro passo com algo a fazer
+  uint32_t ordem;
+  uint32_t n;         // eventos programados
+  uint32_t usados;    // posições do pool já usadas alguma vez
+  int32_t livres;     // posições devolvidas ao pool
+  int32_t vencidos;   // vencidos no passo processado, em ordem
+  int32_t distantes;  // além do horizonte da roda
+  uint64_t ocupadas[LINHA_TEMPO_NIVEIS]; // bit p: posição p não vazia
+  int32_t posicoes[LINHA_TEMPO_NIVEIS][LINHA_TEMPO_POSICOES];
+  EventoProgramado eventos[LINHA_TEMPO_EVENTOS_MAX];
+} LinhaTempo;
+
+// Linha vazia com agora como o próximo passo a processar. O pool não é
+// zerado: só as posições usadas são tocadas.
+void linha_tempo_inicializar(LinhaTempo *linha, uint64_t agora);
+
+// Programa um evento para o passo vencimento (um passo já processado vale
+// como o próximo). Retorna o índice do evento, para cancelá-lo, ou
+// SEM_EVENTO se o pool está cheio.
+int32_t linha_tempo_programar(LinhaTempo *linha, uint64_t vencimento,
+                              uint32_t tipo, double valor);
+
+// Remove um evento programado e ainda não retirado
+void linha_tempo_cancelar(LinhaTempo *linha, int32_t evento);
+
+// Retira o próximo evento vencido até o passo ate, inclusive, na ordem dos
+// vencimentos e, no mesmo passo, da programação. Retorna false quando não
+// há mais nenhum.
+bool linha_tempo_retirar(LinhaTempo *linha, uint64_t ate,
+                         EventoProgramado *evento);
+
+// Verdadeiro se nada vence nem desce de nível até o passo ate: o caminho de
+// todo passo sem eventos
+static inline bool linha_tempo_ociosa(const LinhaTempo *linha, uint64_t ate) {
+  return ate < linha->proximo_trabalho;
+}
+
+// Passo do vencimento mais próximo, ou UINT64_MAX sem eventos. Percorre só
+// a primeira posição ocupada de cada nível.
+uint64_t linha_tempo_proximo_vencimento(const LinhaTempo *linha);
+
+#endif // LINHA_TEMPO_H
@@ -0,0 +1,35 @@
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include "common.h"
+#include "integrador.h"
+#include "sintonia_pid.h"
+
+// Configuração da análise de dispersão Monte Carlo
+typedef struct {
+  int execucoes;        // número de missões independentes
+  int threads;          // trabalhadores no pool (0 = todos os núcleos)
+  double dt;            // passo fixo de cada missão em segundos simulados
+  double duracao_max;   // limite de tempo simulado por missão
+  unsigned int semente; // semente base; cada execução deriva a sua
+  ConfiguracaoIntegrador integrador;
+  // Descida isolada que mede o toque na Lua de cada execução: a missão
+  // padrão não chega à Lua, então a velocidade de pouso vem deste cenário,
+  // com a massa, o combustível e os ganhos dispersos da execução
+  CenarioDescida descida;
+
+  // Desvios padrão relativos (1 sigma) das perturbações
+  double sigma_massa;
+  double sigma_combustivel;
+  double sigma_empuxo;
+  double sigma_ganhos;
+} ConfiguracaoMonteCarlo;
+
+// Inicializa a configuração com as dispersões padrão
+void configuracao_monte_carlo_padrao(ConfiguracaoMonteCarlo *config);
+
+// Executa o conjunto de missões e imprime as estatísticas agregadas.
+// Retorna 0 em sucesso.
+int executar_monte_carlo(const ConfiguracaoMonteCarlo *config);
+
+#endif // MONTE_CARLO_H
@@ -2,8 +2,53 @@
 #define PHYSICS_ENGINE_H
 
 #include "common.h"
+#include "efemerides.h"
+#include "gravidade_harmonica.h"
 
-// Inicializa a thread e o controle de voo/física
-void *controle_voo(void *arg);
+// Constantes Físicas
+#define G 6.67430e-11         // Constante gravitacional em m³/(kg·s²)
+#define M_TERRA 5.972e24      // Massa da Terra em kg
+#define M_LUA 7.342e22        // Massa da Lua em kg
+#define M_SOL 1.989e30        // Massa do Sol em kg
+
+// Raios mínimos usados no cálculo da gravidade (evita força infinita abaixo
+// da superfície; a colisão cuida do movimento)
+#define RAIO_MIN_TERRA 6371000.0
+#define RAIO_MIN_LUA 1737000.0 // Raio da Lua ~1.737 km
+
+// Superfície da Terra para colisão e pouso (raio equatorial)
+#define RAIO_TERRA 6378137.0
+
+#define INTERVALO_SEQUENCIADOR 30.0 // segundos simulados entre estados
+
+// Tudo o que a gravidade precisa saber do instante: posição da Lua e do Sol
+// (efemerides.h) e orientação da Terra para o nível de fidelidade
+// (gravidade_harmonica.h)
+typedef struct {
+  CorposPerturbadores corpos;
+  NivelGravidade nivel;
+  OrientacaoTerra terra;
+} AmbienteGravitacional;
+
+void preparar_ambiente_gravitacional(double tempo, NivelGravidade nivel,
+                                     AmbienteGravitacional *ambiente);
+
+// Modelo de forças. Quem avalia várias posições no mesmo instante prepara o
+// ambiente uma vez e usa a variante _ambiente.
+Vetor3D calcular_aceleracao_gravitacional(Vetor3D pos, double tempo,
+                                          NivelGravidade nivel);
+Vetor3D calcular_aceleracao_gravitacional_ambiente(
+    Vetor3D pos, const AmbienteGravitacional *ambiente);
+Vetor3D calcular_aceleracao_empuxo(const EstadoNave *nave);
+void aplicar_colisao_terra(EstadoNave *nave);
+void aplicar_colisao_lua(EstadoNave *nave);
+
+// Um passo RK4 de posição e velocidade a partir de tempo, com aceleração de
+// empuxo constante no passo. Retorna a aceleração média usada no passo.
+Vetor3D passo_rk4(Vetor3D *posicao, Vetor3D *velocidade, double tempo,
+                  double dt, Vetor3D acel_empuxo, NivelGravidade nivel);
+
+// Passos de simulação, na thread que possui a nave
+void atualizar_fisica_rk4(EstadoNave *nave, double dt);
 
 #endif // PHYSICS_ENGINE_H
@@ -0,0 +1,18 @@
+#ifndef POOL_THREADS_H
+#define POOL_THREADS_H
+
+#include <stddef.h>
+
+// Tarefa executada pelo pool: recebe o índice da tarefa e um contexto comum
+typedef void (*TarefaPool)(size_t indice, void *contexto);
+
+// Número de núcleos disponíveis (mínimo 1)
+int obter_numero_nucleos(void);
+
+// Distribui n_tarefas entre n_threads trabalhadores e aguarda o término.
+// As tarefas são retiradas de um contador atômico compartilhado, então cada
+// índice é executado exatamente uma vez, em qualquer ordem.
+void executar_em_paralelo(size_t n_tarefas, int n_threads, TarefaPool tarefa,
+                          void *contexto);
+
+#endif // POOL_THREADS_H
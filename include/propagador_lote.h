@@ -0,0 +1,45 @@
+#ifndef PROPAGADOR_LOTE_H
+#define PROPAGADOR_LOTE_H
+
+#include "common.h"
+#include <stddef.h>
+
+// Kernels disponíveis para a propagação em lote
+typedef enum {
+  KERNEL_LOTE_ESCALAR,
+  KERNEL_LOTE_AVX2,
+  KERNEL_LOTE_AVX512
+} KernelLote;
+
+// Lote de veículos em estrutura de arrays (SoA). Cada array é alinhado a 64
+// bytes e tem capacidade múltipla de 8, de modo que os kernels vetoriais
+// processam blocos inteiros sem tratamento de cauda (as posições de
+// preenchimento ficam zeradas e não geram NaN).
+typedef struct {
+  size_t n;          // veículos em uso
+  size_t capacidade; // posições alocadas por array
+  double tempo;      // instante comum a todos os veículos (s)
+  double *px, *py, *pz;
+  double *vx, *vy, *vz;
+  // Aceleração de empuxo (F/m ao longo da direção de empuxo), constante
+  // durante um passo
+  double *ax_empuxo, *ay_empuxo, *az_empuxo;
+} LoteVeiculos;
+
+bool lote_criar(LoteVeiculos *lote, size_t capacidade);
+void lote_destruir(LoteVeiculos *lote);
+
+// Adiciona um veículo sem empuxo. Retorna o índice ou -1 se o lote está cheio.
+long lote_adicionar(LoteVeiculos *lote, Vetor3D posicao, Vetor3D velocidade);
+
+// Melhor kernel suportado pela CPU em execução
+KernelLote lote_kernel_disponivel(void);
+const char *lote_nome_kernel(KernelLote kernel);
+
+// Avança todos os veículos um passo RK4 sob a gravidade Terra+Lua+Sol e o
+// empuxo de cada um, a partir de lote->tempo. Os kernels produzem resultados
+// idênticos ao caminho escalar.
+void lote_passo_rk4(LoteVeiculos *lote, double dt);
+void lote_passo_rk4_kernel(LoteVeiculos *lote, double dt, KernelLote kernel);
+
+#endif // PROPAGADOR_LOTE_H
@@ -0,0 +1,39 @@
+#ifndef RAMOS_H
+#define RAMOS_H
+
+#include "checkpoint.h"
+#include <stddef.h>
+
+// Ramos "e se" a partir de um checkpoint: cada ramo restaura uma cópia do
+// checkpoint, aplica comandos alternativos e segue a missão de forma
+// independente, em paralelo com os demais.
+
+#define RAMOS_MAX 64
+
+// Comandos de um ramo. Campos NAN (ou negativos, para contagens) mantêm o
+// valor do checkpoint.
+typedef struct {
+  const char *descricao; // especificação original, para o relatório
+  bool alterar_semente;
+  unsigned int semente;      // novas sementes dos subsistemas
+  double kp, ki, kd;         // ganhos do PID de descida
+  double empuxo_max_descida; // N
+  double empuxo_lancamento;  // N
+  double vazao_lancamento;   // kg/s
+  double combustivel;        // combustível principal, kg
+  int avancos_estado;        // equivalente a N toques em [P]
+  bool emergencia;           // equivalente a [E]
+} ComandosRamo;
+
+// Interpreta "chave=valor,..." com as chaves semente, kp, ki, kd,
+// empuxo_max, empuxo, vazao, combustivel, avancar e a chave sem valor
+// emergencia. Retorna false se a especificação for inválida.
+bool interpretar_ramo(const char *especificacao, ComandosRamo *ramo);
+
+// Executa o ramo base (sem comandos) e os ramos informados a partir do
+// checkpoint até o fim da missão ou duracao_max, com threads trabalhadores
+// (0 = todos os núcleos), e imprime a comparação. Retorna 0 em sucesso.
+int executar_ramos(const Checkpoint *checkpoint, const ComandosRamo *ramos,
+                   size_t n_ramos, int threads, double duracao_max);
+
+#endif // RAMOS_H
@@ -0,0 +1,9 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+// Reproduz um log binário de telemetria nos mesmos painéis da interface ao
+// vivo, com pausa, velocidade variável e busca instantânea por tempo de
+// missão ou por transição de EstadoMissao. Retorna 0 em sucesso.
+int executar_replay(const char *arquivo);
+
+#endif // REPLAY_H
@@ -0,0 +1,89 @@
+#ifndef ROTEIRO_H
+#define ROTEIRO_H
+
+#include "common.h"
+#include "eventos.h"
+#include "linha_tempo.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Roteiro da missão: ações programadas no tempo de missão ou condicionadas
+// a uma transição de estado ou a um evento físico. Um arquivo de texto com
+// uma entrada por linha ('#' começa um comentário):
+//
+//   <instante> <ação>                   no instante de missão
+//   estado <ESTADO> [+<atraso>] <ação>  ao entrar no estado
+//   evento <evento> [+<atraso>] <ação>  na primeira ocorrência do evento
+//
+// Instantes e durações em segundos ou [[h:]m:]s; estados pelos nomes de
+// obter_nome_estado e eventos pelos de eventos_padrao, com '_' no lugar de
+// espaço, sem distinção de caixa. Ações:
+//
+//   avancar                     avança o estado da missão
+//   emergencia                  declara emergência
+//   queima <empuxo N> <duração> motor principal fora das fases propulsadas
+//   separar <veículo>           separa o veículo (nomes de veiculos.h)
+//   blackout [duração]          perda de comunicação (sem duração: até o fim)
+//   falha_energia               perde a bateria principal
+//
+// O contexto carrega as ações no instante na sua linha do tempo
+// (linha_tempo.h), ao lado do temporizador do sequenciador, e as
+// condicionais quando disparam.
+
+// Posições da linha do tempo que um roteiro pode ocupar (uma por ação e
+// uma pelo fim de cada queima ou blackout); a que sobra é do temporizador
+#define ROTEIRO_EVENTOS_MAX (LINHA_TEMPO_EVENTOS_MAX - 1)
+#define ROTEIRO_CONDICOES_MAX 64
+
+typedef enum {
+  ROTEIRO_AVANCAR,
+  ROTEIRO_EMERGENCIA,
+  ROTEIRO_QUEIMA,
+  ROTEIRO_SEPARAR,
+  ROTEIRO_BLACKOUT,
+  ROTEIRO_FALHA_ENERGIA,
+  // Programadas pelo contexto
+  ROTEIRO_FIM_QUEIMA,
+  ROTEIRO_FIM_BLACKOUT,
+  ROTEIRO_TEMPORIZADOR // INTERVALO_SEQUENCIADOR do estado atual venceu
+} AcaoRoteiro;
+
+typedef enum {
+  GATILHO_INSTANTE,
+  GATILHO_ESTADO,
+  GATILHO_EVENTO
+} GatilhoRoteiro;
+
+typedef struct {
+  GatilhoRoteiro gatilho;
+  int alvo;        // EstadoMissao ou evento (posição em eventos_padrao)
+  double instante; // s de missão, ou atraso após o gatilho condicional
+  AcaoRoteiro acao;
+  double valor;    // empuxo (N) ou TipoVeiculo
+  double duracao;  // s da queima ou do blackout (0: blackout sem fim)
+} EntradaRoteiro;
+
+typedef struct {
+  size_t n;
+  size_t eventos; // posições da linha do tempo que ocupa
+  size_t condicoes;
+  EntradaRoteiro entradas[ROTEIRO_EVENTOS_MAX];
+} RoteiroMissao;
+
+// Condicionais de um roteiro carregado em um contexto: cada uma dispara
+// uma vez. Sem ponteiros, vai junto nos checkpoints.
+typedef struct {
+  size_t n;
+  EntradaRoteiro entradas[ROTEIRO_CONDICOES_MAX];
+  uint64_t disparadas;   // bit i: a condicional i já disparou
+  unsigned int eventos;  // bit e: alguma condicional espera o evento e
+  EstadoMissao estado_visto;
+  unsigned long ocorrencias_vistas[EVENTOS_MAX];
+} CondicoesRoteiro;
+
+// Lê o roteiro de caminho. Em falha retorna false com a causa (e a linha)
+// em erro.
+bool roteiro_carregar(RoteiroMissao *roteiro, const char *caminho,
+                      char *erro, size_t tamanho_erro);
+
+#endif // ROTEIRO_H
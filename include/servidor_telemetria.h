@@ -0,0 +1,100 @@
+#ifndef SERVIDOR_TELEMETRIA_H
+#define SERVIDOR_TELEMETRIA_H
+
+#include "fila_telemetria.h"
+#include "telemetria_binaria.h"
+#include <stdint.h>
+#include <sys/un.h>
+
+// Servidor local de telemetria ao vivo.
+//
+// Uma thread própria consome uma fila SPSC alimentada pelo executivo (que
+// descarta amostras com ela cheia, sem nunca esperar) e distribui cada
+// amostra, como um quadro binário, a todos os clientes conectados em um
+// socket UNIX ou TCP em loopback. Todas as conexões são atendidas sem
+// bloqueio por um único epoll. Cada cliente tem uma fila limitada de
+// quadros: quando ele não acompanha, os quadros pendentes são descartados e
+// fica só o mais recente, então um cliente lento perde amostras em vez de
+// atrasar os outros ou o executivo.
+//
+// Protocolo: o cliente recebe todos os canais até enviar um filtro, uma
+// linha de texto com os nomes dos canais separados por vírgula (os de
+// obter_nome_canal, sem distinção de caixa) ou "*" para todos. Cada linha
+// substitui o filtro anterior; uma linha com um canal desconhecido é
+// ignorada. O servidor envia, em ordem de bytes da máquina (o cliente é
+// local),
+//
+//   [CabecalhoQuadro][double valores[n_valores]]
+//
+// com os valores dos canais presentes em canais, em ordem crescente.
+
+// Endereços: "unix:<caminho>" ou "tcp:<porta>" (apenas 127.0.0.1)
+#define ENDERECO_SERVIDOR_PADRAO "unix:apollo_telemetria.sock"
+
+#define SERVIDOR_CLIENTES_MAX 64
+#define QUADROS_POR_CLIENTE 256 // fila de cada cliente
+#define TAM_LINHA_FILTRO 512
+
+typedef struct {
+  uint32_t tamanho;   // bytes do quadro, cabeçalho incluído
+  uint32_t n_valores;
+  uint64_t sequencia; // amostra recebida pelo servidor; lacunas = descartes
+  uint64_t canais;    // bit c: canal c presente
+} CabecalhoQuadro;
+
+#define TAM_QUADRO_MAX \
+  (sizeof(CabecalhoQuadro) + TELEMETRIA_N_CANAIS * sizeof(double))
+
+// Conexão de um cliente: fila circular de quadros já codificados. O
+// primeiro pode ter sido enviado em parte.
+typedef struct {
+  int fd;
+  uint64_t canais; // filtro atual
+  size_t inicio;   // primeiro quadro pendente
+  size_t n;        // quadros pendentes
+  size_t enviado;  // bytes já enviados do primeiro
+  bool aguardando_escrita; // EPOLLOUT armado
+  size_t tam_linha;
+  char linha[TAM_LINHA_FILTRO];
+  uint32_t tamanho[QUADROS_POR_CLIENTE];
+  uint8_t quadros[QUADROS_POR_CLIENTE][TAM_QUADRO_MAX];
+} ClienteTelemetria;
+
+typedef struct {
+  FilaTelemetria *fila; // amostras do executivo
+  int fd_escuta;
+  int fd_epoll;
+  // Removido ao fechar, ou vazio (TCP)
+  char caminho_unix[sizeof(((struct sockaddr_un *)0)->sun_path)];
+  ClienteTelemetria *clientes[SERVIDOR_CLIENTES_MAX];
+  size_t n_clientes;
+  uint64_t sequencia;
+
+  // Estatísticas, válidas após o término da thread
+  unsigned long long conexoes;   // clientes aceitos
+  unsigned long long recusadas;  // além de SERVIDOR_CLIENTES_MAX
+  unsigned long long enviados;   // quadros entregues ao kernel
+  unsigned long long descartados; // quadros perdidos por clientes lentos
+} ServidorTelemetria;
+
+// Abre o socket de escuta em endereco. Deve ser chamado antes de criar as
+// threads; retorna false (com errno) se o endereço é inválido ou está em
+// uso.
+bool servidor_abrir(ServidorTelemetria *servidor, const char *endereco,
+                    FilaTelemetria *fila);
+
+// Fecha as conexões e o socket de escuta
+void servidor_fechar(ServidorTelemetria *servidor);
+
+// arg: ServidorTelemetria*. Atende os clientes até o executivo fechar a
+// fila, depois de distribuir a última amostra.
+void *servidor_telemetria(void *arg);
+
+// Lado do cliente: conecta a endereco, ou retorna -1 (com errno)
+int servidor_conectar(const char *endereco);
+
+// Converte "*" ou "nome,nome,..." em máscara de canais. Retorna false se
+// algum nome é desconhecido.
+bool servidor_interpretar_filtro(const char *texto, uint64_t *canais);
+
+#endif // SERVIDOR_TELEMETRIA_H
@@ -0,0 +1,109 @@
+#ifndef SIMULACAO_H
+#define SIMULACAO_H
+
+#include "common.h"
+#include "eventos.h"
+#include "integrador.h"
+#include "linha_tempo.h"
+#include "roteiro.h"
+#include "systems_control.h"
+#include "veiculos.h"
+
+// Contexto completo de uma simulação independente. Reúne a nave, o controle
+// de propulsão, as sementes dos subsistemas, o integrador e a linha do tempo
+// do sequenciador, permitindo executar várias naves em paralelo sem estado
+// global compartilhado.
+//
+// Com RK4 cada passo integra dt. Com DP54 o passo do contexto é o ciclo da
+// propulsão e a física só é integrada quando necessário (voo propulsado,
+// descida controlada ou mudança de empuxo), com passos adaptativos que podem
+// cobrir muitos ciclos de uma vez durante o voo balístico.
+//
+// Os eventos físicos (contato, esfera de influência, ápsides, fim do
+// combustível) são localizados dentro dos passos em ambos os casos.
+//
+// Os veículos secundários (veiculos.h) avançam juntos na taxa da
+// propulsão, e as separações acontecem no fim do passo em que o estado da
+// missão muda, qualquer que tenha sido a causa (sequenciador ou comando).
+//
+// O temporizador do sequenciador e as ações do roteiro (roteiro.h) vivem na
+// mesma linha do tempo (linha_tempo.h), contada em passos do contexto: o
+// passo em que vencem é o fim do passo n, quando passos chega a n. Um passo
+// sem nada vencendo só compara o contador com o próximo vencimento.
+
+// O que faz o sequenciador avançar a missão
+typedef enum {
+  SEQUENCIADOR_TEMPO,   // um estado a cada INTERVALO_SEQUENCIADOR
+  SEQUENCIADOR_EVENTOS, // estados com evento de saída esperam por ele
+  SEQUENCIADOR_ROTEIRO  // só as ações avancar do roteiro (e os comandos)
+} ModoSequenciador;
+
+typedef struct {
+  EstadoNave *nave;
+  ControlePropulsao propulsao;
+  unsigned int seed_propulsao;
+  unsigned int seed_energia;
+  ModoSequenciador sequenciador;
+
+  // Linha do tempo da missão e o temporizador do sequenciador nela. Um
+  // estado que espera pelo evento de saída suspende o temporizador, que
+  // guarda os passos que faltavam.
+  LinhaTempo linha_tempo;
+  uint64_t passos_sequenciador; // INTERVALO_SEQUENCIADOR em passos
+  int32_t temporizador;         // evento na linha do tempo, ou SEM_EVENTO
+  uint64_t temporizador_restante;
+  CondicoesRoteiro condicoes;
+  unsigned long long acoes_roteiro; // ações do roteiro executadas
+
+  ConfiguracaoIntegrador integrador;
+  EstadoIntegrador estado_integrador;
+  ContextoEventos eventos;
+  TabelaVeiculos veiculos;
+
+  double dt;             // passo do contexto em segundos simulados
+  long passos_propulsao; // período da propulsão em passos do contexto
+  long passos_energia;   // período da energia em passos do contexto
+  double tempo;          // relógio dos subsistemas em segundos simulados
+  unsigned long long passos;
+} ContextoSimulacao;
+
+// integrador pode ser NULL (RK4 de passo fixo). O sequenciador começa por
+// tempo.
+void inicializar_contexto(ContextoSimulacao *ctx, EstadoNave *nave, double dt,
+                          unsigned int semente,
+                          const ConfiguracaoIntegrador *integrador);
+
+// Programa as ações do roteiro a partir do relógio atual (as de instantes
+// que já passaram são ignoradas) e arma as condicionais. Retorna false, sem
+// carregar nada, se a linha do tempo ou as condicionais não comportam o
+// roteiro.
+bool contexto_carregar_roteiro(ContextoSimulacao *ctx,
+                               const RoteiroMissao *roteiro);
+
+// Valor de passos ao fim do passo em que vence o próximo evento da linha do
+// tempo (temporizador ou roteiro), ou UINT64_MAX se não há nenhum
+uint64_t contexto_proximo_evento(const ContextoSimulacao *ctx);
+
+// Executa um passo do contexto e os subsistemas que vencem neste passo
+void passo_contexto(ContextoSimulacao *ctx);
+
+// Avança o estado da missão e descarta os eventos físicos pendentes, para
+// que um cruzamento anterior não encerre o estado novo. Toda transição
+// (temporizador, evento, roteiro, [P] e ramos) passa por aqui.
+void contexto_avancar_estado(ContextoSimulacao *ctx);
+
+// Integra a física pendente até o relógio do contexto (usado ao encerrar)
+void finalizar_contexto(ContextoSimulacao *ctx);
+
+// Copia a nave para destino com a física pendente integrada até o relógio
+// do contexto, sem alterar o contexto nem os eventos registrados (a
+// trajetória não depende de quando o estado é observado)
+void estado_atual_contexto(const ContextoSimulacao *ctx, EstadoNave *destino);
+
+// Verdadeiro quando a missão terminou ou atingiu o limite de tempo simulado
+bool contexto_encerrado(const ContextoSimulacao *ctx, double duracao_max);
+
+// "tempo", "eventos" ou "roteiro"
+ModoSequenciador obter_modo_sequenciador(const char *nome, bool *valido);
+
+#endif // SIMULACAO_H
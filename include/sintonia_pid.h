@@ -0,0 +1,54 @@
+#ifndef SINTONIA_PID_H
+#define SINTONIA_PID_H
+
+#include "common.h"
+#include "systems_control.h"
+
+// Sintonia automática dos ganhos do PID de descida (ALUNISSAGEM).
+//
+// Cada conjunto de ganhos é avaliado numa descida isolada: um modelo
+// vertical com a gravidade da Lua e o mesmo passo_pid_descida do simulador,
+// no mesmo ciclo de propulsão. Entre dois ciclos o empuxo e a gravidade são
+// constantes, então o movimento é integrado de forma exata num único passo
+// por ciclo, e uma descida inteira custa microssegundos. As descidas são
+// distribuídas pelo pool de threads e a fronteira de Pareto é extraída dos
+// três critérios: velocidade de toque, combustível usado e tempo saturado.
+
+// Condição inicial da descida controlada
+typedef struct {
+  double altitude;            // m acima da superfície
+  double velocidade_vertical; // m/s (negativa descendo)
+  double massa_seca;          // kg
+  double combustivel;         // kg
+  double tempo_max;           // s; sem toque até lá, a descida é reprovada
+} CenarioDescida;
+
+typedef struct {
+  bool pousou;
+  double velocidade_toque;  // m/s, em módulo
+  double combustivel_usado; // kg
+  double tempo_saturado;    // s com o empuxo no limite (0 ou empuxo_max)
+  double tempo_descida;     // s
+} ResultadoDescida;
+
+typedef struct {
+  CenarioDescida cenario;
+  int pontos_por_eixo;   // grade logarítmica de kp, ki e kd
+  double fator_faixa;    // cada ganho varre [nominal / f, nominal * f]
+  double velocidade_max; // m/s; toques mais duros ficam fora da fronteira
+  int threads;           // trabalhadores no pool (0 = todos os núcleos)
+} ConfiguracaoSintonia;
+
+void configuracao_sintonia_padrao(ConfiguracaoSintonia *config);
+
+// Uma descida com os ganhos e limites de controle->pid_descida; o estado
+// do integrador e do termo derivativo começa zerado. Reentrante.
+void simular_descida(const ControlePropulsao *controle,
+                     const CenarioDescida *cenario,
+                     ResultadoDescida *resultado);
+
+// Avalia a grade em paralelo e imprime a fronteira de Pareto. Retorna 0 em
+// sucesso.
+int executar_sintonia_pid(const ConfiguracaoSintonia *config);
+
+#endif // SINTONIA_PID_H
@@ -0,0 +1,21 @@
+#ifndef SNAPSHOT_ESTADO_H
+#define SNAPSHOT_ESTADO_H
+
+#include "common.h"
+#include "veiculos.h"
+
+// Snapshot imutável do veículo exibido publicado pelo executivo a cada ciclo.
+//
+// Implementado como seqlock: o escritor (o executivo) nunca espera por
+// leitores, e os leitores (a interface) obtêm uma cópia consistente
+// sem lock, repetindo a leitura se ela cruzar uma publicação.
+
+// Publica uma cópia da nave e do rótulo do veículo que ela representa
+// (NULL: a nave principal, sozinha). Deve ser chamado por um único escritor.
+void publicar_snapshot(const EstadoNave *nave, const RotuloVeiculo *rotulo);
+
+// Copia o último snapshot publicado para destino e, se não for NULL, o
+// rótulo para rotulo. Retorna false se nenhum snapshot foi publicado ainda.
+bool ler_snapshot(EstadoNave *destino, RotuloVeiculo *rotulo);
+
+#endif // SNAPSHOT_ESTADO_H
@@ -3,7 +3,46 @@
 
 #include "common.h"
 
-void *controle_propulsao(void *arg);
-void *controle_energia(void *arg);
+#define INTERVALO_PROPULSAO 50000 // 50ms
+#define INTERVALO_ENERGIA 200000  // 200ms
+
+#define VELOCIDADE_DESCIDA_ALVO -2.0 // m/s no eixo Y durante a ALUNISSAGEM
+
+// Estado e ganhos do controlador PID de descida (ALUNISSAGEM)
+typedef struct {
+  double kp;            // Ganho proporcional
+  double ki;            // Ganho integral
+  double kd;            // Ganho derivativo
+  double empuxo_max;    // Limite do motor de descida em Newtons
+  double integral_erro; // Termo integral acumulado
+  double erro_anterior; // Erro do ciclo anterior (termo derivativo)
+} ControladorPID;
+
+// Parâmetros e estado da propulsão de uma nave. Cada simulação independente
+// possui o seu, tornando passo_propulsao reentrante.
+typedef struct {
+  double empuxo_lancamento; // em Newtons
+  double vazao_lancamento;  // consumo de combustível em kg/s
+  ControladorPID pid_descida;
+
+  // Segundos de queima que o combustível ainda permite no ciclo atual
+  // (INFINITY se dura o ciclo inteiro); marca o evento de esgotamento
+  double autonomia_ciclo;
+
+  // Empuxo das queimas do roteiro (N) nas fases sem propulsão própria
+  double empuxo_roteiro;
+} ControlePropulsao;
+
+// Um ciclo do PID de descida: atualiza o estado do controlador e retorna o
+// empuxo pedido, já limitado a [0, empuxo_max]
+double passo_pid_descida(ControladorPID *pid, double velocidade_vertical,
+                         double dt_real);
+
+// Passos de simulação, na thread que possui a nave. Cada um escreve apenas
+// o bloco do seu subsistema.
+void inicializar_controle_propulsao(ControlePropulsao *controle);
+void passo_propulsao(EstadoNave *nave, ControlePropulsao *controle,
+                     double dt_real, unsigned int *seed);
+void passo_energia(EstadoNave *nave, double dt_real, unsigned int *seed);
 
 #endif // SYSTEMS_CONTROL_H
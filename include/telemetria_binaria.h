@@ -0,0 +1,141 @@
+#ifndef TELEMETRIA_BINARIA_H
+#define TELEMETRIA_BINARIA_H
+
+#include "common.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Formato binário colunar de telemetria (.bin)
+//
+//   [cabeçalho de TELEMETRIA_TAM_CABECALHO bytes]
+//   [bloco 0][bloco 1]...[bloco n-1]
+//
+// Cada bloco guarda até TELEMETRIA_AMOSTRAS_POR_BLOCO amostras em colunas,
+// uma por canal. Cada coluna é codificada sem perdas com a menor das
+// codificações de CodificacaoColuna; todos os blocos exceto o último estão
+// cheios. O fim do arquivo é marcado por um bloco com zero amostras (ou pelo
+// próprio fim do arquivo).
+
+#define TELEMETRIA_MAGICA "APTLM\0\0\0"
+#define TELEMETRIA_VERSAO 2
+#define TELEMETRIA_TAM_CABECALHO 4096
+#define TELEMETRIA_AMOSTRAS_POR_BLOCO 256
+#define TELEMETRIA_TAM_NOME_CANAL 32
+
+// Canais gravados, em unidades SI
+typedef enum {
+  CANAL_TEMPO,           // s
+  CANAL_ESTADO,          // EstadoMissao
+  CANAL_POS_X,           // m
+  CANAL_POS_Y,           // m
+  CANAL_POS_Z,           // m
+  CANAL_VEL_X,           // m/s
+  CANAL_VEL_Y,           // m/s
+  CANAL_VEL_Z,           // m/s
+  CANAL_ACEL_X,          // m/s²
+  CANAL_ACEL_Y,          // m/s²
+  CANAL_ACEL_Z,          // m/s²
+  CANAL_COMBUSTIVEL,     // kg
+  CANAL_COMB_RCS,        // kg
+  CANAL_ENERGIA,         // Wh
+  CANAL_TEMPERATURA,     // °C
+  CANAL_EMPUXO,          // N
+  CANAL_EMPUXO_RCS,      // N
+  CANAL_ENERGIA_RESERVA, // Wh
+  CANAL_CONSUMO,         // W
+  CANAL_PRESSAO,         // kPa
+  CANAL_RADIACAO,        // mSv/h
+  TELEMETRIA_N_CANAIS
+} CanalTelemetria;
+
+typedef enum {
+  COLUNA_CONSTANTE, // um único double repetido
+  COLUNA_DELTA2,    // segunda diferença dos bits, zigzag + varint
+  COLUNA_XOR,       // XOR com o valor anterior, só os bytes significativos
+  COLUNA_BRUTA      // doubles sem codificação
+} CodificacaoColuna;
+
+typedef struct {
+  char magica[8];
+  uint32_t versao;
+  uint32_t n_canais;
+  uint32_t amostras_por_bloco;
+  uint32_t reservado;
+  char nomes[TELEMETRIA_N_CANAIS][TELEMETRIA_TAM_NOME_CANAL];
+} CabecalhoTelemetria;
+
+// Cabeçalho de cada bloco; as colunas seguem na ordem dos canais
+typedef struct {
+  uint32_t n_amostras;
+  uint32_t tamanho; // bytes do bloco, cabeçalho incluído, múltiplo de 8
+  double tempo_inicial;
+  double tempo_final;
+  uint8_t codificacao[TELEMETRIA_N_CANAIS];
+  uint8_t reservado[3];
+  uint16_t tamanho_coluna[TELEMETRIA_N_CANAIS];
+} CabecalhoBloco;
+
+// Escritor: arquivo de anexação mapeado em memória. As amostras são
+// acumuladas em colunas e cada bloco cheio é codificado direto no mapa;
+// chamadas de sistema só ocorrem ao crescer o arquivo.
+typedef struct {
+  int fd;
+  uint8_t *mapa;
+  size_t tamanho_mapa;
+  size_t deslocamento; // fim do último bloco gravado
+  uint64_t n_blocos;
+  uint64_t amostras_gravadas; // nos blocos já gravados
+  uint32_t amostras_no_bloco;
+  // errno da primeira falha ao crescer o arquivo, ou 0. Depois dela o
+  // escritor descarta as amostras: o arquivo fica com os blocos completos
+  // gravados até ali.
+  int erro;
+  double colunas[TELEMETRIA_N_CANAIS][TELEMETRIA_AMOSTRAS_POR_BLOCO];
+} EscritorTelemetria;
+
+// Leitor: arquivo inteiro mapeado somente para leitura, com a tabela de
+// deslocamentos dos blocos montada na abertura
+typedef struct {
+  int fd;
+  const uint8_t *mapa;
+  size_t tamanho;
+  const CabecalhoTelemetria *cabecalho;
+  size_t *deslocamentos;
+  uint64_t n_blocos;
+  uint64_t n_amostras;
+} LeitorTelemetria;
+
+const char *obter_nome_canal(CanalTelemetria canal);
+
+// Converte o estado da nave nos valores dos canais
+void telemetria_amostrar(const EstadoNave *nave,
+                         double valores[TELEMETRIA_N_CANAIS]);
+
+// Operação inversa, para reprodução: preenche os campos gravados da nave e
+// zera os demais
+void telemetria_restaurar_nave(const double valores[TELEMETRIA_N_CANAIS],
+                               EstadoNave *nave);
+
+bool telemetria_abrir_escrita(EscritorTelemetria *escritor,
+                              const char *caminho);
+// false se a amostra não foi aceita (escritor fechado ou em falha) ou se o
+// bloco que ela completou não pôde ser gravado
+bool telemetria_escrever(EscritorTelemetria *escritor,
+                         const double valores[TELEMETRIA_N_CANAIS]);
+void telemetria_fechar_escrita(EscritorTelemetria *escritor);
+
+bool telemetria_abrir_leitura(LeitorTelemetria *leitor, const char *caminho);
+
+// Abertura em duas etapas, para quem já conhece os blocos (índice): mapeia
+// e valida o cabeçalho sem percorrer o arquivo...
+bool telemetria_mapear(LeitorTelemetria *leitor, const char *caminho);
+// ...e percorre os cabeçalhos dos blocos montando a tabela de deslocamentos
+bool telemetria_percorrer_blocos(LeitorTelemetria *leitor);
+// Decodifica o bloco informado em colunas; retorna o número de amostras,
+// ou 0 se o bloco for inválido
+uint32_t telemetria_ler_bloco(
+    const LeitorTelemetria *leitor, uint64_t bloco,
+    double colunas[TELEMETRIA_N_CANAIS][TELEMETRIA_AMOSTRAS_POR_BLOCO]);
+void telemetria_fechar_leitura(LeitorTelemetria *leitor);
+
+#endif // TELEMETRIA_BINARIA_H
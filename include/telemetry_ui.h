@@ -2,8 +2,101 @@
 #define TELEMETRY_UI_H
 
 #include "common.h"
+#include "executivo.h"
+#include "fila_telemetria.h"
+#include "telemetria_binaria.h"
+#include <ncurses.h>
 
+// Log binário gravado pela interface quando nenhum arquivo é informado
+#define ARQUIVO_TELEMETRIA_PADRAO "telemetry.bin"
+
+// Configuração da thread de gravação de telemetria
+typedef struct {
+  // Log binário já aberto por quem cria a thread, que falha antes de
+  // iniciar a missão se não conseguir abri-lo. Fechado ao término.
+  EscritorTelemetria *escritor;
+  FilaTelemetria *fila;        // amostras produzidas pelo executivo
+  unsigned long long gravadas; // preenchido ao término da thread
+  int erro; // preenchido ao término: errno que interrompeu a gravação, ou 0
+  bool fixar_cpu; // prende a thread ao núcleo cpu
+  int cpu;
+} ConfiguracaoLogger;
+
+// Configuração da thread de interface
+typedef struct {
+  Executivo *executivo;           // contexto capturado pela tecla [C]
+  const char *arquivo_checkpoint; // destino dos checkpoints
+} ConfiguracaoInterface;
+
+// Limites da taxa de quadros adaptativa: o intervalo cai para o mínimo
+// quando o painel muda (ou uma tecla chega) e dobra a cada quadro parado
+#define QUADRO_MIN_MS 50   // no máximo 20 quadros/s
+#define QUADRO_MAX_MS 1000 // no mínimo 1 quadro/s
+
+// Maior fator de aceleração da tecla [A]. Com as cônicas (--kepler) o voo
+// balístico custa O(1) por trecho e o limite sobe; acima do que a CPU
+// alcança, o executivo apenas roda tão rápido quanto puder
+#define ACELERACAO_MAX 8192
+#define ACELERACAO_MAX_CONICA 1048576
+
+// Valores variáveis do painel de status, redesenhados um a um
+typedef enum {
+  CAMPO_ESTADO,
+  CAMPO_TEMPO,
+  CAMPO_POSICAO,
+  CAMPO_ACELERACAO,
+  CAMPO_VELOCIDADE,
+  CAMPO_COMBUSTIVEL,
+  CAMPO_RCS,
+  CAMPO_EMPUXO,
+  CAMPO_EMPUXO_RCS,
+  CAMPO_ENERGIA,
+  CAMPO_RESERVA,
+  CAMPO_CONSUMO,
+  CAMPO_TEMPERATURA,
+  CAMPO_PRESSAO,
+  CAMPO_RADIACAO,
+  CAMPO_SIMULACAO,
+  CAMPO_ALERTA,
+  CAMPO_STATUS,
+  CAMPO_CONTROLES,
+  N_CAMPOS_PAINEL
+} CampoPainel;
+
+#define TAMANHO_CAMPO_PAINEL 96
+
+// Janela dos painéis e o texto de cada campo no último desenho. A moldura
+// (bordas, títulos, separadores e rótulos) é desenhada uma vez; depois só
+// os campos cujo texto mudou são reescritos, e o terminal só recebe as
+// células alteradas.
+typedef struct {
+  WINDOW *win;
+  bool moldura_desenhada;
+  char campos[N_CAMPOS_PAINEL][TAMANHO_CAMPO_PAINEL];
+} PainelStatus;
+
+// Inicializa o ncurses e cria a janela fixa dos painéis
+void abrir_painel(PainelStatus *painel);
+void fechar_painel(PainelStatus *painel);
+
+// Redesenha tudo no próximo quadro (depois que outra tela usou a janela)
+void invalidar_painel(PainelStatus *painel);
+
+// Atualiza os painéis de status de nave. linha_simulacao, status e controles
+// são as linhas do rodapé (status pode ser NULL); usado tanto pela interface
+// ao vivo quanto pelo replay de um log gravado. Retorna false se nada mudou
+// desde o último quadro (e nada foi enviado ao terminal).
+bool desenhar_interface(PainelStatus *painel, const EstadoNave *nave,
+                        const char *linha_simulacao, const char *status,
+                        const char *controles);
+
+// Próximo intervalo entre quadros, dado se o último quadro mudou algo
+int proximo_intervalo_quadro(int intervalo_ms, bool alterado);
+
+// arg: ConfiguracaoInterface*
 void *interface_usuario(void *arg);
+// arg: ConfiguracaoLogger*. Esvazia a fila em lotes até que o executivo a
+// feche.
 void *telemetry_logger(void *arg);
 
 #endif // TELEMETRY_UI_H
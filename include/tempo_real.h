@@ -0,0 +1,21 @@
+#ifndef TEMPO_REAL_H
+#define TEMPO_REAL_H
+
+#include <stdbool.h>
+
+// Ajustes de escalonamento para o modo de tempo real estrito. Todos são
+// opcionais e falham sem interromper a simulação (por exemplo, sem
+// CAP_SYS_NICE): o chamador apenas informa o usuário.
+
+// Prende a thread chamadora ao núcleo informado (cpu < 0: nada a fazer)
+bool fixar_thread_cpu(int cpu);
+
+// Passa a thread chamadora para SCHED_FIFO com a prioridade informada
+// (prioridade <= 0: nada a fazer)
+bool solicitar_sched_fifo(int prioridade);
+
+// Trava na RAM as páginas atuais e futuras do processo, evitando falhas de
+// página dentro do laço de tempo real
+bool travar_memoria(void);
+
+#endif // TEMPO_REAL_H
@@ -0,0 +1,126 @@
+#ifndef VEICULOS_H
+#define VEICULOS_H
+
+#include "common.h"
+#include <stddef.h>
+#include <stdint.h>
+
+// Tabela de veículos secundários: estágios e módulos que se separam da nave
+// principal (S-IVB, CSM, estágios do LM, SM) e seguem em voo próprio, cada
+// um com sua massa, propulsão e energia.
+//
+// A nave principal continua no contexto com toda a fidelidade (integrador
+// configurado, gravidade por nível, eventos e subsistemas). Os secundários
+// ficam em arrays contíguos (SoA) dentro da própria tabela, sem ponteiros,
+// de modo que o contexto e seus checkpoints os carregam por cópia, e são
+// integrados todos de uma vez pelo propagador em lote (RK4 sob a gravidade
+// pontual Terra+Lua+Sol), na taxa da propulsão. Criar um veículo ocupa a
+// primeira posição livre; destruí-lo move o último para a vaga, então os
+// arrays ficam sempre densos e nenhuma thread é criada por veículo.
+
+// Múltiplo de 8: os kernels do lote processam blocos inteiros, e as
+// posições livres ficam zeradas
+#define VEICULOS_MAX 64
+#define NOME_VEICULO_MAX 16
+
+typedef enum {
+  VEICULO_APOLLO,     // a nave principal, a que leva a tripulação
+  VEICULO_SIVB,       // terceiro estágio, após a injeção translunar
+  VEICULO_CSM,        // módulo de comando e serviço, em órbita lunar
+  VEICULO_LM_DESCIDA, // estágio de descida, deixado na superfície
+  VEICULO_LM_SUBIDA,  // estágio de subida, descartado após o acoplamento
+  VEICULO_SM,         // módulo de serviço, descartado antes da reentrada
+  N_TIPOS_VEICULO
+} TipoVeiculo;
+
+// Identificador estável de um veículo: a posição nos arrays muda quando
+// outro é destruído, o id não. A nave principal é sempre ID_PRINCIPAL.
+typedef uint32_t IdVeiculo;
+#define ID_PRINCIPAL 0u
+
+typedef struct {
+  size_t n;                  // veículos em uso, nas posições [0, n)
+  double tempo;              // instante do estado dos veículos (s)
+  IdVeiculo proximo_id;
+  EstadoMissao estado_visto; // último estado da missão processado
+  bool separacoes;           // cria e destrói veículos nas transições
+  unsigned long long criados;
+  unsigned long long destruidos;
+
+  // Cada array ocupa VEICULOS_MAX * 8 bytes, múltiplo da linha de cache:
+  // alinhar o primeiro alinha todos
+  alignas(TAM_LINHA_CACHE) double px[VEICULOS_MAX];
+  double py[VEICULOS_MAX], pz[VEICULOS_MAX];
+  double vx[VEICULOS_MAX], vy[VEICULOS_MAX], vz[VEICULOS_MAX];
+  // Aceleração de empuxo do passo em curso (m/s²)
+  double ax_empuxo[VEICULOS_MAX], ay_empuxo[VEICULOS_MAX];
+  double az_empuxo[VEICULOS_MAX];
+  double massa_vazia[VEICULOS_MAX]; // kg
+  double combustivel[VEICULOS_MAX]; // kg
+  // Empuxo em N ao longo da velocidade (negativo: retrógrado), até o fim do
+  // combustível
+  double empuxo[VEICULOS_MAX];
+  double vazao[VEICULOS_MAX];   // kg/s com o motor aceso
+  double energia[VEICULOS_MAX]; // Wh
+  double consumo[VEICULOS_MAX]; // W, até o fim da energia
+  IdVeiculo id[VEICULOS_MAX];
+  TipoVeiculo tipo[VEICULOS_MAX];
+} TabelaVeiculos;
+
+// Identificação do veículo cujo estado é exibido
+typedef struct {
+  char nome[NOME_VEICULO_MAX];
+  uint32_t posicao; // na ordem de seleção: 1 é a nave principal
+  uint32_t total;   // veículos existentes, contando a principal
+} RotuloVeiculo;
+
+// Tabela vazia no instante e no estado da missão da nave principal, sem
+// separações
+void veiculos_inicializar(TabelaVeiculos *tabela, double tempo,
+                          EstadoMissao estado);
+
+// Cria um veículo no estado dado, sem empuxo, energia ou combustível.
+// Retorna a posição ou -1 se a tabela está cheia.
+long veiculos_criar(TabelaVeiculos *tabela, TipoVeiculo tipo, Vetor3D posicao,
+                    Vetor3D velocidade, double massa_vazia);
+void veiculos_destruir(TabelaVeiculos *tabela, size_t indice);
+
+// Integra todos os veículos de tabela->tempo até tempo em um passo,
+// queimando combustível e energia, e destrói os que atingirem a Terra ou a
+// Lua
+void veiculos_avancar(TabelaVeiculos *tabela, double tempo);
+
+// Cria e destrói os veículos das separações entre o último estado visto e
+// o atual da nave, que deve estar integrada até tabela->tempo. A massa que
+// se separa sai da nave principal, e a que se acopla volta para ela.
+void veiculos_separar(TabelaVeiculos *tabela, EstadoNave *principal);
+
+// Separa agora um veículo do tipo com a massa e a propulsão da sua
+// separação na tabela, fora das transições (ações do roteiro). Retorna
+// false se o tipo não se separa ou não há massa ou vaga para ele.
+bool veiculos_separar_tipo(TabelaVeiculos *tabela, EstadoNave *principal,
+                           TipoVeiculo tipo);
+
+// Posição do veículo com o id, ou -1 (inclusive para a nave principal, que
+// não está na tabela)
+long veiculos_indice(const TabelaVeiculos *tabela, IdVeiculo id);
+// Posição do primeiro veículo do tipo, ou -1
+long veiculos_buscar_tipo(const TabelaVeiculos *tabela, TipoVeiculo tipo);
+// Próximo na ordem de seleção (a principal e depois a tabela), circular
+IdVeiculo veiculos_proximo(const TabelaVeiculos *tabela, IdVeiculo id);
+
+// O veículo na posição indice como uma nave completa, para a interface e a
+// telemetria. Os blocos sem modelo próprio nos secundários (missão,
+// ambiente e comunicação) vêm da nave principal.
+void veiculos_como_nave(const TabelaVeiculos *tabela, size_t indice,
+                        const EstadoNave *principal, EstadoNave *destino);
+
+// Rótulo do veículo na posição indice, ou da principal com indice -1 (com
+// tabela NULL, a principal sozinha)
+void veiculos_rotulo(const TabelaVeiculos *tabela, long indice,
+                     RotuloVeiculo *rotulo);
+
+const char *obter_nome_veiculo(TipoVeiculo tipo);
+TipoVeiculo obter_tipo_veiculo(const char *nome, bool *valido);
+
+#endif // VEICULOS_H
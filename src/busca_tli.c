@@ -0,0 +1,500 @@
+#include "busca_tli.h"
+#include "efemerides.h"
+#include "eventos.h"
+#include "physics_engine.h"
+#include "pool_threads.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define G0 9.80665 // m/s², para o impulso específico
+#define MU_TERRA (G * M_TERRA)
+#define MU_LUA (G * M_LUA)
+
+// A queima usa sempre o mesmo número de passos (dt = duração / n): assim o
+// resultado varia continuamente com a duração, o que o corretor exige
+#define PASSOS_QUEIMA 400
+#define PASSO_ESTACIONAMENTO 10.0 // s, maior passo na órbita de espera
+
+// Na costa o passo é uma fração da escala de tempo local, min(r / v), tanto
+// em relação à Terra quanto à Lua. A grade só ordena candidatos e usa passos
+// maiores (erro de ~20 m na periapside); o corretor fica abaixo de 1 m
+#define FATOR_PASSO_GRADE 0.02
+#define FATOR_PASSO_CORRETOR 0.005
+#define PASSO_COSTA_MIN 0.5
+#define PASSO_COSTA_MAX 600.0
+
+#define ITERACOES_CORRETOR 20
+#define PERTURBACAO_DURACAO 1e-3 // s, diferença finita do corretor
+#define PASSO_CORRETOR_MAX 2.0   // s por iteração
+
+typedef enum {
+  DESFECHO_PERIAPSIDE,    // passou pela periapside lunar
+  DESFECHO_IMPACTO_LUA,   // periapside abaixo da superfície
+  DESFECHO_ENERGIA,       // podado: apogeu não alcança a Lua
+  DESFECHO_APOGEU,        // podado: apogeu passou longe da Lua
+  DESFECHO_IMPACTO_TERRA, // podado: caiu de volta
+  DESFECHO_ESCAPE,        // podado: além da órbita da Lua, longe dela
+  DESFECHO_TEMPO,         // podado: tempo de voo esgotado
+  N_DESFECHOS
+} DesfechoTLI;
+
+static const char *nomes_desfecho[N_DESFECHOS] = {
+    "periapside", "impacto na Lua", "energia insuficiente", "apogeu sem Lua",
+    "impacto na Terra", "escape", "tempo esgotado"};
+
+// Estado na órbita de estacionamento em cada instante de ignição da grade.
+// Depende só do instante, então é propagado uma vez para todos os
+// candidatos.
+typedef struct {
+  double tempo;
+  Vetor3D posicao;
+  Vetor3D velocidade;
+} EstadoIgnicao;
+
+typedef struct {
+  int ignicao; // índice em EstadoIgnicao
+  double duracao;
+  double arfagem, guinada; // rad
+} ParametrosTLI;
+
+typedef struct {
+  DesfechoTLI desfecho;
+  // Raio da periapside lunar (elementos osculadores em relação à Lua), ou a
+  // menor distância à Lua até o candidato ser podado
+  double raio_minimo;
+  double tempo_periapside;
+  double delta_v;
+  double massa_final;
+  unsigned long passos;
+} ResultadoTLI;
+
+typedef struct {
+  ParametrosTLI parametros;
+  ResultadoTLI resultado;
+  int iteracoes;
+  bool convergiu;
+} SolucaoTLI;
+
+typedef struct {
+  const ConfiguracaoBuscaTLI *config;
+  const EstadoIgnicao *ignicoes;
+  double raio_alvo;
+  ParametrosTLI *candidatos;
+  ResultadoTLI *resultados;
+  SolucaoTLI *solucoes;
+} ContextoBusca;
+
+static Vetor3D subtrair(Vetor3D a, Vetor3D b) {
+  return (Vetor3D){a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+static double escalar(Vetor3D a, Vetor3D b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static Vetor3D vetorial(Vetor3D a, Vetor3D b) {
+  return (Vetor3D){a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z,
+                   a.x * b.y - a.y * b.x};
+}
+
+static Vetor3D normalizar(Vetor3D a) {
+  double n = sqrt(escalar(a, a));
+  return (Vetor3D){a.x / n, a.y / n, a.z / n};
+}
+
+// Raio da periapside da cônica osculadora em torno de um corpo
+static double raio_periapside(Vetor3D r, Vetor3D v, double mu) {
+  double dist = sqrt(escalar(r, r));
+  Vetor3D h = vetorial(r, v);
+  double h2 = escalar(h, h);
+  double energia = 0.5 * escalar(v, v) - mu / dist;
+  double e2 = 1.0 + 2.0 * energia * h2 / (mu * mu);
+  double e = e2 > 0.0 ? sqrt(e2) : 0.0;
+  return h2 / mu / (1.0 + e);
+}
+
+// Direção do empuxo: velocidade girada pela arfagem no plano da órbita e
+// pela guinada para fora dele, recalculada a cada passo
+static Vetor3D direcao_empuxo(Vetor3D pos, Vetor3D vel, double arfagem,
+                              double guinada) {
+  Vetor3D tangente = normalizar(vel);
+  Vetor3D normal = normalizar(vetorial(pos, vel));
+  Vetor3D radial = vetorial(tangente, normal);
+  double ca = cos(arfagem), sa = sin(arfagem);
+  double cg = cos(guinada), sg = sin(guinada);
+  return (Vetor3D){cg * (ca * tangente.x + sa * radial.x) + sg * normal.x,
+                   cg * (ca * tangente.y + sa * radial.y) + sg * normal.y,
+                   cg * (ca * tangente.z + sa * radial.z) + sg * normal.z};
+}
+
+static double periodo_estacionamento(const ConfiguracaoBuscaTLI *config) {
+  double raio = RAIO_MIN_TERRA + config->altitude_estacionamento;
+  return 2.0 * M_PI * sqrt(raio * raio * raio / MU_TERRA);
+}
+
+// Estados da órbita de estacionamento nos instantes de ignição da grade
+static void propagar_estacionamento(const ConfiguracaoBuscaTLI *config,
+                                    EstadoIgnicao *ignicoes) {
+  double raio = RAIO_MIN_TERRA + config->altitude_estacionamento;
+  Vetor3D pos = {raio, 0.0, 0.0};
+  Vetor3D vel = {0.0, sqrt(MU_TERRA / raio), 0.0};
+  double tempo = config->tempo_inicial;
+  double intervalo = periodo_estacionamento(config) / config->n_ignicao;
+  NivelGravidade nivel = gravidade_nivel(ORBITA_TERRESTRE);
+  Vetor3D sem_empuxo = {0.0, 0.0, 0.0};
+
+  int passos = (int)ceil(intervalo / PASSO_ESTACIONAMENTO);
+  double dt = intervalo / passos;
+  for (int i = 0; i < config->n_ignicao; i++) {
+    ignicoes[i] = (EstadoIgnicao){tempo, pos, vel};
+    for (int p = 0; p < passos; p++) {
+      passo_rk4(&pos, &vel, tempo, dt, sem_empuxo, nivel);
+      tempo += dt;
+    }
+  }
+}
+
+// Propaga um candidato da ignição até a periapside lunar ou até ele se
+// mostrar incapaz de chegar lá
+static ResultadoTLI propagar_candidato(const ContextoBusca *busca,
+                                       const ParametrosTLI *parametros,
+                                       double fator_passo) {
+  const ConfiguracaoBuscaTLI *config = busca->config;
+  const EstadoIgnicao *ignicao = &busca->ignicoes[parametros->ignicao];
+  ResultadoTLI resultado = {.raio_minimo = INFINITY};
+  Vetor3D pos = ignicao->posicao;
+  Vetor3D vel = ignicao->velocidade;
+  double tempo = ignicao->tempo;
+
+  // --- Queima: empuxo constante, massa decrescente ---
+  double vazao = config->empuxo / (config->impulso_especifico * G0);
+  double massa = config->massa_inicial;
+  double dt = parametros->duracao / PASSOS_QUEIMA;
+  NivelGravidade nivel = gravidade_nivel(ORBITA_TERRESTRE);
+  for (int p = 0; p < PASSOS_QUEIMA; p++) {
+    Vetor3D dir = direcao_empuxo(pos, vel, parametros->arfagem,
+                                 parametros->guinada);
+    double a = config->empuxo / massa;
+    passo_rk4(&pos, &vel, tempo, dt, (Vetor3D){dir.x * a, dir.y * a, dir.z * a},
+              nivel);
+    tempo += dt;
+    massa -= vazao * dt;
+  }
+  resultado.passos = PASSOS_QUEIMA;
+  resultado.massa_final = massa;
+  resultado.delta_v =
+      config->impulso_especifico * G0 * log(config->massa_inicial / massa);
+
+  // Poda mais barata: o apogeu kepleriano após a queima não chega perto da
+  // órbita da Lua
+  Vetor3D lua = efemerides_lua(tempo);
+  double dist_lua_terra = sqrt(escalar(lua, lua));
+  double r = sqrt(escalar(pos, pos));
+  double energia = 0.5 * escalar(vel, vel) - MU_TERRA / r;
+  if (energia < 0.0) {
+    Vetor3D h = vetorial(pos, vel);
+    double a = -MU_TERRA / (2.0 * energia);
+    double e = sqrt(fmax(0.0, 1.0 + 2.0 * energia * escalar(h, h) /
+                                        (MU_TERRA * MU_TERRA)));
+    double apogeu = a * (1.0 + e);
+    if (apogeu < dist_lua_terra - RAIO_SOI_LUA) {
+      resultado.desfecho = DESFECHO_ENERGIA;
+      resultado.raio_minimo = dist_lua_terra - apogeu;
+      return resultado;
+    }
+  }
+
+  // --- Costa até a periapside lunar ---
+  nivel = gravidade_nivel(TRANSITO_LUNAR);
+  double fim_queima = tempo;
+  double taxa_anterior = -1.0;
+  Vetor3D sem_empuxo = {0.0, 0.0, 0.0};
+  for (;;) {
+    Vetor3D v_lua = efemerides_velocidade_lua(tempo);
+    Vetor3D rel = subtrair(pos, lua);
+    Vetor3D vel_rel = subtrair(vel, v_lua);
+    double dist_lua = sqrt(escalar(rel, rel));
+    double taxa = escalar(rel, vel_rel);
+    if (dist_lua < resultado.raio_minimo)
+      resultado.raio_minimo = dist_lua;
+
+    if (dist_lua < RAIO_SOI_LUA && (taxa >= 0.0 || dist_lua < RAIO_MIN_LUA)) {
+      // Logo após a periapside (ou já dentro da Lua), a cônica osculadora
+      // dá o raio da periapside de forma contínua nos parâmetros
+      resultado.desfecho =
+          taxa_anterior < 0.0 && dist_lua >= RAIO_MIN_LUA
+              ? DESFECHO_PERIAPSIDE
+              : DESFECHO_IMPACTO_LUA;
+      resultado.raio_minimo = raio_periapside(rel, vel_rel, MU_LUA);
+      if (resultado.desfecho == DESFECHO_PERIAPSIDE &&
+          resultado.raio_minimo < RAIO_MIN_LUA)
+        resultado.desfecho = DESFECHO_IMPACTO_LUA;
+      resultado.tempo_periapside = tempo;
+      return resultado;
+    }
+    taxa_anterior = taxa;
+
+    r = sqrt(escalar(pos, pos));
+    double radial_terra = escalar(pos, vel);
+    if (r < RAIO_MIN_TERRA) {
+      resultado.desfecho = DESFECHO_IMPACTO_TERRA;
+      return resultado;
+    }
+    if (dist_lua > RAIO_SOI_LUA) {
+      if (radial_terra < 0.0 && tempo - fim_queima > 3600.0) {
+        resultado.desfecho = DESFECHO_APOGEU;
+        return resultado;
+      }
+      if (r > sqrt(escalar(lua, lua)) + RAIO_SOI_LUA) {
+        resultado.desfecho = DESFECHO_ESCAPE;
+        return resultado;
+      }
+    }
+    if (tempo - fim_queima > config->tempo_voo_max) {
+      resultado.desfecho = DESFECHO_TEMPO;
+      return resultado;
+    }
+
+    double v = sqrt(escalar(vel, vel));
+    double v_rel = sqrt(escalar(vel_rel, vel_rel));
+    double escala = fmin(r / v, dist_lua / v_rel);
+    dt = fmin(PASSO_COSTA_MAX,
+              fmax(PASSO_COSTA_MIN, fator_passo * escala));
+    passo_rk4(&pos, &vel, tempo, dt, sem_empuxo, nivel);
+    tempo += dt;
+    lua = efemerides_lua(tempo);
+    resultado.passos++;
+  }
+}
+
+static void avaliar_candidato(size_t indice, void *arg) {
+  ContextoBusca *busca = arg;
+  busca->resultados[indice] =
+      propagar_candidato(busca, &busca->candidatos[indice],
+                         FATOR_PASSO_GRADE);
+}
+
+// Corretor diferencial: Newton na duração da queima, com a derivada do raio
+// da periapside por diferença finita
+static void corrigir_semente(size_t indice, void *arg) {
+  ContextoBusca *busca = arg;
+  const ConfiguracaoBuscaTLI *config = busca->config;
+  SolucaoTLI *solucao = &busca->solucoes[indice];
+  ParametrosTLI p = solucao->parametros;
+  ResultadoTLI r = propagar_candidato(busca, &p, FATOR_PASSO_CORRETOR);
+
+  double duracao_limite =
+      0.99 * config->massa_inicial * config->impulso_especifico * G0 /
+      config->empuxo;
+  for (int i = 0; i < ITERACOES_CORRETOR; i++) {
+    double erro = r.raio_minimo - busca->raio_alvo;
+    if (r.desfecho == DESFECHO_PERIAPSIDE && fabs(erro) < config->tolerancia) {
+      solucao->convergiu = true;
+      break;
+    }
+
+    ParametrosTLI vizinho = p;
+    vizinho.duracao += PERTURBACAO_DURACAO;
+    ResultadoTLI rv = propagar_candidato(busca, &vizinho, FATOR_PASSO_CORRETOR);
+    double derivada = (rv.raio_minimo - r.raio_minimo) / PERTURBACAO_DURACAO;
+    if (!isfinite(derivada) || derivada == 0.0)
+      break;
+
+    double passo = -erro / derivada;
+    if (passo > PASSO_CORRETOR_MAX)
+      passo = PASSO_CORRETOR_MAX;
+    if (passo < -PASSO_CORRETOR_MAX)
+      passo = -PASSO_CORRETOR_MAX;
+    p.duracao += passo;
+    if (p.duracao <= 0.0 || p.duracao > duracao_limite)
+      break;
+    r = propagar_candidato(busca, &p, FATOR_PASSO_CORRETOR);
+    solucao->iteracoes = i + 1;
+  }
+
+  solucao->parametros = p;
+  solucao->resultado = r;
+}
+
+static double ponto_grade(double min, double max, int n, int i) {
+  return n > 1 ? min + (max - min) * i / (n - 1) : 0.5 * (min + max);
+}
+
+static double segundos_desde(const struct timespec *inicio) {
+  struct timespec agora;
+  clock_gettime(CLOCK_MONOTONIC, &agora);
+  return (agora.tv_sec - inicio->tv_sec) +
+         (agora.tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+typedef struct {
+  double erro; // |raio mínimo - raio alvo|
+  size_t indice;
+} ErroCandidato;
+
+static int comparar_candidatos(const void *a, const void *b) {
+  double ea = ((const ErroCandidato *)a)->erro;
+  double eb = ((const ErroCandidato *)b)->erro;
+  return (ea > eb) - (ea < eb);
+}
+
+// Soluções convergidas primeiro, por delta-v crescente
+static int comparar_solucoes(const void *a, const void *b) {
+  const SolucaoTLI *sa = a, *sb = b;
+  if (sa->convergiu != sb->convergiu)
+    return sa->convergiu ? -1 : 1;
+  return (sa->resultado.delta_v > sb->resultado.delta_v) -
+         (sa->resultado.delta_v < sb->resultado.delta_v);
+}
+
+void configuracao_busca_tli_padrao(ConfiguracaoBuscaTLI *config) {
+  config->altitude_estacionamento = 185000.0;
+  config->tempo_inicial = 7200.0;
+  config->empuxo = 1.0e6;
+  config->impulso_especifico = 421.0;
+  config->massa_inicial = 140000.0;
+  config->periapside_alvo = 110000.0;
+  config->tolerancia = 100.0;
+  config->n_ignicao = 72;
+  config->n_duracao = 21;
+  config->duracao_min = 300.0;
+  config->duracao_max = 400.0;
+  config->n_arfagem = 3;
+  config->arfagem_max = 10.0;
+  config->n_guinada = 3;
+  config->guinada_max = 6.0;
+  config->tempo_voo_max = 5 * 86400.0;
+  config->sementes = 16;
+  config->threads = 0;
+}
+
+double busca_tli_horizonte(const ConfiguracaoBuscaTLI *config) {
+  return config->tempo_inicial + periodo_estacionamento(config) +
+         config->duracao_max + PASSO_CORRETOR_MAX * ITERACOES_CORRETOR +
+         config->tempo_voo_max + PASSO_COSTA_MAX;
+}
+
+int executar_busca_tli(const ConfiguracaoBuscaTLI *config) {
+  if (config->n_ignicao < 1 || config->n_duracao < 1 ||
+      config->n_arfagem < 1 || config->n_guinada < 1 ||
+      config->sementes < 1 || config->duracao_min <= 0.0 ||
+      config->duracao_max < config->duracao_min) {
+    fprintf(stderr, "busca-tli: configuracao invalida\n");
+    return 1;
+  }
+
+  int threads = config->threads > 0 ? config->threads : obter_numero_nucleos();
+  size_t n_candidatos = (size_t)config->n_ignicao * config->n_duracao *
+                        config->n_arfagem * config->n_guinada;
+  size_t n_sementes = (size_t)config->sementes;
+  if (n_sementes > n_candidatos)
+    n_sementes = n_candidatos;
+
+  EstadoIgnicao *ignicoes = malloc(config->n_ignicao * sizeof(EstadoIgnicao));
+  ParametrosTLI *candidatos = malloc(n_candidatos * sizeof(ParametrosTLI));
+  ResultadoTLI *resultados = malloc(n_candidatos * sizeof(ResultadoTLI));
+  ErroCandidato *ordem = malloc(n_candidatos * sizeof(ErroCandidato));
+  SolucaoTLI *solucoes = calloc(n_sementes, sizeof(SolucaoTLI));
+  if (!ignicoes || !candidatos || !resultados || !ordem || !solucoes) {
+    fprintf(stderr, "busca-tli: memoria insuficiente\n");
+    free(ignicoes);
+    free(candidatos);
+    free(resultados);
+    free(ordem);
+    free(solucoes);
+    return 1;
+  }
+
+  struct timespec inicio;
+  clock_gettime(CLOCK_MONOTONIC, &inicio);
+  propagar_estacionamento(config, ignicoes);
+
+  size_t k = 0;
+  for (int i = 0; i < config->n_ignicao; i++)
+    for (int d = 0; d < config->n_duracao; d++)
+      for (int a = 0; a < config->n_arfagem; a++)
+        for (int g = 0; g < config->n_guinada; g++)
+          candidatos[k++] = (ParametrosTLI){
+              .ignicao = i,
+              .duracao = ponto_grade(config->duracao_min, config->duracao_max,
+                                     config->n_duracao, d),
+              .arfagem = ponto_grade(-config->arfagem_max, config->arfagem_max,
+                                     config->n_arfagem, a) *
+                         M_PI / 180.0,
+              .guinada = ponto_grade(-config->guinada_max, config->guinada_max,
+                                     config->n_guinada, g) *
+                         M_PI / 180.0};
+
+  ContextoBusca busca = {.config = config,
+                         .ignicoes = ignicoes,
+                         .raio_alvo = RAIO_MIN_LUA + config->periapside_alvo,
+                         .candidatos = candidatos,
+                         .resultados = resultados,
+                         .solucoes = solucoes};
+
+  // --- Varredura em grade ---
+  executar_em_paralelo(n_candidatos, threads, avaliar_candidato, &busca);
+  double tempo_grade = segundos_desde(&inicio);
+
+  unsigned long desfechos[N_DESFECHOS] = {0};
+  unsigned long passos = 0;
+  for (size_t i = 0; i < n_candidatos; i++) {
+    desfechos[resultados[i].desfecho]++;
+    passos += resultados[i].passos;
+    ordem[i] = (ErroCandidato){
+        fabs(resultados[i].raio_minimo - busca.raio_alvo), i};
+  }
+  qsort(ordem, n_candidatos, sizeof(ErroCandidato), comparar_candidatos);
+
+  // --- Corretor diferencial nas melhores sementes ---
+  for (size_t i = 0; i < n_sementes; i++)
+    solucoes[i].parametros = candidatos[ordem[i].indice];
+  executar_em_paralelo(n_sementes, threads, corrigir_semente, &busca);
+  double tempo_total = segundos_desde(&inicio);
+  qsort(solucoes, n_sementes, sizeof(SolucaoTLI), comparar_solucoes);
+
+  printf("Busca TLI: %zu candidatos em %.3f s (%.0f candidatos/s, "
+         "%.0f passos RK4 em media), %d threads\n",
+         n_candidatos, tempo_grade,
+         tempo_grade > 0.0 ? n_candidatos / tempo_grade : 0.0,
+         (double)passos / n_candidatos, threads);
+  printf("  Desfechos:");
+  for (int d = 0; d < N_DESFECHOS; d++)
+    if (desfechos[d] > 0)
+      printf(" %s=%lu", nomes_desfecho[d], desfechos[d]);
+  printf("\n");
+  printf("  Corretor: %zu sementes, total %.3f s\n", n_sementes, tempo_total);
+  printf("  Alvo: periapside lunar a %.1f km (tolerancia %.0f m)\n\n",
+         config->periapside_alvo / 1000.0, config->tolerancia);
+
+  printf("  %-3s %10s %9s %8s %8s %9s %12s %10s %5s\n", "#", "ignicao(s)",
+         "duracao", "arfagem", "guinada", "dv(m/s)", "periapside", "voo(h)",
+         "iter");
+  int convergidas = 0;
+  for (size_t i = 0; i < n_sementes; i++) {
+    const SolucaoTLI *s = &solucoes[i];
+    if (!s->convergiu)
+      continue;
+    convergidas++;
+    double t_ign = ignicoes[s->parametros.ignicao].tempo;
+    printf("  %-3d %10.1f %9.4f %8.2f %8.2f %9.1f %9.3f km %10.2f %5d\n",
+           convergidas, t_ign, s->parametros.duracao,
+           s->parametros.arfagem * 180.0 / M_PI,
+           s->parametros.guinada * 180.0 / M_PI, s->resultado.delta_v,
+           (s->resultado.raio_minimo - RAIO_MIN_LUA) / 1000.0,
+           (s->resultado.tempo_periapside - t_ign - s->parametros.duracao) /
+               3600.0,
+           s->iteracoes);
+  }
+  if (convergidas == 0)
+    printf("  Nenhuma semente convergiu; amplie a grade\n");
+
+  free(ignicoes);
+  free(candidatos);
+  free(resultados);
+  free(ordem);
+  free(solucoes);
+  return convergidas > 0 ? 0 : 1;
+}
@@ -0,0 +1,110 @@
+#include "checkpoint.h"
+#include "efemerides.h"
+#include "gravidade_harmonica.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint64_t fnv1a(const void *dados, size_t tamanho) {
+  const uint8_t *bytes = dados;
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < tamanho; i++) {
+    hash ^= bytes[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+void checkpoint_capturar(Checkpoint *checkpoint, const ContextoSimulacao *ctx) {
+  memcpy(&checkpoint->nave, ctx->nave, sizeof(EstadoNave));
+  memcpy(&checkpoint->contexto, ctx, sizeof(ContextoSimulacao));
+  checkpoint->contexto.nave = NULL;
+  configuracao_fisica_capturar(&checkpoint->fisica);
+}
+
+void checkpoint_restaurar(const Checkpoint *checkpoint, ContextoSimulacao *ctx,
+                          EstadoNave *nave) {
+  memcpy(nave, &checkpoint->nave, sizeof(EstadoNave));
+  memcpy(ctx, &checkpoint->contexto, sizeof(ContextoSimulacao));
+  ctx->nave = nave;
+}
+
+void configuracao_fisica_capturar(ConfiguracaoFisica *fisica) {
+  memset(fisica, 0, sizeof(*fisica)); // sem bytes indeterminados na soma
+  fisica->grau_gravidade = gravidade_grau();
+  fisica->ordem_gravidade = gravidade_ordem();
+  for (int i = 0; i < N_ESTADOS_MISSAO; i++)
+    fisica->niveis_gravidade[i] = gravidade_nivel((EstadoMissao)i);
+  fisica->duracao_efemerides = efemerides_duracao();
+}
+
+bool configuracao_gravidade_igual(const ConfiguracaoFisica *a,
+                                  const ConfiguracaoFisica *b) {
+  return a->grau_gravidade == b->grau_gravidade &&
+         a->ordem_gravidade == b->ordem_gravidade &&
+         memcmp(a->niveis_gravidade, b->niveis_gravidade,
+                sizeof(a->niveis_gravidade)) == 0;
+}
+
+bool configuracao_fisica_aplicar(const ConfiguracaoFisica *fisica,
+                                 const char *caminho_efemerides) {
+  if (!gravidade_configurar(fisica->grau_gravidade, fisica->ordem_gravidade))
+    return false;
+  for (int i = 0; i < N_ESTADOS_MISSAO; i++) {
+    NivelGravidade nivel = fisica->niveis_gravidade[i];
+    if ((int)nivel < 0 || nivel >= N_NIVEIS_GRAVIDADE)
+      return false;
+    gravidade_definir_nivel((EstadoMissao)i, nivel);
+  }
+  if (fisica->duracao_efemerides != efemerides_duracao())
+    return efemerides_inicializar(fisica->duracao_efemerides,
+                                  caminho_efemerides);
+  return true;
+}
+
+bool checkpoint_salvar(const Checkpoint *checkpoint, const char *caminho) {
+  CabecalhoCheckpoint cabecalho = {
+      .versao = CHECKPOINT_VERSAO,
+      .tamanho_nave = sizeof(EstadoNave),
+      .tamanho_contexto = sizeof(ContextoSimulacao),
+      .soma_verificacao = fnv1a(checkpoint, sizeof(*checkpoint))};
+  memcpy(cabecalho.magica, CHECKPOINT_MAGICA, sizeof(cabecalho.magica));
+
+  // Grava em um arquivo temporário e renomeia: um checkpoint existente nunca
+  // fica pela metade
+  char temporario[4096];
+  if (snprintf(temporario, sizeof(temporario), "%s.tmp", caminho) >=
+      (int)sizeof(temporario))
+    return false;
+
+  FILE *arquivo = fopen(temporario, "wb");
+  if (!arquivo)
+    return false;
+  bool ok = fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+            fwrite(checkpoint, sizeof(*checkpoint), 1, arquivo) == 1;
+  ok = fclose(arquivo) == 0 && ok;
+
+  if (!ok || rename(temporario, caminho) != 0) {
+    remove(temporario);
+    return false;
+  }
+  return true;
+}
+
+bool checkpoint_carregar(Checkpoint *checkpoint, const char *caminho) {
+  FILE *arquivo = fopen(caminho, "rb");
+  if (!arquivo)
+    return false;
+
+  CabecalhoCheckpoint cabecalho;
+  bool ok = fread(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+            memcmp(cabecalho.magica, CHECKPOINT_MAGICA,
+                   sizeof(cabecalho.magica)) == 0 &&
+            cabecalho.versao == CHECKPOINT_VERSAO &&
+            cabecalho.tamanho_nave == sizeof(EstadoNave) &&
+            cabecalho.tamanho_contexto == sizeof(ContextoSimulacao) &&
+            fread(checkpoint, sizeof(*checkpoint), 1, arquivo) == 1 &&
+            fnv1a(checkpoint, sizeof(*checkpoint)) ==
+                cabecalho.soma_verificacao;
+  fclose(arquivo);
+  return ok;
+}
@@ -1,8 +1,6 @@
 #include "common.h"
-#include <stdio.h>
 
 EstadoNave estado_nave;
-pthread_mutex_t mutex_estado = PTHREAD_MUTEX_INITIALIZER;
 
 const char *obter_nome_estado(EstadoMissao estado) {
   switch (estado) {
@@ -35,56 +33,78 @@ const char *obter_nome_estado(EstadoMissao estado) {
   }
 }
 
-void acionar_emergencia(const char *motivo) {
-  (void)motivo;
-  pthread_mutex_lock(&mutex_estado);
-  if (estado_nave.estado_missao != EMERGENCIA) {
-    estado_nave.estado_missao = EMERGENCIA;
-    estado_nave.emergencia = true;
+void inicializar_nave(EstadoNave *nave) {
+  // Posiciona a nave na superfície da Terra (Raio equatorial ~6.378 km)
+  nave->posicao = (Vetor3D){0.0, 6378137.0, 0.0};
+  nave->velocidade = (Vetor3D){0.0, 0.0, 0.0};
+  nave->aceleracao = (Vetor3D){0.0, 0.0, 0.0};
+  nave->orientacao = (Vetor3D){0.0, 1.0, 0.0};
+
+  nave->estado_missao = PREPARACAO;
+  nave->tempo_missao = 0.0;
+
+  nave->massa_vazia = 100000.0; // aprox 100 toneladas vazio (Sem comb.)
+  nave->combustivel_principal = 1924000.0; // Foguete cheio
+  nave->combustivel_rcs = 500.0;
+  nave->empuxo_principal = 0.0;
+  nave->empuxo_rcs = 0.0;
+
+  nave->energia_principal = 10000.0;
+  nave->energia_reserva = 5000.0;
+  nave->consumo_energia = 100.0;
+
+  nave->temperatura_interna = 22.0;
+  nave->pressao_interna = 101.3;
+  nave->radiacao = 0.1;
+  nave->energia_esgotada = false;
+
+  nave->comunicacao_ativa = true;
+  nave->forca_sinal = 100.0;
+
+  nave->emergencia = false;
+}
+
+void entrar_emergencia(EstadoNave *nave) {
+  if (nave->estado_missao != EMERGENCIA) {
+    nave->estado_missao = EMERGENCIA;
+    nave->emergencia = true;
   }
-  // O motivo será tratado pela UI separadamente, mas em um dmesg / log
-  // poderíamos salvar aqui
-  pthread_mutex_unlock(&mutex_estado);
 }
 
-void avancar_estado_missao() {
-  pthread_mutex_lock(&mutex_estado);
-  switch (estado_nave.estado_missao) {
+void avancar_estado(EstadoNave *nave) {
+  switch (nave->estado_missao) {
   case PREPARACAO:
-    estado_nave.estado_missao = LANCAMENTO;
+    nave->estado_missao = LANCAMENTO;
     break;
   case LANCAMENTO:
-    estado_nave.estado_missao = ORBITA_TERRESTRE;
+    nave->estado_missao = ORBITA_TERRESTRE;
     break;
   case ORBITA_TERRESTRE:
-    estado_nave.estado_missao = TRANSITO_LUNAR;
+    nave->estado_missao = TRANSITO_LUNAR;
     break;
   case TRANSITO_LUNAR:
-    estado_nave.estado_missao = ORBITA_LUNAR;
+    nave->estado_missao = ORBITA_LUNAR;
     break;
   case ORBITA_LUNAR:
-    estado_nave.estado_missao = ALUNISSAGEM;
+    nave->estado_missao = ALUNISSAGEM;
     break;
   case ALUNISSAGEM:
-    estado_nave.estado_missao = SUPERFICIE_LUNAR;
+    nave->estado_missao = SUPERFICIE_LUNAR;
     break;
   case SUPERFICIE_LUNAR:
-    estado_nave.estado_missao = RETORNO_TERRA;
+    nave->estado_missao = RETORNO_TERRA;
     break;
   case RETORNO_TERRA:
-    estado_nave.estado_missao = REENTRADA;
+    nave->estado_missao = REENTRADA;
     break;
   case REENTRADA:
-    estado_nave.estado_missao = AMERISSAGEM;
+    nave->estado_missao = AMERISSAGEM;
     break;
   case AMERISSAGEM:
-    estado_nave.estado_missao = FINALIZACAO;
+    nave->estado_missao = FINALIZACAO;
     break;
   case FINALIZACAO:
-    atomic_store(&estado_nave.sistema_ativo, false);
-    break;
   case EMERGENCIA:
     break;
   }
-  pthread_mutex_unlock(&mutex_estado);
 }
@@ -0,0 +1,221 @@
+#include "estado_compartilhado.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+// Tentativas de um leitor antes de desistir de uma sequência ímpar: um
+// escritor vivo termina a publicação em bem menos tempo, um que morreu no
+// meio dela nunca termina
+#define TENTATIVAS_LEITURA_MAX 100000
+
+static uint64_t relogio_ns(void) {
+  struct timespec agora;
+  clock_gettime(CLOCK_MONOTONIC, &agora);
+  return (uint64_t)agora.tv_sec * 1000000000ULL + (uint64_t)agora.tv_nsec;
+}
+
+// Um segmento com nome é de um simulador vivo quando o cabeçalho é desta
+// versão, não foi encerrado e o pid gravado ainda existe (EPERM: existe,
+// mas é de outro usuário). Cabeçalho ilegível ou incompleto conta como
+// sobra de uma execução interrompida.
+static bool segmento_em_uso(const char *nome) {
+  int fd = shm_open(nome, O_RDONLY, 0);
+  if (fd < 0)
+    return false;
+  struct stat info;
+  void *mapa = MAP_FAILED;
+  if (fstat(fd, &info) == 0 &&
+      (size_t)info.st_size >= sizeof(CabecalhoEstadoCompartilhado))
+    mapa = mmap(NULL, sizeof(CabecalhoEstadoCompartilhado), PROT_READ,
+                MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapa == MAP_FAILED)
+    return false;
+
+  const CabecalhoEstadoCompartilhado *cabecalho = mapa;
+  bool em_uso = atomic_load_explicit(&cabecalho->magica,
+                                     memory_order_acquire) ==
+                    ESTADO_COMPARTILHADO_MAGICA &&
+                cabecalho->versao == ESTADO_COMPARTILHADO_VERSAO &&
+                !atomic_load_explicit(&cabecalho->encerrado,
+                                      memory_order_acquire) &&
+                cabecalho->pid > 0 &&
+                (kill((pid_t)cabecalho->pid, 0) == 0 || errno == EPERM);
+  munmap(mapa, sizeof(CabecalhoEstadoCompartilhado));
+  return em_uso;
+}
+
+bool exportacao_abrir(ExportacaoEstado *exportacao, const char *nome) {
+  exportacao->segmento = NULL;
+  if (nome[0] != '/' || strlen(nome) >= sizeof(exportacao->nome) ||
+      strchr(nome + 1, '/')) {
+    errno = EINVAL;
+    return false;
+  }
+  strcpy(exportacao->nome, nome);
+
+  // O segmento de outro simulador em execução não é tocado. Um que sobrou
+  // de uma execução interrompida é substituído; os leitores que ainda o
+  // mapeiam não veem mais publicações. Se outro simulador criar o nome
+  // entre a verificação e shm_open, O_EXCL falha com EEXIST.
+  if (segmento_em_uso(nome)) {
+    errno = EEXIST;
+    return false;
+  }
+  shm_unlink(nome);
+  int fd = shm_open(nome, O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0)
+    return false;
+  if (ftruncate(fd, sizeof(SegmentoEstado)) < 0) {
+    int erro = errno;
+    close(fd);
+    shm_unlink(nome);
+    errno = erro;
+    return false;
+  }
+  void *mapa = mmap(NULL, sizeof(SegmentoEstado), PROT_READ | PROT_WRITE,
+                    MAP_SHARED, fd, 0);
+  close(fd); // o mapeamento mantém o segmento
+  if (mapa == MAP_FAILED) {
+    int erro = errno;
+    shm_unlink(nome);
+    errno = erro;
+    return false;
+  }
+
+  // ftruncate já zerou o segmento: sequência 0, nada publicado
+  SegmentoEstado *segmento = mapa;
+  segmento->cabecalho.versao = ESTADO_COMPARTILHADO_VERSAO;
+  segmento->cabecalho.tamanho_nave = sizeof(EstadoNave);
+  segmento->cabecalho.tamanho_segmento = sizeof(SegmentoEstado);
+  segmento->cabecalho.pid = (int32_t)getpid();
+  atomic_store_explicit(&segmento->cabecalho.magica,
+                        ESTADO_COMPARTILHADO_MAGICA, memory_order_release);
+  exportacao->segmento = segmento;
+  return true;
+}
+
+void exportacao_publicar(ExportacaoEstado *exportacao, const EstadoNave *nave,
+                         unsigned long long passos) {
+  EstadoExportado estado;
+  memset(&estado, 0, sizeof(estado)); // sem bytes indeterminados
+  estado.nave = *nave;
+  estado.passos = passos;
+  estado.instante_ns = relogio_ns();
+  uint64_t copia[PALAVRAS_ESTADO_EXPORTADO];
+  memcpy(copia, &estado, sizeof(copia));
+
+  SegmentoEstado *segmento = exportacao->segmento;
+  uint64_t seq =
+      atomic_load_explicit(&segmento->sequencia, memory_order_relaxed);
+  atomic_store_explicit(&segmento->sequencia, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  for (size_t i = 0; i < PALAVRAS_ESTADO_EXPORTADO; i++)
+    atomic_store_explicit(&segmento->palavras[i], copia[i],
+                          memory_order_relaxed);
+
+  atomic_store_explicit(&segmento->sequencia, seq + 2, memory_order_release);
+}
+
+void exportacao_fechar(ExportacaoEstado *exportacao) {
+  if (!exportacao->segmento)
+    return;
+  atomic_store_explicit(&exportacao->segmento->cabecalho.encerrado, true,
+                        memory_order_release);
+  munmap(exportacao->segmento, sizeof(SegmentoEstado));
+  shm_unlink(exportacao->nome);
+  exportacao->segmento = NULL;
+}
+
+bool leitor_estado_abrir(LeitorEstado *leitor, const char *nome) {
+  leitor->segmento = NULL;
+  int fd = shm_open(nome, O_RDONLY, 0);
+  if (fd < 0)
+    return false;
+  struct stat info;
+  if (fstat(fd, &info) < 0) {
+    int erro = errno;
+    close(fd);
+    errno = erro;
+    return false;
+  }
+  // Ainda sem tamanho: o escritor está entre shm_open e ftruncate
+  if ((size_t)info.st_size < sizeof(CabecalhoEstadoCompartilhado)) {
+    close(fd);
+    errno = EAGAIN;
+    return false;
+  }
+  size_t tamanho = (size_t)info.st_size;
+  void *mapa = mmap(NULL, tamanho, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapa == MAP_FAILED)
+    return false;
+
+  const SegmentoEstado *segmento = mapa;
+  const CabecalhoEstadoCompartilhado *cabecalho = &segmento->cabecalho;
+  uint64_t magica =
+      atomic_load_explicit(&cabecalho->magica, memory_order_acquire);
+  int erro = 0;
+  if (magica == 0)
+    erro = EAGAIN;
+  else if (magica != ESTADO_COMPARTILHADO_MAGICA ||
+           cabecalho->versao != ESTADO_COMPARTILHADO_VERSAO ||
+           cabecalho->tamanho_nave != sizeof(EstadoNave) ||
+           cabecalho->tamanho_segmento != sizeof(SegmentoEstado) ||
+           tamanho != sizeof(SegmentoEstado))
+    erro = EPROTO;
+  if (erro) {
+    munmap(mapa, tamanho);
+    errno = erro;
+    return false;
+  }
+  leitor->segmento = segmento;
+  return true;
+}
+
+void leitor_estado_fechar(LeitorEstado *leitor) {
+  if (leitor->segmento)
+    munmap((void *)leitor->segmento, sizeof(SegmentoEstado));
+  leitor->segmento = NULL;
+}
+
+bool leitor_estado_ler(const LeitorEstado *leitor, EstadoExportado *destino,
+                       uint64_t *sequencia) {
+  const SegmentoEstado *segmento = leitor->segmento;
+  uint64_t copia[PALAVRAS_ESTADO_EXPORTADO];
+  uint64_t inicio, fim;
+  int tentativas = 0;
+
+  do {
+    if (tentativas++ == TENTATIVAS_LEITURA_MAX)
+      return false;
+    inicio = atomic_load_explicit(&segmento->sequencia, memory_order_acquire);
+    if (inicio == 0)
+      return false;
+    if (inicio & 1u)
+      continue; // escrita em andamento
+
+    for (size_t i = 0; i < PALAVRAS_ESTADO_EXPORTADO; i++)
+      copia[i] =
+          atomic_load_explicit(&segmento->palavras[i], memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_acquire);
+    fim = atomic_load_explicit(&segmento->sequencia, memory_order_relaxed);
+  } while (inicio & 1u || inicio != fim);
+
+  memcpy(destino, copia, sizeof(copia));
+  if (sequencia)
+    *sequencia = inicio / 2;
+  return true;
+}
+
+bool leitor_estado_encerrado(const LeitorEstado *leitor) {
+  return atomic_load_explicit(&leitor->segmento->cabecalho.encerrado,
+                              memory_order_acquire);
+}
@@ -0,0 +1,335 @@
+#include "eventos.h"
+#include "efemerides.h"
+#include "physics_engine.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define AMOSTRAS_EVENTO 8       // subintervalos quando g pode cruzar duas vezes
+#define TOLERANCIA_TEMPO 1e-6   // s, largura final do intervalo do zero
+#define ITERACOES_EVENTO 100
+#define VELOCIDADE_MAX_LUA 1.2e3 // m/s, limite da velocidade orbital da Lua
+#define DISTANCIA_MIN_LUA 3.5e8  // m, abaixo do perigeu lunar (~356.400 km)
+
+// Estado interpolado no passo: Hermite cúbico em θ ∈ [0, 1] a partir das
+// posições e velocidades das pontas
+typedef struct {
+  double t0, h;
+  Vetor3D p0, v0, p1, v1;
+  double r0, r1; // |p0| e |p1|
+  double velocidade_max, variacao_velocidade;
+} Interpolacao;
+
+static void interpolar(const Interpolacao *in, double theta, Vetor3D *p,
+                       Vetor3D *v) {
+  double t2 = theta * theta, t3 = t2 * theta;
+  double h00 = 2 * t3 - 3 * t2 + 1, h10 = t3 - 2 * t2 + theta;
+  double h01 = -2 * t3 + 3 * t2, h11 = t3 - t2;
+  double d00 = 6 * t2 - 6 * theta, d10 = 3 * t2 - 4 * theta + 1;
+  double d01 = -6 * t2 + 6 * theta, d11 = 3 * t2 - 2 * theta;
+  double h = in->h;
+
+  p->x = h00 * in->p0.x + h10 * h * in->v0.x + h01 * in->p1.x +
+         h11 * h * in->v1.x;
+  p->y = h00 * in->p0.y + h10 * h * in->v0.y + h01 * in->p1.y +
+         h11 * h * in->v1.y;
+  p->z = h00 * in->p0.z + h10 * h * in->v0.z + h01 * in->p1.z +
+         h11 * h * in->v1.z;
+
+  v->x = (d00 * in->p0.x + d01 * in->p1.x) / h + d10 * in->v0.x +
+         d11 * in->v1.x;
+  v->y = (d00 * in->p0.y + d01 * in->p1.y) / h + d10 * in->v0.y +
+         d11 * in->v1.y;
+  v->z = (d00 * in->p0.z + d01 * in->p1.z) / h + d10 * in->v0.z +
+         d11 * in->v1.z;
+}
+
+static double norma(Vetor3D a) {
+  return sqrt(a.x * a.x + a.y * a.y + a.z * a.z);
+}
+
+// Perto da Terra basta um limite inferior da distância à Lua, sem consultar
+// as efemérides: ele só é usado para concluir que g está longe do zero
+static double distancia_lua(double tempo, Vetor3D p, double r) {
+  if (r < 0.5 * DISTANCIA_MIN_LUA)
+    return DISTANCIA_MIN_LUA - r;
+  Vetor3D lua = efemerides_lua(tempo);
+  return norma((Vetor3D){p.x - lua.x, p.y - lua.y, p.z - lua.z});
+}
+
+// g no estado (tempo, p, v), com r = |p| já calculado
+static double funcao_evento(const ContextoEventos *eventos,
+                            const DefinicaoEvento *d, double tempo, Vetor3D p,
+                            Vetor3D v, double r) {
+  switch (d->tipo) {
+  case EVENTO_ALTITUDE_TERRA:
+    return r - (RAIO_TERRA + d->valor);
+  case EVENTO_ALTITUDE_LUA:
+    return distancia_lua(tempo, p, r) - (RAIO_MIN_LUA + d->valor);
+  case EVENTO_SOI_LUA:
+    return distancia_lua(tempo, p, r) - RAIO_SOI_LUA;
+  case EVENTO_APSIDE_TERRA:
+    return p.x * v.x + p.y * v.y + p.z * v.z;
+  case EVENTO_COMBUSTIVEL:
+  default:
+    return eventos->tempo_esgotamento - tempo;
+  }
+}
+
+// Quanto g pode variar ao longo do passo (com folga). Se |g| nas duas
+// pontas passa disso, não há zero no passo e nenhuma busca é feita.
+static double variacao_maxima(const DefinicaoEvento *d,
+                              const Interpolacao *in) {
+  double v = in->velocidade_max;
+  switch (d->tipo) {
+  case EVENTO_ALTITUDE_TERRA:
+    return 2.0 * v * in->h;
+  case EVENTO_ALTITUDE_LUA:
+  case EVENTO_SOI_LUA:
+    return 2.0 * (v + VELOCIDADE_MAX_LUA) * in->h;
+  case EVENTO_APSIDE_TERRA:
+    // d(r · v)/dt = v² + r · a
+    return 2.0 * (v * v * in->h +
+                  fmax(in->r0, in->r1) * in->variacao_velocidade);
+  case EVENTO_COMBUSTIVEL:
+  default:
+    return in->h;
+  }
+}
+
+static double limiar_rearme(const DefinicaoEvento *d) {
+  switch (d->tipo) {
+  case EVENTO_APSIDE_TERRA:
+    return 1.0e3; // m²/s
+  case EVENTO_COMBUSTIVEL:
+    return 1.0e-3; // s
+  default:
+    return 1.0; // m
+  }
+}
+
+static bool cruza(const DefinicaoEvento *d, double ga, double gb) {
+  switch (d->sentido) {
+  case CRUZAMENTO_SUBINDO:
+    return ga < 0.0 && gb >= 0.0;
+  case CRUZAMENTO_DESCENDO:
+    return ga > 0.0 && gb <= 0.0;
+  case CRUZAMENTO_QUALQUER:
+  default:
+    return (ga < 0.0 && gb >= 0.0) || (ga > 0.0 && gb <= 0.0);
+  }
+}
+
+static double g_interpolado(const ContextoEventos *eventos,
+                            const DefinicaoEvento *d, const Interpolacao *in,
+                            double theta) {
+  Vetor3D p, v;
+  interpolar(in, theta, &p, &v);
+  return funcao_evento(eventos, d, in->t0 + theta * in->h, p, v, norma(p));
+}
+
+// Regula falsi com a modificação de Illinois em [a, b], com ga e gb de
+// sinais opostos. Retorna a ponta do lado de a (antes do cruzamento), para
+// que um passo refeito até lá não atravesse a superfície.
+static double refinar_zero(const ContextoEventos *eventos,
+                           const DefinicaoEvento *d, const Interpolacao *in,
+                           double a, double ga, double b, double gb) {
+  int lado = 0;
+  for (int i = 0; i < ITERACOES_EVENTO && (b - a) * in->h > TOLERANCIA_TEMPO;
+       i++) {
+    double c = (a * gb - b * ga) / (gb - ga);
+    if (!(c > a && c < b))
+      c = 0.5 * (a + b);
+    double gc = g_interpolado(eventos, d, in, c);
+    if (gc == 0.0)
+      return c;
+    if ((gc > 0.0) == (gb > 0.0)) {
+      b = c;
+      gb = gc;
+      if (lado == 1)
+        ga *= 0.5;
+      lado = 1;
+    } else {
+      a = c;
+      ga = gc;
+      if (lado == -1)
+        gb *= 0.5;
+      lado = -1;
+    }
+  }
+  return a;
+}
+
+// Primeiro cruzamento do evento no passo, em θ, ou -1
+static double primeiro_cruzamento(const ContextoEventos *eventos,
+                                  const DefinicaoEvento *d,
+                                  const Interpolacao *in) {
+  double g0 = funcao_evento(eventos, d, in->t0, in->p0, in->v0, in->r0);
+  double g1 =
+      funcao_evento(eventos, d, in->t0 + in->h, in->p1, in->v1, in->r1);
+  double variacao = variacao_maxima(d, in);
+  if (fmin(fabs(g0), fabs(g1)) > variacao)
+    return -1.0;
+
+  // Perto do zero: amostra o polinômio e procura o primeiro subintervalo com
+  // cruzamento no sentido pedido (um passo que entra e sai também conta)
+  double a = 0.0, ga = g0;
+  for (int k = 1; k <= AMOSTRAS_EVENTO; k++) {
+    double b = (double)k / AMOSTRAS_EVENTO;
+    double gb = k == AMOSTRAS_EVENTO ? g1 : g_interpolado(eventos, d, in, b);
+    if (cruza(d, ga, gb))
+      return refinar_zero(eventos, d, in, a, ga, b, gb);
+    a = b;
+    ga = gb;
+  }
+  return -1.0;
+}
+
+static void registrar(ContextoEventos *eventos, int indice, double tempo) {
+  eventos->ocorrencias[indice]++;
+  eventos->ultimo_tempo[indice] = tempo;
+  eventos->pendentes |= 1u << indice;
+  eventos->desarmado[indice] = true;
+}
+
+static void adicionar(ContextoEventos *eventos, const char *nome,
+                      TipoEvento tipo, SentidoEvento sentido, AcaoEvento acao,
+                      double valor) {
+  if (eventos->n == EVENTOS_MAX)
+    return;
+  DefinicaoEvento *d = &eventos->definicoes[eventos->n++];
+  snprintf(d->nome, sizeof(d->nome), "%s", nome);
+  d->tipo = tipo;
+  d->sentido = sentido;
+  d->acao = acao;
+  d->valor = valor;
+}
+
+void eventos_padrao(ContextoEventos *eventos) {
+  memset(eventos, 0, sizeof(*eventos));
+  eventos->tempo_esgotamento = INFINITY;
+  adicionar(eventos, "contato Terra", EVENTO_ALTITUDE_TERRA,
+            CRUZAMENTO_DESCENDO, ACAO_CONTATO_TERRA, 0.0);
+  adicionar(eventos, "contato Lua", EVENTO_ALTITUDE_LUA, CRUZAMENTO_DESCENDO,
+            ACAO_CONTATO_LUA, 0.0);
+  adicionar(eventos, "entrada SOI Lua", EVENTO_SOI_LUA, CRUZAMENTO_DESCENDO,
+            ACAO_REGISTRAR, 0.0);
+  adicionar(eventos, "periapside", EVENTO_APSIDE_TERRA, CRUZAMENTO_SUBINDO,
+            ACAO_REGISTRAR, 0.0);
+  adicionar(eventos, "apoapside", EVENTO_APSIDE_TERRA, CRUZAMENTO_DESCENDO,
+            ACAO_REGISTRAR, 0.0);
+  adicionar(eventos, "fim do combustivel", EVENTO_COMBUSTIVEL,
+            CRUZAMENTO_DESCENDO, ACAO_CORTE_EMPUXO, 0.0);
+
+  // Desarmados até o estado se afastar do zero: a nave parte da superfície
+  for (int i = 0; i < eventos->n; i++)
+    eventos->desarmado[i] = true;
+}
+
+int eventos_localizar(ContextoEventos *eventos, double t0, Vetor3D p0,
+                      Vetor3D v0, double t1, Vetor3D p1, Vetor3D v1,
+                      double *tempo_evento) {
+  Interpolacao in = {t0, t1 - t0, p0, v0, p1, v1, 0.0, 0.0, 0.0, 0.0};
+  if (in.h <= 0.0)
+    return -1;
+  in.r0 = norma(p0);
+  in.r1 = norma(p1);
+  in.velocidade_max = fmax(norma(v0), norma(v1));
+  in.variacao_velocidade =
+      norma((Vetor3D){v1.x - v0.x, v1.y - v0.y, v1.z - v0.z});
+
+  double theta[EVENTOS_MAX];
+  int terminal = -1;
+  double theta_terminal = 2.0;
+  for (int i = 0; i < eventos->n; i++) {
+    theta[i] = -1.0;
+    if (eventos->desarmado[i])
+      continue;
+    const DefinicaoEvento *d = &eventos->definicoes[i];
+    theta[i] = primeiro_cruzamento(eventos, d, &in);
+    if (theta[i] >= 0.0 && d->acao != ACAO_REGISTRAR &&
+        theta[i] < theta_terminal) {
+      terminal = i;
+      theta_terminal = theta[i];
+    }
+  }
+
+  // Eventos de registro depois do terminal ficam para o resto do passo
+  for (int i = 0; i < eventos->n; i++)
+    if (theta[i] >= 0.0 && eventos->definicoes[i].acao == ACAO_REGISTRAR &&
+        theta[i] <= theta_terminal)
+      registrar(eventos, i, t0 + theta[i] * in.h);
+
+  if (terminal >= 0)
+    *tempo_evento = t0 + theta_terminal * in.h;
+  return terminal;
+}
+
+void eventos_aplicar(ContextoEventos *eventos, int indice, EstadoNave *nave) {
+  const DefinicaoEvento *d = &eventos->definicoes[indice];
+  registrar(eventos, indice, nave->tempo_missao);
+
+  // Pousada, a nave não tem ápsides: r · v fica em torno de zero e cada
+  // passo cairia na busca. Voltam a armar quando ela deixar a superfície
+  if (d->acao == ACAO_CONTATO_TERRA || d->acao == ACAO_CONTATO_LUA)
+    for (int i = 0; i < eventos->n; i++)
+      if (eventos->definicoes[i].tipo == EVENTO_APSIDE_TERRA)
+        eventos->desarmado[i] = true;
+
+  switch (d->acao) {
+  case ACAO_CONTATO_TERRA: {
+    // Já está a menos de TOLERANCIA_TEMPO do zero: o ajuste é milimétrico
+    Vetor3D p = nave->posicao;
+    double fator = (RAIO_TERRA + d->valor) / norma(p);
+    nave->posicao = (Vetor3D){p.x * fator, p.y * fator, p.z * fator};
+    Vetor3D v = nave->velocidade;
+    if (p.x * v.x + p.y * v.y + p.z * v.z < 0)
+      nave->velocidade = (Vetor3D){0.0, 0.0, 0.0};
+    break;
+  }
+  case ACAO_CONTATO_LUA: {
+    Vetor3D lua = efemerides_lua(nave->tempo_missao);
+    Vetor3D rel = {nave->posicao.x - lua.x, nave->posicao.y - lua.y,
+                   nave->posicao.z - lua.z};
+    double fator = (RAIO_MIN_LUA + d->valor) / norma(rel);
+    nave->posicao = (Vetor3D){lua.x + rel.x * fator, lua.y + rel.y * fator,
+                              lua.z + rel.z * fator};
+    nave->velocidade = efemerides_velocidade_lua(nave->tempo_missao);
+    break;
+  }
+  case ACAO_CORTE_EMPUXO:
+    nave->empuxo_principal = 0.0;
+    break;
+  case ACAO_REGISTRAR:
+    break;
+  }
+}
+
+void eventos_rearmar(ContextoEventos *eventos, const EstadoNave *nave) {
+  double r = -1.0;
+  for (int i = 0; i < eventos->n; i++) {
+    if (!eventos->desarmado[i])
+      continue;
+    if (r < 0.0)
+      r = norma(nave->posicao);
+    const DefinicaoEvento *d = &eventos->definicoes[i];
+    double g = funcao_evento(eventos, d, nave->tempo_missao, nave->posicao,
+                             nave->velocidade, r);
+    if (fabs(g) > limiar_rearme(d))
+      eventos->desarmado[i] = false;
+  }
+}
+
+bool eventos_consumir(ContextoEventos *eventos, TipoEvento tipo,
+                      SentidoEvento sentido) {
+  for (int i = 0; i < eventos->n; i++) {
+    const DefinicaoEvento *d = &eventos->definicoes[i];
+    unsigned int bit = 1u << i;
+    if (d->tipo == tipo && d->sentido == sentido &&
+        (eventos->pendentes & bit)) {
+      eventos->pendentes &= ~bit;
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,435 @@
+#include "executivo.h"
+#include "instrumentacao.h"
+#include "snapshot_estado.h"
+#include "tempo_real.h"
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+// Tempo de relógio máximo gasto em um ciclo de tempo real antes de publicar
+// o snapshot e consultar os comandos, em s
+#define LIMITE_CICLO_TEMPO_REAL 0.005
+
+static inline double segundos_entre(const struct timespec *inicio,
+                                    const struct timespec *fim) {
+  return (fim->tv_sec - inicio->tv_sec) +
+         (fim->tv_nsec - inicio->tv_nsec) / 1e9;
+}
+
+static uint64_t relogio_ns(void) {
+  struct timespec agora;
+  clock_gettime(CLOCK_MONOTONIC, &agora);
+  return (uint64_t)agora.tv_sec * 1000000000ULL + (uint64_t)agora.tv_nsec;
+}
+
+static void inicializar_canal(CanalComandos *canal) {
+  atomic_init(&canal->sistema_ativo, true);
+  atomic_init(&canal->simulacao_acelerada, 1);
+  for (int c = 0; c < N_COMANDOS; c++) {
+    atomic_init(&canal->pedidos[c], 0);
+    atomic_init(&canal->instante_pedido_ns[c], 0);
+    atomic_init(&canal->atendidos[c], 0);
+  }
+  canal->destino_checkpoint = NULL;
+  atomic_init(&canal->encerrado, false);
+}
+
+bool executivo_inicializar(Executivo *executivo, EstadoNave *nave,
+                           const ConfiguracaoExecutivo *config) {
+  executivo->config = *config;
+  if (executivo->config.decimacao < 1)
+    executivo->config.decimacao = 1;
+
+  inicializar_contexto(&executivo->ctx, nave, config->dt, config->semente,
+                       &config->integrador);
+  executivo->ctx.sequenciador = config->sequenciador;
+  executivo->ctx.veiculos.separacoes = config->separacoes;
+  executivo->quadros_desde_amostra = executivo->config.decimacao - 1;
+  executivo->veiculo_exibido = ID_PRINCIPAL;
+  executivo->passo_salto = 0;
+  inicializar_canal(&executivo->canal);
+  executivo->amostras = 0;
+  executivo->ciclos = 0;
+  executivo->ciclos_sobrecarga = 0;
+  executivo->comandos = 0;
+  executivo->espera_max_comando = 0.0;
+  executivo->tempo_real = 0.0;
+  memset(&executivo->prazos, 0, sizeof(executivo->prazos));
+  executivo->cpu_fixada = false;
+  executivo->sched_fifo = false;
+  return !config->roteiro ||
+         contexto_carregar_roteiro(&executivo->ctx, config->roteiro);
+}
+
+bool executivo_restaurar(Executivo *executivo, const Checkpoint *checkpoint) {
+  checkpoint_restaurar(checkpoint, &executivo->ctx, executivo->ctx.nave);
+  executivo->config.dt = executivo->ctx.dt;
+  executivo->config.integrador = executivo->ctx.integrador;
+  return !executivo->config.roteiro ||
+         contexto_carregar_roteiro(&executivo->ctx, executivo->config.roteiro);
+}
+
+// Estado do veículo na posição indice da tabela, ou da nave principal no
+// relógio do contexto com indice -1
+static void estado_veiculo(const ContextoSimulacao *ctx, long indice,
+                           EstadoNave *destino) {
+  if (indice < 0)
+    estado_atual_contexto(ctx, destino);
+  else
+    veiculos_como_nave(&ctx->veiculos, (size_t)indice, ctx->nave, destino);
+}
+
+static void capturar_telemetria(Executivo *executivo) {
+  const ConfiguracaoExecutivo *config = &executivo->config;
+  if (!config->fila && !config->escritor && !config->fila_servidor)
+    return;
+  if (++executivo->quadros_desde_amostra < config->decimacao)
+    return;
+  executivo->quadros_desde_amostra = 0;
+
+  long indice = -1;
+  if (config->veiculo_telemetria != VEICULO_APOLLO) {
+    indice = veiculos_buscar_tipo(&executivo->ctx.veiculos,
+                                  config->veiculo_telemetria);
+    if (indice < 0)
+      return;
+  }
+  EstadoNave nave;
+  estado_veiculo(&executivo->ctx, indice, &nave);
+  AmostraTelemetria amostra;
+  telemetria_amostrar(&nave, amostra.valores);
+
+  // A fila nunca bloqueia: com ela cheia a amostra é descartada e contada
+  if (config->fila)
+    executivo->amostras += fila_enfileirar(config->fila, &amostra);
+  else if (config->escritor)
+    executivo->amostras +=
+        telemetria_escrever(config->escritor, amostra.valores);
+  if (config->fila_servidor)
+    fila_enfileirar(config->fila_servidor, &amostra);
+}
+
+void executivo_quadro(Executivo *executivo) {
+  INSTR_INICIO(inicio);
+  passo_contexto(&executivo->ctx);
+  capturar_telemetria(executivo);
+  INSTR_FIM(METRICA_TRABALHO, inicio);
+}
+
+// Fim da missão, limite de tempo simulado ou sistema_ativo desligado. A
+// linha de sistema_ativo só é escrita ao sair: a consulta a cada quadro
+// não sai do cache.
+static bool executivo_encerrado(const Executivo *executivo) {
+  const ContextoSimulacao *ctx = &executivo->ctx;
+  double duracao_max = executivo->config.duracao_max;
+  if (!atomic_load_explicit(&executivo->canal.sistema_ativo,
+                            memory_order_relaxed))
+    return true;
+  if (executivo->config.continuar_em_emergencia &&
+      ctx->nave->estado_missao == EMERGENCIA)
+    return ctx->tempo >= duracao_max;
+  return contexto_encerrado(ctx, duracao_max);
+}
+
+static void executar_comando(Executivo *executivo, TipoComando comando) {
+  switch (comando) {
+  case COMANDO_AVANCAR:
+    contexto_avancar_estado(&executivo->ctx);
+    break;
+  case COMANDO_EMERGENCIA:
+    entrar_emergencia(executivo->ctx.nave);
+    break;
+  case COMANDO_CHECKPOINT:
+    checkpoint_capturar(executivo->canal.destino_checkpoint, &executivo->ctx);
+    break;
+  case COMANDO_PROXIMO_VEICULO:
+    executivo->veiculo_exibido = veiculos_proximo(&executivo->ctx.veiculos,
+                                                  executivo->veiculo_exibido);
+    break;
+  case COMANDO_SALTAR: {
+    uint64_t passo = contexto_proximo_evento(&executivo->ctx);
+    if (passo != UINT64_MAX)
+      executivo->passo_salto = passo;
+    break;
+  }
+  case N_COMANDOS:
+    break;
+  }
+}
+
+// Atende, entre dois quadros, os pedidos feitos desde o último ciclo. Sem
+// pedidos, são só leituras de linhas que a interface não está escrevendo.
+static void atender_comandos(Executivo *executivo) {
+  CanalComandos *canal = &executivo->canal;
+  for (int c = 0; c < N_COMANDOS; c++) {
+    unsigned int pedidos =
+        atomic_load_explicit(&canal->pedidos[c], memory_order_acquire);
+    unsigned int atendidos =
+        atomic_load_explicit(&canal->atendidos[c], memory_order_relaxed);
+    if (pedidos == atendidos)
+      continue;
+
+    // Cada tecla de avanço avança um estado
+    for (unsigned int n = pedidos - atendidos; n > 0; n--)
+      executar_comando(executivo, (TipoComando)c);
+    atomic_store_explicit(&canal->atendidos[c], pedidos, memory_order_release);
+    executivo->comandos += pedidos - atendidos;
+
+    uint64_t instante = atomic_load_explicit(&canal->instante_pedido_ns[c],
+                                             memory_order_relaxed);
+    uint64_t espera_ns = relogio_ns() - instante;
+    INSTR_VALOR(METRICA_ESPERA_COMANDO, espera_ns);
+    if (espera_ns * 1e-9 > executivo->espera_max_comando)
+      executivo->espera_max_comando = espera_ns * 1e-9;
+  }
+}
+
+static void iniciar_ciclo(Executivo *executivo) {
+  atender_comandos(executivo);
+  executivo->ciclos++;
+}
+
+// Publica para a interface o estado do veículo exibido, e para outros
+// processos o da nave principal. Um veículo destruído devolve a exibição à
+// nave principal.
+static void publicar_estado(Executivo *executivo) {
+  const TabelaVeiculos *veiculos = &executivo->ctx.veiculos;
+  long indice = veiculos_indice(veiculos, executivo->veiculo_exibido);
+  if (indice < 0)
+    executivo->veiculo_exibido = ID_PRINCIPAL;
+
+  EstadoNave nave;
+  RotuloVeiculo rotulo;
+  estado_veiculo(&executivo->ctx, indice, &nave);
+  veiculos_rotulo(veiculos, indice, &rotulo);
+  publicar_snapshot(&nave, &rotulo);
+
+  if (executivo->config.exportacao) {
+    if (indice >= 0)
+      estado_veiculo(&executivo->ctx, -1, &nave);
+    exportacao_publicar(executivo->config.exportacao, &nave,
+                        executivo->ctx.passos);
+  }
+}
+
+static void executar_maxima_velocidade(Executivo *executivo) {
+  while (!executivo_encerrado(executivo)) {
+    iniciar_ciclo(executivo);
+    for (int i = 0; i < QUADROS_POR_LOTE && !executivo_encerrado(executivo);
+         i++)
+      executivo_quadro(executivo);
+    publicar_estado(executivo);
+  }
+}
+
+// A cada ciclo de relógio o orçamento de tempo simulado cresce
+// proporcionalmente ao fator de aceleração, e são executados os quadros que
+// cabem nele. Se a CPU não acompanhar, o atraso além de 0,1 s de relógio é
+// descartado em vez de acumulado. O salto ([T]) executa os mesmos quadros,
+// apenas sem o ritmo do relógio: a missão é a mesma que sem ele.
+static void executar_tempo_real(Executivo *executivo) {
+  double dt = executivo->ctx.dt;
+  double orcamento = 0.0;
+
+  struct timespec anterior, agora, proximo_ciclo;
+  clock_gettime(CLOCK_MONOTONIC, &anterior);
+  proximo_ciclo = anterior;
+
+  while (!executivo_encerrado(executivo)) {
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    double delta_real = segundos_entre(&anterior, &agora);
+    anterior = agora;
+    INSTR_VALOR(METRICA_PERIODO, (uint64_t)(delta_real * 1e9));
+    if (delta_real > 0.1)
+      delta_real = 0.1;
+
+    int fator_aceleracao = atomic_load_explicit(
+        &executivo->canal.simulacao_acelerada, memory_order_relaxed);
+    orcamento += delta_real * fator_aceleracao;
+
+    iniciar_ciclo(executivo);
+    // Num salto os quadros seguem sem esperar o relógio até o passo do
+    // evento, e o orçamento recomeça de zero ao chegar
+    bool saltando = executivo->passo_salto > executivo->ctx.passos;
+    if (saltando)
+      orcamento = 0.0;
+    unsigned int quadros = 0;
+    while ((saltando ? executivo->ctx.passos < executivo->passo_salto
+                     : orcamento >= dt) &&
+           !executivo_encerrado(executivo)) {
+      executivo_quadro(executivo);
+      if (!saltando)
+        orcamento -= dt;
+
+      // Confere o relógio a cada 256 quadros para não atrasar o snapshot
+      // e os comandos
+      if ((++quadros & 255) == 0) {
+        struct timespec instante;
+        clock_gettime(CLOCK_MONOTONIC, &instante);
+        if (segundos_entre(&agora, &instante) > LIMITE_CICLO_TEMPO_REAL)
+          break;
+      }
+    }
+    publicar_estado(executivo);
+
+    if (orcamento >= dt) {
+      executivo->ciclos_sobrecarga++;
+      if (orcamento > 0.1 * fator_aceleracao)
+        orcamento = 0.1 * fator_aceleracao;
+    }
+
+    // Próximo ciclo em tempo absoluto: o período não acumula o custo do
+    // ciclo atual
+    proximo_ciclo.tv_nsec += PERIODO_CICLO_TEMPO_REAL;
+    if (proximo_ciclo.tv_nsec >= 1000000000L) {
+      proximo_ciclo.tv_nsec -= 1000000000L;
+      proximo_ciclo.tv_sec++;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    if (saltando || segundos_entre(&proximo_ciclo, &agora) > 0.0)
+      proximo_ciclo = agora;
+    else {
+      clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &proximo_ciclo, NULL);
+#ifdef APOLLO_INSTRUMENTACAO
+      struct timespec despertar;
+      clock_gettime(CLOCK_MONOTONIC, &despertar);
+      INSTR_VALOR(METRICA_ATRASO_SONO,
+                  (uint64_t)(segundos_entre(&proximo_ciclo, &despertar) * 1e9));
+#endif
+    }
+  }
+}
+
+static inline void somar_nanossegundos(struct timespec *instante, long ns) {
+  instante->tv_nsec += ns;
+  while (instante->tv_nsec >= 1000000000L) {
+    instante->tv_nsec -= 1000000000L;
+    instante->tv_sec++;
+  }
+}
+
+// Um quadro por período de dt segundos de relógio, liberado em prazos
+// absolutos: o erro de um ciclo não se acumula nos seguintes e o passo
+// simulado é sempre dt. Um quadro que termina depois do próximo prazo conta
+// como prazo perdido; os prazos já vencidos são pulados, mantendo a fase,
+// em vez de executados em rajada.
+static void executar_tempo_real_estrito(Executivo *executivo) {
+  EstatisticasPrazos *prazos = &executivo->prazos;
+  long periodo = lround(executivo->ctx.dt * 1e9);
+  if (periodo < 1)
+    periodo = 1;
+
+  struct timespec prazo, inicio, fim;
+  clock_gettime(CLOCK_MONOTONIC, &prazo);
+
+  while (!executivo_encerrado(executivo)) {
+    clock_gettime(CLOCK_MONOTONIC, &inicio);
+    iniciar_ciclo(executivo);
+    executivo_quadro(executivo);
+    publicar_estado(executivo);
+    clock_gettime(CLOCK_MONOTONIC, &fim);
+    prazos->ciclos++;
+
+    double execucao = segundos_entre(&inicio, &fim);
+    if (execucao > prazos->execucao_max)
+      prazos->execucao_max = execucao;
+
+    somar_nanossegundos(&prazo, periodo);
+    double excesso = segundos_entre(&prazo, &fim);
+    if (excesso >= 0.0) {
+      long saltados = (long)(excesso * 1e9) / periodo + 1;
+      prazos->prazos_perdidos++;
+      prazos->ciclos_saltados += (unsigned long long)saltados;
+      somar_nanossegundos(&prazo, saltados * periodo);
+    }
+
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &prazo, NULL);
+    struct timespec despertar;
+    clock_gettime(CLOCK_MONOTONIC, &despertar);
+    double jitter = segundos_entre(&prazo, &despertar);
+    prazos->jitter_soma += jitter;
+    prazos->jitter_soma_quadrados += jitter * jitter;
+    if (jitter > prazos->jitter_max)
+      prazos->jitter_max = jitter;
+    INSTR_VALOR(METRICA_ATRASO_SONO, (uint64_t)(jitter * 1e9));
+  }
+}
+
+void executivo_executar(Executivo *executivo) {
+  struct timespec inicio, fim;
+  clock_gettime(CLOCK_MONOTONIC, &inicio);
+
+  switch (executivo->config.modo) {
+  case EXECUTIVO_TEMPO_REAL:
+    executar_tempo_real(executivo);
+    break;
+  case EXECUTIVO_TEMPO_REAL_ESTRITO:
+    executar_tempo_real_estrito(executivo);
+    break;
+  case EXECUTIVO_MAXIMA_VELOCIDADE:
+    executar_maxima_velocidade(executivo);
+    break;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &fim);
+  executivo->tempo_real = segundos_entre(&inicio, &fim);
+}
+
+void executivo_finalizar(Executivo *executivo) {
+  finalizar_contexto(&executivo->ctx);
+  publicar_estado(executivo);
+}
+
+void *executivo_missao(void *arg) {
+  Executivo *executivo = arg;
+  const ConfiguracaoExecutivo *config = &executivo->config;
+  if (config->fixar_cpu)
+    executivo->cpu_fixada = fixar_thread_cpu(config->cpu);
+  if (config->prioridade_fifo > 0)
+    executivo->sched_fifo = solicitar_sched_fifo(config->prioridade_fifo);
+  INSTR_THREAD("executivo");
+  executivo_executar(executivo);
+
+  // Checkpoints pedidos até aqui ainda veem o contexto antes da finalização.
+  // A barreira pareia com o desligamento de sistema_ativo, lido sem ordem
+  // no laço: o que a interface pediu antes de sair fica visível.
+  atomic_thread_fence(memory_order_acquire);
+  atender_comandos(executivo);
+  executivo_finalizar(executivo);
+  atomic_store_explicit(&executivo->canal.encerrado, true,
+                        memory_order_release);
+  if (executivo->config.fila)
+    fila_fechar(executivo->config.fila);
+  if (executivo->config.fila_servidor)
+    fila_fechar(executivo->config.fila_servidor);
+  return NULL;
+}
+
+static void pedir(CanalComandos *canal, TipoComando comando) {
+  atomic_store_explicit(&canal->instante_pedido_ns[comando], relogio_ns(),
+                        memory_order_relaxed);
+  atomic_fetch_add_explicit(&canal->pedidos[comando], 1, memory_order_release);
+}
+
+void executivo_comandar(Executivo *executivo, TipoComando comando) {
+  pedir(&executivo->canal, comando);
+}
+
+void executivo_pedir_checkpoint(Executivo *executivo, Checkpoint *destino) {
+  executivo->canal.destino_checkpoint = destino;
+  pedir(&executivo->canal, COMANDO_CHECKPOINT);
+}
+
+ResultadoCheckpoint executivo_checkpoint_resultado(Executivo *executivo) {
+  CanalComandos *canal = &executivo->canal;
+  // encerrado antes de atendidos: se o executivo já terminou, o que ele
+  // atendeu antes disso está visível
+  bool encerrado =
+      atomic_load_explicit(&canal->encerrado, memory_order_acquire);
+  unsigned int pedidos = atomic_load_explicit(
+      &canal->pedidos[COMANDO_CHECKPOINT], memory_order_relaxed);
+  if (atomic_load_explicit(&canal->atendidos[COMANDO_CHECKPOINT],
+                           memory_order_acquire) == pedidos)
+    return CHECKPOINT_CAPTURADO;
+  return encerrado ? CHECKPOINT_CANCELADO : CHECKPOINT_PENDENTE;
+}
@@ -0,0 +1,82 @@
+#include "fila_telemetria.h"
+#include <stdlib.h>
+#include <string.h>
+
+bool fila_criar(FilaTelemetria *fila, size_t capacidade) {
+  size_t potencia = 1;
+  while (potencia < capacidade)
+    potencia <<= 1;
+
+  memset(fila, 0, sizeof(*fila));
+  fila->amostras = aligned_alloc(TAM_LINHA_CACHE,
+                                 potencia * sizeof(AmostraTelemetria));
+  if (!fila->amostras)
+    return false;
+  fila->mascara = potencia - 1;
+  atomic_init(&fila->cabeca, 0);
+  atomic_init(&fila->cauda, 0);
+  atomic_init(&fila->descartadas, 0);
+  atomic_init(&fila->fechada, false);
+  return true;
+}
+
+void fila_destruir(FilaTelemetria *fila) {
+  free(fila->amostras);
+  fila->amostras = NULL;
+}
+
+bool fila_enfileirar(FilaTelemetria *fila, const AmostraTelemetria *amostra) {
+  size_t cabeca = atomic_load_explicit(&fila->cabeca, memory_order_relaxed);
+
+  // Só relê a cauda do consumidor (outra linha de cache) quando a cópia
+  // local indica fila cheia
+  if (cabeca - fila->cauda_cache > fila->mascara) {
+    fila->cauda_cache =
+        atomic_load_explicit(&fila->cauda, memory_order_acquire);
+    if (cabeca - fila->cauda_cache > fila->mascara) {
+      atomic_fetch_add_explicit(&fila->descartadas, 1, memory_order_relaxed);
+      return false;
+    }
+  }
+
+  fila->amostras[cabeca & fila->mascara] = *amostra;
+  atomic_store_explicit(&fila->cabeca, cabeca + 1, memory_order_release);
+  fila->enfileiradas++;
+  return true;
+}
+
+void fila_fechar(FilaTelemetria *fila) {
+  atomic_store_explicit(&fila->fechada, true, memory_order_release);
+}
+
+size_t fila_lote(FilaTelemetria *fila, const AmostraTelemetria **lote) {
+  size_t cauda = atomic_load_explicit(&fila->cauda, memory_order_relaxed);
+  if (cauda == fila->cabeca_cache) {
+    fila->cabeca_cache =
+        atomic_load_explicit(&fila->cabeca, memory_order_acquire);
+    if (cauda == fila->cabeca_cache)
+      return 0;
+  }
+
+  size_t ocupacao = fila->cabeca_cache - cauda;
+  if (ocupacao > fila->ocupacao_max)
+    fila->ocupacao_max = ocupacao;
+
+  // O lote termina no fim do buffer; o restante vem na próxima chamada
+  size_t indice = cauda & fila->mascara;
+  size_t ate_o_fim = fila->mascara + 1 - indice;
+  *lote = &fila->amostras[indice];
+  return ocupacao < ate_o_fim ? ocupacao : ate_o_fim;
+}
+
+void fila_liberar(FilaTelemetria *fila, size_t n) {
+  size_t cauda = atomic_load_explicit(&fila->cauda, memory_order_relaxed);
+  atomic_store_explicit(&fila->cauda, cauda + n, memory_order_release);
+}
+
+bool fila_encerrada(FilaTelemetria *fila) {
+  if (!atomic_load_explicit(&fila->fechada, memory_order_acquire))
+    return false;
+  size_t cauda = atomic_load_explicit(&fila->cauda, memory_order_relaxed);
+  return cauda == atomic_load_explicit(&fila->cabeca, memory_order_acquire);
+}
@@ -0,0 +1,275 @@
+#include "gravidade_harmonica.h"
+#include "efemerides.h"
+#include "physics_engine.h"
+#include <math.h>
+#include <string.h>
+
+#define GRAUS (M_PI / 180.0)
+
+// Coeficientes normalizados do EGM2008 até grau e ordem 6 (C10, C11 e S11
+// são nulos com a origem no centro de massa; C00 fica com a massa pontual)
+static const struct {
+  unsigned char n, m;
+  double c, s;
+} coeficientes_egm2008[] = {
+    {2, 0, -4.84165143790815e-4, 0.0},
+    {2, 1, -2.06615509074176e-10, 1.38441389137979e-9},
+    {2, 2, 2.43938357328313e-6, -1.40027370385934e-6},
+    {3, 0, 9.57161207093473e-7, 0.0},
+    {3, 1, 2.03046201047864e-6, 2.48200415856872e-7},
+    {3, 2, 9.04787894809528e-7, -6.19005475177618e-7},
+    {3, 3, 7.21321757121568e-7, 1.41434926192941e-6},
+    {4, 0, 5.39965866638991e-7, 0.0},
+    {4, 1, -5.36157389388867e-7, -4.73567346518086e-7},
+    {4, 2, 3.50501623962649e-7, 6.62480026275829e-7},
+    {4, 3, 9.90856766672321e-7, -2.00956723567452e-7},
+    {4, 4, -1.88519633023033e-7, 3.08803882149194e-7},
+    {5, 0, 6.86702913736681e-8, 0.0},
+    {5, 1, -6.29211923042529e-8, -9.43698073395769e-8},
+    {5, 2, 6.52078043176164e-7, -3.23353192540522e-7},
+    {5, 3, -4.51847152328843e-7, -2.14955408306046e-7},
+    {5, 4, -2.95328761175629e-7, 4.98070550102351e-8},
+    {5, 5, 1.74811398444378e-7, -6.69379935180165e-7},
+    {6, 0, -1.49953927978527e-7, 0.0},
+    {6, 1, -7.59210081892527e-8, 2.65122593213647e-8},
+    {6, 2, 4.86488070462587e-8, -3.73789324523752e-7},
+    {6, 3, 5.72451611175653e-8, 8.95201130010730e-9},
+    {6, 4, -8.60237937191611e-8, -4.71425573429095e-7},
+    {6, 5, -2.67166423703038e-7, -5.36493151500206e-7},
+    {6, 6, 9.47068749756983e-9, -2.37382353351005e-7}};
+
+// Estado do campo, escrito só em gravidade_configurar e nas funções de nível
+// (antes das threads) e depois apenas lido
+static struct {
+  int grau;  // 0 enquanto não configurado
+  int ordem;
+  // Coeficientes desnormalizados, zerados além do grau e da ordem escolhidos
+  double c[GRAVIDADE_GRAU_MAX + 1][GRAVIDADE_GRAU_MAX + 1];
+  double s[GRAVIDADE_GRAU_MAX + 1][GRAVIDADE_GRAU_MAX + 1];
+  // V[n][m] = a[n][m] z0 V[n-1][m] - b[n][m] rho V[n-2][m]
+  double recorrencia_a[GRAVIDADE_GRAU_MAX + 2][GRAVIDADE_GRAU_MAX + 2];
+  double recorrencia_b[GRAVIDADE_GRAU_MAX + 2][GRAVIDADE_GRAU_MAX + 2];
+  // Missão -> equador médio da data, sem a rotação diária
+  double equatorial[3][3];
+  double tempo_sideral_inicial; // rad, no lançamento
+  NivelGravidade niveis[N_ESTADOS_MISSAO];
+} campo;
+
+// Nível padrão: campo completo perto da Terra, zonal nos trechos de ida e
+// volta ainda sob a sua influência, massa pontual no resto
+static const NivelGravidade niveis_padrao[N_ESTADOS_MISSAO] = {
+    [PREPARACAO] = GRAVIDADE_HARMONICA,  [LANCAMENTO] = GRAVIDADE_HARMONICA,
+    [ORBITA_TERRESTRE] = GRAVIDADE_HARMONICA,
+    [TRANSITO_LUNAR] = GRAVIDADE_ZONAL,  [ORBITA_LUNAR] = GRAVIDADE_PONTUAL,
+    [ALUNISSAGEM] = GRAVIDADE_PONTUAL,   [SUPERFICIE_LUNAR] = GRAVIDADE_PONTUAL,
+    [RETORNO_TERRA] = GRAVIDADE_ZONAL,   [REENTRADA] = GRAVIDADE_HARMONICA,
+    [AMERISSAGEM] = GRAVIDADE_HARMONICA, [FINALIZACAO] = GRAVIDADE_PONTUAL,
+    [EMERGENCIA] = GRAVIDADE_HARMONICA};
+
+// sqrt((2 - δm0)(2n + 1)(n - m)! / (n + m)!)
+static double fator_normalizacao(int n, int m) {
+  double razao = 1.0;
+  for (int k = n - m + 1; k <= n + m; k++)
+    razao /= k;
+  return sqrt((m == 0 ? 1.0 : 2.0) * (2 * n + 1) * razao);
+}
+
+bool gravidade_configurar(int grau, int ordem) {
+  if (grau < 2 || grau > GRAVIDADE_GRAU_MAX || ordem < 0 || ordem > grau)
+    return false;
+
+  memset(campo.c, 0, sizeof(campo.c));
+  memset(campo.s, 0, sizeof(campo.s));
+  for (size_t i = 0;
+       i < sizeof(coeficientes_egm2008) / sizeof(coeficientes_egm2008[0]);
+       i++) {
+    int n = coeficientes_egm2008[i].n, m = coeficientes_egm2008[i].m;
+    if (n > grau || m > ordem)
+      continue;
+    double fator = fator_normalizacao(n, m);
+    campo.c[n][m] = coeficientes_egm2008[i].c * fator;
+    campo.s[n][m] = coeficientes_egm2008[i].s * fator;
+  }
+
+  for (int m = 0; m <= GRAVIDADE_GRAU_MAX + 1; m++) {
+    for (int n = m + 2; n <= GRAVIDADE_GRAU_MAX + 1; n++) {
+      campo.recorrencia_a[n][m] = (double)(2 * n - 1) / (n - m);
+      campo.recorrencia_b[n][m] = (double)(n + m - 1) / (n - m);
+    }
+  }
+
+  // Eclíptica da missão (X na longitude da Lua no lançamento) para o
+  // equador médio: Rx(obliquidade) Rz(longitude de referência)
+  double t = (EFEMERIDES_EPOCA_JD - 2451545.0) / 36525.0;
+  double obliquidade = (23.439291 - 0.0130042 * t) * GRAUS;
+  double lambda = efemerides_longitude_referencia();
+  double ce = cos(obliquidade), se = sin(obliquidade);
+  double cl = cos(lambda), sl = sin(lambda);
+  double equatorial[3][3] = {
+      {cl, -sl, 0.0}, {ce * sl, ce * cl, -se}, {se * sl, se * cl, ce}};
+  memcpy(campo.equatorial, equatorial, sizeof(equatorial));
+
+  // Tempo sideral médio de Greenwich no lançamento
+  double dias = EFEMERIDES_EPOCA_JD - 2451545.0;
+  campo.tempo_sideral_inicial =
+      fmod(280.46061837 + 360.98564736629 * dias + 0.000387933 * t * t,
+           360.0) *
+      GRAUS;
+
+  campo.grau = grau;
+  campo.ordem = ordem;
+  return true;
+}
+
+int gravidade_grau(void) { return campo.grau; }
+int gravidade_ordem(void) { return campo.ordem; }
+
+void gravidade_niveis_por_estado(void) {
+  memcpy(campo.niveis, niveis_padrao, sizeof(campo.niveis));
+}
+
+void gravidade_nivel_unico(NivelGravidade nivel) {
+  for (int i = 0; i < N_ESTADOS_MISSAO; i++)
+    campo.niveis[i] = nivel;
+}
+
+void gravidade_definir_nivel(EstadoMissao estado, NivelGravidade nivel) {
+  if ((int)estado >= 0 && (int)estado < N_ESTADOS_MISSAO)
+    campo.niveis[estado] = nivel;
+}
+
+NivelGravidade gravidade_nivel(EstadoMissao estado) {
+  if (campo.grau == 0 || (int)estado < 0 || (int)estado >= N_ESTADOS_MISSAO)
+    return GRAVIDADE_PONTUAL;
+  return campo.niveis[estado];
+}
+
+void gravidade_orientacao(double tempo, NivelGravidade nivel,
+                          OrientacaoTerra *orientacao) {
+  // O campo zonal é simétrico em torno do eixo: a rotação diária não muda
+  // nada e o referencial equatorial basta
+  if (nivel != GRAVIDADE_HARMONICA) {
+    memcpy(orientacao->m, campo.equatorial, sizeof(orientacao->m));
+    return;
+  }
+
+  // Rz(-tempo sideral) aplicada ao referencial equatorial
+  double theta =
+      campo.tempo_sideral_inicial + VELOCIDADE_ROTACAO_TERRA * tempo;
+  double c = cos(theta), s = sin(theta);
+  for (int j = 0; j < 3; j++) {
+    orientacao->m[0][j] = c * campo.equatorial[0][j] +
+                          s * campo.equatorial[1][j];
+    orientacao->m[1][j] = -s * campo.equatorial[0][j] +
+                          c * campo.equatorial[1][j];
+    orientacao->m[2][j] = campo.equatorial[2][j];
+  }
+}
+
+Vetor3D gravidade_harmonica(Vetor3D pos, const OrientacaoTerra *orientacao,
+                            NivelGravidade nivel) {
+  Vetor3D zero = {0.0, 0.0, 0.0};
+  if (nivel == GRAVIDADE_PONTUAL || campo.grau == 0)
+    return zero;
+
+  const double(*m)[3] = orientacao->m;
+  double x = m[0][0] * pos.x + m[0][1] * pos.y + m[0][2] * pos.z;
+  double y = m[1][0] * pos.x + m[1][1] * pos.y + m[1][2] * pos.z;
+  double z = m[2][0] * pos.x + m[2][1] * pos.y + m[2][2] * pos.z;
+
+  // Abaixo da superfície a série é avaliada na superfície, como a massa
+  // pontual em RAIO_MIN_TERRA
+  double r2 = x * x + y * y + z * z;
+  if (r2 < RAIO_MIN_TERRA * RAIO_MIN_TERRA) {
+    if (r2 == 0.0)
+      return zero;
+    double fator = RAIO_MIN_TERRA / sqrt(r2);
+    x *= fator;
+    y *= fator;
+    z *= fator;
+    r2 = RAIO_MIN_TERRA * RAIO_MIN_TERRA;
+  }
+
+  const double raio = RAIO_REFERENCIA_TERRA;
+  int grau = campo.grau;
+  int ordem = nivel == GRAVIDADE_ZONAL ? 0 : campo.ordem;
+  double rho = raio * raio / r2;
+  double x0 = raio * x / r2, y0 = raio * y / r2, z0 = raio * z / r2;
+
+  // Funções de Legendre (vezes r^-(n+1)) até grau + 1 e ordem + 1, que a
+  // derivada da série consome
+  double v[GRAVIDADE_GRAU_MAX + 2][GRAVIDADE_GRAU_MAX + 2];
+  double w[GRAVIDADE_GRAU_MAX + 2][GRAVIDADE_GRAU_MAX + 2];
+  v[0][0] = raio / sqrt(r2);
+  w[0][0] = 0.0;
+  v[1][0] = z0 * v[0][0];
+  w[1][0] = 0.0;
+  for (int n = 2; n <= grau + 1; n++) {
+    v[n][0] = campo.recorrencia_a[n][0] * z0 * v[n - 1][0] -
+              campo.recorrencia_b[n][0] * rho * v[n - 2][0];
+    w[n][0] = 0.0;
+  }
+  for (int k = 1; k <= ordem + 1; k++) {
+    v[k][k] = (2 * k - 1) * (x0 * v[k - 1][k - 1] - y0 * w[k - 1][k - 1]);
+    w[k][k] = (2 * k - 1) * (x0 * w[k - 1][k - 1] + y0 * v[k - 1][k - 1]);
+    if (k <= grau) {
+      v[k + 1][k] = (2 * k + 1) * z0 * v[k][k];
+      w[k + 1][k] = (2 * k + 1) * z0 * w[k][k];
+    }
+    for (int n = k + 2; n <= grau + 1; n++) {
+      v[n][k] = campo.recorrencia_a[n][k] * z0 * v[n - 1][k] -
+                campo.recorrencia_b[n][k] * rho * v[n - 2][k];
+      w[n][k] = campo.recorrencia_a[n][k] * z0 * w[n - 1][k] -
+                campo.recorrencia_b[n][k] * rho * w[n - 2][k];
+    }
+  }
+
+  double ax = 0.0, ay = 0.0, az = 0.0;
+  for (int n = 2; n <= grau; n++) {
+    double zonal = campo.c[n][0];
+    ax -= zonal * v[n + 1][1];
+    ay -= zonal * w[n + 1][1];
+    az -= (n + 1) * zonal * v[n + 1][0];
+
+    int ordem_n = n < ordem ? n : ordem;
+    for (int k = 1; k <= ordem_n; k++) {
+      double c = campo.c[n][k], s = campo.s[n][k];
+      double fator = 0.5 * (n - k + 1) * (n - k + 2);
+      ax += 0.5 * (-c * v[n + 1][k + 1] - s * w[n + 1][k + 1]) +
+            fator * (c * v[n + 1][k - 1] + s * w[n + 1][k - 1]);
+      ay += 0.5 * (-c * w[n + 1][k + 1] + s * v[n + 1][k + 1]) +
+            fator * (-c * w[n + 1][k - 1] + s * v[n + 1][k - 1]);
+      az += (n - k + 1) * (-c * v[n + 1][k] - s * w[n + 1][k]);
+    }
+  }
+
+  // De volta ao referencial da missão pela transposta
+  double escala = G * M_TERRA / (raio * raio);
+  ax *= escala;
+  ay *= escala;
+  az *= escala;
+  return (Vetor3D){m[0][0] * ax + m[1][0] * ay + m[2][0] * az,
+                   m[0][1] * ax + m[1][1] * ay + m[2][1] * az,
+                   m[0][2] * ax + m[1][2] * ay + m[2][2] * az};
+}
+
+NivelGravidade obter_nivel_gravidade(const char *nome, bool *valido) {
+  *valido = true;
+  for (int nivel = 0; nivel < N_NIVEIS_GRAVIDADE; nivel++) {
+    if (strcmp(nome, obter_nome_nivel_gravidade(nivel)) == 0)
+      return nivel;
+  }
+  *valido = false;
+  return GRAVIDADE_PONTUAL;
+}
+
+const char *obter_nome_nivel_gravidade(NivelGravidade nivel) {
+  switch (nivel) {
+  case GRAVIDADE_ZONAL:
+    return "zonal";
+  case GRAVIDADE_HARMONICA:
+    return "harmonica";
+  default:
+    return "pontual";
+  }
+}
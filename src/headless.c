@@ -0,0 +1,147 @@
+#include "headless.h"
+#include "executivo.h"
+#include "instrumentacao.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int executar_headless(const ConfiguracaoHeadless *config) {
+  double dt = config->dt;
+  if (dt <= 0.0) {
+    fprintf(stderr, "headless: dt invalido (%g)\n", dt);
+    return 1;
+  }
+
+  // Nenhuma outra thread está ativa: a telemetria é gravada na própria
+  // thread do executivo
+  EscritorTelemetria *escritor = NULL;
+  bool gravar_telemetria = config->arquivo_telemetria != NULL;
+  if (gravar_telemetria) {
+    escritor = malloc(sizeof(EscritorTelemetria));
+    if (!escritor ||
+        !telemetria_abrir_escrita(escritor, config->arquivo_telemetria)) {
+      perror(config->arquivo_telemetria);
+      free(escritor);
+      return 1;
+    }
+  }
+
+  ConfiguracaoExecutivo config_executivo = {
+      .modo = EXECUTIVO_MAXIMA_VELOCIDADE,
+      .dt = dt,
+      .duracao_max = config->duracao_max,
+      .semente = config->semente,
+      .integrador = config->integrador,
+      .sequenciador = config->sequenciador,
+      .separacoes = config->separacoes,
+      .escritor = escritor,
+      .decimacao = config->decimacao_telemetria,
+      .veiculo_telemetria = config->veiculo_telemetria,
+      .roteiro = config->roteiro};
+  INSTR_THREAD("headless");
+  Executivo executivo;
+  // Com checkpoint, o roteiro é recarregado sobre a linha do tempo
+  // restaurada, e só essa carga decide se ele cabe
+  bool roteiro_cabe =
+      executivo_inicializar(&executivo, &estado_nave, &config_executivo);
+  if (config->checkpoint_inicial)
+    roteiro_cabe = executivo_restaurar(&executivo, config->checkpoint_inicial);
+  if (!roteiro_cabe) {
+    fprintf(stderr, "headless: o roteiro nao cabe na linha do tempo%s\n",
+            config->checkpoint_inicial ? " do checkpoint" : "");
+    if (gravar_telemetria) {
+      telemetria_fechar_escrita(escritor);
+      free(escritor);
+    }
+    return 1;
+  }
+  executivo_executar(&executivo);
+
+  // O checkpoint final permite continuar ou ramificar a missão a partir
+  // deste ponto com --restaurar. É capturado antes de finalizar o contexto,
+  // para que a continuação seja idêntica a uma execução sem interrupção
+  bool checkpoint_salvo = false;
+  if (config->arquivo_checkpoint) {
+    Checkpoint checkpoint;
+    checkpoint_capturar(&checkpoint, &executivo.ctx);
+    checkpoint_salvo =
+        checkpoint_salvar(&checkpoint, config->arquivo_checkpoint);
+    if (!checkpoint_salvo)
+      perror(config->arquivo_checkpoint);
+  }
+  executivo_finalizar(&executivo);
+
+  int erro_telemetria = 0;
+  unsigned long long amostras_gravadas = 0;
+  if (gravar_telemetria) {
+    telemetria_fechar_escrita(escritor);
+    erro_telemetria = escritor->erro;
+    amostras_gravadas = escritor->amostras_gravadas;
+    free(escritor);
+  }
+
+  const ContextoSimulacao *ctx = &executivo.ctx;
+  const EstadoNave *nave = ctx->nave;
+  double tempo_real = executivo.tempo_real;
+
+  printf("Estado final:        %s\n", obter_nome_estado(nave->estado_missao));
+  printf("Tempo simulado:      %.3f s\n", nave->tempo_missao);
+  printf("Tempo real:          %.3f s\n", tempo_real);
+  printf("Passos do contexto:  %llu (dt = %g s)\n", ctx->passos, ctx->dt);
+  printf("Integrador:          %s, %llu passos aceitos, %llu rejeitados\n",
+         obter_nome_integrador(ctx->integrador.tipo),
+         ctx->estado_integrador.passos_aceitos,
+         ctx->estado_integrador.passos_rejeitados);
+  printf("Avaliacoes de forca: %llu\n", ctx->estado_integrador.avaliacoes);
+  if (ctx->integrador.limiar_kepler > 0.0)
+    printf("Trechos conicos:     %llu\n",
+           ctx->estado_integrador.segmentos_conicos);
+  if (tempo_real > 0.0 && ctx->passos > 0) {
+    printf("Desempenho:          %.1f s simulados / s real\n",
+           nave->tempo_missao / tempo_real);
+    printf("Custo por passo:     %.1f ns\n", tempo_real * 1e9 / ctx->passos);
+  }
+  printf("Posicao final (km):  X=%.3f Y=%.3f Z=%.3f\n",
+         nave->posicao.x / 1000.0, nave->posicao.y / 1000.0,
+         nave->posicao.z / 1000.0);
+  printf("Combustivel (kg):    principal=%.3f RCS=%.3f\n",
+         nave->combustivel_principal, nave->combustivel_rcs);
+  const ContextoEventos *eventos = &ctx->eventos;
+  for (int i = 0; i < eventos->n; i++)
+    if (eventos->ocorrencias[i] > 0)
+      printf("Evento:              %-20s %lux, ultimo em %.6f s\n",
+             eventos->definicoes[i].nome, eventos->ocorrencias[i],
+             eventos->ultimo_tempo[i]);
+  if (config->roteiro || ctx->acoes_roteiro > 0)
+    printf("Roteiro:             %llu acoes executadas, %u na linha do "
+           "tempo\n",
+           ctx->acoes_roteiro, ctx->linha_tempo.n);
+  const TabelaVeiculos *veiculos = &ctx->veiculos;
+  if (veiculos->separacoes)
+    printf("Veiculos:            %zu ativos, %llu criados, %llu destruidos\n",
+           veiculos->n, veiculos->criados, veiculos->destruidos);
+  for (size_t i = 0; i < veiculos->n; i++) {
+    RotuloVeiculo rotulo;
+    veiculos_rotulo(veiculos, (long)i, &rotulo);
+    double r = sqrt(veiculos->px[i] * veiculos->px[i] +
+                    veiculos->py[i] * veiculos->py[i] +
+                    veiculos->pz[i] * veiculos->pz[i]);
+    printf("Veiculo:             %-14s r=%.3f km, massa=%.1f kg, "
+           "energia=%.1f Wh\n",
+           rotulo.nome, r / 1000.0,
+           veiculos->massa_vazia[i] + veiculos->combustivel[i],
+           veiculos->energia[i]);
+  }
+  if (gravar_telemetria)
+    printf("Telemetria:          %llu amostras em %s\n", amostras_gravadas,
+           config->arquivo_telemetria);
+  if (erro_telemetria)
+    fprintf(stderr, "%s: %s (gravacao interrompida)\n",
+            config->arquivo_telemetria, strerror(erro_telemetria));
+  if (checkpoint_salvo)
+    printf("Checkpoint:          %s\n", config->arquivo_checkpoint);
+
+  return (config->arquivo_checkpoint && !checkpoint_salvo) ||
+         erro_telemetria != 0;
+}
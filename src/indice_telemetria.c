@@ -0,0 +1,289 @@
+#include "indice_telemetria.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+static void caminho_indice(const char *log, char *destino, size_t tamanho) {
+  snprintf(destino, tamanho, "%s.idx", log);
+}
+
+// Identifica a versão do log que o índice descreve
+static bool identificar_log(const char *caminho, CabecalhoIndice *cabecalho) {
+  struct stat info;
+  if (stat(caminho, &info) != 0)
+    return false;
+
+  memset(cabecalho, 0, sizeof(*cabecalho));
+  memcpy(cabecalho->magica, INDICE_MAGICA, sizeof(cabecalho->magica));
+  cabecalho->versao = INDICE_VERSAO;
+  cabecalho->versao_log = TELEMETRIA_VERSAO;
+  cabecalho->tamanho_log = (uint64_t)info.st_size;
+  cabecalho->modificacao_log_s = (int64_t)info.st_mtim.tv_sec;
+  cabecalho->modificacao_log_ns = (int64_t)info.st_mtim.tv_nsec;
+  return true;
+}
+
+static bool carregar_indice(LogIndexado *log, const char *caminho_idx,
+                            const CabecalhoIndice *esperado) {
+  FILE *arquivo = fopen(caminho_idx, "rb");
+  if (!arquivo)
+    return false;
+
+  CabecalhoIndice cabecalho;
+  bool ok = fread(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+            memcmp(cabecalho.magica, esperado->magica,
+                   sizeof(cabecalho.magica)) == 0 &&
+            cabecalho.versao == esperado->versao &&
+            cabecalho.versao_log == esperado->versao_log &&
+            cabecalho.tamanho_log == esperado->tamanho_log &&
+            cabecalho.modificacao_log_s == esperado->modificacao_log_s &&
+            cabecalho.modificacao_log_ns == esperado->modificacao_log_ns;
+
+  if (ok) {
+    log->blocos = malloc((cabecalho.n_blocos + 1) * sizeof(EntradaIndice));
+    log->transicoes =
+        malloc((cabecalho.n_transicoes + 1) * sizeof(TransicaoEstado));
+    ok = log->blocos && log->transicoes &&
+         fread(log->blocos, sizeof(EntradaIndice), cabecalho.n_blocos,
+               arquivo) == cabecalho.n_blocos &&
+         fread(log->transicoes, sizeof(TransicaoEstado),
+               cabecalho.n_transicoes, arquivo) == cabecalho.n_transicoes;
+  }
+  fclose(arquivo);
+
+  // Os blocos listados precisam caber no log
+  for (uint64_t b = 0; ok && b < cabecalho.n_blocos; b++)
+    ok = log->blocos[b].deslocamento + sizeof(CabecalhoBloco) <=
+         log->leitor.tamanho;
+
+  if (ok) {
+    log->leitor.deslocamentos =
+        malloc((cabecalho.n_blocos + 1) * sizeof(size_t));
+    ok = log->leitor.deslocamentos != NULL;
+  }
+  if (!ok) {
+    free(log->blocos);
+    free(log->transicoes);
+    log->blocos = NULL;
+    log->transicoes = NULL;
+    return false;
+  }
+
+  for (uint64_t b = 0; b < cabecalho.n_blocos; b++)
+    log->leitor.deslocamentos[b] = (size_t)log->blocos[b].deslocamento;
+  log->leitor.n_blocos = cabecalho.n_blocos;
+  log->leitor.n_amostras = cabecalho.n_amostras;
+  log->n_blocos = cabecalho.n_blocos;
+  log->n_transicoes = cabecalho.n_transicoes;
+  return true;
+}
+
+// Percorre o log uma vez, decodificando os blocos para achar as transições
+static bool montar_indice(LogIndexado *log) {
+  LeitorTelemetria *leitor = &log->leitor;
+  if (!telemetria_percorrer_blocos(leitor))
+    return false;
+
+  log->n_blocos = leitor->n_blocos;
+  log->blocos = malloc((leitor->n_blocos + 1) * sizeof(EntradaIndice));
+  if (!log->blocos)
+    return false;
+
+  size_t capacidade = 16;
+  log->transicoes = malloc(capacidade * sizeof(TransicaoEstado));
+  if (!log->transicoes)
+    return false;
+  log->n_transicoes = 0;
+
+  uint64_t amostra = 0;
+  int32_t estado_anterior = -1;
+  for (uint64_t b = 0; b < leitor->n_blocos; b++) {
+    uint32_t n = telemetria_ler_bloco(leitor, b, log->colunas);
+    if (n == 0) {
+      // Bloco corrompido: o log termina no último bloco íntegro
+      leitor->n_blocos = log->n_blocos = b;
+      leitor->n_amostras = amostra;
+      break;
+    }
+
+    log->blocos[b] = (EntradaIndice){
+        .deslocamento = leitor->deslocamentos[b],
+        .primeira_amostra = amostra,
+        .tempo_inicial = log->colunas[CANAL_TEMPO][0],
+        .tempo_final = log->colunas[CANAL_TEMPO][n - 1]};
+
+    for (uint32_t i = 0; i < n; i++) {
+      int32_t estado = (int32_t)log->colunas[CANAL_ESTADO][i];
+      if (estado != estado_anterior && estado_anterior >= 0) {
+        if (log->n_transicoes == capacidade) {
+          capacidade *= 2;
+          TransicaoEstado *novo =
+              realloc(log->transicoes, capacidade * sizeof(TransicaoEstado));
+          if (!novo)
+            return false;
+          log->transicoes = novo;
+        }
+        log->transicoes[log->n_transicoes++] = (TransicaoEstado){
+            .tempo = log->colunas[CANAL_TEMPO][i],
+            .amostra = amostra + i,
+            .estado_anterior = estado_anterior,
+            .estado_novo = estado};
+      }
+      estado_anterior = estado;
+    }
+    amostra += n;
+  }
+  return true;
+}
+
+static void gravar_indice(const LogIndexado *log, const char *caminho_idx,
+                          const CabecalhoIndice *identificacao) {
+  CabecalhoIndice cabecalho = *identificacao;
+  cabecalho.n_blocos = log->n_blocos;
+  cabecalho.n_amostras = log->leitor.n_amostras;
+  cabecalho.n_transicoes = log->n_transicoes;
+
+  // Sem permissão de escrita o índice só vale para esta execução
+  FILE *arquivo = fopen(caminho_idx, "wb");
+  if (!arquivo)
+    return;
+  bool ok = fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+            fwrite(log->blocos, sizeof(EntradaIndice), log->n_blocos,
+                   arquivo) == log->n_blocos &&
+            fwrite(log->transicoes, sizeof(TransicaoEstado), log->n_transicoes,
+                   arquivo) == log->n_transicoes;
+  if (fclose(arquivo) != 0 || !ok)
+    remove(caminho_idx);
+}
+
+bool log_indexado_abrir(LogIndexado *log, const char *caminho) {
+  memset(log, 0, sizeof(*log));
+  log->leitor.fd = -1;
+  log->bloco_em_cache = -1;
+
+  CabecalhoIndice identificacao;
+  if (!identificar_log(caminho, &identificacao) ||
+      !telemetria_mapear(&log->leitor, caminho))
+    return false;
+
+  char caminho_idx[4096];
+  caminho_indice(caminho, caminho_idx, sizeof(caminho_idx));
+
+  log->indice_reaproveitado =
+      carregar_indice(log, caminho_idx, &identificacao);
+  if (!log->indice_reaproveitado) {
+    if (!montar_indice(log)) {
+      log_indexado_fechar(log);
+      return false;
+    }
+    gravar_indice(log, caminho_idx, &identificacao);
+  }
+  return true;
+}
+
+void log_indexado_fechar(LogIndexado *log) {
+  telemetria_fechar_leitura(&log->leitor);
+  free(log->blocos);
+  free(log->transicoes);
+  log->blocos = NULL;
+  log->transicoes = NULL;
+  log->n_blocos = 0;
+  log->n_transicoes = 0;
+  log->bloco_em_cache = -1;
+}
+
+static bool carregar_bloco(LogIndexado *log, uint64_t bloco) {
+  if ((int64_t)bloco == log->bloco_em_cache)
+    return true;
+  uint32_t n = telemetria_ler_bloco(&log->leitor, bloco, log->colunas);
+  if (n == 0) {
+    log->bloco_em_cache = -1;
+    return false;
+  }
+  log->bloco_em_cache = (int64_t)bloco;
+  log->amostras_em_cache = n;
+  return true;
+}
+
+uint64_t log_indexado_buscar_tempo(LogIndexado *log, double tempo) {
+  if (log->n_blocos == 0 || tempo < log->blocos[0].tempo_inicial)
+    return 0;
+
+  // Último bloco que começa em ou antes de tempo
+  uint64_t inicio = 0, fim = log->n_blocos;
+  while (fim - inicio > 1) {
+    uint64_t meio = inicio + (fim - inicio) / 2;
+    if (log->blocos[meio].tempo_inicial <= tempo)
+      inicio = meio;
+    else
+      fim = meio;
+  }
+
+  const EntradaIndice *entrada = &log->blocos[inicio];
+  if (!carregar_bloco(log, inicio))
+    return entrada->primeira_amostra;
+
+  // Última amostra do bloco com tempo <= tempo
+  const double *tempos = log->colunas[CANAL_TEMPO];
+  uint32_t a = 0, b = log->amostras_em_cache;
+  while (b - a > 1) {
+    uint32_t meio = a + (b - a) / 2;
+    if (tempos[meio] <= tempo)
+      a = meio;
+    else
+      b = meio;
+  }
+  return entrada->primeira_amostra + a;
+}
+
+bool log_indexado_ler_amostra(LogIndexado *log, uint64_t amostra,
+                              double valores[TELEMETRIA_N_CANAIS]) {
+  if (amostra >= log->leitor.n_amostras)
+    return false;
+
+  // Bloco da amostra: último com primeira_amostra <= amostra
+  uint64_t inicio = 0, fim = log->n_blocos;
+  while (fim - inicio > 1) {
+    uint64_t meio = inicio + (fim - inicio) / 2;
+    if (log->blocos[meio].primeira_amostra <= amostra)
+      inicio = meio;
+    else
+      fim = meio;
+  }
+  if (!carregar_bloco(log, inicio))
+    return false;
+
+  uint64_t i = amostra - log->blocos[inicio].primeira_amostra;
+  if (i >= log->amostras_em_cache)
+    return false;
+  for (int c = 0; c < TELEMETRIA_N_CANAIS; c++)
+    valores[c] = log->colunas[c][i];
+  return true;
+}
+
+const TransicaoEstado *log_indexado_proxima_transicao(const LogIndexado *log,
+                                                      double tempo) {
+  uint64_t inicio = 0, fim = log->n_transicoes;
+  while (inicio < fim) {
+    uint64_t meio = inicio + (fim - inicio) / 2;
+    if (log->transicoes[meio].tempo <= tempo)
+      inicio = meio + 1;
+    else
+      fim = meio;
+  }
+  return inicio < log->n_transicoes ? &log->transicoes[inicio] : NULL;
+}
+
+const TransicaoEstado *log_indexado_transicao_anterior(const LogIndexado *log,
+                                                       double tempo) {
+  uint64_t inicio = 0, fim = log->n_transicoes;
+  while (inicio < fim) {
+    uint64_t meio = inicio + (fim - inicio) / 2;
+    if (log->transicoes[meio].tempo < tempo)
+      inicio = meio + 1;
+    else
+      fim = meio;
+  }
+  return inicio > 0 ? &log->transicoes[inicio - 1] : NULL;
+}
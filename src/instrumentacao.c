@@ -0,0 +1,146 @@
+#include "instrumentacao.h"
+
+#ifdef APOLLO_INSTRUMENTACAO
+
+#include <stdlib.h>
+#include <string.h>
+
+static ConjuntoInstrumentacao *_Atomic conjuntos;
+static _Thread_local ConjuntoInstrumentacao *conjunto_thread;
+
+static const char *nomes_metricas[N_METRICAS] = {
+    "periodo", "trabalho", "atraso_sono", "espera_comando"};
+
+const char *obter_nome_metrica(MetricaInstrumentacao metrica) {
+  return metrica < N_METRICAS ? nomes_metricas[metrica] : "?";
+}
+
+void instr_registrar_thread(const char *nome) {
+  ConjuntoInstrumentacao *conjunto = calloc(1, sizeof(*conjunto));
+  if (!conjunto)
+    return;
+  snprintf(conjunto->nome, sizeof(conjunto->nome), "%s", nome);
+
+  // Inserção sem lock no início da lista; leitores só a percorrem
+  conjunto->proximo = atomic_load(&conjuntos);
+  while (!atomic_compare_exchange_weak(&conjuntos, &conjunto->proximo,
+                                       conjunto))
+    ;
+  conjunto_thread = conjunto;
+}
+
+static inline unsigned int balde_de(uint64_t ns) {
+  if (ns < HIST_SUB_BALDES)
+    return (unsigned int)ns;
+  unsigned int expoente = 63 - (unsigned int)__builtin_clzll(ns);
+  unsigned int sub = (unsigned int)(ns >> (expoente - HIST_BITS_SUB)) &
+                     (HIST_SUB_BALDES - 1);
+  return (expoente - HIST_BITS_SUB + 1) * HIST_SUB_BALDES + sub;
+}
+
+// Maior valor representado pelo balde
+static uint64_t limite_superior(unsigned int balde) {
+  if (balde < HIST_SUB_BALDES)
+    return balde;
+  unsigned int expoente = balde / HIST_SUB_BALDES + HIST_BITS_SUB - 1;
+  uint64_t sub = balde % HIST_SUB_BALDES;
+  uint64_t largura = 1ULL << (expoente - HIST_BITS_SUB);
+  return ((HIST_SUB_BALDES + sub) << (expoente - HIST_BITS_SUB)) + largura - 1;
+}
+
+// Escritor único: carga e armazenamento relaxados bastam, e leitores
+// concorrentes nunca veem valores rasgados
+static inline void incrementar(_Atomic uint64_t *contador, uint64_t valor) {
+  atomic_store_explicit(
+      contador, atomic_load_explicit(contador, memory_order_relaxed) + valor,
+      memory_order_relaxed);
+}
+
+void instr_registrar(MetricaInstrumentacao metrica, uint64_t ns) {
+  ConjuntoInstrumentacao *conjunto = conjunto_thread;
+  if (!conjunto)
+    return;
+  Histograma *histograma = &conjunto->metricas[metrica];
+  incrementar(&histograma->baldes[balde_de(ns)], 1);
+  incrementar(&histograma->total, 1);
+  incrementar(&histograma->soma_ns, ns);
+  if (ns > atomic_load_explicit(&histograma->max_ns, memory_order_relaxed))
+    atomic_store_explicit(&histograma->max_ns, ns, memory_order_relaxed);
+}
+
+const ConjuntoInstrumentacao *instr_conjuntos(void) {
+  return atomic_load(&conjuntos);
+}
+
+void instr_resumir(const Histograma *histograma, ResumoHistograma *resumo) {
+  memset(resumo, 0, sizeof(*resumo));
+  uint64_t contagens[HIST_N_BALDES];
+  uint64_t total = 0;
+  for (unsigned int b = 0; b < HIST_N_BALDES; b++) {
+    contagens[b] =
+        atomic_load_explicit(&histograma->baldes[b], memory_order_relaxed);
+    total += contagens[b];
+  }
+  if (total == 0)
+    return;
+
+  resumo->total = total;
+  resumo->media =
+      (double)atomic_load_explicit(&histograma->soma_ns,
+                                   memory_order_relaxed) /
+      (double)atomic_load_explicit(&histograma->total, memory_order_relaxed);
+  resumo->max = atomic_load_explicit(&histograma->max_ns, memory_order_relaxed);
+
+  // Percentis pelo limite superior do balde, limitados ao máximo exato
+  uint64_t limites[3] = {(total * 50 + 99) / 100, (total * 99 + 99) / 100,
+                         (total * 999 + 999) / 1000};
+  uint64_t *destinos[3] = {&resumo->p50, &resumo->p99, &resumo->p999};
+  uint64_t acumulado = 0;
+  int proximo = 0;
+  for (unsigned int b = 0; b < HIST_N_BALDES && proximo < 3; b++) {
+    acumulado += contagens[b];
+    while (proximo < 3 && acumulado >= limites[proximo]) {
+      uint64_t valor = limite_superior(b);
+      *destinos[proximo++] = valor < resumo->max ? valor : resumo->max;
+    }
+  }
+}
+
+bool instr_despejar(const char *caminho) {
+  FILE *arquivo = fopen(caminho, "w");
+  if (!arquivo)
+    return false;
+
+  fprintf(arquivo, "# thread metrica total media_ns p50_ns p99_ns p999_ns "
+                   "max_ns\n");
+  for (const ConjuntoInstrumentacao *c = instr_conjuntos(); c; c = c->proximo)
+    for (int m = 0; m < N_METRICAS; m++) {
+      ResumoHistograma resumo;
+      instr_resumir(&c->metricas[m], &resumo);
+      if (resumo.total == 0)
+        continue;
+      fprintf(arquivo, "%s %s %llu %.1f %llu %llu %llu %llu\n", c->nome,
+              obter_nome_metrica(m), (unsigned long long)resumo.total,
+              resumo.media, (unsigned long long)resumo.p50,
+              (unsigned long long)resumo.p99, (unsigned long long)resumo.p999,
+              (unsigned long long)resumo.max);
+    }
+
+  // Baldes não vazios: limite superior em ns e contagem
+  fprintf(arquivo, "\n# thread metrica limite_superior_ns contagem\n");
+  for (const ConjuntoInstrumentacao *c = instr_conjuntos(); c; c = c->proximo)
+    for (int m = 0; m < N_METRICAS; m++)
+      for (unsigned int b = 0; b < HIST_N_BALDES; b++) {
+        uint64_t contagem = atomic_load_explicit(&c->metricas[m].baldes[b],
+                                                 memory_order_relaxed);
+        if (contagem)
+          fprintf(arquivo, "%s %s %llu %llu\n", c->nome,
+                  obter_nome_metrica(m),
+                  (unsigned long long)limite_superior(b),
+                  (unsigned long long)contagem);
+      }
+
+  return fclose(arquivo) == 0;
+}
+
+#endif // APOLLO_INSTRUMENTACAO
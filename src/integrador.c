@@ -0,0 +1,537 @@
+#include "integrador.h"
+#include "kepler.h"
+#include "physics_engine.h"
+#include <math.h>
+#include <string.h>
+
+// Coeficientes do par embutido de Dormand-Prince 5(4). O campo de forças
+// depende do tempo pelas efemérides, então cada estágio usa seu nó c_i.
+static const double c2 = 1.0 / 5.0, c3 = 3.0 / 10.0, c4 = 4.0 / 5.0,
+                    c5 = 8.0 / 9.0;
+static const double a21 = 1.0 / 5.0;
+static const double a31 = 3.0 / 40.0, a32 = 9.0 / 40.0;
+static const double a41 = 44.0 / 45.0, a42 = -56.0 / 15.0, a43 = 32.0 / 9.0;
+static const double a51 = 19372.0 / 6561.0, a52 = -25360.0 / 2187.0,
+                    a53 = 64448.0 / 6561.0, a54 = -212.0 / 729.0;
+static const double a61 = 9017.0 / 3168.0, a62 = -355.0 / 33.0,
+                    a63 = 46732.0 / 5247.0, a64 = 49.0 / 176.0,
+                    a65 = -5103.0 / 18656.0;
+
+// Pesos da solução de 5a ordem (também a linha 7 da tabela, FSAL)
+static const double b1 = 35.0 / 384.0, b3 = 500.0 / 1113.0,
+                    b4 = 125.0 / 192.0, b5 = -2187.0 / 6784.0,
+                    b6 = 11.0 / 84.0;
+
+// Diferença entre as soluções de 5a e 4a ordem (estimativa de erro)
+static const double e1 = 71.0 / 57600.0, e3 = -71.0 / 16695.0,
+                    e4 = 71.0 / 1920.0, e5 = -17253.0 / 339200.0,
+                    e6 = 22.0 / 525.0, e7 = -1.0 / 40.0;
+
+// Limites da variação do passo entre tentativas
+#define FATOR_SEGURANCA 0.9
+#define FATOR_MIN 0.2
+#define FATOR_MAX 5.0
+
+// Trechos cônicos: cada um cobre no máximo esta fração do tempo
+// característico da órbita (min(r/v, √(r³/μ))), para que a perturbação, o
+// corpo dominante e a interpolação dos eventos sejam reavaliados a tempo
+#define FRACAO_ARCO_CONICO 0.05
+#define ALTITUDE_MIN_CONICA 1.0     // m; abaixo disso a nave está pousada
+#define TOLERANCIA_TROCA_SOI 1e-3   // s
+
+void configuracao_integrador_padrao(ConfiguracaoIntegrador *config) {
+  config->tipo = INTEGRADOR_RK4;
+  config->tol_abs = 1e-6;
+  config->tol_rel = 1e-12;
+  config->passo_min = 1e-6;
+  config->passo_max = 600.0;
+  config->limiar_kepler = 0.0;
+}
+
+void inicializar_estado_integrador(EstadoIntegrador *estado) {
+  memset(estado, 0, sizeof(*estado));
+}
+
+TipoIntegrador obter_tipo_integrador(const char *nome, bool *valido) {
+  *valido = true;
+  if (strcmp(nome, "rk4") == 0)
+    return INTEGRADOR_RK4;
+  if (strcmp(nome, "dp54") == 0)
+    return INTEGRADOR_DP54;
+  *valido = false;
+  return INTEGRADOR_RK4;
+}
+
+const char *obter_nome_integrador(TipoIntegrador tipo) {
+  return tipo == INTEGRADOR_DP54 ? "dp54" : "rk4";
+}
+
+// f(t, y) para y = (posição, velocidade): derivada = (velocidade, aceleração),
+// com o ambiente gravitacional já preparado para o instante t
+static void derivada(const AmbienteGravitacional *ambiente, const double y[6],
+                     Vetor3D empuxo, double f[6]) {
+  Vetor3D gravidade = calcular_aceleracao_gravitacional_ambiente(
+      (Vetor3D){y[0], y[1], y[2]}, ambiente);
+  f[0] = y[3];
+  f[1] = y[4];
+  f[2] = y[5];
+  f[3] = gravidade.x + empuxo.x;
+  f[4] = gravidade.y + empuxo.y;
+  f[5] = gravidade.z + empuxo.z;
+}
+
+// Tenta um passo de tamanho h. Retorna a norma RMS do erro escalada pelas
+// tolerâncias (aceitável quando <= 1) e preenche y_novo e f_novo (FSAL).
+static double tentar_passo_dp54(double t, NivelGravidade nivel,
+                                const double y[6], const double k1[6],
+                                Vetor3D empuxo, double h,
+                                const ConfiguracaoIntegrador *config,
+                                double y_novo[6], double f_novo[6]) {
+  double k2[6], k3[6], k4[6], k5[6], k6[6], tmp[6];
+  AmbienteGravitacional ambiente;
+  int i;
+
+  for (i = 0; i < 6; i++)
+    tmp[i] = y[i] + h * (a21 * k1[i]);
+  preparar_ambiente_gravitacional(t + c2 * h, nivel, &ambiente);
+  derivada(&ambiente, tmp, empuxo, k2);
+
+  for (i = 0; i < 6; i++)
+    tmp[i] = y[i] + h * (a31 * k1[i] + a32 * k2[i]);
+  preparar_ambiente_gravitacional(t + c3 * h, nivel, &ambiente);
+  derivada(&ambiente, tmp, empuxo, k3);
+
+  for (i = 0; i < 6; i++)
+    tmp[i] = y[i] + h * (a41 * k1[i] + a42 * k2[i] + a43 * k3[i]);
+  preparar_ambiente_gravitacional(t + c4 * h, nivel, &ambiente);
+  derivada(&ambiente, tmp, empuxo, k4);
+
+  for (i = 0; i < 6; i++)
+    tmp[i] = y[i] + h * (a51 * k1[i] + a52 * k2[i] + a53 * k3[i] +
+                         a54 * k4[i]);
+  preparar_ambiente_gravitacional(t + c5 * h, nivel, &ambiente);
+  derivada(&ambiente, tmp, empuxo, k5);
+
+  for (i = 0; i < 6; i++)
+    tmp[i] = y[i] + h * (a61 * k1[i] + a62 * k2[i] + a63 * k3[i] +
+                         a64 * k4[i] + a65 * k5[i]);
+  // O sexto estágio e o FSAL compartilham o instante t + h
+  preparar_ambiente_gravitacional(t + h, nivel, &ambiente);
+  derivada(&ambiente, tmp, empuxo, k6);
+
+  for (i = 0; i < 6; i++)
+    y_novo[i] = y[i] + h * (b1 * k1[i] + b3 * k3[i] + b4 * k4[i] +
+                            b5 * k5[i] + b6 * k6[i]);
+  derivada(&ambiente, y_novo, empuxo, f_novo);
+
+  double soma = 0.0;
+  for (i = 0; i < 6; i++) {
+    double erro = h * (e1 * k1[i] + e3 * k3[i] + e4 * k4[i] + e5 * k5[i] +
+                       e6 * k6[i] + e7 * f_novo[i]);
+    double escala = config->tol_abs +
+                    config->tol_rel * fmax(fabs(y[i]), fabs(y_novo[i]));
+    soma += (erro / escala) * (erro / escala);
+  }
+  return sqrt(soma / 6.0);
+}
+
+static void integrar_dp54(EstadoNave *nave, double intervalo,
+                          const ConfiguracaoIntegrador *config,
+                          EstadoIntegrador *estado,
+                          ContextoEventos *eventos) {
+  Vetor3D empuxo = calcular_aceleracao_empuxo(nave);
+  NivelGravidade nivel = gravidade_nivel(nave->estado_missao);
+  double restante = intervalo;
+  double h = estado->passo_sugerido;
+  if (h <= 0.0)
+    h = fmin(1.0, intervalo);
+
+  while (restante > 0.0) {
+    double y[6] = {nave->posicao.x,    nave->posicao.y,    nave->posicao.z,
+                   nave->velocidade.x, nave->velocidade.y, nave->velocidade.z};
+    double k1[6];
+
+    if (estado->fsal_valido && estado->fsal_tempo == nave->tempo_missao &&
+        estado->fsal_nivel == nivel &&
+        memcmp(estado->fsal_estado, y, sizeof(y)) == 0 &&
+        memcmp(&estado->fsal_empuxo, &empuxo, sizeof(empuxo)) == 0) {
+      memcpy(k1, estado->fsal_derivada, sizeof(k1));
+    } else {
+      AmbienteGravitacional ambiente;
+      preparar_ambiente_gravitacional(nave->tempo_missao, nivel, &ambiente);
+      derivada(&ambiente, y, empuxo, k1);
+      estado->avaliacoes++;
+    }
+
+    double y_novo[6], f_novo[6];
+    double erro;
+    double h_passo;
+    for (;;) {
+      // O último passo é recortado para terminar exatamente no intervalo
+      double h_alvo = fmin(h, config->passo_max);
+      h_passo = fmin(h_alvo, restante);
+      erro = tentar_passo_dp54(nave->tempo_missao, nivel, y, k1, empuxo,
+                               h_passo, config, y_novo, f_novo);
+      estado->avaliacoes += 6;
+
+      double fator = erro > 0.0 ? FATOR_SEGURANCA * pow(erro, -0.2) : FATOR_MAX;
+      fator = fmin(FATOR_MAX, fmax(FATOR_MIN, fator));
+
+      if (erro <= 1.0) {
+        // Um passo recortado não serve de base para a próxima proposta
+        if (h_passo == h_alvo)
+          h = fmin(h_passo * fator, config->passo_max);
+        break;
+      }
+      if (h_passo <= config->passo_min) {
+        // Aceita no passo mínimo mesmo acima da tolerância
+        h = config->passo_min;
+        break;
+      }
+      estado->passos_rejeitados++;
+      h = fmax(h_passo * fator, config->passo_min);
+    }
+    estado->passos_aceitos++;
+
+    // Evento terminal no passo: refaz o passo até o instante dele. O passo
+    // encurtado é menor que um já aceito, então não é testado de novo
+    int evento = -1;
+    double tempo_evento = 0.0;
+    if (eventos) {
+      Vetor3D p1 = {y_novo[0], y_novo[1], y_novo[2]};
+      Vetor3D v1 = {y_novo[3], y_novo[4], y_novo[5]};
+      evento = eventos_localizar(eventos, nave->tempo_missao, nave->posicao,
+                                 nave->velocidade, nave->tempo_missao + h_passo,
+                                 p1, v1, &tempo_evento);
+    }
+    if (evento >= 0) {
+      h_passo = tempo_evento - nave->tempo_missao;
+      if (h_passo > 0.0) {
+        tentar_passo_dp54(nave->tempo_missao, nivel, y, k1, empuxo, h_passo,
+                          config, y_novo, f_novo);
+        estado->avaliacoes += 6;
+      } else {
+        h_passo = 0.0;
+        memcpy(y_novo, y, sizeof(y_novo));
+        memcpy(f_novo, k1, sizeof(f_novo));
+      }
+    }
+
+    nave->posicao = (Vetor3D){y_novo[0], y_novo[1], y_novo[2]};
+    nave->velocidade = (Vetor3D){y_novo[3], y_novo[4], y_novo[5]};
+    nave->aceleracao = (Vetor3D){f_novo[3], f_novo[4], f_novo[5]};
+    restante -= h_passo;
+    nave->tempo_missao += h_passo;
+
+    if (evento >= 0) {
+      // A ação muda o estado ou o empuxo: o FSAL deixa de valer
+      eventos_aplicar(eventos, evento, nave);
+      empuxo = calcular_aceleracao_empuxo(nave);
+      estado->fsal_valido = false;
+      continue;
+    }
+
+    aplicar_colisao_terra(nave);
+    aplicar_colisao_lua(nave);
+    if (eventos)
+      eventos_rearmar(eventos, nave);
+
+    memcpy(estado->fsal_estado, y_novo, sizeof(y_novo));
+    memcpy(estado->fsal_derivada, f_novo, sizeof(f_novo));
+    estado->fsal_empuxo = empuxo;
+    estado->fsal_nivel = nivel;
+    estado->fsal_tempo = nave->tempo_missao;
+    estado->fsal_valido = true;
+  }
+
+  estado->passo_sugerido = h;
+}
+
+// Um passo RK4 de `intervalo`, encurtado pelos eventos terminais que
+// houver nele
+static void integrar_rk4_eventos(EstadoNave *nave, double intervalo,
+                                 EstadoIntegrador *estado,
+                                 ContextoEventos *eventos) {
+  NivelGravidade nivel = gravidade_nivel(nave->estado_missao);
+  double tempo_final = nave->tempo_missao + intervalo;
+  double h = intervalo;
+
+  while (h > 0.0) {
+    Vetor3D acel_empuxo = calcular_aceleracao_empuxo(nave);
+    Vetor3D posicao = nave->posicao, velocidade = nave->velocidade;
+    Vetor3D aceleracao = passo_rk4(&posicao, &velocidade, nave->tempo_missao,
+                                   h, acel_empuxo, nivel);
+    if (estado) {
+      estado->avaliacoes += 4;
+      estado->passos_aceitos++;
+    }
+
+    double tempo_evento;
+    int evento =
+        eventos_localizar(eventos, nave->tempo_missao, nave->posicao,
+                          nave->velocidade, tempo_final, posicao, velocidade,
+                          &tempo_evento);
+    if (evento < 0) {
+      nave->posicao = posicao;
+      nave->velocidade = velocidade;
+      nave->aceleracao = aceleracao;
+      nave->tempo_missao = tempo_final;
+      break;
+    }
+
+    h = tempo_evento - nave->tempo_missao;
+    if (h > 0.0) {
+      nave->aceleracao =
+          passo_rk4(&nave->posicao, &nave->velocidade, nave->tempo_missao, h,
+                    acel_empuxo, nivel);
+      if (estado)
+        estado->avaliacoes += 4;
+      nave->tempo_missao = tempo_evento;
+    }
+    eventos_aplicar(eventos, evento, nave);
+    h = tempo_final - nave->tempo_missao;
+  }
+
+  aplicar_colisao_terra(nave);
+  aplicar_colisao_lua(nave);
+  eventos_rearmar(eventos, nave);
+}
+
+static void integrar_numerico(EstadoNave *nave, double intervalo,
+                              const ConfiguracaoIntegrador *config,
+                              EstadoIntegrador *estado,
+                              ContextoEventos *eventos) {
+  if (config && config->tipo == INTEGRADOR_DP54) {
+    integrar_dp54(nave, intervalo, config, estado, eventos);
+    return;
+  }
+
+  if (eventos) {
+    integrar_rk4_eventos(nave, intervalo, estado, eventos);
+    return;
+  }
+
+  atualizar_fisica_rk4(nave, intervalo);
+  if (estado) {
+    estado->avaliacoes += 4;
+    estado->passos_aceitos++;
+  }
+}
+
+// Corpo dominante da cônica: a Lua dentro da esfera de influência dela, a
+// Terra fora. Posição e velocidade do corpo no referencial da missão
+typedef struct {
+  bool lua;
+  double mu;
+  Vetor3D posicao, velocidade;
+} CorpoCentral;
+
+static Vetor3D diferenca(Vetor3D a, Vetor3D b) {
+  return (Vetor3D){a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+static double modulo(Vetor3D a) {
+  return sqrt(a.x * a.x + a.y * a.y + a.z * a.z);
+}
+
+static void corpo_dominante(double tempo, Vetor3D posicao,
+                            CorpoCentral *corpo) {
+  Vetor3D lua = efemerides_lua(tempo);
+  if (modulo(diferenca(posicao, lua)) < RAIO_SOI_LUA) {
+    *corpo = (CorpoCentral){true, G * M_LUA, lua,
+                            efemerides_velocidade_lua(tempo)};
+    return;
+  }
+  *corpo = (CorpoCentral){false, G * M_TERRA, {0.0, 0.0, 0.0},
+                          {0.0, 0.0, 0.0}};
+}
+
+// |perturbação| / |atração central| no estado atual. A perturbação é tudo
+// o que o modelo de forças soma além do corpo central: os outros corpos, o
+// termo indireto e os harmônicos da Terra. Em torno da Lua, a aceleração
+// da própria Lua (o modelo avaliado no centro dela) é descontada
+static double razao_perturbacao(const EstadoNave *nave, NivelGravidade nivel,
+                                const CorpoCentral *corpo) {
+  AmbienteGravitacional ambiente;
+  preparar_ambiente_gravitacional(nave->tempo_missao, nivel, &ambiente);
+  Vetor3D total =
+      calcular_aceleracao_gravitacional_ambiente(nave->posicao, &ambiente);
+  if (corpo->lua)
+    total = diferenca(total, calcular_aceleracao_gravitacional_ambiente(
+                                 corpo->posicao, &ambiente));
+
+  Vetor3D relativa = diferenca(nave->posicao, corpo->posicao);
+  double r = modulo(relativa);
+  double central = corpo->mu / (r * r);
+  Vetor3D perturbacao = {total.x + central * relativa.x / r,
+                         total.y + central * relativa.y / r,
+                         total.z + central * relativa.z / r};
+  return modulo(perturbacao) / central;
+}
+
+// Estado na cônica `tau` segundos após (tempo, p0, v0), no referencial da
+// missão. O corpo central segue as efemérides; o movimento relativo a ele
+// é o de dois corpos
+static bool estado_conico(const CorpoCentral *corpo, double tempo, Vetor3D p0,
+                          Vetor3D v0, double tau, Vetor3D *p, Vetor3D *v) {
+  Vetor3D r = diferenca(p0, corpo->posicao);
+  Vetor3D u = diferenca(v0, corpo->velocidade);
+  if (!kepler_propagar(&r, &u, corpo->mu, tau))
+    return false;
+
+  Vetor3D origem = {0.0, 0.0, 0.0}, velocidade_origem = {0.0, 0.0, 0.0};
+  if (corpo->lua) {
+    origem = efemerides_lua(tempo + tau);
+    velocidade_origem = efemerides_velocidade_lua(tempo + tau);
+  }
+  *p = (Vetor3D){origem.x + r.x, origem.y + r.y, origem.z + r.z};
+  *v = (Vetor3D){velocidade_origem.x + u.x, velocidade_origem.y + u.y,
+                 velocidade_origem.z + u.z};
+  return true;
+}
+
+// Distância à Lua menos o raio da esfera de influência, ao longo da cônica
+static double distancia_soi(const CorpoCentral *corpo, double tempo,
+                            Vetor3D p0, Vetor3D v0, double tau) {
+  Vetor3D p, v;
+  estado_conico(corpo, tempo, p0, v0, tau, &p, &v);
+  return modulo(diferenca(p, efemerides_lua(tempo + tau))) - RAIO_SOI_LUA;
+}
+
+// Instante da troca de corpo dominante em (0, h] por regula falsi
+// (Illinois). Retorna o lado de depois da troca, para que o próximo trecho
+// já comece em torno do novo corpo
+static double instante_troca_soi(const CorpoCentral *corpo, double tempo,
+                                 Vetor3D p0, Vetor3D v0, double h) {
+  double a = 0.0, b = h;
+  double ga = distancia_soi(corpo, tempo, p0, v0, a);
+  double gb = distancia_soi(corpo, tempo, p0, v0, b);
+  int lado = 0;
+  while (b - a > TOLERANCIA_TROCA_SOI && ga != gb) {
+    double c = (a * gb - b * ga) / (gb - ga);
+    if (!(c > a && c < b))
+      c = 0.5 * (a + b);
+    double gc = distancia_soi(corpo, tempo, p0, v0, c);
+    if ((gc > 0.0) == (gb > 0.0)) {
+      b = c;
+      gb = gc;
+      if (lado == 1)
+        ga *= 0.5;
+      lado = 1;
+    } else {
+      a = c;
+      ga = gc;
+      if (lado == -1)
+        gb *= 0.5;
+      lado = -1;
+    }
+  }
+  return b;
+}
+
+// Um trecho balístico pela cônica, de no máximo `restante` segundos.
+// Retorna false, sem mexer na nave, fora das condições da cônica: com
+// empuxo, pousada, perturbação acima do limiar ou sem convergência.
+static bool segmento_conico(EstadoNave *nave, double restante,
+                            const ConfiguracaoIntegrador *config,
+                            EstadoIntegrador *estado,
+                            ContextoEventos *eventos) {
+  // O RCS não entra na translação (calcular_aceleracao_empuxo): basta o
+  // motor principal desligado
+  if (nave->empuxo_principal != 0.0)
+    return false;
+
+  double tempo = nave->tempo_missao;
+  Vetor3D p0 = nave->posicao, v0 = nave->velocidade;
+  CorpoCentral corpo;
+  corpo_dominante(tempo, p0, &corpo);
+  Vetor3D relativa = diferenca(p0, corpo.posicao);
+  double r = modulo(relativa);
+  double raio_corpo = corpo.lua ? RAIO_MIN_LUA : RAIO_TERRA;
+  if (r < raio_corpo + ALTITUDE_MIN_CONICA)
+    return false;
+  if (razao_perturbacao(nave, gravidade_nivel(nave->estado_missao),
+                        &corpo) > config->limiar_kepler)
+    return false;
+
+  double v = modulo(diferenca(v0, corpo.velocidade));
+  double escala = sqrt(r * r * r / corpo.mu);
+  if (v > 0.0)
+    escala = fmin(escala, r / v);
+  double h = fmin(restante, FRACAO_ARCO_CONICO * escala);
+
+  Vetor3D p1, v1;
+  if (!estado_conico(&corpo, tempo, p0, v0, h, &p1, &v1))
+    return false;
+
+  // Cruzou a esfera de influência: o trecho termina na troca de corpo
+  CorpoCentral corpo_final;
+  corpo_dominante(tempo + h, p1, &corpo_final);
+  if (corpo_final.lua != corpo.lua) {
+    h = instante_troca_soi(&corpo, tempo, p0, v0, h);
+    estado_conico(&corpo, tempo, p0, v0, h, &p1, &v1);
+  }
+
+  // Evento terminal no trecho: a cônica dá o estado exato no instante dele
+  int evento = -1;
+  double tempo_evento = 0.0;
+  if (eventos)
+    evento = eventos_localizar(eventos, tempo, p0, v0, tempo + h, p1, v1,
+                               &tempo_evento);
+  if (evento >= 0) {
+    h = tempo_evento - tempo;
+    estado_conico(&corpo, tempo, p0, v0, h, &p1, &v1);
+  }
+
+  Vetor3D relativa_final = diferenca(p1, corpo.lua ? efemerides_lua(tempo + h)
+                                                   : corpo.posicao);
+  double r1 = modulo(relativa_final);
+  double central = -corpo.mu / (r1 * r1 * r1);
+  nave->posicao = p1;
+  nave->velocidade = v1;
+  nave->aceleracao = (Vetor3D){central * relativa_final.x,
+                               central * relativa_final.y,
+                               central * relativa_final.z};
+  nave->tempo_missao = h == restante ? tempo + restante : tempo + h;
+  if (estado)
+    estado->segmentos_conicos++;
+
+  if (evento >= 0) {
+    eventos_aplicar(eventos, evento, nave);
+    return true;
+  }
+  aplicar_colisao_terra(nave);
+  aplicar_colisao_lua(nave);
+  if (eventos)
+    eventos_rearmar(eventos, nave);
+  return true;
+}
+
+void integrar_intervalo(EstadoNave *nave, double intervalo,
+                        const ConfiguracaoIntegrador *config,
+                        EstadoIntegrador *estado, ContextoEventos *eventos) {
+  if (intervalo <= 0.0)
+    return;
+  if (!config || config->limiar_kepler <= 0.0) {
+    integrar_numerico(nave, intervalo, config, estado, eventos);
+    return;
+  }
+
+  // Alterna entre cônicas e o integrador numérico conforme as condições do
+  // trecho. O DP54 avança um passo por vez, para que a cônica seja retomada
+  // assim que a perturbação cair; o RK4 cobre o intervalo em um passo
+  double tempo_final = nave->tempo_missao + intervalo;
+  double restante = intervalo;
+  while (restante > 0.0) {
+    if (!segmento_conico(nave, restante, config, estado, eventos)) {
+      double trecho = restante;
+      if (config->tipo == INTEGRADOR_DP54 && estado->passo_sugerido > 0.0)
+        trecho = fmin(restante,
+                      fmin(estado->passo_sugerido, config->passo_max));
+      integrar_numerico(nave, trecho, config, estado, eventos);
+      if (trecho == restante)
+        nave->tempo_missao = tempo_final;
+    }
+    restante = tempo_final - nave->tempo_missao;
+  }
+}
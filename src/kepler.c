@@ -0,0 +1,75 @@
+#include "kepler.h"
+#include <math.h>
+
+#define ITERACOES_KEPLER 50
+#define TOLERANCIA_KEPLER 1e-13 // relativa, em χ
+
+// Funções de Stumpff. Perto de z = 0 as formas fechadas perdem precisão por
+// cancelamento: usa a série
+static void stumpff(double z, double *c, double *s) {
+  if (z > 1e-6) {
+    double raiz = sqrt(z);
+    *c = (1.0 - cos(raiz)) / z;
+    *s = (raiz - sin(raiz)) / (raiz * z);
+  } else if (z < -1e-6) {
+    double raiz = sqrt(-z);
+    *c = (cosh(raiz) - 1.0) / -z;
+    *s = (sinh(raiz) - raiz) / (raiz * -z);
+  } else {
+    *c = 0.5 - z / 24.0 + z * z / 720.0;
+    *s = 1.0 / 6.0 - z / 120.0 + z * z / 5040.0;
+  }
+}
+
+bool kepler_propagar(Vetor3D *posicao, Vetor3D *velocidade, double mu,
+                     double dt) {
+  Vetor3D r0 = *posicao, v0 = *velocidade;
+  double dist0 = sqrt(r0.x * r0.x + r0.y * r0.y + r0.z * r0.z);
+  if (dist0 <= 0.0 || mu <= 0.0)
+    return false;
+  if (dt == 0.0)
+    return true;
+
+  double raiz_mu = sqrt(mu);
+  double rv = (r0.x * v0.x + r0.y * v0.y + r0.z * v0.z) / raiz_mu;
+  double v2 = v0.x * v0.x + v0.y * v0.y + v0.z * v0.z;
+  double alfa = 2.0 / dist0 - v2 / mu; // 1/a: > 0 elíptica, < 0 hiperbólica
+
+  // Chute de arco curto: χ ≈ √μ Δt / r0
+  double chi = raiz_mu * dt / dist0;
+  double c = 0.5, s = 1.0 / 6.0, z = 0.0;
+  bool convergiu = false;
+  for (int i = 0; i < ITERACOES_KEPLER; i++) {
+    z = alfa * chi * chi;
+    stumpff(z, &c, &s);
+    double chi2 = chi * chi;
+    double f = rv * chi2 * c + (1.0 - alfa * dist0) * chi2 * chi * s +
+               dist0 * chi - raiz_mu * dt;
+    // A derivada é o raio na solução: sempre positiva
+    double df = rv * chi * (1.0 - z * s) + (1.0 - alfa * dist0) * chi2 * c +
+                dist0;
+    double passo = f / df;
+    chi -= passo;
+    if (fabs(passo) <= TOLERANCIA_KEPLER * fmax(1.0, fabs(chi))) {
+      convergiu = true;
+      break;
+    }
+  }
+  if (!convergiu || !isfinite(chi))
+    return false;
+
+  z = alfa * chi * chi;
+  stumpff(z, &c, &s);
+  double chi2 = chi * chi;
+  double f = 1.0 - chi2 / dist0 * c;
+  double g = dt - chi2 * chi * s / raiz_mu;
+  Vetor3D r = {f * r0.x + g * v0.x, f * r0.y + g * v0.y, f * r0.z + g * v0.z};
+  double dist = sqrt(r.x * r.x + r.y * r.y + r.z * r.z);
+
+  double df = raiz_mu / (dist * dist0) * (z * chi * s - chi);
+  double dg = 1.0 - chi2 / dist * c;
+  *posicao = r;
+  *velocidade = (Vetor3D){df * r0.x + dg * v0.x, df * r0.y + dg * v0.y,
+                          df * r0.z + dg * v0.z};
+  return true;
+}
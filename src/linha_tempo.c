@@ -0,0 +1,272 @@
+#include "linha_tempo.h"
+
+// Listas além das posições da roda
+#define LISTA_VENCIDOS (LINHA_TEMPO_NIVEIS * LINHA_TEMPO_POSICOES)
+#define LISTA_DISTANTES (LISTA_VENCIDOS + 1)
+#define MASCARA_POSICAO (LINHA_TEMPO_POSICOES - 1)
+
+// Passos cobertos por uma posição do nível
+static inline uint64_t unidade(int nivel) {
+  return 1ULL << (LINHA_TEMPO_BITS * nivel);
+}
+
+// Os distantes são revistos a cada posição do último nível
+#define UNIDADE_DISTANTES unidade(LINHA_TEMPO_NIVEIS - 1)
+#define HORIZONTE unidade(LINHA_TEMPO_NIVEIS)
+
+static inline uint64_t rotacionar(uint64_t bits, unsigned int n) {
+  return n ? (bits >> n) | (bits << (64 - n)) : bits;
+}
+
+// Primeiro passo >= agora em que a posição do nível começa, quando o que
+// ela guarda desce (ou, no nível 0, vence)
+static uint64_t passo_da_posicao(uint64_t agora, int nivel,
+                                 unsigned int posicao) {
+  unsigned int bits = LINHA_TEMPO_BITS * nivel;
+  uint64_t fronteira = (agora + unidade(nivel) - 1) >> bits;
+  uint64_t salto = (posicao - fronteira) & MASCARA_POSICAO;
+  return (fronteira + salto) << bits;
+}
+
+static uint64_t passo_dos_distantes(uint64_t agora) {
+  return (agora + UNIDADE_DISTANTES - 1) / UNIDADE_DISTANTES *
+         UNIDADE_DISTANTES;
+}
+
+// Primeira posição ocupada do nível a partir da fronteira atual, e o passo
+// em que ela começa
+static unsigned int primeira_posicao(const LinhaTempo *linha, int nivel,
+                                     uint64_t *passo) {
+  unsigned int bits = LINHA_TEMPO_BITS * nivel;
+  uint64_t fronteira = (linha->agora + unidade(nivel) - 1) >> bits;
+  uint64_t ocupadas = rotacionar(linha->ocupadas[nivel],
+                                 (unsigned int)(fronteira & MASCARA_POSICAO));
+  fronteira += (uint64_t)__builtin_ctzll(ocupadas);
+  *passo = fronteira << bits;
+  return (unsigned int)fronteira & MASCARA_POSICAO;
+}
+
+static uint64_t calcular_proximo_trabalho(const LinhaTempo *linha) {
+  uint64_t proximo = UINT64_MAX;
+  for (int nivel = 0; nivel < LINHA_TEMPO_NIVEIS; nivel++) {
+    if (!linha->ocupadas[nivel])
+      continue;
+    uint64_t passo;
+    primeira_posicao(linha, nivel, &passo);
+    if (passo < proximo)
+      proximo = passo;
+  }
+  if (linha->distantes != SEM_EVENTO) {
+    uint64_t passo = passo_dos_distantes(linha->agora);
+    if (passo < proximo)
+      proximo = passo;
+  }
+  return proximo;
+}
+
+static void empilhar(LinhaTempo *linha, int32_t *lista, int32_t evento,
+                     uint32_t onde) {
+  linha->eventos[evento].proximo = *lista;
+  linha->eventos[evento].lista = onde;
+  *lista = evento;
+}
+
+// Coloca o evento no nível em que o vencimento cabe a partir de agora e
+// antecipa o próximo trabalho se for o caso
+static void inserir(LinhaTempo *linha, int32_t evento) {
+  uint64_t vencimento = linha->eventos[evento].vencimento;
+  uint64_t delta = vencimento - linha->agora;
+  uint64_t passo;
+  if (delta >= HORIZONTE) {
+    empilhar(linha, &linha->distantes, evento, LISTA_DISTANTES);
+    passo = passo_dos_distantes(linha->agora);
+  } else {
+    int nivel = 0;
+    while (delta >= unidade(nivel + 1))
+      nivel++;
+    unsigned int posicao = (unsigned int)(vencimento >>
+                                          (LINHA_TEMPO_BITS * nivel)) &
+                           MASCARA_POSICAO;
+    empilhar(linha, &linha->posicoes[nivel][posicao], evento,
+             (uint32_t)(nivel * LINHA_TEMPO_POSICOES + posicao));
+    linha->ocupadas[nivel] |= 1ULL << posicao;
+    passo = passo_da_posicao(linha->agora, nivel, posicao);
+  }
+  if (passo < linha->proximo_trabalho)
+    linha->proximo_trabalho = passo;
+}
+
+void linha_tempo_inicializar(LinhaTempo *linha, uint64_t agora) {
+  linha->agora = agora;
+  linha->proximo_trabalho = UINT64_MAX;
+  linha->ordem = 0;
+  linha->n = 0;
+  linha->usados = 0;
+  linha->livres = SEM_EVENTO;
+  linha->vencidos = SEM_EVENTO;
+  linha->distantes = SEM_EVENTO;
+  for (int nivel = 0; nivel < LINHA_TEMPO_NIVEIS; nivel++) {
+    linha->ocupadas[nivel] = 0;
+    for (int p = 0; p < LINHA_TEMPO_POSICOES; p++)
+      linha->posicoes[nivel][p] = SEM_EVENTO;
+  }
+}
+
+int32_t linha_tempo_programar(LinhaTempo *linha, uint64_t vencimento,
+                              uint32_t tipo, double valor) {
+  int32_t evento;
+  if (linha->livres != SEM_EVENTO) {
+    evento = linha->livres;
+    linha->livres = linha->eventos[evento].proximo;
+  } else if (linha->usados < LINHA_TEMPO_EVENTOS_MAX) {
+    evento = (int32_t)linha->usados++;
+  } else {
+    return SEM_EVENTO;
+  }
+
+  EventoProgramado *e = &linha->eventos[evento];
+  e->vencimento = vencimento < linha->agora ? linha->agora : vencimento;
+  e->ordem = linha->ordem++;
+  e->tipo = tipo;
+  e->valor = valor;
+  inserir(linha, evento);
+  linha->n++;
+  return evento;
+}
+
+static void liberar(LinhaTempo *linha, int32_t evento) {
+  linha->eventos[evento].proximo = linha->livres;
+  linha->livres = evento;
+  linha->n--;
+}
+
+static int32_t *cabeca_da_lista(LinhaTempo *linha, uint32_t onde) {
+  if (onde == LISTA_VENCIDOS)
+    return &linha->vencidos;
+  if (onde == LISTA_DISTANTES)
+    return &linha->distantes;
+  return &linha->posicoes[onde / LINHA_TEMPO_POSICOES]
+                         [onde % LINHA_TEMPO_POSICOES];
+}
+
+// As listas de uma posição são curtas: o evento é procurado a partir da
+// cabeça. Uma posição esvaziada sai do bitmap; o próximo trabalho, se
+// ficar adiantado, só custa um passo sem nada a fazer.
+void linha_tempo_cancelar(LinhaTempo *linha, int32_t evento) {
+  uint32_t onde = linha->eventos[evento].lista;
+  int32_t *elo = cabeca_da_lista(linha, onde);
+  while (*elo != evento)
+    elo = &linha->eventos[*elo].proximo;
+  *elo = linha->eventos[evento].proximo;
+
+  if (onde < LISTA_VENCIDOS &&
+      *cabeca_da_lista(linha, onde) == SEM_EVENTO)
+    linha->ocupadas[onde / LINHA_TEMPO_POSICOES] &=
+        ~(1ULL << (onde % LINHA_TEMPO_POSICOES));
+  liberar(linha, evento);
+}
+
+// Esvazia uma posição e devolve os seus eventos à roda a partir de agora
+static void cascatear(LinhaTempo *linha, int nivel, unsigned int posicao) {
+  int32_t evento = linha->posicoes[nivel][posicao];
+  linha->posicoes[nivel][posicao] = SEM_EVENTO;
+  linha->ocupadas[nivel] &= ~(1ULL << posicao);
+  while (evento != SEM_EVENTO) {
+    int32_t proximo = linha->eventos[evento].proximo;
+    inserir(linha, evento);
+    evento = proximo;
+  }
+}
+
+static void trazer_distantes(LinhaTempo *linha) {
+  int32_t evento = linha->distantes;
+  linha->distantes = SEM_EVENTO;
+  while (evento != SEM_EVENTO) {
+    int32_t proximo = linha->eventos[evento].proximo;
+    inserir(linha, evento); // os que ainda não cabem voltam à lista
+    evento = proximo;
+  }
+}
+
+// Os vencidos de um passo saem na ordem em que foram programados
+static void ordenar_vencidos(LinhaTempo *linha, int32_t evento) {
+  while (evento != SEM_EVENTO) {
+    int32_t proximo = linha->eventos[evento].proximo;
+    uint32_t ordem = linha->eventos[evento].ordem;
+    int32_t *elo = &linha->vencidos;
+    while (*elo != SEM_EVENTO &&
+           (int32_t)(linha->eventos[*elo].ordem - ordem) < 0)
+      elo = &linha->eventos[*elo].proximo;
+    empilhar(linha, elo, evento, LISTA_VENCIDOS);
+    evento = proximo;
+  }
+}
+
+// Processa o próximo passo com trabalho: distantes que entram no
+// horizonte, cascatas das posições que começam nele (do nível mais fino ao
+// mais largo) e os vencimentos do nível 0
+static void processar_passo(LinhaTempo *linha) {
+  uint64_t passo = linha->proximo_trabalho;
+  linha->agora = passo;
+  if (linha->distantes != SEM_EVENTO && passo % UNIDADE_DISTANTES == 0)
+    trazer_distantes(linha);
+  for (int nivel = 1; nivel < LINHA_TEMPO_NIVEIS; nivel++) {
+    if (passo & (unidade(nivel) - 1))
+      break;
+    unsigned int posicao =
+        (unsigned int)(passo >> (LINHA_TEMPO_BITS * nivel)) & MASCARA_POSICAO;
+    if (linha->ocupadas[nivel] & (1ULL << posicao))
+      cascatear(linha, nivel, posicao);
+  }
+
+  unsigned int posicao = (unsigned int)passo & MASCARA_POSICAO;
+  if (linha->ocupadas[0] & (1ULL << posicao)) {
+    int32_t evento = linha->posicoes[0][posicao];
+    linha->posicoes[0][posicao] = SEM_EVENTO;
+    linha->ocupadas[0] &= ~(1ULL << posicao);
+    ordenar_vencidos(linha, evento);
+  }
+
+  linha->agora = passo + 1;
+  linha->proximo_trabalho = calcular_proximo_trabalho(linha);
+}
+
+bool linha_tempo_retirar(LinhaTempo *linha, uint64_t ate,
+                         EventoProgramado *evento) {
+  while (linha->vencidos == SEM_EVENTO) {
+    if (linha->proximo_trabalho > ate)
+      return false;
+    processar_passo(linha);
+  }
+  int32_t retirado = linha->vencidos;
+  *evento = linha->eventos[retirado];
+  linha->vencidos = evento->proximo;
+  liberar(linha, retirado);
+  return true;
+}
+
+static uint64_t menor_vencimento(const LinhaTempo *linha, int32_t evento) {
+  uint64_t menor = UINT64_MAX;
+  for (; evento != SEM_EVENTO; evento = linha->eventos[evento].proximo)
+    if (linha->eventos[evento].vencimento < menor)
+      menor = linha->eventos[evento].vencimento;
+  return menor;
+}
+
+// Em cada nível, a primeira posição a descer guarda os vencimentos mais
+// próximos daquele nível
+uint64_t linha_tempo_proximo_vencimento(const LinhaTempo *linha) {
+  if (linha->vencidos != SEM_EVENTO)
+    return linha->eventos[linha->vencidos].vencimento;
+  uint64_t proximo = menor_vencimento(linha, linha->distantes);
+  for (int nivel = 0; nivel < LINHA_TEMPO_NIVEIS; nivel++) {
+    if (!linha->ocupadas[nivel])
+      continue;
+    uint64_t passo;
+    unsigned int posicao = primeira_posicao(linha, nivel, &passo);
+    uint64_t menor = menor_vencimento(linha, linha->posicoes[nivel][posicao]);
+    if (menor < proximo)
+      proximo = menor;
+  }
+  return proximo;
+}
@@ -1,78 +1,732 @@
+#include "busca_tli.h"
 #include "common.h"
-#include "physics_engine.h"
-#include "systems_control.h"
+#include "efemerides.h"
+#include "estado_compartilhado.h"
+#include "executivo.h"
+#include "fila_telemetria.h"
+#include "gravidade_harmonica.h"
+#include "headless.h"
+#include "instrumentacao.h"
+#include "monte_carlo.h"
+#include "ramos.h"
+#include "replay.h"
+#include "roteiro.h"
+#include "servidor_telemetria.h"
+#include "sintonia_pid.h"
+#include "snapshot_estado.h"
 #include "telemetry_ui.h"
+#include "tempo_real.h"
+#include <errno.h>
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
+// Antes de criar as threads: a nave passa a pertencer ao executivo
 void inicializar_estado() {
-  pthread_mutex_lock(&mutex_estado);
+  inicializar_nave(&estado_nave);
+  publicar_snapshot(&estado_nave, NULL);
+}
 
-  // Posiciona a nave na superfície da Terra (Raio equatorial ~6.378 km)
-  estado_nave.posicao = (Vetor3D){0.0, 6378137.0, 0.0};
-  estado_nave.velocidade = (Vetor3D){0.0, 0.0, 0.0};
-  estado_nave.aceleracao = (Vetor3D){0.0, 0.0, 0.0};
-  estado_nave.orientacao = (Vetor3D){0.0, 1.0, 0.0};
+static void imprimir_prazos(const Executivo *executivo) {
+  const EstatisticasPrazos *prazos = &executivo->prazos;
+  double media = 0.0, desvio = 0.0;
+  if (prazos->ciclos > 0) {
+    double n = (double)prazos->ciclos;
+    media = prazos->jitter_soma / n;
+    double variancia = prazos->jitter_soma_quadrados / n - media * media;
+    desvio = variancia > 0.0 ? sqrt(variancia) : 0.0;
+  }
+  printf("Tempo real estrito: %llu ciclos a %.0f Hz, %llu prazos perdidos, "
+         "%llu ciclos saltados\n",
+         prazos->ciclos, 1.0 / executivo->ctx.dt, prazos->prazos_perdidos,
+         prazos->ciclos_saltados);
+  printf("Jitter de liberacao: medio %.1f us, desvio %.1f us, maximo %.1f us; "
+         "quadro mais longo %.1f us\n",
+         media * 1e6, desvio * 1e6, prazos->jitter_max * 1e6,
+         prazos->execucao_max * 1e6);
+}
 
-  estado_nave.estado_missao = PREPARACAO;
-  estado_nave.tempo_missao = 0.0;
+static void imprimir_uso(const char *programa) {
+  printf("Uso: %s [opcoes]\n"
+         "  --headless          executa sem interface, em passo fixo e tao\n"
+         "                      rapido quanto a CPU permitir\n"
+         "  --dt <s>            quadro simulado do executivo (padrao 0.001)\n"
+         "  --rapido            modo interativo sem sincronia com o relogio\n"
+         "  --tempo-real-estrito\n"
+         "                      um quadro de dt por periodo de dt em prazos "
+         "absolutos\n"
+         "                      (padrao dt = 0.001, 1 kHz), sem aceleracao\n"
+         "  --cpu <n>           prende a thread do executivo ao nucleo n\n"
+         "  --cpu-logger <n>    prende a thread de telemetria ao nucleo n\n"
+         "  --fifo <prio>       executivo em SCHED_FIFO com a prioridade dada "
+         "e\n"
+         "                      memoria travada (mlockall)\n"
+         "  --duracao <s>       limite de tempo simulado (padrao 8 dias)\n"
+         "  --semente <n>       semente dos subsistemas (padrao 1969 no modo\n"
+         "                      headless, aleatoria no interativo)\n"
+         "  --integrador <nome> rk4 (passo fixo, padrao) ou dp54 (adaptativo)\n"
+         "  --tol-abs <v>       tolerancia absoluta do dp54 (padrao 1e-6)\n"
+         "  --tol-rel <v>       tolerancia relativa do dp54 (padrao 1e-12)\n"
+         "  --passo-max <s>     maior passo do dp54 (padrao 600)\n"
+         "  --kepler <limiar>   voo balistico em conicas (Terra ou Lua) "
+         "enquanto a\n"
+         "                      perturbacao for menor que limiar x atracao "
+         "central\n"
+         "                      (ex.: 1e-3; 1 = conicas ligadas na SOI); "
+         "desligado\n"
+         "                      por padrao\n"
+         "  --sequenciador <m>  tempo (um estado a cada 30 s, padrao), "
+         "eventos\n"
+         "                      (fim da queima, entrada na SOI e contatos "
+         "encerram\n"
+         "                      os estados correspondentes) ou roteiro (so "
+         "as\n"
+         "                      acoes avancar do --roteiro)\n"
+         "  --roteiro <arq>     acoes programadas no tempo de missao, ao "
+         "entrar em\n"
+         "                      um estado ou num evento fisico (queimas, "
+         "separacoes,\n"
+         "                      blackouts, falhas); a tecla [T] salta ate a "
+         "proxima\n"
+         "  --veiculos          separa S-IVB, CSM, estagios do LM e SM nas "
+         "transicoes\n"
+         "                      da missao e os propaga junto com a nave "
+         "(tecla [V])\n"
+         "  --monte-carlo <n>   executa n missoes com dispersao em paralelo\n"
+         "  --sintonia-pid <n>  avalia em paralelo n^3 ganhos do PID de "
+         "descida e\n"
+         "                      imprime a fronteira de Pareto\n"
+         "  --busca-tli         busca em paralelo a queima de injecao "
+         "translunar\n"
+         "  --periapside-alvo <km>\n"
+         "                      altitude da periapside lunar buscada (padrao "
+         "110)\n"
+         "  --telemetria <arq>  log binario de telemetria (padrao "
+         ARQUIVO_TELEMETRIA_PADRAO "; no\n"
+         "                      modo headless grava cada passo)\n"
+         "  --telemetria-veiculo <nome>\n"
+         "                      veiculo gravado na telemetria: apollo "
+         "(padrao),\n"
+         "                      s-ivb, csm, lm-descida, lm-subida ou sm\n"
+         "  --servidor-telemetria <end>\n"
+         "                      publica a telemetria ao vivo em "
+         "unix:<caminho> ou\n"
+         "                      tcp:<porta> (127.0.0.1) para clientes "
+         "locais (modo\n"
+         "                      interativo; ex.: "
+         "unix:apollo_telemetria.sock)\n"
+         "  --exportar-estado <nome>\n"
+         "                      publica o estado da nave em memoria "
+         "compartilhada\n"
+         "                      POSIX para outros processos (modo "
+         "interativo;\n"
+         "                      ex.: " NOME_ESTADO_PADRAO ")\n"
+         "  --decimacao <n>     grava a telemetria a cada n passos da fisica "
+         "(padrao 1)\n"
+         "  --salvar-checkpoint <arq>\n"
+         "                      checkpoint ao fim do modo headless (com "
+         "--duracao)\n"
+         "                      e destino da tecla [C] (padrao "
+         ARQUIVO_CHECKPOINT_PADRAO ")\n"
+         "  --restaurar <arq>   continua a missao a partir de um checkpoint, "
+         "com a\n"
+         "                      gravidade e a janela de efemerides gravadas "
+         "nele\n"
+         "  --ramo <cmds>       com --restaurar, executa em paralelo um ramo "
+         "com os\n"
+         "                      comandos dados (ex.: kp=20000,ki=4000 ou "
+         "avancar=1);\n"
+         "                      pode ser repetido\n"
+         "  --replay <arq>      reproduz um log de telemetria gravado nos "
+         "paineis\n"
+         "                      da interface\n"
+         "  --instrumentacao <arq>\n"
+         "                      relatorio dos histogramas de latencia ao sair "
+         "(padrao\n"
+         "                      " ARQUIVO_INSTRUMENTACAO_PADRAO
+         "; requer make INSTRUMENTACAO=1)\n"
+         "  --gravidade <nivel> pontual (padrao), zonal (J2..Jn), harmonica "
+         "(grau e\n"
+         "                      ordem completos) ou auto (pelo estado da "
+         "missao)\n"
+         "  --grau-gravidade <n>\n"
+         "                      grau do campo da Terra, 2 a 6 (padrao 6)\n"
+         "  --ordem-gravidade <m>\n"
+         "                      ordem do campo da Terra, 0 ao grau (padrao "
+         "6)\n"
+         "  --efemerides <arq>  cache das series de Chebyshev da Lua e do Sol\n"
+         "                      (reaproveitado se cobrir --duracao; sem ele "
+         "as\n"
+         "                      series sao ajustadas a cada execucao)\n"
+         "  --threads <n>       trabalhadores do Monte Carlo, dos ramos, da "
+         "sintonia\n"
+         "                      e da busca TLI (padrao: nucleos)\n"
+         "  --ajuda             mostra esta mensagem\n",
+         programa);
+}
 
-  estado_nave.massa_vazia = 100000.0; // aprox 100 toneladas vazio (Sem comb.)
-  estado_nave.combustivel_principal = 1924000.0; // Foguete cheio
-  estado_nave.combustivel_rcs = 500.0;
-  estado_nave.empuxo_principal = 0.0;
-  estado_nave.empuxo_rcs = 0.0;
+int main(int argc, char *argv[]) {
+  bool modo_headless = false;
+  bool modo_monte_carlo = false;
+  bool modo_busca_tli = false;
+  bool modo_sintonia = false;
+  ConfiguracaoHeadless config_headless = {
+      .dt = 0.001, .duracao_max = 8 * 86400.0, .semente = 1969};
+  ConfiguracaoMonteCarlo config_monte_carlo;
+  configuracao_monte_carlo_padrao(&config_monte_carlo);
+  ConfiguracaoBuscaTLI config_busca_tli;
+  configuracao_busca_tli_padrao(&config_busca_tli);
+  ConfiguracaoSintonia config_sintonia;
+  configuracao_sintonia_padrao(&config_sintonia);
+  ConfiguracaoIntegrador config_integrador;
+  configuracao_integrador_padrao(&config_integrador);
+  bool dt_informado = false;
+  bool semente_informada = false;
+  bool modo_rapido = false;
+  bool modo_estrito = false;
+  int cpu_executivo = -1;
+  int cpu_logger = -1;
+  int prioridade_fifo = 0;
+  bool integrador_valido;
+  bool sequenciador_valido;
+  bool veiculo_valido;
+  const char *arquivo_restauracao = NULL;
+  const char *arquivo_replay = NULL;
+  const char *arquivo_instrumentacao = ARQUIVO_INSTRUMENTACAO_PADRAO;
+  const char *arquivo_efemerides = NULL;
+  const char *endereco_servidor = NULL;
+  const char *nome_exportacao = NULL;
+  const char *arquivo_roteiro = NULL;
+  const char *nome_gravidade = "pontual";
+  int grau_gravidade = GRAVIDADE_GRAU_MAX;
+  int ordem_gravidade = GRAVIDADE_GRAU_MAX;
+  bool gravidade_informada = false;
+  ComandosRamo ramos[RAMOS_MAX];
+  size_t n_ramos = 0;
 
-  estado_nave.energia_principal = 10000.0;
-  estado_nave.energia_reserva = 5000.0;
-  estado_nave.consumo_energia = 100.0;
+  static const struct option opcoes[] = {
+      {"headless", no_argument, NULL, 'H'},
+      {"dt", required_argument, NULL, 't'},
+      {"rapido", no_argument, NULL, 'R'},
+      {"tempo-real-estrito", no_argument, NULL, 'E'},
+      {"cpu", required_argument, NULL, 'c'},
+      {"cpu-logger", required_argument, NULL, 'g'},
+      {"fifo", required_argument, NULL, 'F'},
+      {"duracao", required_argument, NULL, 'u'},
+      {"semente", required_argument, NULL, 's'},
+      {"integrador", required_argument, NULL, 'i'},
+      {"tol-abs", required_argument, NULL, 'a'},
+      {"tol-rel", required_argument, NULL, 'r'},
+      {"passo-max", required_argument, NULL, 'x'},
+      {"kepler", required_argument, NULL, 'k'},
+      {"sequenciador", required_argument, NULL, 'q'},
+      {"veiculos", no_argument, NULL, 'v'},
+      {"roteiro", required_argument, NULL, 'Q'},
+      {"monte-carlo", required_argument, NULL, 'M'},
+      {"sintonia-pid", required_argument, NULL, 'K'},
+      {"busca-tli", no_argument, NULL, 'b'},
+      {"periapside-alvo", required_argument, NULL, 'A'},
+      {"threads", required_argument, NULL, 'j'},
+      {"telemetria", required_argument, NULL, 'T'},
+      {"telemetria-veiculo", required_argument, NULL, 'W'},
+      {"servidor-telemetria", required_argument, NULL, 'S'},
+      {"exportar-estado", required_argument, NULL, 'X'},
+      {"decimacao", required_argument, NULL, 'D'},
+      {"salvar-checkpoint", required_argument, NULL, 'C'},
+      {"restaurar", required_argument, NULL, 'L'},
+      {"ramo", required_argument, NULL, 'B'},
+      {"replay", required_argument, NULL, 'P'},
+      {"instrumentacao", required_argument, NULL, 'I'},
+      {"efemerides", required_argument, NULL, 'e'},
+      {"gravidade", required_argument, NULL, 'V'},
+      {"grau-gravidade", required_argument, NULL, 'N'},
+      {"ordem-gravidade", required_argument, NULL, 'O'},
+      {"ajuda", no_argument, NULL, 'h'},
+      {NULL, 0, NULL, 0}};
 
-  estado_nave.temperatura_interna = 22.0;
-  estado_nave.pressao_interna = 101.3;
-  estado_nave.radiacao = 0.1;
+  int opcao;
+  while ((opcao = getopt_long(argc, argv, "h", opcoes, NULL)) != -1) {
+    switch (opcao) {
+    case 'H':
+      modo_headless = true;
+      break;
+    case 't':
+      config_headless.dt = atof(optarg);
+      dt_informado = true;
+      break;
+    case 'u':
+      config_headless.duracao_max = atof(optarg);
+      break;
+    case 's':
+      config_headless.semente = (unsigned int)strtoul(optarg, NULL, 10);
+      semente_informada = true;
+      break;
+    case 'R':
+      modo_rapido = true;
+      break;
+    case 'E':
+      modo_estrito = true;
+      break;
+    case 'c':
+      cpu_executivo = atoi(optarg);
+      break;
+    case 'g':
+      cpu_logger = atoi(optarg);
+      break;
+    case 'F':
+      prioridade_fifo = atoi(optarg);
+      break;
+    case 'i':
+      config_integrador.tipo =
+          obter_tipo_integrador(optarg, &integrador_valido);
+      if (!integrador_valido) {
+        fprintf(stderr, "Integrador desconhecido: %s\n", optarg);
+        return 1;
+      }
+      break;
+    case 'a':
+      config_integrador.tol_abs = atof(optarg);
+      break;
+    case 'r':
+      config_integrador.tol_rel = atof(optarg);
+      break;
+    case 'x':
+      config_integrador.passo_max = atof(optarg);
+      break;
+    case 'k':
+      config_integrador.limiar_kepler = atof(optarg);
+      break;
+    case 'q':
+      config_headless.sequenciador =
+          obter_modo_sequenciador(optarg, &sequenciador_valido);
+      if (!sequenciador_valido) {
+        fprintf(stderr, "Sequenciador desconhecido: %s\n", optarg);
+        return 1;
+      }
+      break;
+    case 'v':
+      config_headless.separacoes = true;
+      break;
+    case 'Q':
+      arquivo_roteiro = optarg;
+      break;
+    case 'M':
+      modo_monte_carlo = true;
+      config_monte_carlo.execucoes = atoi(optarg);
+      break;
+    case 'K':
+      modo_sintonia = true;
+      config_sintonia.pontos_por_eixo = atoi(optarg);
+      break;
+    case 'b':
+      modo_busca_tli = true;
+      break;
+    case 'A':
+      config_busca_tli.periapside_alvo = atof(optarg) * 1000.0;
+      break;
+    case 'j':
+      config_monte_carlo.threads = atoi(optarg);
+      break;
+    case 'T':
+      config_headless.arquivo_telemetria = optarg;
+      break;
+    case 'W':
+      config_headless.veiculo_telemetria =
+          obter_tipo_veiculo(optarg, &veiculo_valido);
+      if (!veiculo_valido) {
+        fprintf(stderr, "Veiculo desconhecido: %s\n", optarg);
+        return 1;
+      }
+      break;
+    case 'S':
+      endereco_servidor = optarg;
+      break;
+    case 'X':
+      nome_exportacao = optarg;
+      break;
+    case 'D':
+      config_headless.decimacao_telemetria =
+          (unsigned int)strtoul(optarg, NULL, 10);
+      break;
+    case 'C':
+      config_headless.arquivo_checkpoint = optarg;
+      break;
+    case 'L':
+      arquivo_restauracao = optarg;
+      break;
+    case 'B':
+      if (n_ramos == RAMOS_MAX) {
+        fprintf(stderr, "No maximo %d ramos\n", RAMOS_MAX);
+        return 1;
+      }
+      if (!interpretar_ramo(optarg, &ramos[n_ramos])) {
+        fprintf(stderr, "Ramo invalido: %s\n", optarg);
+        return 1;
+      }
+      n_ramos++;
+      break;
+    case 'P':
+      arquivo_replay = optarg;
+      break;
+    case 'I':
+      arquivo_instrumentacao = optarg;
+      break;
+    case 'e':
+      arquivo_efemerides = optarg;
+      break;
+    case 'V':
+      nome_gravidade = optarg;
+      gravidade_informada = true;
+      break;
+    case 'N':
+      grau_gravidade = atoi(optarg);
+      gravidade_informada = true;
+      break;
+    case 'O':
+      ordem_gravidade = atoi(optarg);
+      gravidade_informada = true;
+      break;
+    case 'h':
+      imprimir_uso(argv[0]);
+      return 0;
+    default:
+      imprimir_uso(argv[0]);
+      return 1;
+    }
+  }
 
-  estado_nave.comunicacao_ativa = true;
-  estado_nave.forca_sinal = 100.0;
+  // Replay: só lê o log, sem executar a simulação
+  if (arquivo_replay)
+    return executar_replay(arquivo_replay);
 
-  atomic_store(&estado_nave.sistema_ativo, true);
-  estado_nave.emergencia = false;
-  atomic_store(&estado_nave.simulacao_acelerada, 1);
+  if (modo_rapido && modo_estrito) {
+    fprintf(stderr, "--rapido e --tempo-real-estrito sao excludentes\n");
+    return 1;
+  }
 
-  pthread_mutex_unlock(&mutex_estado);
-}
+  // Roteiro: só o executivo (modos headless e interativo) o executa
+  static RoteiroMissao roteiro;
+  if (arquivo_roteiro) {
+    if (modo_monte_carlo || modo_sintonia || modo_busca_tli || n_ramos > 0) {
+      fprintf(stderr, "--roteiro requer o modo headless ou interativo\n");
+      return 1;
+    }
+    char erro[128];
+    if (!roteiro_carregar(&roteiro, arquivo_roteiro, erro, sizeof(erro))) {
+      fprintf(stderr, "Roteiro invalido: %s: %s\n", arquivo_roteiro, erro);
+      return 1;
+    }
+    config_headless.roteiro = &roteiro;
+  } else if (config_headless.sequenciador == SEQUENCIADOR_ROTEIRO) {
+    fprintf(stderr, "--sequenciador roteiro requer --roteiro\n");
+    return 1;
+  }
+
+  // Efemérides da Lua e do Sol ajustadas antes de qualquer thread: depois
+  // disso as séries são apenas lidas. A busca TLI precisa delas até o fim do
+  // maior tempo de voo
+  double janela_efemerides = config_headless.duracao_max;
+  if (modo_busca_tli)
+    janela_efemerides =
+        fmax(janela_efemerides, busca_tli_horizonte(&config_busca_tli));
+  if (!efemerides_inicializar(janela_efemerides, arquivo_efemerides)) {
+    fprintf(stderr, "Falha ao alocar as efemerides\n");
+    return 1;
+  }
+
+  // Campo da Terra: nível único ou, com "auto", escolhido pelo estado da
+  // missão
+  if (!gravidade_configurar(grau_gravidade, ordem_gravidade)) {
+    fprintf(stderr, "Grau/ordem de gravidade invalidos (grau 2..%d, ordem "
+                    "0..grau)\n",
+            GRAVIDADE_GRAU_MAX);
+    return 1;
+  }
+  if (strcmp(nome_gravidade, "auto") == 0) {
+    gravidade_niveis_por_estado();
+  } else {
+    bool nivel_valido;
+    NivelGravidade nivel = obter_nivel_gravidade(nome_gravidade, &nivel_valido);
+    if (!nivel_valido) {
+      fprintf(stderr, "Nivel de gravidade desconhecido: %s\n", nome_gravidade);
+      return 1;
+    }
+    gravidade_nivel_unico(nivel);
+  }
+
+  config_headless.integrador = config_integrador;
+  config_monte_carlo.integrador = config_integrador;
+
+  // Monte Carlo: cada execução possui seu próprio contexto, sem estado global
+  if (modo_monte_carlo) {
+    if (dt_informado)
+      config_monte_carlo.dt = config_headless.dt;
+    config_monte_carlo.duracao_max = config_headless.duracao_max;
+    config_monte_carlo.semente = config_headless.semente;
+    return executar_monte_carlo(&config_monte_carlo);
+  }
+
+  // Sintonia do PID: descidas isoladas no pool, sem estado global
+  if (modo_sintonia) {
+    config_sintonia.threads = config_monte_carlo.threads;
+    return executar_sintonia_pid(&config_sintonia);
+  }
 
-int main() {
-  // Inicialização da seed pseudoaleatória principal
-  srand(time(NULL));
+  // Busca TLI: propagações independentes no pool, sem estado global
+  if (modo_busca_tli) {
+    config_busca_tli.threads = config_monte_carlo.threads;
+    return executar_busca_tli(&config_busca_tli);
+  }
+
+  // Checkpoint de partida: substitui o estado inicial, inclusive dt,
+  // integrador e sementes
+  static Checkpoint checkpoint_inicial;
+  if (arquivo_restauracao) {
+    if (!checkpoint_carregar(&checkpoint_inicial, arquivo_restauracao)) {
+      fprintf(stderr, "Checkpoint invalido ou incompativel: %s\n",
+              arquivo_restauracao);
+      return 1;
+    }
+    // A física global volta à da execução que gravou o checkpoint; flags de
+    // gravidade explícitas e diferentes não são ignoradas em silêncio
+    ConfiguracaoFisica fisica_atual;
+    configuracao_fisica_capturar(&fisica_atual);
+    if (gravidade_informada &&
+        !configuracao_gravidade_igual(&fisica_atual,
+                                      &checkpoint_inicial.fisica)) {
+      fprintf(stderr, "A gravidade pedida difere da do checkpoint %s (grau "
+                      "%d, ordem %d)\n",
+              arquivo_restauracao, checkpoint_inicial.fisica.grau_gravidade,
+              checkpoint_inicial.fisica.ordem_gravidade);
+      return 1;
+    }
+    if (!configuracao_fisica_aplicar(&checkpoint_inicial.fisica,
+                                     arquivo_efemerides)) {
+      fprintf(stderr, "Configuracao fisica invalida no checkpoint: %s\n",
+              arquivo_restauracao);
+      return 1;
+    }
+    config_headless.checkpoint_inicial = &checkpoint_inicial;
+  }
+
+  // Ramos: cada um restaura sua própria cópia do checkpoint
+  if (n_ramos > 0) {
+    if (!arquivo_restauracao) {
+      fprintf(stderr, "--ramo requer --restaurar\n");
+      return 1;
+    }
+    return executar_ramos(&checkpoint_inicial, ramos, n_ramos,
+                          config_monte_carlo.threads,
+                          config_headless.duracao_max);
+  }
+
+  // No modo interativo a semente é sorteada, mas impressa ao final para que
+  // a execução possa ser repetida com --semente
+  if (!modo_headless && !semente_informada)
+    config_headless.semente = (unsigned int)time(NULL);
 
   // Configurando estado inicial antes de disparar threads
   inicializar_estado();
 
+  // Modo headless: sem threads nem ncurses, reprodutível bit a bit
+  if (modo_headless) {
+    if (endereco_servidor) {
+      fprintf(stderr, "--servidor-telemetria requer o modo interativo\n");
+      return 1;
+    }
+    if (nome_exportacao) {
+      fprintf(stderr, "--exportar-estado requer o modo interativo\n");
+      return 1;
+    }
+    int codigo = executar_headless(&config_headless);
+    if (!INSTR_DESPEJAR(arquivo_instrumentacao))
+      perror(arquivo_instrumentacao);
+    return codigo;
+  }
+
+  // Fila SPSC entre a física (produtora) e o logger (consumidor)
+  FilaTelemetria fila_telemetria;
+  if (!fila_criar(&fila_telemetria, CAPACIDADE_FILA_TELEMETRIA)) {
+    fprintf(stderr, "Falha ao alocar a fila de telemetria\n");
+    return 1;
+  }
+  // Servidor de telemetria ao vivo: fila própria, para que clientes lentos
+  // não atrasem a gravação em disco
+  static ServidorTelemetria servidor;
+  FilaTelemetria fila_servidor;
+  if (endereco_servidor) {
+    if (!fila_criar(&fila_servidor, CAPACIDADE_FILA_TELEMETRIA)) {
+      fprintf(stderr, "Falha ao alocar a fila do servidor\n");
+      return 1;
+    }
+    if (!servidor_abrir(&servidor, endereco_servidor, &fila_servidor)) {
+      perror(endereco_servidor);
+      return 1;
+    }
+  }
+  ExportacaoEstado exportacao;
+  if (nome_exportacao && !exportacao_abrir(&exportacao, nome_exportacao)) {
+    if (errno == EEXIST)
+      fprintf(stderr, "%s: em uso por outro simulador em execucao\n",
+              nome_exportacao);
+    else
+      perror(nome_exportacao);
+    return 1;
+  }
+  // Log aberto antes das threads: um caminho inválido encerra aqui, como
+  // no modo headless, e não em uma missão inteira sem gravação
+  static EscritorTelemetria escritor_telemetria;
+  const char *arquivo_telemetria = config_headless.arquivo_telemetria
+                                       ? config_headless.arquivo_telemetria
+                                       : ARQUIVO_TELEMETRIA_PADRAO;
+  if (!telemetria_abrir_escrita(&escritor_telemetria, arquivo_telemetria)) {
+    perror(arquivo_telemetria);
+    if (nome_exportacao)
+      exportacao_fechar(&exportacao);
+    if (endereco_servidor)
+      servidor_fechar(&servidor);
+    return 1;
+  }
+  ConfiguracaoLogger config_logger = {
+      .escritor = &escritor_telemetria,
+      .fila = &fila_telemetria,
+      .fixar_cpu = cpu_logger >= 0,
+      .cpu = cpu_logger};
+
+  // Quadro interativo de 1 ms, o do laço original: no tempo real estrito,
+  // 1 kHz
+  ModoExecutivo modo = EXECUTIVO_TEMPO_REAL;
+  if (modo_rapido)
+    modo = EXECUTIVO_MAXIMA_VELOCIDADE;
+  else if (modo_estrito)
+    modo = EXECUTIVO_TEMPO_REAL_ESTRITO;
+
+  // Páginas travadas antes de criar as threads, para que nem as pilhas
+  // sofram falhas de página no laço de tempo real
+  bool memoria_travada = prioridade_fifo > 0 && travar_memoria();
+
+  // Física, propulsão, energia e sequenciador rodam no executivo, em ordem
+  // fixa de tempo simulado
+  ConfiguracaoExecutivo config_executivo = {
+      .modo = modo,
+      .dt = config_headless.dt,
+      .duracao_max = config_headless.duracao_max,
+      .semente = config_headless.semente,
+      .integrador = config_integrador,
+      .sequenciador = config_headless.sequenciador,
+      .separacoes = config_headless.separacoes,
+      .continuar_em_emergencia = true,
+      .fila = &fila_telemetria,
+      .decimacao = config_headless.decimacao_telemetria,
+      .fila_servidor = endereco_servidor ? &fila_servidor : NULL,
+      .veiculo_telemetria = config_headless.veiculo_telemetria,
+      .exportacao = nome_exportacao ? &exportacao : NULL,
+      .roteiro = config_headless.roteiro,
+      .fixar_cpu = cpu_executivo >= 0,
+      .cpu = cpu_executivo,
+      .prioridade_fifo = prioridade_fifo};
+  Executivo executivo;
+  // Com checkpoint, o roteiro é recarregado sobre a linha do tempo
+  // restaurada, e só essa carga decide se ele cabe
+  bool roteiro_cabe =
+      executivo_inicializar(&executivo, &estado_nave, &config_executivo);
+  if (arquivo_restauracao)
+    roteiro_cabe = executivo_restaurar(&executivo, &checkpoint_inicial);
+  if (!roteiro_cabe) {
+    fprintf(stderr, "O roteiro nao cabe na linha do tempo%s\n",
+            arquivo_restauracao ? " do checkpoint" : "");
+    telemetria_fechar_escrita(&escritor_telemetria);
+    if (nome_exportacao)
+      exportacao_fechar(&exportacao);
+    if (endereco_servidor)
+      servidor_fechar(&servidor);
+    return 1;
+  }
+  if (arquivo_restauracao)
+    publicar_snapshot(&estado_nave, NULL);
+  ConfiguracaoInterface config_interface = {
+      .executivo = &executivo,
+      .arquivo_checkpoint = config_headless.arquivo_checkpoint
+                                ? config_headless.arquivo_checkpoint
+                                : ARQUIVO_CHECKPOINT_PADRAO};
+
   // Arrays de threads
-  pthread_t thread_voo, thread_propulsao, thread_energia, thread_interface,
-      thread_logger;
+  pthread_t thread_executivo, thread_interface, thread_logger,
+      thread_servidor;
 
   // Criando theads funcionais (Pthreads)
-  pthread_create(&thread_voo, NULL, controle_voo, NULL);
-  pthread_create(&thread_propulsao, NULL, controle_propulsao, NULL);
-  pthread_create(&thread_energia, NULL, controle_energia, NULL);
-  pthread_create(&thread_logger, NULL, telemetry_logger, NULL);
+  pthread_create(&thread_executivo, NULL, executivo_missao, &executivo);
+  pthread_create(&thread_logger, NULL, telemetry_logger, &config_logger);
+  if (endereco_servidor)
+    pthread_create(&thread_servidor, NULL, servidor_telemetria, &servidor);
 
   // Interface (roda na thread principal ou em uma separada que gerencia o main
   // block)
-  pthread_create(&thread_interface, NULL, interface_usuario, NULL);
+  pthread_create(&thread_interface, NULL, interface_usuario,
+                 &config_interface);
 
   // O programa principal esperará a UI finalizar (Usuário apertou Q ou S)
   pthread_join(thread_interface, NULL);
 
   // As outras threads finalizarão automaticamente em seu próximo laço de poll
-  // porque a variável atomic atomic_load(&estado_nave.sistema_ativo) se tornou
-  // 'false' no "Sair" da UI
-  pthread_join(thread_voo, NULL);
-  pthread_join(thread_propulsao, NULL);
-  pthread_join(thread_energia, NULL);
+  // porque o sistema_ativo do canal do executivo se tornou 'false' no "Sair"
+  // da UI
+  pthread_join(thread_executivo, NULL);
   pthread_join(thread_logger, NULL);
+  if (endereco_servidor)
+    pthread_join(thread_servidor, NULL);
+
+  if (arquivo_restauracao)
+    printf("Restaurado de %s (dt = %g s)\n", arquivo_restauracao,
+           executivo.ctx.dt);
+  else
+    printf("Semente: %u (dt = %g s)\n", config_executivo.semente,
+           executivo.ctx.dt);
+  printf("Executivo: %llu quadros em %llu ciclos, %llu em sobrecarga\n",
+         executivo.ctx.passos, executivo.ciclos, executivo.ciclos_sobrecarga);
+  if (executivo.comandos > 0)
+    printf("Comandos: %llu atendidos, espera maxima %.1f us\n",
+           executivo.comandos, executivo.espera_max_comando * 1e6);
+  if (arquivo_roteiro)
+    printf("Roteiro: %llu acoes executadas\n", executivo.ctx.acoes_roteiro);
+  if (modo == EXECUTIVO_TEMPO_REAL_ESTRITO)
+    imprimir_prazos(&executivo);
+  if (cpu_executivo >= 0 && !executivo.cpu_fixada)
+    fprintf(stderr, "Aviso: executivo nao foi preso ao nucleo %d\n",
+            cpu_executivo);
+  if (cpu_logger >= 0 && !config_logger.fixar_cpu)
+    fprintf(stderr, "Aviso: logger nao foi preso ao nucleo %d\n", cpu_logger);
+  if (prioridade_fifo > 0 && !executivo.sched_fifo)
+    fprintf(stderr, "Aviso: SCHED_FIFO negado (requer CAP_SYS_NICE)\n");
+  if (prioridade_fifo > 0 && !memoria_travada)
+    fprintf(stderr, "Aviso: mlockall falhou; memoria nao travada\n");
+  printf("Telemetria: %llu amostras gravadas, %llu descartadas, ocupacao "
+         "maxima da fila %zu/%zu\n",
+         config_logger.gravadas,
+         (unsigned long long)atomic_load(&fila_telemetria.descartadas),
+         fila_telemetria.ocupacao_max, fila_capacidade(&fila_telemetria));
+  if (config_logger.erro)
+    fprintf(stderr, "%s: %s (gravacao interrompida)\n", arquivo_telemetria,
+            strerror(config_logger.erro));
+  fila_destruir(&fila_telemetria);
+  if (endereco_servidor) {
+    printf("Servidor: %llu clientes (%llu recusados), %llu quadros enviados, "
+           "%llu descartados por clientes lentos, %llu amostras perdidas na "
+           "fila\n",
+           servidor.conexoes, servidor.recusadas, servidor.enviados,
+           servidor.descartados,
+           (unsigned long long)atomic_load(&fila_servidor.descartadas));
+    servidor_fechar(&servidor);
+    fila_destruir(&fila_servidor);
+  }
+  if (nome_exportacao)
+    exportacao_fechar(&exportacao);
 
+  if (!INSTR_DESPEJAR(arquivo_instrumentacao))
+    perror(arquivo_instrumentacao);
   return 0;
 }
@@ -0,0 +1,213 @@
+#include "monte_carlo.h"
+#include "pool_threads.h"
+#include "simulacao.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Resultado de uma execução individual
+typedef struct {
+  double velocidade_pouso;   // m/s no toque da descida, em módulo
+  double margem_combustivel; // fração do combustível principal restante
+  double altitude_maxima;    // em km acima do raio terrestre
+  bool pousou;
+  bool emergencia;
+} ResultadoExecucao;
+
+typedef struct {
+  const ConfiguracaoMonteCarlo *config;
+  ResultadoExecucao *resultados;
+} LoteMonteCarlo;
+
+// Gerador SplitMix64: barato, sem estado global e com fluxos independentes
+// por execução, o que mantém os resultados iguais para qualquer número de
+// threads
+static uint64_t proximo_aleatorio(uint64_t *estado) {
+  uint64_t z = (*estado += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return z ^ (z >> 31);
+}
+
+static double aleatorio_uniforme(uint64_t *estado) {
+  return (proximo_aleatorio(estado) >> 11) * 0x1.0p-53;
+}
+
+// Amostra normal padrão pelo método de Box-Muller
+static double aleatorio_normal(uint64_t *estado) {
+  double u1 = aleatorio_uniforme(estado);
+  double u2 = aleatorio_uniforme(estado);
+  if (u1 < 1e-300)
+    u1 = 1e-300;
+  return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static double perturbar(double nominal, double sigma, uint64_t *estado) {
+  return nominal * (1.0 + sigma * aleatorio_normal(estado));
+}
+
+static void executar_missao(size_t indice, void *arg) {
+  LoteMonteCarlo *lote = arg;
+  const ConfiguracaoMonteCarlo *config = lote->config;
+  ResultadoExecucao *resultado = &lote->resultados[indice];
+
+  uint64_t rng = ((uint64_t)config->semente << 32) ^ (uint64_t)indice;
+  proximo_aleatorio(&rng);
+
+  // Os fatores de massa e combustível valem para a missão e para a descida
+  double fator_massa = perturbar(1.0, config->sigma_massa, &rng);
+  double fator_combustivel = perturbar(1.0, config->sigma_combustivel, &rng);
+  EstadoNave nave;
+  inicializar_nave(&nave);
+  nave.massa_vazia *= fator_massa;
+  nave.combustivel_principal *= fator_combustivel;
+  nave.combustivel_rcs =
+      perturbar(nave.combustivel_rcs, config->sigma_combustivel, &rng);
+  double combustivel_inicial = nave.combustivel_principal;
+
+  ContextoSimulacao ctx;
+  inicializar_contexto(&ctx, &nave, config->dt,
+                       (unsigned int)proximo_aleatorio(&rng),
+                       &config->integrador);
+
+  ControlePropulsao *propulsao = &ctx.propulsao;
+  // A descida usa o motor nominal: a dispersão de empuxo é a do lançamento
+  ControlePropulsao descida = *propulsao;
+  propulsao->empuxo_lancamento =
+      perturbar(propulsao->empuxo_lancamento, config->sigma_empuxo, &rng);
+  propulsao->pid_descida.kp =
+      perturbar(propulsao->pid_descida.kp, config->sigma_ganhos, &rng);
+  propulsao->pid_descida.ki =
+      perturbar(propulsao->pid_descida.ki, config->sigma_ganhos, &rng);
+  propulsao->pid_descida.kd =
+      perturbar(propulsao->pid_descida.kd, config->sigma_ganhos, &rng);
+  descida.pid_descida = propulsao->pid_descida;
+
+  // Pouso: só um toque de fato, na descida controlada com o estado disperso
+  CenarioDescida cenario = config->descida;
+  cenario.massa_seca *= fator_massa;
+  cenario.combustivel *= fator_combustivel;
+  ResultadoDescida toque;
+  simular_descida(&descida, &cenario, &toque);
+  resultado->pousou = toque.pousou;
+  resultado->velocidade_pouso = toque.velocidade_toque;
+
+  double raio_maximo = 0.0;
+  while (!contexto_encerrado(&ctx, config->duracao_max)) {
+    passo_contexto(&ctx);
+
+    double raio = sqrt(nave.posicao.x * nave.posicao.x +
+                       nave.posicao.y * nave.posicao.y +
+                       nave.posicao.z * nave.posicao.z);
+    if (raio > raio_maximo)
+      raio_maximo = raio;
+  }
+  finalizar_contexto(&ctx);
+
+  resultado->margem_combustivel =
+      combustivel_inicial > 0 ? nave.combustivel_principal / combustivel_inicial
+                              : 0.0;
+  resultado->altitude_maxima = (raio_maximo - 6378137.0) / 1000.0;
+  resultado->emergencia = nave.estado_missao == EMERGENCIA;
+}
+
+static int comparar_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+// Imprime média, desvio, extremos e percentis de uma métrica
+static void imprimir_estatistica(const char *nome, const char *unidade,
+                                 double *valores, size_t n) {
+  if (n == 0) {
+    printf("  %-22s sem amostras\n", nome);
+    return;
+  }
+
+  double soma = 0.0, soma_quadrados = 0.0;
+  for (size_t i = 0; i < n; i++) {
+    soma += valores[i];
+    soma_quadrados += valores[i] * valores[i];
+  }
+  double media = soma / n;
+  double variancia = soma_quadrados / n - media * media;
+  double desvio = variancia > 0 ? sqrt(variancia) : 0.0;
+
+  qsort(valores, n, sizeof(double), comparar_double);
+  printf("  %-22s media=%12.4f  desvio=%10.4f  min=%12.4f  p50=%12.4f  "
+         "p95=%12.4f  max=%12.4f %s\n",
+         nome, media, desvio, valores[0], valores[n / 2],
+         valores[(size_t)(0.95 * (n - 1))], valores[n - 1], unidade);
+}
+
+void configuracao_monte_carlo_padrao(ConfiguracaoMonteCarlo *config) {
+  config->execucoes = 1000;
+  config->threads = 0;
+  config->dt = 0.01;
+  config->duracao_max = 8 * 86400.0;
+  config->semente = 1969;
+  configuracao_integrador_padrao(&config->integrador);
+  ConfiguracaoSintonia sintonia;
+  configuracao_sintonia_padrao(&sintonia);
+  config->descida = sintonia.cenario;
+  config->sigma_massa = 0.02;
+  config->sigma_combustivel = 0.01;
+  config->sigma_empuxo = 0.01;
+  config->sigma_ganhos = 0.10;
+}
+
+int executar_monte_carlo(const ConfiguracaoMonteCarlo *config) {
+  if (config->execucoes <= 0 || config->dt <= 0.0) {
+    fprintf(stderr, "monte-carlo: configuracao invalida\n");
+    return 1;
+  }
+
+  size_t n = (size_t)config->execucoes;
+  int threads = config->threads > 0 ? config->threads : obter_numero_nucleos();
+
+  ResultadoExecucao *resultados = calloc(n, sizeof(ResultadoExecucao));
+  double *valores = malloc(n * sizeof(double));
+  if (!resultados || !valores) {
+    fprintf(stderr, "monte-carlo: memoria insuficiente\n");
+    free(resultados);
+    free(valores);
+    return 1;
+  }
+
+  LoteMonteCarlo lote = {.config = config, .resultados = resultados};
+
+  struct timespec inicio, fim;
+  clock_gettime(CLOCK_MONOTONIC, &inicio);
+  executar_em_paralelo(n, threads, executar_missao, &lote);
+  clock_gettime(CLOCK_MONOTONIC, &fim);
+  double tempo_real =
+      (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+
+  printf("Monte Carlo: %zu execucoes, %d threads, %.3f s (%.1f execucoes/s)\n",
+         n, threads, tempo_real, tempo_real > 0 ? n / tempo_real : 0.0);
+
+  size_t emergencias = 0, pousos = 0;
+  for (size_t i = 0; i < n; i++) {
+    emergencias += resultados[i].emergencia;
+    if (resultados[i].pousou)
+      valores[pousos++] = resultados[i].velocidade_pouso;
+  }
+  imprimir_estatistica("Velocidade de pouso", "m/s", valores, pousos);
+
+  for (size_t i = 0; i < n; i++)
+    valores[i] = resultados[i].margem_combustivel * 100.0;
+  imprimir_estatistica("Margem de combustivel", "%", valores, n);
+
+  for (size_t i = 0; i < n; i++)
+    valores[i] = resultados[i].altitude_maxima;
+  imprimir_estatistica("Altitude maxima", "km", valores, n);
+
+  printf("  Pousos: %zu/%zu  Taxa de emergencia: %.2f%%\n", pousos, n,
+         100.0 * emergencias / n);
+
+  free(resultados);
+  free(valores);
+  return 0;
+}
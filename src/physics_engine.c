@@ -2,16 +2,6 @@
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
-#include <unistd.h>
-
-// Constantes Físicas
-#define G 6.67430e-11         // Constante gravitacional em m³/(kg·s²)
-#define M_TERRA 5.972e24      // Massa da Terra em kg
-#define M_LUA 7.342e22        // Massa da Lua em kg
-#define POS_LUA_X 384400000.0 // Distância Terra-Lua ~ 384,400 km
-#define POS_LUA_Y 0.0
-#define POS_LUA_Z 0.0
 
 // Estrutura auxiliar para o RK4 representativa da derivada (d(Pos)/dt e
 // d(Vel)/dt)
@@ -20,16 +10,27 @@ typedef struct {
   Vetor3D acel; // Derivada da velocidade (aceleração)
 } Derivada;
 
-// Calcula o vetor de aceleração gravitacional devido à Terra e à Lua
-static Vetor3D calcular_aceleracao_gravitacional(Vetor3D pos) {
-  Vetor3D acel_total = {0.0, 0.0, 0.0};
+void preparar_ambiente_gravitacional(double tempo, NivelGravidade nivel,
+                                     AmbienteGravitacional *ambiente) {
+  efemerides_corpos(tempo, &ambiente->corpos);
+  ambiente->nivel = nivel;
+  if (nivel != GRAVIDADE_PONTUAL)
+    gravidade_orientacao(tempo, nivel, &ambiente->terra);
+}
+
+// Calcula o vetor de aceleração gravitacional devido à Terra, à Lua e ao Sol
+Vetor3D calcular_aceleracao_gravitacional_ambiente(
+    Vetor3D pos, const AmbienteGravitacional *ambiente) {
+  const CorposPerturbadores *corpos = &ambiente->corpos;
+  Vetor3D acel_total = corpos->indireta;
 
   // --- Influência da Terra ---
   double dist_terra = sqrt(pos.x * pos.x + pos.y * pos.y + pos.z * pos.z);
   // Salvaguarda: Se estiver abaixo da superfície, usamos o raio da Terra para o
   // cálculo de gravidade para evitar força infinita, mas a lógica de colisão
   // cuidará do movimento.
-  double r_calc_terra = (dist_terra < 6371000.0) ? 6371000.0 : dist_terra;
+  double r_calc_terra =
+      (dist_terra < RAIO_MIN_TERRA) ? RAIO_MIN_TERRA : dist_terra;
 
   double mag_terra =
       -(G * M_TERRA) / (r_calc_terra * r_calc_terra * r_calc_terra);
@@ -38,27 +39,56 @@ static Vetor3D calcular_aceleracao_gravitacional(Vetor3D pos) {
   acel_total.z += mag_terra * pos.z;
 
   // --- Influência da Lua ---
-  double r_lua_x = pos.x - POS_LUA_X;
-  double r_lua_y = pos.y - POS_LUA_Y;
-  double r_lua_z = pos.z - POS_LUA_Z;
+  double r_lua_x = pos.x - corpos->lua.x;
+  double r_lua_y = pos.y - corpos->lua.y;
+  double r_lua_z = pos.z - corpos->lua.z;
   double dist_lua =
       sqrt(r_lua_x * r_lua_x + r_lua_y * r_lua_y + r_lua_z * r_lua_z);
 
   // Salvaguarda Lua: Raio da Lua ~1.737 km
-  double r_calc_lua = (dist_lua < 1737000.0) ? 1737000.0 : dist_lua;
+  double r_calc_lua = (dist_lua < RAIO_MIN_LUA) ? RAIO_MIN_LUA : dist_lua;
 
   double mag_lua = -(G * M_LUA) / (r_calc_lua * r_calc_lua * r_calc_lua);
   acel_total.x += mag_lua * r_lua_x;
   acel_total.y += mag_lua * r_lua_y;
   acel_total.z += mag_lua * r_lua_z;
 
+  // --- Influência do Sol (maré: o termo indireto cancela quase tudo) ---
+  double r_sol_x = pos.x - corpos->sol.x;
+  double r_sol_y = pos.y - corpos->sol.y;
+  double r_sol_z = pos.z - corpos->sol.z;
+  double dist_sol =
+      sqrt(r_sol_x * r_sol_x + r_sol_y * r_sol_y + r_sol_z * r_sol_z);
+
+  double mag_sol = -(G * M_SOL) / (dist_sol * dist_sol * dist_sol);
+  acel_total.x += mag_sol * r_sol_x;
+  acel_total.y += mag_sol * r_sol_y;
+  acel_total.z += mag_sol * r_sol_z;
+
+  // --- Achatamento e irregularidades da Terra, conforme o nível ---
+  if (ambiente->nivel != GRAVIDADE_PONTUAL) {
+    Vetor3D harmonica =
+        gravidade_harmonica(pos, &ambiente->terra, ambiente->nivel);
+    acel_total.x += harmonica.x;
+    acel_total.y += harmonica.y;
+    acel_total.z += harmonica.z;
+  }
+
   return acel_total;
 }
 
+Vetor3D calcular_aceleracao_gravitacional(Vetor3D pos, double tempo,
+                                          NivelGravidade nivel) {
+  AmbienteGravitacional ambiente;
+  preparar_ambiente_gravitacional(tempo, nivel, &ambiente);
+  return calcular_aceleracao_gravitacional_ambiente(pos, &ambiente);
+}
+
 // Avalia a derivada para o RK4 em um instante dt
 static Derivada avaliar(Vetor3D pos_inicial, Vetor3D vel_inicial,
-                        double temporal_dt, Derivada d, double empuxo_principal,
-                        double massa_total, Vetor3D dir_empuxo) {
+                        double temporal_dt, Derivada d,
+                        const AmbienteGravitacional *ambiente,
+                        Vetor3D acel_empuxo) {
 
   // Nova posição extrapolada
   Vetor3D pos;
@@ -76,49 +106,76 @@ static Derivada avaliar(Vetor3D pos_inicial, Vetor3D vel_inicial,
   saida.vel = vel; // A derivada da posição é a nova velocidade
 
   // Calcula as forças gravitacionais na posição provisória
-  Vetor3D gravidade = calcular_aceleracao_gravitacional(pos);
+  Vetor3D gravidade = calcular_aceleracao_gravitacional_ambiente(pos, ambiente);
 
-  // Aceleração causada pelo empuxo dos motores (a = F / m)
-  double acel_empuxo =
-      (massa_total > 0) ? (empuxo_principal / massa_total) : 0.0;
-
-  saida.acel.x = gravidade.x + dir_empuxo.x * acel_empuxo;
-  saida.acel.y = gravidade.y + dir_empuxo.y * acel_empuxo;
-  saida.acel.z = gravidade.z + dir_empuxo.z * acel_empuxo;
+  saida.acel.x = gravidade.x + acel_empuxo.x;
+  saida.acel.y = gravidade.y + acel_empuxo.y;
+  saida.acel.z = gravidade.z + acel_empuxo.z;
 
   return saida;
 }
 
-// Realiza um passo de integração RK4
-static void atualizar_fisica_rk4(double dt) {
-  pthread_mutex_lock(&mutex_estado);
+// Aceleração dos motores (a = F / m) ao longo da direção de empuxo
+Vetor3D calcular_aceleracao_empuxo(const EstadoNave *nave) {
+  double massa_total =
+      nave->massa_vazia + nave->combustivel_principal + nave->combustivel_rcs;
+  double acel_empuxo =
+      (massa_total > 0) ? (nave->empuxo_principal / massa_total) : 0.0;
 
-  // Massa total variável (Dinâmica de Massa)
-  double massa_total = estado_nave.massa_vazia +
-                       estado_nave.combustivel_principal +
-                       estado_nave.combustivel_rcs;
+  // Mesma simplificação de atualizar_fisica_rk4: empuxo ao longo do eixo Y
+  return (Vetor3D){0.0, acel_empuxo, 0.0};
+}
+
+// Lógica de Colisão com a Terra (Solo)
+void aplicar_colisao_terra(EstadoNave *nave) {
+  double dist_centro = sqrt(nave->posicao.x * nave->posicao.x +
+                            nave->posicao.y * nave->posicao.y +
+                            nave->posicao.z * nave->posicao.z);
 
-  // Simplificação da direção do empuxo (em um sistema completo viria da
-  // orientação da nave) Usando eixo Y para subida vertical / alunissagem
-  Vetor3D dir_empuxo = {0.0, 1.0, 0.0};
+  if (dist_centro < RAIO_TERRA) {
+    // Reposiciona na superfície
+    double fator = RAIO_TERRA / dist_centro;
+    nave->posicao.x *= fator;
+    nave->posicao.y *= fator;
+    nave->posicao.z *= fator;
+
+    // Se estiver caindo, anula a velocidade vertical (impacto)
+    // Simplificação: se o produto escalar Pos . Vel < 0, está indo para o
+    // centro
+    double dot = nave->posicao.x * nave->velocidade.x +
+                 nave->posicao.y * nave->velocidade.y +
+                 nave->posicao.z * nave->velocidade.z;
+
+    if (dot < 0) {
+      nave->velocidade.x = 0;
+      nave->velocidade.y = 0;
+      nave->velocidade.z = 0;
+    }
+  }
+}
 
+Vetor3D passo_rk4(Vetor3D *posicao, Vetor3D *velocidade, double tempo,
+                  double dt, Vetor3D acel_empuxo, NivelGravidade nivel) {
   Derivada inicial = {{0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}};
 
+  // Lua, Sol e orientação da Terra nos três instantes distintos do passo (K2
+  // e K3 compartilham o ponto médio)
+  AmbienteGravitacional inicio, meio, fim;
+  preparar_ambiente_gravitacional(tempo, nivel, &inicio);
+  preparar_ambiente_gravitacional(tempo + dt * 0.5, nivel, &meio);
+  preparar_ambiente_gravitacional(tempo + dt, nivel, &fim);
+
   // K1
   Derivada d1 =
-      avaliar(estado_nave.posicao, estado_nave.velocidade, 0.0, inicial,
-              estado_nave.empuxo_principal, massa_total, dir_empuxo);
+      avaliar(*posicao, *velocidade, 0.0, inicial, &inicio, acel_empuxo);
   // K2
   Derivada d2 =
-      avaliar(estado_nave.posicao, estado_nave.velocidade, dt * 0.5, d1,
-              estado_nave.empuxo_principal, massa_total, dir_empuxo);
+      avaliar(*posicao, *velocidade, dt * 0.5, d1, &meio, acel_empuxo);
   // K3
   Derivada d3 =
-      avaliar(estado_nave.posicao, estado_nave.velocidade, dt * 0.5, d2,
-              estado_nave.empuxo_principal, massa_total, dir_empuxo);
+      avaliar(*posicao, *velocidade, dt * 0.5, d2, &meio, acel_empuxo);
   // K4
-  Derivada d4 = avaliar(estado_nave.posicao, estado_nave.velocidade, dt, d3,
-                        estado_nave.empuxo_principal, massa_total, dir_empuxo);
+  Derivada d4 = avaliar(*posicao, *velocidade, dt, d3, &fim, acel_empuxo);
 
   // Combinação dos K's para a velocidade e posição ( RK4 )
   double dx_dt =
@@ -135,96 +192,59 @@ static void atualizar_fisica_rk4(double dt) {
   double dvz_dt =
       1.0 / 6.0 * (d1.acel.z + 2.0 * (d2.acel.z + d3.acel.z) + d4.acel.z);
 
-  // Atualiza estado global
-  estado_nave.posicao.x += dx_dt * dt;
-  estado_nave.posicao.y += dy_dt * dt;
-  estado_nave.posicao.z += dz_dt * dt;
-
-  estado_nave.velocidade.x += dvx_dt * dt;
-  estado_nave.velocidade.y += dvy_dt * dt;
-  estado_nave.velocidade.z += dvz_dt * dt;
+  posicao->x += dx_dt * dt;
+  posicao->y += dy_dt * dt;
+  posicao->z += dz_dt * dt;
 
-  // --- Lógica de Colisão com a Terra (Solo) ---
-  double dist_centro = sqrt(estado_nave.posicao.x * estado_nave.posicao.x +
-                            estado_nave.posicao.y * estado_nave.posicao.y +
-                            estado_nave.posicao.z * estado_nave.posicao.z);
+  velocidade->x += dvx_dt * dt;
+  velocidade->y += dvy_dt * dt;
+  velocidade->z += dvz_dt * dt;
 
-  if (dist_centro < 6378137.0) { // Raio da Terra
-    // Reposiciona na superfície
-    double fator = 6378137.0 / dist_centro;
-    estado_nave.posicao.x *= fator;
-    estado_nave.posicao.y *= fator;
-    estado_nave.posicao.z *= fator;
-
-    // Se estiver caindo, anula a velocidade vertical (impacto)
-    // Simplificação: se o produto escalar Pos . Vel < 0, está indo para o
-    // centro
-    double dot = estado_nave.posicao.x * estado_nave.velocidade.x +
-                 estado_nave.posicao.y * estado_nave.velocidade.y +
-                 estado_nave.posicao.z * estado_nave.velocidade.z;
-
-    if (dot < 0) {
-      estado_nave.velocidade.x = 0;
-      estado_nave.velocidade.y = 0;
-      estado_nave.velocidade.z = 0;
-    }
-  }
-
-  estado_nave.aceleracao.x = dvx_dt;
-  estado_nave.aceleracao.y = dvy_dt;
-  estado_nave.aceleracao.z = dvz_dt;
-
-  estado_nave.tempo_missao += dt;
+  return (Vetor3D){dvx_dt, dvy_dt, dvz_dt};
+}
 
-  pthread_mutex_unlock(&mutex_estado);
+// Mesma lógica para a Lua: a nave pousada acompanha o movimento dela
+void aplicar_colisao_lua(EstadoNave *nave) {
+  // A Lua nunca está a menos de ~356.000 km da Terra: perto da Terra nem é
+  // preciso consultar as efemérides
+  const double raio_minimo_orbita = 3.0e8;
+  Vetor3D pos = nave->posicao;
+  if (pos.x * pos.x + pos.y * pos.y + pos.z * pos.z <
+      raio_minimo_orbita * raio_minimo_orbita)
+    return;
+
+  Vetor3D lua = efemerides_lua(nave->tempo_missao);
+  Vetor3D rel = {pos.x - lua.x, pos.y - lua.y, pos.z - lua.z};
+  double dist = sqrt(rel.x * rel.x + rel.y * rel.y + rel.z * rel.z);
+  if (dist >= RAIO_MIN_LUA)
+    return;
+
+  double fator = RAIO_MIN_LUA / dist;
+  nave->posicao = (Vetor3D){lua.x + rel.x * fator, lua.y + rel.y * fator,
+                            lua.z + rel.z * fator};
+
+  Vetor3D v_lua = efemerides_velocidade_lua(nave->tempo_missao);
+  Vetor3D v_rel = {nave->velocidade.x - v_lua.x, nave->velocidade.y - v_lua.y,
+                   nave->velocidade.z - v_lua.z};
+  if (rel.x * v_rel.x + rel.y * v_rel.y + rel.z * v_rel.z < 0)
+    nave->velocidade = v_lua;
 }
 
-// Thread principal de controle da física (Alta Resolução)
-void *controle_voo(void *arg) {
-  (void)arg;
-  struct timespec tempo_anterior, tempo_atual;
-  clock_gettime(CLOCK_MONOTONIC, &tempo_anterior);
-
-  double tempo_para_proximo_estado = 30.0;
-
-  while (atomic_load(&estado_nave.sistema_ativo)) {
-    // High-Resolution Timer usando CLOCK_MONOTONIC
-    clock_gettime(CLOCK_MONOTONIC, &tempo_atual);
-    double delta_tempo_real =
-        (tempo_atual.tv_sec - tempo_anterior.tv_sec) +
-        (tempo_atual.tv_nsec - tempo_anterior.tv_nsec) / 1e9;
-    tempo_anterior = tempo_atual;
-
-    // Limita o dt real para evitar saltos enormes em caso de lag na thread
-    if (delta_tempo_real > 0.1)
-      delta_tempo_real = 0.1;
-
-    int fator_aceleracao = atomic_load(&estado_nave.simulacao_acelerada);
-    double dt_simulacao = delta_tempo_real * fator_aceleracao;
-
-    // Atualiza a física com o RK4
-    atualizar_fisica_rk4(dt_simulacao);
-
-    pthread_mutex_lock(&mutex_estado);
-
-    // Lógica Fictícia de Avanço de Estados
-    if (estado_nave.estado_missao != EMERGENCIA &&
-        estado_nave.estado_missao != FINALIZACAO) {
-      tempo_para_proximo_estado -= dt_simulacao;
-      if (tempo_para_proximo_estado <= 0) {
-        pthread_mutex_unlock(&mutex_estado);
-        avancar_estado_missao();
-        pthread_mutex_lock(&mutex_estado);
-        tempo_para_proximo_estado = 30.0;
-      }
-    }
+// Realiza um passo de integração RK4 sobre a nave informada, na thread que a
+// possui.
+void atualizar_fisica_rk4(EstadoNave *nave, double dt) {
+  // Massa variável e empuxo ao longo do eixo Y (em um sistema completo a
+  // direção viria da orientação da nave)
+  Vetor3D acel_empuxo = calcular_aceleracao_empuxo(nave);
 
-    pthread_mutex_unlock(&mutex_estado);
+  // Atualiza o estado da nave
+  nave->aceleracao =
+      passo_rk4(&nave->posicao, &nave->velocidade, nave->tempo_missao, dt,
+                acel_empuxo, gravidade_nivel(nave->estado_missao));
 
-    // Usleep curto apenas para não consumir 100% da CPU, mas permitindo o
-    // relógio de precisão ditar a taxa de delta_tempo (cerca de ~1ms de espera)
-    usleep(1000);
-  }
+  nave->tempo_missao += dt;
 
-  return NULL;
+  // A Lua é consultada no instante do fim do passo
+  aplicar_colisao_terra(nave);
+  aplicar_colisao_lua(nave);
 }
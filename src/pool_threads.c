@@ -0,0 +1,52 @@
+#include "pool_threads.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+typedef struct {
+  atomic_size_t proxima;
+  size_t n_tarefas;
+  TarefaPool tarefa;
+  void *contexto;
+} FilaTarefas;
+
+int obter_numero_nucleos(void) {
+  long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+  return nucleos < 1 ? 1 : (int)nucleos;
+}
+
+static void *trabalhador_pool(void *arg) {
+  FilaTarefas *fila = arg;
+  size_t indice;
+  while ((indice = atomic_fetch_add(&fila->proxima, 1)) < fila->n_tarefas)
+    fila->tarefa(indice, fila->contexto);
+  return NULL;
+}
+
+void executar_em_paralelo(size_t n_tarefas, int n_threads, TarefaPool tarefa,
+                          void *contexto) {
+  FilaTarefas fila = {.n_tarefas = n_tarefas,
+                      .tarefa = tarefa,
+                      .contexto = contexto};
+  atomic_init(&fila.proxima, 0);
+
+  if (n_threads < 1)
+    n_threads = 1;
+  if ((size_t)n_threads > n_tarefas)
+    n_threads = n_tarefas > 0 ? (int)n_tarefas : 1;
+
+  // A thread chamadora também trabalha: cria apenas n_threads - 1 auxiliares
+  pthread_t *threads = malloc(sizeof(pthread_t) * (size_t)n_threads);
+  int criadas = 0;
+  for (int i = 1; threads && i < n_threads; i++) {
+    if (pthread_create(&threads[criadas], NULL, trabalhador_pool, &fila) == 0)
+      criadas++;
+  }
+
+  trabalhador_pool(&fila);
+
+  for (int i = 0; i < criadas; i++)
+    pthread_join(threads[i], NULL);
+  free(threads);
+}
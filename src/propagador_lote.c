@@ -0,0 +1,498 @@
+#include "propagador_lote.h"
+#include "physics_engine.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define LOTE_X86_SIMD 1
+#endif
+
+#define LOTE_ALINHAMENTO 64
+#define LOTE_LARGURA_MAX 8 // largura do AVX-512 em doubles
+
+bool lote_criar(LoteVeiculos *lote, size_t capacidade) {
+  memset(lote, 0, sizeof(*lote));
+
+  // Arredonda para múltiplo da maior largura vetorial
+  capacidade = (capacidade + LOTE_LARGURA_MAX - 1) / LOTE_LARGURA_MAX *
+               LOTE_LARGURA_MAX;
+  if (capacidade == 0)
+    capacidade = LOTE_LARGURA_MAX;
+
+  // Um único bloco para os nove arrays; cada um começa alinhado pois
+  // capacidade * sizeof(double) é múltiplo de 64
+  size_t bytes_array = capacidade * sizeof(double);
+  double *bloco = aligned_alloc(LOTE_ALINHAMENTO, 9 * bytes_array);
+  if (!bloco)
+    return false;
+  memset(bloco, 0, 9 * bytes_array);
+
+  double **arrays[] = {&lote->px, &lote->py, &lote->pz,
+                       &lote->vx, &lote->vy, &lote->vz,
+                       &lote->ax_empuxo, &lote->ay_empuxo, &lote->az_empuxo};
+  for (size_t i = 0; i < 9; i++)
+    *arrays[i] = bloco + i * capacidade;
+
+  lote->capacidade = capacidade;
+  lote->n = 0;
+  lote->tempo = 0.0;
+  return true;
+}
+
+void lote_destruir(LoteVeiculos *lote) {
+  free(lote->px);
+  memset(lote, 0, sizeof(*lote));
+}
+
+long lote_adicionar(LoteVeiculos *lote, Vetor3D posicao, Vetor3D velocidade) {
+  if (lote->n >= lote->capacidade)
+    return -1;
+
+  size_t i = lote->n++;
+  lote->px[i] = posicao.x;
+  lote->py[i] = posicao.y;
+  lote->pz[i] = posicao.z;
+  lote->vx[i] = velocidade.x;
+  lote->vy[i] = velocidade.y;
+  lote->vz[i] = velocidade.z;
+  lote->ax_empuxo[i] = 0.0;
+  lote->ay_empuxo[i] = 0.0;
+  lote->az_empuxo[i] = 0.0;
+  return (long)i;
+}
+
+KernelLote lote_kernel_disponivel(void) {
+#ifdef LOTE_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return KERNEL_LOTE_AVX512;
+  if (__builtin_cpu_supports("avx2"))
+    return KERNEL_LOTE_AVX2;
+#endif
+  return KERNEL_LOTE_ESCALAR;
+}
+
+const char *lote_nome_kernel(KernelLote kernel) {
+  switch (kernel) {
+  case KERNEL_LOTE_AVX512:
+    return "avx512";
+  case KERNEL_LOTE_AVX2:
+    return "avx2";
+  default:
+    return "escalar";
+  }
+}
+
+// ============================================
+// KERNEL ESCALAR (referência e fallback)
+// ============================================
+
+// Mesma sequência de operações de calcular_aceleracao_gravitacional, para que
+// todos os kernels produzam resultados idênticos
+static inline void gravidade_escalar(const CorposPerturbadores *corpos,
+                                     double x, double y, double z, double *ax,
+                                     double *ay, double *az) {
+  double dist_terra = sqrt(x * x + y * y + z * z);
+  double r_terra = (dist_terra < RAIO_MIN_TERRA) ? RAIO_MIN_TERRA : dist_terra;
+  double mag_terra = -(G * M_TERRA) / (r_terra * r_terra * r_terra);
+
+  double lx = x - corpos->lua.x;
+  double ly = y - corpos->lua.y;
+  double lz = z - corpos->lua.z;
+  double dist_lua = sqrt(lx * lx + ly * ly + lz * lz);
+  double r_lua = (dist_lua < RAIO_MIN_LUA) ? RAIO_MIN_LUA : dist_lua;
+  double mag_lua = -(G * M_LUA) / (r_lua * r_lua * r_lua);
+
+  double sx = x - corpos->sol.x;
+  double sy = y - corpos->sol.y;
+  double sz = z - corpos->sol.z;
+  double r_sol = sqrt(sx * sx + sy * sy + sz * sz);
+  double mag_sol = -(G * M_SOL) / (r_sol * r_sol * r_sol);
+
+  *ax = corpos->indireta.x + mag_terra * x + mag_lua * lx + mag_sol * sx;
+  *ay = corpos->indireta.y + mag_terra * y + mag_lua * ly + mag_sol * sy;
+  *az = corpos->indireta.z + mag_terra * z + mag_lua * lz + mag_sol * sz;
+}
+
+static void passo_rk4_escalar(LoteVeiculos *lote, double dt,
+                              const CorposPerturbadores corpos[3]) {
+  double meio = dt * 0.5;
+  double sexto = 1.0 / 6.0;
+
+  for (size_t i = 0; i < lote->n; i++) {
+    double px = lote->px[i], py = lote->py[i], pz = lote->pz[i];
+    double vx = lote->vx[i], vy = lote->vy[i], vz = lote->vz[i];
+    double ex = lote->ax_empuxo[i], ey = lote->ay_empuxo[i],
+           ez = lote->az_empuxo[i];
+    double gx, gy, gz;
+
+    // K1
+    gravidade_escalar(&corpos[0], px, py, pz, &gx, &gy, &gz);
+    double a1x = gx + ex, a1y = gy + ey, a1z = gz + ez;
+
+    // K2
+    double v2x = vx + a1x * meio, v2y = vy + a1y * meio, v2z = vz + a1z * meio;
+    gravidade_escalar(&corpos[1], px + vx * meio, py + vy * meio,
+                      pz + vz * meio, &gx, &gy, &gz);
+    double a2x = gx + ex, a2y = gy + ey, a2z = gz + ez;
+
+    // K3
+    double v3x = vx + a2x * meio, v3y = vy + a2y * meio, v3z = vz + a2z * meio;
+    gravidade_escalar(&corpos[1], px + v2x * meio, py + v2y * meio,
+                      pz + v2z * meio, &gx, &gy, &gz);
+    double a3x = gx + ex, a3y = gy + ey, a3z = gz + ez;
+
+    // K4
+    double v4x = vx + a3x * dt, v4y = vy + a3y * dt, v4z = vz + a3z * dt;
+    gravidade_escalar(&corpos[2], px + v3x * dt, py + v3y * dt,
+                      pz + v3z * dt, &gx, &gy, &gz);
+    double a4x = gx + ex, a4y = gy + ey, a4z = gz + ez;
+
+    // Combinação dos K's ( RK4 )
+    lote->px[i] = px + sexto * (vx + 2.0 * (v2x + v3x) + v4x) * dt;
+    lote->py[i] = py + sexto * (vy + 2.0 * (v2y + v3y) + v4y) * dt;
+    lote->pz[i] = pz + sexto * (vz + 2.0 * (v2z + v3z) + v4z) * dt;
+    lote->vx[i] = vx + sexto * (a1x + 2.0 * (a2x + a3x) + a4x) * dt;
+    lote->vy[i] = vy + sexto * (a1y + 2.0 * (a2y + a3y) + a4y) * dt;
+    lote->vz[i] = vz + sexto * (a1z + 2.0 * (a2z + a3z) + a4z) * dt;
+  }
+}
+
+#ifdef LOTE_X86_SIMD
+
+// ============================================
+// KERNEL AVX2 (4 veículos por iteração)
+// ============================================
+
+#define ALVO_AVX2 __attribute__((target("avx2")))
+
+// Corpos perturbadores de um estágio já replicados em todas as vias
+typedef struct {
+  __m256d lua_x, lua_y, lua_z;
+  __m256d sol_x, sol_y, sol_z;
+  __m256d indireta_x, indireta_y, indireta_z;
+} CorposAvx2;
+
+ALVO_AVX2 static inline void replicar_corpos_avx2(const CorposPerturbadores *c,
+                                                  CorposAvx2 *v) {
+  v->lua_x = _mm256_set1_pd(c->lua.x);
+  v->lua_y = _mm256_set1_pd(c->lua.y);
+  v->lua_z = _mm256_set1_pd(c->lua.z);
+  v->sol_x = _mm256_set1_pd(c->sol.x);
+  v->sol_y = _mm256_set1_pd(c->sol.y);
+  v->sol_z = _mm256_set1_pd(c->sol.z);
+  v->indireta_x = _mm256_set1_pd(c->indireta.x);
+  v->indireta_y = _mm256_set1_pd(c->indireta.y);
+  v->indireta_z = _mm256_set1_pd(c->indireta.z);
+}
+
+ALVO_AVX2 static inline void gravidade_avx2(const CorposAvx2 *c, __m256d x,
+                                            __m256d y, __m256d z, __m256d *ax,
+                                            __m256d *ay, __m256d *az) {
+  const __m256d gm_terra = _mm256_set1_pd(-(G * M_TERRA));
+  const __m256d gm_lua = _mm256_set1_pd(-(G * M_LUA));
+  const __m256d gm_sol = _mm256_set1_pd(-(G * M_SOL));
+  const __m256d raio_terra = _mm256_set1_pd(RAIO_MIN_TERRA);
+  const __m256d raio_lua = _mm256_set1_pd(RAIO_MIN_LUA);
+
+  __m256d r2 = _mm256_add_pd(
+      _mm256_add_pd(_mm256_mul_pd(x, x), _mm256_mul_pd(y, y)),
+      _mm256_mul_pd(z, z));
+  __m256d r = _mm256_max_pd(_mm256_sqrt_pd(r2), raio_terra);
+  __m256d mag_terra =
+      _mm256_div_pd(gm_terra, _mm256_mul_pd(_mm256_mul_pd(r, r), r));
+
+  __m256d lx = _mm256_sub_pd(x, c->lua_x);
+  __m256d ly = _mm256_sub_pd(y, c->lua_y);
+  __m256d lz = _mm256_sub_pd(z, c->lua_z);
+  __m256d l2 = _mm256_add_pd(
+      _mm256_add_pd(_mm256_mul_pd(lx, lx), _mm256_mul_pd(ly, ly)),
+      _mm256_mul_pd(lz, lz));
+  __m256d rl = _mm256_max_pd(_mm256_sqrt_pd(l2), raio_lua);
+  __m256d mag_lua =
+      _mm256_div_pd(gm_lua, _mm256_mul_pd(_mm256_mul_pd(rl, rl), rl));
+
+  __m256d sx = _mm256_sub_pd(x, c->sol_x);
+  __m256d sy = _mm256_sub_pd(y, c->sol_y);
+  __m256d sz = _mm256_sub_pd(z, c->sol_z);
+  __m256d rs = _mm256_sqrt_pd(_mm256_add_pd(
+      _mm256_add_pd(_mm256_mul_pd(sx, sx), _mm256_mul_pd(sy, sy)),
+      _mm256_mul_pd(sz, sz)));
+  __m256d mag_sol =
+      _mm256_div_pd(gm_sol, _mm256_mul_pd(_mm256_mul_pd(rs, rs), rs));
+
+  // Mesma ordem de soma do caminho escalar
+  *ax = _mm256_add_pd(
+      _mm256_add_pd(_mm256_add_pd(c->indireta_x, _mm256_mul_pd(mag_terra, x)),
+                    _mm256_mul_pd(mag_lua, lx)),
+      _mm256_mul_pd(mag_sol, sx));
+  *ay = _mm256_add_pd(
+      _mm256_add_pd(_mm256_add_pd(c->indireta_y, _mm256_mul_pd(mag_terra, y)),
+                    _mm256_mul_pd(mag_lua, ly)),
+      _mm256_mul_pd(mag_sol, sy));
+  *az = _mm256_add_pd(
+      _mm256_add_pd(_mm256_add_pd(c->indireta_z, _mm256_mul_pd(mag_terra, z)),
+                    _mm256_mul_pd(mag_lua, lz)),
+      _mm256_mul_pd(mag_sol, sz));
+}
+
+// p + v * h, componente a componente
+ALVO_AVX2 static inline __m256d avx2_eixo(__m256d p, __m256d v, __m256d h) {
+  return _mm256_add_pd(p, _mm256_mul_pd(v, h));
+}
+
+// p + 1/6 (k1 + 2 (k2 + k3) + k4) dt, na mesma ordem do caminho escalar
+ALVO_AVX2 static inline __m256d avx2_rk4(__m256d p, __m256d k1, __m256d k2,
+                                        __m256d k3, __m256d k4, __m256d dt) {
+  __m256d dois_k = _mm256_mul_pd(_mm256_set1_pd(2.0), _mm256_add_pd(k2, k3));
+  __m256d soma = _mm256_add_pd(_mm256_add_pd(k1, dois_k), k4);
+  __m256d sexto = _mm256_set1_pd(1.0 / 6.0);
+  return _mm256_add_pd(p, _mm256_mul_pd(_mm256_mul_pd(sexto, soma), dt));
+}
+
+ALVO_AVX2 static void passo_rk4_avx2(LoteVeiculos *lote, double dt_passo,
+                                     const CorposPerturbadores corpos[3]) {
+  const __m256d dt = _mm256_set1_pd(dt_passo);
+  const __m256d meio = _mm256_set1_pd(dt_passo * 0.5);
+  CorposAvx2 inicio, ponto_medio, fim;
+  replicar_corpos_avx2(&corpos[0], &inicio);
+  replicar_corpos_avx2(&corpos[1], &ponto_medio);
+  replicar_corpos_avx2(&corpos[2], &fim);
+
+  for (size_t i = 0; i < lote->n; i += 4) {
+    __m256d px = _mm256_load_pd(lote->px + i);
+    __m256d py = _mm256_load_pd(lote->py + i);
+    __m256d pz = _mm256_load_pd(lote->pz + i);
+    __m256d vx = _mm256_load_pd(lote->vx + i);
+    __m256d vy = _mm256_load_pd(lote->vy + i);
+    __m256d vz = _mm256_load_pd(lote->vz + i);
+    __m256d ex = _mm256_load_pd(lote->ax_empuxo + i);
+    __m256d ey = _mm256_load_pd(lote->ay_empuxo + i);
+    __m256d ez = _mm256_load_pd(lote->az_empuxo + i);
+    __m256d gx, gy, gz;
+
+    // K1
+    gravidade_avx2(&inicio, px, py, pz, &gx, &gy, &gz);
+    __m256d a1x = _mm256_add_pd(gx, ex), a1y = _mm256_add_pd(gy, ey),
+            a1z = _mm256_add_pd(gz, ez);
+
+    // K2
+    __m256d v2x = avx2_eixo(vx, a1x, meio), v2y = avx2_eixo(vy, a1y, meio),
+            v2z = avx2_eixo(vz, a1z, meio);
+    gravidade_avx2(&ponto_medio, avx2_eixo(px, vx, meio),
+                   avx2_eixo(py, vy, meio), avx2_eixo(pz, vz, meio), &gx,
+                   &gy, &gz);
+    __m256d a2x = _mm256_add_pd(gx, ex), a2y = _mm256_add_pd(gy, ey),
+            a2z = _mm256_add_pd(gz, ez);
+
+    // K3
+    __m256d v3x = avx2_eixo(vx, a2x, meio), v3y = avx2_eixo(vy, a2y, meio),
+            v3z = avx2_eixo(vz, a2z, meio);
+    gravidade_avx2(&ponto_medio, avx2_eixo(px, v2x, meio),
+                   avx2_eixo(py, v2y, meio), avx2_eixo(pz, v2z, meio), &gx,
+                   &gy, &gz);
+    __m256d a3x = _mm256_add_pd(gx, ex), a3y = _mm256_add_pd(gy, ey),
+            a3z = _mm256_add_pd(gz, ez);
+
+    // K4
+    __m256d v4x = avx2_eixo(vx, a3x, dt), v4y = avx2_eixo(vy, a3y, dt),
+            v4z = avx2_eixo(vz, a3z, dt);
+    gravidade_avx2(&fim, avx2_eixo(px, v3x, dt), avx2_eixo(py, v3y, dt),
+                   avx2_eixo(pz, v3z, dt), &gx, &gy, &gz);
+    __m256d a4x = _mm256_add_pd(gx, ex), a4y = _mm256_add_pd(gy, ey),
+            a4z = _mm256_add_pd(gz, ez);
+
+    // Combinação dos K's ( RK4 )
+    _mm256_store_pd(lote->px + i, avx2_rk4(px, vx, v2x, v3x, v4x, dt));
+    _mm256_store_pd(lote->py + i, avx2_rk4(py, vy, v2y, v3y, v4y, dt));
+    _mm256_store_pd(lote->pz + i, avx2_rk4(pz, vz, v2z, v3z, v4z, dt));
+    _mm256_store_pd(lote->vx + i, avx2_rk4(vx, a1x, a2x, a3x, a4x, dt));
+    _mm256_store_pd(lote->vy + i, avx2_rk4(vy, a1y, a2y, a3y, a4y, dt));
+    _mm256_store_pd(lote->vz + i, avx2_rk4(vz, a1z, a2z, a3z, a4z, dt));
+  }
+}
+
+// ============================================
+// KERNEL AVX-512 (8 veículos por iteração)
+// ============================================
+
+#define ALVO_AVX512 __attribute__((target("avx512f")))
+
+// Corpos perturbadores de um estágio já replicados em todas as vias
+typedef struct {
+  __m512d lua_x, lua_y, lua_z;
+  __m512d sol_x, sol_y, sol_z;
+  __m512d indireta_x, indireta_y, indireta_z;
+} CorposAvx512;
+
+ALVO_AVX512 static inline void
+replicar_corpos_avx512(const CorposPerturbadores *c, CorposAvx512 *v) {
+  v->lua_x = _mm512_set1_pd(c->lua.x);
+  v->lua_y = _mm512_set1_pd(c->lua.y);
+  v->lua_z = _mm512_set1_pd(c->lua.z);
+  v->sol_x = _mm512_set1_pd(c->sol.x);
+  v->sol_y = _mm512_set1_pd(c->sol.y);
+  v->sol_z = _mm512_set1_pd(c->sol.z);
+  v->indireta_x = _mm512_set1_pd(c->indireta.x);
+  v->indireta_y = _mm512_set1_pd(c->indireta.y);
+  v->indireta_z = _mm512_set1_pd(c->indireta.z);
+}
+
+ALVO_AVX512 static inline void gravidade_avx512(const CorposAvx512 *c,
+                                                __m512d x, __m512d y, __m512d z,
+                                                __m512d *ax, __m512d *ay,
+                                                __m512d *az) {
+  const __m512d gm_terra = _mm512_set1_pd(-(G * M_TERRA));
+  const __m512d gm_lua = _mm512_set1_pd(-(G * M_LUA));
+  const __m512d gm_sol = _mm512_set1_pd(-(G * M_SOL));
+  const __m512d raio_terra = _mm512_set1_pd(RAIO_MIN_TERRA);
+  const __m512d raio_lua = _mm512_set1_pd(RAIO_MIN_LUA);
+
+  __m512d r2 = _mm512_add_pd(
+      _mm512_add_pd(_mm512_mul_pd(x, x), _mm512_mul_pd(y, y)),
+      _mm512_mul_pd(z, z));
+  __m512d r = _mm512_max_pd(_mm512_sqrt_pd(r2), raio_terra);
+  __m512d mag_terra =
+      _mm512_div_pd(gm_terra, _mm512_mul_pd(_mm512_mul_pd(r, r), r));
+
+  __m512d lx = _mm512_sub_pd(x, c->lua_x);
+  __m512d ly = _mm512_sub_pd(y, c->lua_y);
+  __m512d lz = _mm512_sub_pd(z, c->lua_z);
+  __m512d l2 = _mm512_add_pd(
+      _mm512_add_pd(_mm512_mul_pd(lx, lx), _mm512_mul_pd(ly, ly)),
+      _mm512_mul_pd(lz, lz));
+  __m512d rl = _mm512_max_pd(_mm512_sqrt_pd(l2), raio_lua);
+  __m512d mag_lua =
+      _mm512_div_pd(gm_lua, _mm512_mul_pd(_mm512_mul_pd(rl, rl), rl));
+
+  __m512d sx = _mm512_sub_pd(x, c->sol_x);
+  __m512d sy = _mm512_sub_pd(y, c->sol_y);
+  __m512d sz = _mm512_sub_pd(z, c->sol_z);
+  __m512d rs = _mm512_sqrt_pd(_mm512_add_pd(
+      _mm512_add_pd(_mm512_mul_pd(sx, sx), _mm512_mul_pd(sy, sy)),
+      _mm512_mul_pd(sz, sz)));
+  __m512d mag_sol =
+      _mm512_div_pd(gm_sol, _mm512_mul_pd(_mm512_mul_pd(rs, rs), rs));
+
+  // Mesma ordem de soma do caminho escalar
+  *ax = _mm512_add_pd(
+      _mm512_add_pd(_mm512_add_pd(c->indireta_x, _mm512_mul_pd(mag_terra, x)),
+                    _mm512_mul_pd(mag_lua, lx)),
+      _mm512_mul_pd(mag_sol, sx));
+  *ay = _mm512_add_pd(
+      _mm512_add_pd(_mm512_add_pd(c->indireta_y, _mm512_mul_pd(mag_terra, y)),
+                    _mm512_mul_pd(mag_lua, ly)),
+      _mm512_mul_pd(mag_sol, sy));
+  *az = _mm512_add_pd(
+      _mm512_add_pd(_mm512_add_pd(c->indireta_z, _mm512_mul_pd(mag_terra, z)),
+                    _mm512_mul_pd(mag_lua, lz)),
+      _mm512_mul_pd(mag_sol, sz));
+}
+
+// p + v * h, componente a componente
+ALVO_AVX512 static inline __m512d avx512_eixo(__m512d p, __m512d v, __m512d h) {
+  return _mm512_add_pd(p, _mm512_mul_pd(v, h));
+}
+
+// p + 1/6 (k1 + 2 (k2 + k3) + k4) dt, na mesma ordem do caminho escalar
+ALVO_AVX512 static inline __m512d avx512_rk4(__m512d p, __m512d k1, __m512d k2,
+                                        __m512d k3, __m512d k4, __m512d dt) {
+  __m512d dois_k = _mm512_mul_pd(_mm512_set1_pd(2.0), _mm512_add_pd(k2, k3));
+  __m512d soma = _mm512_add_pd(_mm512_add_pd(k1, dois_k), k4);
+  __m512d sexto = _mm512_set1_pd(1.0 / 6.0);
+  return _mm512_add_pd(p, _mm512_mul_pd(_mm512_mul_pd(sexto, soma), dt));
+}
+
+ALVO_AVX512 static void passo_rk4_avx512(LoteVeiculos *lote, double dt_passo,
+                                         const CorposPerturbadores corpos[3]) {
+  const __m512d dt = _mm512_set1_pd(dt_passo);
+  const __m512d meio = _mm512_set1_pd(dt_passo * 0.5);
+  CorposAvx512 inicio, ponto_medio, fim;
+  replicar_corpos_avx512(&corpos[0], &inicio);
+  replicar_corpos_avx512(&corpos[1], &ponto_medio);
+  replicar_corpos_avx512(&corpos[2], &fim);
+
+  for (size_t i = 0; i < lote->n; i += 8) {
+    __m512d px = _mm512_load_pd(lote->px + i);
+    __m512d py = _mm512_load_pd(lote->py + i);
+    __m512d pz = _mm512_load_pd(lote->pz + i);
+    __m512d vx = _mm512_load_pd(lote->vx + i);
+    __m512d vy = _mm512_load_pd(lote->vy + i);
+    __m512d vz = _mm512_load_pd(lote->vz + i);
+    __m512d ex = _mm512_load_pd(lote->ax_empuxo + i);
+    __m512d ey = _mm512_load_pd(lote->ay_empuxo + i);
+    __m512d ez = _mm512_load_pd(lote->az_empuxo + i);
+    __m512d gx, gy, gz;
+
+    // K1
+    gravidade_avx512(&inicio, px, py, pz, &gx, &gy, &gz);
+    __m512d a1x = _mm512_add_pd(gx, ex), a1y = _mm512_add_pd(gy, ey),
+            a1z = _mm512_add_pd(gz, ez);
+
+    // K2
+    __m512d v2x = avx512_eixo(vx, a1x, meio), v2y = avx512_eixo(vy, a1y, meio),
+            v2z = avx512_eixo(vz, a1z, meio);
+    gravidade_avx512(&ponto_medio, avx512_eixo(px, vx, meio),
+                     avx512_eixo(py, vy, meio), avx512_eixo(pz, vz, meio), &gx,
+                     &gy, &gz);
+    __m512d a2x = _mm512_add_pd(gx, ex), a2y = _mm512_add_pd(gy, ey),
+            a2z = _mm512_add_pd(gz, ez);
+
+    // K3
+    __m512d v3x = avx512_eixo(vx, a2x, meio), v3y = avx512_eixo(vy, a2y, meio),
+            v3z = avx512_eixo(vz, a2z, meio);
+    gravidade_avx512(&ponto_medio, avx512_eixo(px, v2x, meio),
+                     avx512_eixo(py, v2y, meio), avx512_eixo(pz, v2z, meio),
+                     &gx, &gy, &gz);
+    __m512d a3x = _mm512_add_pd(gx, ex), a3y = _mm512_add_pd(gy, ey),
+            a3z = _mm512_add_pd(gz, ez);
+
+    // K4
+    __m512d v4x = avx512_eixo(vx, a3x, dt), v4y = avx512_eixo(vy, a3y, dt),
+            v4z = avx512_eixo(vz, a3z, dt);
+    gravidade_avx512(&fim, avx512_eixo(px, v3x, dt), avx512_eixo(py, v3y, dt),
+                     avx512_eixo(pz, v3z, dt), &gx, &gy, &gz);
+    __m512d a4x = _mm512_add_pd(gx, ex), a4y = _mm512_add_pd(gy, ey),
+            a4z = _mm512_add_pd(gz, ez);
+
+    // Combinação dos K's ( RK4 )
+    _mm512_store_pd(lote->px + i, avx512_rk4(px, vx, v2x, v3x, v4x, dt));
+    _mm512_store_pd(lote->py + i, avx512_rk4(py, vy, v2y, v3y, v4y, dt));
+    _mm512_store_pd(lote->pz + i, avx512_rk4(pz, vz, v2z, v3z, v4z, dt));
+    _mm512_store_pd(lote->vx + i, avx512_rk4(vx, a1x, a2x, a3x, a4x, dt));
+    _mm512_store_pd(lote->vy + i, avx512_rk4(vy, a1y, a2y, a3y, a4y, dt));
+    _mm512_store_pd(lote->vz + i, avx512_rk4(vz, a1z, a2z, a3z, a4z, dt));
+  }
+}
+
+#endif // LOTE_X86_SIMD
+
+void lote_passo_rk4_kernel(LoteVeiculos *lote, double dt, KernelLote kernel) {
+  // Todos os veículos compartilham o instante: as efemérides são consultadas
+  // uma vez por estágio, não uma vez por veículo
+  CorposPerturbadores corpos[3];
+  efemerides_corpos(lote->tempo, &corpos[0]);
+  efemerides_corpos(lote->tempo + dt * 0.5, &corpos[1]);
+  efemerides_corpos(lote->tempo + dt, &corpos[2]);
+
+  switch (kernel) {
+#ifdef LOTE_X86_SIMD
+  case KERNEL_LOTE_AVX512:
+    passo_rk4_avx512(lote, dt, corpos);
+    break;
+  case KERNEL_LOTE_AVX2:
+    passo_rk4_avx2(lote, dt, corpos);
+    break;
+#endif
+  default:
+    passo_rk4_escalar(lote, dt, corpos);
+    break;
+  }
+  lote->tempo += dt;
+}
+
+void lote_passo_rk4(LoteVeiculos *lote, double dt) {
+  lote_passo_rk4_kernel(lote, dt, lote_kernel_disponivel());
+}
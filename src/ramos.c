@@ -0,0 +1,196 @@
+#include "ramos.h"
+#include "pool_threads.h"
+#include "sintonia_pid.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+  EstadoMissao estado_final;
+  double tempo_final;
+  double combustivel;
+  double velocidade_pouso; // m/s no toque da descida, em módulo
+  bool pousou;
+} ResultadoRamo;
+
+typedef struct {
+  const Checkpoint *checkpoint;
+  const ComandosRamo *ramos; // ramos[0] é o ramo base
+  ResultadoRamo *resultados;
+  double duracao_max;
+  // A missão padrão não chega à Lua: o pouso de cada ramo é o toque desta
+  // descida isolada, com o PID de descida do ramo
+  CenarioDescida descida;
+} LoteRamos;
+
+bool interpretar_ramo(const char *especificacao, ComandosRamo *ramo) {
+  *ramo = (ComandosRamo){.descricao = especificacao,
+                         .kp = NAN,
+                         .ki = NAN,
+                         .kd = NAN,
+                         .empuxo_max_descida = NAN,
+                         .empuxo_lancamento = NAN,
+                         .vazao_lancamento = NAN,
+                         .combustivel = NAN,
+                         .avancos_estado = -1};
+
+  char copia[256];
+  if (strlen(especificacao) >= sizeof(copia))
+    return false;
+  strcpy(copia, especificacao);
+
+  char *contexto_tokens;
+  for (char *item = strtok_r(copia, ",", &contexto_tokens); item;
+       item = strtok_r(NULL, ",", &contexto_tokens)) {
+    if (strcmp(item, "emergencia") == 0) {
+      ramo->emergencia = true;
+      continue;
+    }
+
+    char *igual = strchr(item, '=');
+    if (!igual)
+      return false;
+    *igual = '\0';
+    const char *chave = item;
+    char *fim;
+    double valor = strtod(igual + 1, &fim);
+    if (fim == igual + 1 || *fim != '\0')
+      return false;
+
+    if (strcmp(chave, "semente") == 0) {
+      ramo->alterar_semente = true;
+      ramo->semente = (unsigned int)valor;
+    } else if (strcmp(chave, "kp") == 0) {
+      ramo->kp = valor;
+    } else if (strcmp(chave, "ki") == 0) {
+      ramo->ki = valor;
+    } else if (strcmp(chave, "kd") == 0) {
+      ramo->kd = valor;
+    } else if (strcmp(chave, "empuxo_max") == 0) {
+      ramo->empuxo_max_descida = valor;
+    } else if (strcmp(chave, "empuxo") == 0) {
+      ramo->empuxo_lancamento = valor;
+    } else if (strcmp(chave, "vazao") == 0) {
+      ramo->vazao_lancamento = valor;
+    } else if (strcmp(chave, "combustivel") == 0) {
+      ramo->combustivel = valor;
+    } else if (strcmp(chave, "avancar") == 0) {
+      ramo->avancos_estado = (int)valor;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void aplicar_comandos(const ComandosRamo *ramo, ContextoSimulacao *ctx) {
+  EstadoNave *nave = ctx->nave;
+  ControladorPID *pid = &ctx->propulsao.pid_descida;
+
+  if (ramo->alterar_semente) {
+    ctx->seed_propulsao = ramo->semente;
+    ctx->seed_energia = ramo->semente + 1u;
+  }
+  if (!isnan(ramo->kp))
+    pid->kp = ramo->kp;
+  if (!isnan(ramo->ki))
+    pid->ki = ramo->ki;
+  if (!isnan(ramo->kd))
+    pid->kd = ramo->kd;
+  if (!isnan(ramo->empuxo_max_descida))
+    pid->empuxo_max = ramo->empuxo_max_descida;
+  if (!isnan(ramo->empuxo_lancamento))
+    ctx->propulsao.empuxo_lancamento = ramo->empuxo_lancamento;
+  if (!isnan(ramo->vazao_lancamento))
+    ctx->propulsao.vazao_lancamento = ramo->vazao_lancamento;
+  if (!isnan(ramo->combustivel))
+    nave->combustivel_principal = ramo->combustivel;
+  for (int i = 0; i < ramo->avancos_estado; i++)
+    contexto_avancar_estado(ctx);
+  if (ramo->emergencia)
+    entrar_emergencia(nave);
+}
+
+static void executar_ramo(size_t indice, void *arg) {
+  LoteRamos *lote = arg;
+  ResultadoRamo *resultado = &lote->resultados[indice];
+
+  // Cada ramo tem sua própria nave e contexto: nenhum estado compartilhado
+  EstadoNave nave;
+  ContextoSimulacao ctx;
+  checkpoint_restaurar(lote->checkpoint, &ctx, &nave);
+  // O motor de lançamento do checkpoint, mesmo que o ramo o altere
+  ControlePropulsao descida = ctx.propulsao;
+  aplicar_comandos(&lote->ramos[indice], &ctx);
+  descida.pid_descida = ctx.propulsao.pid_descida;
+
+  ResultadoDescida toque;
+  simular_descida(&descida, &lote->descida, &toque);
+  resultado->pousou = toque.pousou;
+  resultado->velocidade_pouso = toque.velocidade_toque;
+
+  while (!contexto_encerrado(&ctx, lote->duracao_max))
+    passo_contexto(&ctx);
+  finalizar_contexto(&ctx);
+
+  resultado->estado_final = nave.estado_missao;
+  resultado->tempo_final = nave.tempo_missao;
+  resultado->combustivel = nave.combustivel_principal;
+}
+
+int executar_ramos(const Checkpoint *checkpoint, const ComandosRamo *ramos,
+                   size_t n_ramos, int threads, double duracao_max) {
+  size_t n = n_ramos + 1;
+  ComandosRamo *todos = malloc(n * sizeof(ComandosRamo));
+  ResultadoRamo *resultados = calloc(n, sizeof(ResultadoRamo));
+  if (!todos || !resultados) {
+    fprintf(stderr, "ramos: memoria insuficiente\n");
+    free(todos);
+    free(resultados);
+    return 1;
+  }
+
+  interpretar_ramo("", &todos[0]);
+  todos[0].descricao = "(base)";
+  memcpy(todos + 1, ramos, n_ramos * sizeof(ComandosRamo));
+
+  if (threads <= 0)
+    threads = obter_numero_nucleos();
+  ConfiguracaoSintonia sintonia;
+  configuracao_sintonia_padrao(&sintonia);
+  LoteRamos lote = {.checkpoint = checkpoint,
+                    .ramos = todos,
+                    .resultados = resultados,
+                    .duracao_max = duracao_max,
+                    .descida = sintonia.cenario};
+
+  struct timespec inicio, fim;
+  clock_gettime(CLOCK_MONOTONIC, &inicio);
+  executar_em_paralelo(n, threads, executar_ramo, &lote);
+  clock_gettime(CLOCK_MONOTONIC, &fim);
+  double tempo_real =
+      (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+
+  printf("Ramos a partir de %s em t=%.3f s: %zu ramos, %d threads, %.3f s\n",
+         obter_nome_estado(checkpoint->nave.estado_missao),
+         checkpoint->nave.tempo_missao, n, threads, tempo_real);
+  printf("  %-3s %-32s %-17s %12s %16s %10s\n", "#", "Comandos",
+         "Estado final", "Tempo (s)", "Combustivel (kg)", "Pouso m/s");
+  for (size_t i = 0; i < n; i++) {
+    const ResultadoRamo *r = &resultados[i];
+    char pouso[16] = "-";
+    if (r->pousou)
+      snprintf(pouso, sizeof(pouso), "%.3f", r->velocidade_pouso);
+    printf("  %-3zu %-32.32s %-17s %12.3f %16.3f %10s\n", i,
+           todos[i].descricao, obter_nome_estado(r->estado_final),
+           r->tempo_final, r->combustivel, pouso);
+  }
+  printf("  Pouso: toque da descida isolada do ajuste do PID, com o PID de "
+         "descida de cada ramo\n");
+
+  free(todos);
+  free(resultados);
+  return 0;
+}
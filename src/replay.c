@@ -0,0 +1,184 @@
+#include "replay.h"
+#include "indice_telemetria.h"
+#include "telemetry_ui.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define REPLAY_VELOCIDADE_MAX 65536
+
+static double relogio_s(void) {
+  struct timespec agora;
+  clock_gettime(CLOCK_MONOTONIC, &agora);
+  return (double)agora.tv_sec + (double)agora.tv_nsec * 1e-9;
+}
+
+// Lê o tempo de missão digitado pelo usuário (em horas) no rodapé
+static bool perguntar_tempo(WINDOW *win, double *tempo) {
+  char entrada[32] = {0};
+  mvwprintw(win, 28, 2, "%-76s", "Ir para (horas de missao): ");
+  wmove(win, 28, 29);
+  wrefresh(win);
+
+  timeout(-1);
+  echo();
+  curs_set(1);
+  int lido = wgetnstr(win, entrada, (int)sizeof(entrada) - 1);
+  curs_set(0);
+  noecho();
+
+  char *fim;
+  double horas = strtod(entrada, &fim);
+  if (lido == ERR || fim == entrada)
+    return false;
+  *tempo = horas * 3600.0;
+  return true;
+}
+
+int executar_replay(const char *arquivo) {
+  LogIndexado *log = malloc(sizeof(LogIndexado));
+  if (!log)
+    return 1;
+  if (!log_indexado_abrir(log, arquivo)) {
+    fprintf(stderr, "Log de telemetria invalido ou incompativel: %s\n",
+            arquivo);
+    free(log);
+    return 1;
+  }
+  if (log_indexado_amostras(log) == 0) {
+    fprintf(stderr, "Log de telemetria vazio: %s\n", arquivo);
+    log_indexado_fechar(log);
+    free(log);
+    return 1;
+  }
+
+  double valores[TELEMETRIA_N_CANAIS];
+  uint64_t ultima = log_indexado_amostras(log) - 1;
+  log_indexado_ler_amostra(log, 0, valores);
+  const double tempo_inicial = valores[CANAL_TEMPO];
+  log_indexado_ler_amostra(log, ultima, valores);
+  const double tempo_final = valores[CANAL_TEMPO];
+
+  // O relógio do replay avança em tempo de missão; a amostra exibida é a
+  // última gravada antes dele
+  double tempo = tempo_inicial;
+  int velocidade = 1;
+  bool pausado = false;
+  bool executando = true;
+  double relogio_anterior = relogio_s();
+  EstadoNave nave;
+
+  PainelStatus painel;
+  abrir_painel(&painel);
+  int intervalo_ms = QUADRO_MIN_MS;
+  while (executando) {
+    double agora = relogio_s();
+    if (!pausado)
+      tempo += (agora - relogio_anterior) * velocidade;
+    relogio_anterior = agora;
+    if (tempo >= tempo_final) {
+      tempo = tempo_final;
+      pausado = true;
+    }
+
+    uint64_t amostra = log_indexado_buscar_tempo(log, tempo);
+    if (log_indexado_ler_amostra(log, amostra, valores))
+      telemetria_restaurar_nave(valores, &nave);
+
+    char linha_replay[80];
+    snprintf(linha_replay, sizeof(linha_replay),
+             "REPLAY t = %.1f s  velocidade: %dx%s", tempo, velocidade,
+             pausado ? "  [PAUSADO]" : "");
+
+    char status[80];
+    const TransicaoEstado *proxima =
+        log_indexado_proxima_transicao(log, tempo);
+    if (proxima)
+      snprintf(status, sizeof(status),
+               "Amostra %llu/%llu  proxima fase: %s em t = %.1f s",
+               (unsigned long long)amostra + 1,
+               (unsigned long long)ultima + 1,
+               obter_nome_estado((EstadoMissao)proxima->estado_novo),
+               proxima->tempo);
+    else
+      snprintf(status, sizeof(status), "Amostra %llu/%llu",
+               (unsigned long long)amostra + 1,
+               (unsigned long long)ultima + 1);
+
+    bool alterado = desenhar_interface(
+        &painel, &nave, linha_replay, status,
+        "[Espaco]Pausa [A/D]Vel. [Setas]1 min/1 h [[/]]Fase [G]Ir para "
+        "[S]air");
+
+    // Mesma taxa adaptativa da interface ao vivo: pausado, o painel para e
+    // os quadros se espaçam até uma tecla chegar
+    intervalo_ms = proximo_intervalo_quadro(intervalo_ms, alterado);
+    timeout(intervalo_ms);
+    const TransicaoEstado *transicao;
+    int ch = getch();
+    if (ch != ERR)
+      intervalo_ms = QUADRO_MIN_MS;
+    switch (ch) {
+    case ' ':
+      pausado = !pausado;
+      break;
+    case 'a':
+    case 'A':
+      if (velocidade < REPLAY_VELOCIDADE_MAX)
+        velocidade *= 2;
+      break;
+    case 'd':
+    case 'D':
+      if (velocidade > 1)
+        velocidade /= 2;
+      break;
+    case KEY_RIGHT:
+      tempo += 60.0;
+      break;
+    case KEY_LEFT:
+      tempo -= 60.0;
+      break;
+    case KEY_UP:
+      tempo += 3600.0;
+      break;
+    case KEY_DOWN:
+      tempo -= 3600.0;
+      break;
+    case KEY_HOME:
+      tempo = tempo_inicial;
+      break;
+    case KEY_END:
+      tempo = tempo_final;
+      break;
+    case ']':
+      transicao = log_indexado_proxima_transicao(log, tempo);
+      if (transicao)
+        tempo = transicao->tempo;
+      break;
+    case '[':
+      // Volta ao início da fase atual, ou da anterior se já estiver nele
+      transicao = log_indexado_transicao_anterior(log, tempo);
+      tempo = transicao ? transicao->tempo : tempo_inicial;
+      break;
+    case 'g':
+    case 'G':
+      perguntar_tempo(painel.win, &tempo);
+      invalidar_painel(&painel);
+      relogio_anterior = relogio_s();
+      break;
+    case 's':
+    case 'S':
+    case 'q':
+    case 'Q':
+      executando = false;
+      break;
+    }
+    if (tempo < tempo_inicial)
+      tempo = tempo_inicial;
+  }
+  fechar_painel(&painel);
+
+  log_indexado_fechar(log);
+  free(log);
+  return 0;
+}
@@ -0,0 +1,201 @@
+#include "roteiro.h"
+#include "veiculos.h"
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define TAM_LINHA_ROTEIRO 256
+#define SEPARADORES " \t\r\n"
+
+// "s", "m:s" ou "h:m:s", com a última parte fracionária
+static bool ler_tempo(const char *texto, double *segundos) {
+  double total = 0.0;
+  for (int partes = 0; partes < 3; partes++) {
+    char *fim;
+    double valor = strtod(texto, &fim);
+    if (fim == texto || !(valor >= 0.0))
+      return false;
+    total = total * 60.0 + valor;
+    if (*fim == '\0') {
+      *segundos = total;
+      return true;
+    }
+    if (*fim != ':')
+      return false;
+    texto = fim + 1;
+  }
+  return false;
+}
+
+static bool ler_numero(const char *texto, double *valor) {
+  char *fim;
+  if (!texto)
+    return false;
+  *valor = strtod(texto, &fim);
+  return fim != texto && *fim == '\0';
+}
+
+static bool ler_estado(const char *nome, int *estado) {
+  for (int e = PREPARACAO; e <= EMERGENCIA; e++)
+    if (strcasecmp(nome, obter_nome_estado((EstadoMissao)e)) == 0) {
+      *estado = e;
+      return true;
+    }
+  return false;
+}
+
+// Nome de eventos_padrao com '_' no lugar de espaço
+static bool ler_evento(const char *nome, const ContextoEventos *eventos,
+                       int *evento) {
+  for (int e = 0; e < eventos->n; e++) {
+    const char *definido = eventos->definicoes[e].nome;
+    size_t i = 0;
+    for (; nome[i] && definido[i]; i++) {
+      char c = nome[i] == '_' ? ' ' : nome[i];
+      if (tolower((unsigned char)c) != tolower((unsigned char)definido[i]))
+        break;
+    }
+    if (nome[i] == '\0' && definido[i] == '\0') {
+      *evento = e;
+      return true;
+    }
+  }
+  return false;
+}
+
+// A ação e seus argumentos, a partir do token nome. Retorna a causa do erro
+// ou NULL.
+static const char *ler_acao(const char *nome, char **contexto,
+                            EntradaRoteiro *entrada) {
+  if (!nome)
+    return "falta a acao";
+  const char *argumento = strtok_r(NULL, SEPARADORES, contexto);
+  if (strcmp(nome, "avancar") == 0) {
+    entrada->acao = ROTEIRO_AVANCAR;
+  } else if (strcmp(nome, "emergencia") == 0) {
+    entrada->acao = ROTEIRO_EMERGENCIA;
+  } else if (strcmp(nome, "falha_energia") == 0) {
+    entrada->acao = ROTEIRO_FALHA_ENERGIA;
+  } else if (strcmp(nome, "queima") == 0) {
+    entrada->acao = ROTEIRO_QUEIMA;
+    const char *duracao = strtok_r(NULL, SEPARADORES, contexto);
+    if (!ler_numero(argumento, &entrada->valor) || entrada->valor < 0.0 ||
+        !duracao || !ler_tempo(duracao, &entrada->duracao) ||
+        entrada->duracao <= 0.0)
+      return "queima espera <empuxo N> <duracao>";
+    argumento = strtok_r(NULL, SEPARADORES, contexto);
+  } else if (strcmp(nome, "separar") == 0) {
+    entrada->acao = ROTEIRO_SEPARAR;
+    bool valido = false;
+    TipoVeiculo tipo =
+        argumento ? obter_tipo_veiculo(argumento, &valido) : VEICULO_APOLLO;
+    if (!valido || tipo == VEICULO_APOLLO)
+      return "separar espera um veiculo secundario";
+    entrada->valor = tipo;
+    argumento = strtok_r(NULL, SEPARADORES, contexto);
+  } else if (strcmp(nome, "blackout") == 0) {
+    entrada->acao = ROTEIRO_BLACKOUT;
+    if (argumento) {
+      if (!ler_tempo(argumento, &entrada->duracao) || entrada->duracao <= 0.0)
+        return "duracao de blackout invalida";
+      argumento = strtok_r(NULL, SEPARADORES, contexto);
+    }
+  } else {
+    return "acao desconhecida";
+  }
+  return argumento ? "argumentos demais" : NULL;
+}
+
+// Interpreta uma linha sem comentário. Retorna a causa do erro ou NULL; uma
+// linha vazia deixa *vazia.
+static const char *ler_entrada(char *linha, const ContextoEventos *eventos,
+                               EntradaRoteiro *entrada, bool *vazia) {
+  char *contexto;
+  const char *token = strtok_r(linha, SEPARADORES, &contexto);
+  *vazia = token == NULL;
+  if (*vazia)
+    return NULL;
+  *entrada = (EntradaRoteiro){0};
+
+  bool estado = strcmp(token, "estado") == 0;
+  if (estado || strcmp(token, "evento") == 0) {
+    entrada->gatilho = estado ? GATILHO_ESTADO : GATILHO_EVENTO;
+    const char *alvo = strtok_r(NULL, SEPARADORES, &contexto);
+    if (!alvo)
+      return estado ? "falta o estado" : "falta o evento";
+    if (estado && !ler_estado(alvo, &entrada->alvo))
+      return "estado desconhecido";
+    if (!estado && !ler_evento(alvo, eventos, &entrada->alvo))
+      return "evento desconhecido";
+    token = strtok_r(NULL, SEPARADORES, &contexto);
+    if (token && token[0] == '+') {
+      if (!ler_tempo(token + 1, &entrada->instante))
+        return "atraso invalido";
+      token = strtok_r(NULL, SEPARADORES, &contexto);
+    }
+  } else {
+    entrada->gatilho = GATILHO_INSTANTE;
+    if (!ler_tempo(token, &entrada->instante))
+      return "instante invalido";
+    token = strtok_r(NULL, SEPARADORES, &contexto);
+  }
+  return ler_acao(token, &contexto, entrada);
+}
+
+bool roteiro_carregar(RoteiroMissao *roteiro, const char *caminho,
+                      char *erro, size_t tamanho_erro) {
+  FILE *arquivo = fopen(caminho, "r");
+  if (!arquivo) {
+    snprintf(erro, tamanho_erro, "%s", strerror(errno));
+    return false;
+  }
+
+  ContextoEventos eventos;
+  eventos_padrao(&eventos);
+  roteiro->n = 0;
+  roteiro->eventos = 0;
+  roteiro->condicoes = 0;
+
+  char linha[TAM_LINHA_ROTEIRO];
+  const char *causa = NULL;
+  int numero = 0;
+  while (!causa && fgets(linha, sizeof(linha), arquivo)) {
+    numero++;
+    if (!strchr(linha, '\n') && !feof(arquivo)) {
+      causa = "linha longa demais";
+      break;
+    }
+    char *comentario = strchr(linha, '#');
+    if (comentario)
+      *comentario = '\0';
+
+    EntradaRoteiro entrada;
+    bool vazia;
+    causa = ler_entrada(linha, &eventos, &entrada, &vazia);
+    if (causa || vazia)
+      continue;
+
+    // Cada ação ocupa uma posição na linha do tempo, e o seu fim outra
+    size_t ocupa = 1 + (entrada.duracao > 0.0);
+    bool condicional = entrada.gatilho != GATILHO_INSTANTE;
+    if (roteiro->eventos + ocupa > ROTEIRO_EVENTOS_MAX) {
+      causa = "eventos demais para a linha do tempo";
+    } else if (condicional && roteiro->condicoes == ROTEIRO_CONDICOES_MAX) {
+      causa = "condicoes demais";
+    } else {
+      roteiro->entradas[roteiro->n++] = entrada;
+      roteiro->eventos += ocupa;
+      roteiro->condicoes += condicional;
+    }
+  }
+  fclose(arquivo);
+
+  if (causa) {
+    snprintf(erro, tamanho_erro, "linha %d: %s", numero, causa);
+    return false;
+  }
+  return true;
+}
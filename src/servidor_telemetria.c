@@ -0,0 +1,381 @@
+#define _GNU_SOURCE
+#include "servidor_telemetria.h"
+#include "instrumentacao.h"
+#include <assert.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static_assert(TELEMETRIA_N_CANAIS <= 64, "a máscara de canais tem 64 bits");
+
+// Espera máxima do epoll sem eventos: latência das amostras sem clientes
+// ativos e do fim da fila
+#define ESPERA_EPOLL_MS 10
+#define EVENTOS_POR_ESPERA 16
+#define QUADROS_POR_ENVIO 64 // iovecs por sendmsg
+
+static bool interpretar_endereco(const char *endereco,
+                                 struct sockaddr_storage *sa,
+                                 socklen_t *tamanho) {
+  memset(sa, 0, sizeof(*sa));
+  if (strncmp(endereco, "unix:", 5) == 0) {
+    struct sockaddr_un *un = (struct sockaddr_un *)sa;
+    const char *caminho = endereco + 5;
+    if (caminho[0] == '\0' || strlen(caminho) >= sizeof(un->sun_path))
+      return false;
+    un->sun_family = AF_UNIX;
+    strcpy(un->sun_path, caminho);
+    *tamanho = sizeof(*un);
+    return true;
+  }
+  if (strncmp(endereco, "tcp:", 4) == 0) {
+    char *fim;
+    long porta = strtol(endereco + 4, &fim, 10);
+    if (fim == endereco + 4 || *fim != '\0' || porta < 1 || porta > 65535)
+      return false;
+    struct sockaddr_in *in = (struct sockaddr_in *)sa;
+    in->sin_family = AF_INET;
+    in->sin_port = htons((uint16_t)porta);
+    in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    *tamanho = sizeof(*in);
+    return true;
+  }
+  return false;
+}
+
+bool servidor_interpretar_filtro(const char *texto, uint64_t *canais) {
+  if (strcmp(texto, "*") == 0) {
+    *canais = TELEMETRIA_N_CANAIS == 64 ? UINT64_MAX
+                                        : (1ULL << TELEMETRIA_N_CANAIS) - 1;
+    return true;
+  }
+
+  uint64_t mascara = 0;
+  const char *nome = texto;
+  while (*nome) {
+    size_t tamanho = strcspn(nome, ",");
+    int canal = 0;
+    while (canal < TELEMETRIA_N_CANAIS &&
+           (strlen(obter_nome_canal(canal)) != tamanho ||
+            strncasecmp(obter_nome_canal(canal), nome, tamanho) != 0))
+      canal++;
+    if (canal == TELEMETRIA_N_CANAIS)
+      return false;
+    mascara |= 1ULL << canal;
+    nome += tamanho;
+    if (*nome == ',')
+      nome++;
+  }
+  *canais = mascara;
+  return true;
+}
+
+bool servidor_abrir(ServidorTelemetria *servidor, const char *endereco,
+                    FilaTelemetria *fila) {
+  memset(servidor, 0, sizeof(*servidor));
+  servidor->fila = fila;
+  servidor->fd_escuta = -1;
+  servidor->fd_epoll = -1;
+
+  struct sockaddr_storage sa;
+  socklen_t tamanho;
+  if (!interpretar_endereco(endereco, &sa, &tamanho)) {
+    errno = EINVAL;
+    return false;
+  }
+
+  servidor->fd_escuta =
+      socket(sa.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (servidor->fd_escuta < 0)
+    return false;
+  if (sa.ss_family == AF_UNIX) {
+    // Um socket deixado por uma execução anterior impediria o bind
+    const char *caminho = ((struct sockaddr_un *)&sa)->sun_path;
+    unlink(caminho);
+    strcpy(servidor->caminho_unix, caminho); // interpretar_endereco limita
+  } else {
+    int sim = 1;
+    setsockopt(servidor->fd_escuta, SOL_SOCKET, SO_REUSEADDR, &sim,
+               sizeof(sim));
+  }
+
+  servidor->fd_epoll = epoll_create1(EPOLL_CLOEXEC);
+  struct epoll_event evento = {.events = EPOLLIN, .data.ptr = NULL};
+  if (bind(servidor->fd_escuta, (struct sockaddr *)&sa, tamanho) < 0 ||
+      listen(servidor->fd_escuta, SOMAXCONN) < 0 || servidor->fd_epoll < 0 ||
+      epoll_ctl(servidor->fd_epoll, EPOLL_CTL_ADD, servidor->fd_escuta,
+                &evento) < 0) {
+    int erro = errno;
+    servidor_fechar(servidor);
+    errno = erro;
+    return false;
+  }
+  return true;
+}
+
+static void desconectar(ServidorTelemetria *servidor, size_t indice) {
+  ClienteTelemetria *cliente = servidor->clientes[indice];
+  close(cliente->fd); // também o remove do epoll
+  free(cliente);
+  servidor->clientes[indice] = servidor->clientes[--servidor->n_clientes];
+}
+
+void servidor_fechar(ServidorTelemetria *servidor) {
+  while (servidor->n_clientes > 0)
+    desconectar(servidor, servidor->n_clientes - 1);
+  if (servidor->fd_epoll >= 0)
+    close(servidor->fd_epoll);
+  if (servidor->fd_escuta >= 0)
+    close(servidor->fd_escuta);
+  if (servidor->caminho_unix[0])
+    unlink(servidor->caminho_unix);
+  servidor->fd_epoll = -1;
+  servidor->fd_escuta = -1;
+  servidor->caminho_unix[0] = '\0';
+}
+
+int servidor_conectar(const char *endereco) {
+  struct sockaddr_storage sa;
+  socklen_t tamanho;
+  if (!interpretar_endereco(endereco, &sa, &tamanho)) {
+    errno = EINVAL;
+    return -1;
+  }
+  int fd = socket(sa.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0)
+    return -1;
+  if (connect(fd, (struct sockaddr *)&sa, tamanho) < 0) {
+    int erro = errno;
+    close(fd);
+    errno = erro;
+    return -1;
+  }
+  return fd;
+}
+
+static void aceitar(ServidorTelemetria *servidor) {
+  for (;;) {
+    int fd = accept4(servidor->fd_escuta, NULL, NULL,
+                     SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0)
+      return; // EAGAIN: nenhuma conexão pendente
+    ClienteTelemetria *cliente =
+        servidor->n_clientes < SERVIDOR_CLIENTES_MAX
+            ? calloc(1, sizeof(ClienteTelemetria))
+            : NULL;
+    struct epoll_event evento = {.events = EPOLLIN | EPOLLRDHUP,
+                                 .data.ptr = cliente};
+    if (!cliente ||
+        epoll_ctl(servidor->fd_epoll, EPOLL_CTL_ADD, fd, &evento) < 0) {
+      close(fd);
+      free(cliente);
+      servidor->recusadas++;
+      continue;
+    }
+    cliente->fd = fd;
+    servidor_interpretar_filtro("*", &cliente->canais);
+    servidor->clientes[servidor->n_clientes++] = cliente;
+    servidor->conexoes++;
+  }
+}
+
+static size_t indice_cliente(const ServidorTelemetria *servidor,
+                             const ClienteTelemetria *cliente) {
+  size_t i = 0;
+  while (servidor->clientes[i] != cliente)
+    i++;
+  return i;
+}
+
+// Lê as linhas de filtro do cliente. Retorna false se ele desconectou.
+static bool ler_filtros(ClienteTelemetria *cliente) {
+  char buffer[TAM_LINHA_FILTRO];
+  for (;;) {
+    ssize_t lidos = recv(cliente->fd, buffer, sizeof(buffer), 0);
+    if (lidos == 0)
+      return false;
+    if (lidos < 0)
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+    for (ssize_t i = 0; i < lidos; i++) {
+      char c = buffer[i];
+      if (c != '\n') {
+        // Uma linha longa demais é descartada inteira
+        if (cliente->tam_linha < TAM_LINHA_FILTRO)
+          cliente->linha[cliente->tam_linha] = c;
+        cliente->tam_linha++;
+        continue;
+      }
+      size_t tamanho = cliente->tam_linha;
+      if (tamanho < TAM_LINHA_FILTRO) {
+        if (tamanho > 0 && cliente->linha[tamanho - 1] == '\r')
+          tamanho--;
+        cliente->linha[tamanho] = '\0';
+        uint64_t canais;
+        if (servidor_interpretar_filtro(cliente->linha, &canais))
+          cliente->canais = canais;
+      }
+      cliente->tam_linha = 0;
+    }
+  }
+}
+
+// Arma ou desarma o aviso de escrita conforme haja quadros pendentes
+static void ajustar_escrita(ServidorTelemetria *servidor,
+                            ClienteTelemetria *cliente) {
+  bool pendente = cliente->n > 0;
+  if (pendente == cliente->aguardando_escrita)
+    return;
+  struct epoll_event evento = {
+      .events = EPOLLIN | EPOLLRDHUP | (pendente ? EPOLLOUT : 0),
+      .data.ptr = cliente};
+  epoll_ctl(servidor->fd_epoll, EPOLL_CTL_MOD, cliente->fd, &evento);
+  cliente->aguardando_escrita = pendente;
+}
+
+// Envia o que o socket aceitar sem bloquear, vários quadros por chamada.
+// Retorna false se a conexão caiu.
+static bool enviar(ServidorTelemetria *servidor, ClienteTelemetria *cliente) {
+  while (cliente->n > 0) {
+    struct iovec iov[QUADROS_POR_ENVIO];
+    size_t n_iov = 0;
+    for (size_t k = 0; k < cliente->n && n_iov < QUADROS_POR_ENVIO; k++) {
+      size_t q = (cliente->inicio + k) % QUADROS_POR_CLIENTE;
+      size_t desvio = k == 0 ? cliente->enviado : 0;
+      iov[n_iov].iov_base = cliente->quadros[q] + desvio;
+      iov[n_iov].iov_len = cliente->tamanho[q] - desvio;
+      n_iov++;
+    }
+    struct msghdr mensagem = {.msg_iov = iov, .msg_iovlen = n_iov};
+    ssize_t escritos = sendmsg(cliente->fd, &mensagem, MSG_NOSIGNAL);
+    if (escritos < 0)
+      return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+    // Avança pelos quadros completos; o último pode ficar pela metade
+    size_t restantes = (size_t)escritos;
+    while (restantes > 0) {
+      size_t q = cliente->inicio;
+      size_t falta = cliente->tamanho[q] - cliente->enviado;
+      if (restantes < falta) {
+        cliente->enviado += restantes;
+        break;
+      }
+      restantes -= falta;
+      cliente->enviado = 0;
+      cliente->inicio = (cliente->inicio + 1) % QUADROS_POR_CLIENTE;
+      cliente->n--;
+      servidor->enviados++;
+    }
+    if (cliente->enviado > 0)
+      break; // o socket encheu no meio de um quadro
+  }
+  return true;
+}
+
+// Codifica a amostra com o filtro do cliente no fim da sua fila. Com a fila
+// cheia mesmo depois de tentar enviar, descarta os quadros pendentes e fica
+// só com o mais recente (menos o que já foi enviado em parte, que precisa
+// terminar para o fluxo continuar legível).
+static bool enfileirar_quadro(ServidorTelemetria *servidor,
+                              ClienteTelemetria *cliente,
+                              const AmostraTelemetria *amostra) {
+  if (cliente->canais == 0)
+    return true;
+  if (cliente->n == QUADROS_POR_CLIENTE && !enviar(servidor, cliente))
+    return false;
+  if (cliente->n == QUADROS_POR_CLIENTE) {
+    size_t mantidos = cliente->enviado > 0 ? 1 : 0;
+    servidor->descartados += cliente->n - mantidos;
+    cliente->n = mantidos;
+  }
+
+  size_t q = (cliente->inicio + cliente->n) % QUADROS_POR_CLIENTE;
+  uint8_t *quadro = cliente->quadros[q];
+  double *valores = (double *)(quadro + sizeof(CabecalhoQuadro));
+  uint32_t n_valores = 0;
+  for (int c = 0; c < TELEMETRIA_N_CANAIS; c++)
+    if (cliente->canais & (1ULL << c))
+      memcpy(&valores[n_valores++], &amostra->valores[c], sizeof(double));
+
+  CabecalhoQuadro cabecalho = {
+      .tamanho = (uint32_t)(sizeof(CabecalhoQuadro) +
+                            n_valores * sizeof(double)),
+      .n_valores = n_valores,
+      .sequencia = servidor->sequencia,
+      .canais = cliente->canais};
+  memcpy(quadro, &cabecalho, sizeof(cabecalho));
+  cliente->tamanho[q] = cabecalho.tamanho;
+  cliente->n++;
+  return true;
+}
+
+// Distribui as amostras disponíveis na fila. Retorna quantas havia.
+static size_t distribuir(ServidorTelemetria *servidor) {
+  const AmostraTelemetria *lote;
+  size_t n = fila_lote(servidor->fila, &lote);
+  for (size_t a = 0; a < n; a++) {
+    for (size_t i = servidor->n_clientes; i-- > 0;)
+      if (!enfileirar_quadro(servidor, servidor->clientes[i], &lote[a]))
+        desconectar(servidor, i);
+    servidor->sequencia++;
+  }
+  fila_liberar(servidor->fila, n);
+
+  for (size_t i = servidor->n_clientes; i-- > 0;) {
+    ClienteTelemetria *cliente = servidor->clientes[i];
+    if (enviar(servidor, cliente))
+      ajustar_escrita(servidor, cliente);
+    else
+      desconectar(servidor, i);
+  }
+  return n;
+}
+
+void *servidor_telemetria(void *arg) {
+  ServidorTelemetria *servidor = arg;
+  INSTR_THREAD("servidor");
+  struct epoll_event eventos[EVENTOS_POR_ESPERA];
+
+  // A espera no epoll só acontece com a fila vazia: com amostras chegando
+  // o laço as distribui e apenas consulta os sockets
+  int espera_ms = 0;
+  while (!fila_encerrada(servidor->fila)) {
+    int n = epoll_wait(servidor->fd_epoll, eventos, EVENTOS_POR_ESPERA,
+                       espera_ms);
+    for (int e = 0; e < n; e++) {
+      ClienteTelemetria *cliente = eventos[e].data.ptr;
+      if (!cliente) {
+        aceitar(servidor);
+        continue;
+      }
+      bool conectado = !(eventos[e].events & (EPOLLERR | EPOLLHUP));
+      if (conectado && eventos[e].events & (EPOLLIN | EPOLLRDHUP))
+        conectado = ler_filtros(cliente);
+      if (conectado && eventos[e].events & EPOLLOUT) {
+        conectado = enviar(servidor, cliente);
+        if (conectado)
+          ajustar_escrita(servidor, cliente);
+      }
+      if (!conectado)
+        desconectar(servidor, indice_cliente(servidor, cliente));
+    }
+
+    INSTR_INICIO(inicio_lote);
+    size_t distribuidas = distribuir(servidor);
+    if (distribuidas > 0)
+      INSTR_FIM(METRICA_TRABALHO, inicio_lote);
+    espera_ms = distribuidas > 0 ? 0 : ESPERA_EPOLL_MS;
+  }
+
+  // Últimas amostras, enquanto os clientes ainda estiverem lendo
+  distribuir(servidor);
+  return NULL;
+}
@@ -0,0 +1,416 @@
+#include "simulacao.h"
+#include "physics_engine.h"
+#include <math.h>
+#include <string.h>
+
+// Converte um período de subsistema em número inteiro de passos de física,
+// para que a ordem de execução dependa apenas do contador de passos
+static long passos_por_periodo(double periodo, double dt) {
+  long passos = lround(periodo / dt);
+  return passos < 1 ? 1 : passos;
+}
+
+// O antigo temporizador em ponto flutuante (t -= dt até t <= 0) contado em
+// passos: o estado avança no mesmo passo, bit a bit
+static uint64_t passos_do_intervalo(double intervalo, double dt) {
+  uint64_t passos = 0;
+  double restante = intervalo;
+  do {
+    restante -= dt;
+    passos++;
+  } while (restante > 0);
+  return passos;
+}
+
+// Passos inteiros que cobrem segundos a partir do passo atual
+static uint64_t passos_de(const ContextoSimulacao *ctx, double segundos) {
+  double passos = ceil(segundos / ctx->dt - 1e-9);
+  return passos > 0.0 ? (uint64_t)passos : 0;
+}
+
+// Temporizador de um estado novo: vence INTERVALO_SEQUENCIADOR depois do
+// passo atual
+static void reiniciar_temporizador(ContextoSimulacao *ctx, uint64_t passo) {
+  if (ctx->temporizador != SEM_EVENTO)
+    linha_tempo_cancelar(&ctx->linha_tempo, ctx->temporizador);
+  ctx->temporizador_restante = 0;
+  ctx->temporizador =
+      linha_tempo_programar(&ctx->linha_tempo, passo + ctx->passos_sequenciador,
+                            ROTEIRO_TEMPORIZADOR, 0.0);
+}
+
+void contexto_avancar_estado(ContextoSimulacao *ctx) {
+  avancar_estado(ctx->nave);
+  // Um evento antigo não encerra o estado que começa agora
+  ctx->eventos.pendentes = 0;
+}
+
+void inicializar_contexto(ContextoSimulacao *ctx, EstadoNave *nave, double dt,
+                          unsigned int semente,
+                          const ConfiguracaoIntegrador *integrador) {
+  ctx->nave = nave;
+  inicializar_controle_propulsao(&ctx->propulsao);
+
+  // Sementes fixas por subsistema: a mesma configuração reproduz a mesma
+  // trajetória bit a bit
+  ctx->seed_propulsao = semente;
+  ctx->seed_energia = semente + 1u;
+  ctx->sequenciador = SEQUENCIADOR_TEMPO;
+  eventos_padrao(&ctx->eventos);
+
+  if (integrador)
+    ctx->integrador = *integrador;
+  else
+    configuracao_integrador_padrao(&ctx->integrador);
+  inicializar_estado_integrador(&ctx->estado_integrador);
+
+  // O DP54 escolhe o próprio passo: o contexto avança no ciclo da propulsão
+  if (ctx->integrador.tipo == INTEGRADOR_DP54)
+    dt = INTERVALO_PROPULSAO / 1e6;
+
+  ctx->dt = dt;
+  ctx->passos_propulsao = passos_por_periodo(INTERVALO_PROPULSAO / 1e6, dt);
+  ctx->passos_energia = passos_por_periodo(INTERVALO_ENERGIA / 1e6, dt);
+  ctx->tempo = nave->tempo_missao;
+  ctx->passos = 0;
+  veiculos_inicializar(&ctx->veiculos, ctx->tempo, nave->estado_missao);
+
+  // O passo 1 é o primeiro a vencer
+  linha_tempo_inicializar(&ctx->linha_tempo, 1);
+  ctx->passos_sequenciador = passos_do_intervalo(INTERVALO_SEQUENCIADOR, dt);
+  ctx->temporizador = SEM_EVENTO;
+  reiniciar_temporizador(ctx, 0);
+  ctx->condicoes.n = 0;
+  ctx->condicoes.disparadas = 0;
+  ctx->condicoes.eventos = 0;
+  ctx->acoes_roteiro = 0;
+}
+
+// Executa os subsistemas que vencem no passo atual
+static void executar_subsistemas(ContextoSimulacao *ctx) {
+  EstadoNave *nave = ctx->nave;
+  if (ctx->passos % ctx->passos_propulsao == 0) {
+    passo_propulsao(nave, &ctx->propulsao, ctx->passos_propulsao * ctx->dt,
+                    &ctx->seed_propulsao);
+    ctx->eventos.tempo_esgotamento =
+        ctx->tempo + ctx->propulsao.autonomia_ciclo;
+  }
+  if (ctx->passos % ctx->passos_energia == 0)
+    passo_energia(nave, ctx->passos_energia * ctx->dt, &ctx->seed_energia);
+
+  // Passagem da energia para o sequenciador, dono do estado da missão
+  if (nave->energia_esgotada)
+    entrar_emergencia(nave);
+}
+
+// Integra a física do instante em que parou até o relógio do contexto
+static void sincronizar_fisica(ContextoSimulacao *ctx) {
+  EstadoNave *nave = ctx->nave;
+  integrar_intervalo(nave, ctx->tempo - nave->tempo_missao, &ctx->integrador,
+                     &ctx->estado_integrador, &ctx->eventos);
+  nave->tempo_missao = ctx->tempo;
+}
+
+// Evento que encerra o estado no sequenciador por eventos. Os estados sem
+// um (órbitas, superfície, preparação) seguem o temporizador.
+static bool evento_de_saida(EstadoMissao estado, TipoEvento *tipo) {
+  switch (estado) {
+  case LANCAMENTO:
+    *tipo = EVENTO_COMBUSTIVEL; // queima até o fim do combustível
+    return true;
+  case TRANSITO_LUNAR:
+    *tipo = EVENTO_SOI_LUA;
+    return true;
+  case ALUNISSAGEM:
+    *tipo = EVENTO_ALTITUDE_LUA;
+    return true;
+  case REENTRADA:
+    *tipo = EVENTO_ALTITUDE_TERRA;
+    return true;
+  default:
+    return false;
+  }
+}
+
+// O temporizador de um estado que espera pelo evento de saída fica parado
+// com os passos que faltavam, e volta a correr de onde parou
+static void suspender_temporizador(ContextoSimulacao *ctx, uint64_t passo) {
+  if (ctx->temporizador == SEM_EVENTO)
+    return;
+  uint64_t vencimento =
+      ctx->linha_tempo.eventos[ctx->temporizador].vencimento;
+  ctx->temporizador_restante = vencimento - passo + 1;
+  linha_tempo_cancelar(&ctx->linha_tempo, ctx->temporizador);
+  ctx->temporizador = SEM_EVENTO;
+}
+
+static void retomar_temporizador(ContextoSimulacao *ctx, uint64_t passo) {
+  ctx->temporizador = linha_tempo_programar(
+      &ctx->linha_tempo, passo + ctx->temporizador_restante - 1,
+      ROTEIRO_TEMPORIZADOR, 0.0);
+  ctx->temporizador_restante = 0;
+}
+
+// Programa a ação da entrada para o passo e, se ela tem duração, o seu fim
+static void programar_acao(ContextoSimulacao *ctx,
+                           const EntradaRoteiro *entrada, uint64_t passo) {
+  linha_tempo_programar(&ctx->linha_tempo, passo, entrada->acao,
+                        entrada->valor);
+  if (entrada->duracao > 0.0) {
+    uint64_t duracao = passos_de(ctx, entrada->duracao);
+    AcaoRoteiro fim = entrada->acao == ROTEIRO_QUEIMA ? ROTEIRO_FIM_QUEIMA
+                                                      : ROTEIRO_FIM_BLACKOUT;
+    linha_tempo_programar(&ctx->linha_tempo,
+                          passo + (duracao > 0 ? duracao : 1), fim, 0.0);
+  }
+}
+
+bool contexto_carregar_roteiro(ContextoSimulacao *ctx,
+                               const RoteiroMissao *roteiro) {
+  CondicoesRoteiro *condicoes = &ctx->condicoes;
+  if (ctx->linha_tempo.n + roteiro->eventos > LINHA_TEMPO_EVENTOS_MAX ||
+      condicoes->n + roteiro->condicoes > ROTEIRO_CONDICOES_MAX)
+    return false;
+  condicoes->estado_visto = ctx->nave->estado_missao;
+  memcpy(condicoes->ocorrencias_vistas, ctx->eventos.ocorrencias,
+         sizeof(condicoes->ocorrencias_vistas));
+
+  for (size_t i = 0; i < roteiro->n; i++) {
+    const EntradaRoteiro *entrada = &roteiro->entradas[i];
+    if (entrada->gatilho == GATILHO_INSTANTE) {
+      if (entrada->instante < ctx->tempo)
+        continue;
+      uint64_t passos = passos_de(ctx, entrada->instante - ctx->tempo);
+      programar_acao(ctx, entrada, ctx->passos + (passos > 0 ? passos : 1));
+      continue;
+    }
+    condicoes->entradas[condicoes->n++] = *entrada;
+    if (entrada->gatilho == GATILHO_EVENTO)
+      condicoes->eventos |= 1u << entrada->alvo;
+  }
+  return true;
+}
+
+// Dispara as condicionais da transição de estado ou dos eventos novos desde
+// o último passo. Sem nenhuma das duas coisas, só compara contadores.
+static void verificar_condicoes(ContextoSimulacao *ctx, uint64_t passo) {
+  CondicoesRoteiro *condicoes = &ctx->condicoes;
+  if (condicoes->n == 0)
+    return;
+
+  unsigned int novos = 0;
+  for (unsigned int e = 0; e < EVENTOS_MAX; e++)
+    if ((condicoes->eventos >> e & 1u) &&
+        ctx->eventos.ocorrencias[e] != condicoes->ocorrencias_vistas[e]) {
+      condicoes->ocorrencias_vistas[e] = ctx->eventos.ocorrencias[e];
+      novos |= 1u << e;
+    }
+  EstadoMissao anterior = condicoes->estado_visto;
+  EstadoMissao estado = ctx->nave->estado_missao;
+  if (estado == anterior && !novos)
+    return;
+  condicoes->estado_visto = estado;
+
+  for (size_t i = 0; i < condicoes->n; i++) {
+    const EntradaRoteiro *entrada = &condicoes->entradas[i];
+    if (condicoes->disparadas >> i & 1u)
+      continue;
+    // Estados avançados de uma vez (comandos) também disparam as suas
+    bool disparou =
+        entrada->gatilho == GATILHO_ESTADO
+            ? estado != anterior &&
+                  (entrada->alvo == (int)estado ||
+                   (estado != EMERGENCIA && entrada->alvo > (int)anterior &&
+                    entrada->alvo < (int)estado))
+            : (novos >> entrada->alvo & 1u) != 0;
+    if (!disparou)
+      continue;
+    condicoes->disparadas |= 1ULL << i;
+    programar_acao(ctx, entrada, passo + passos_de(ctx, entrada->instante));
+  }
+}
+
+static void executar_acao(ContextoSimulacao *ctx, AcaoRoteiro acao,
+                          double valor, uint64_t passo) {
+  EstadoNave *nave = ctx->nave;
+  bool encerrada = nave->estado_missao == EMERGENCIA ||
+                   nave->estado_missao == FINALIZACAO;
+  switch (acao) {
+  case ROTEIRO_TEMPORIZADOR:
+    ctx->temporizador = SEM_EVENTO;
+    if (encerrada || ctx->sequenciador == SEQUENCIADOR_ROTEIRO)
+      return;
+    contexto_avancar_estado(ctx);
+    reiniciar_temporizador(ctx, passo);
+    return;
+  case ROTEIRO_AVANCAR:
+    if (!encerrada)
+      contexto_avancar_estado(ctx);
+    break;
+  case ROTEIRO_EMERGENCIA:
+    entrar_emergencia(nave);
+    break;
+  case ROTEIRO_QUEIMA:
+    ctx->propulsao.empuxo_roteiro = valor;
+    break;
+  case ROTEIRO_FIM_QUEIMA:
+    ctx->propulsao.empuxo_roteiro = 0.0;
+    break;
+  case ROTEIRO_SEPARAR:
+    // O veículo parte do estado da nave neste instante
+    if (ctx->integrador.tipo == INTEGRADOR_DP54)
+      sincronizar_fisica(ctx);
+    veiculos_avancar(&ctx->veiculos, ctx->tempo);
+    veiculos_separar_tipo(&ctx->veiculos, nave, (TipoVeiculo)valor);
+    break;
+  case ROTEIRO_BLACKOUT:
+    nave->comunicacao_ativa = false;
+    nave->forca_sinal = 0.0;
+    break;
+  case ROTEIRO_FIM_BLACKOUT:
+    nave->comunicacao_ativa = true;
+    nave->forca_sinal = 100.0;
+    break;
+  case ROTEIRO_FALHA_ENERGIA:
+    nave->energia_principal = 0.0;
+    break;
+  }
+  ctx->acoes_roteiro++;
+}
+
+// Fim do passo: condicionais do roteiro, evento de saída do estado e o que
+// vence na linha do tempo, nesta ordem
+static void atualizar_sequenciador_contexto(ContextoSimulacao *ctx) {
+  EstadoNave *nave = ctx->nave;
+  uint64_t passo = ctx->passos + 1;
+  verificar_condicoes(ctx, passo);
+
+  TipoEvento tipo;
+  if (ctx->sequenciador == SEQUENCIADOR_EVENTOS &&
+      evento_de_saida(nave->estado_missao, &tipo)) {
+    suspender_temporizador(ctx, passo);
+    // Todos os eventos de saída são cruzamentos descendentes
+    if (eventos_consumir(&ctx->eventos, tipo, CRUZAMENTO_DESCENDO)) {
+      contexto_avancar_estado(ctx);
+      reiniciar_temporizador(ctx, passo);
+    }
+  } else if (ctx->temporizador_restante > 0) {
+    retomar_temporizador(ctx, passo);
+  }
+
+  if (linha_tempo_ociosa(&ctx->linha_tempo, passo))
+    return;
+  EventoProgramado evento;
+  while (linha_tempo_retirar(&ctx->linha_tempo, passo, &evento))
+    executar_acao(ctx, (AcaoRoteiro)evento.tipo, evento.valor, passo);
+}
+
+uint64_t contexto_proximo_evento(const ContextoSimulacao *ctx) {
+  return linha_tempo_proximo_vencimento(&ctx->linha_tempo);
+}
+
+// Com o sequenciador por eventos, um estado que espera por um evento precisa
+// da física em dia a cada ciclo para percebê-lo a tempo
+static bool aguardando_evento(const ContextoSimulacao *ctx) {
+  TipoEvento tipo;
+  return ctx->sequenciador == SEQUENCIADOR_EVENTOS &&
+         evento_de_saida(ctx->nave->estado_missao, &tipo);
+}
+
+// Fim do passo: separações da transição de estado, se houve uma, e o passo
+// dos veículos secundários quando vence o período da propulsão. Sem
+// separações nem veículos, não altera nada.
+static void atualizar_veiculos(ContextoSimulacao *ctx) {
+  TabelaVeiculos *veiculos = &ctx->veiculos;
+  if (veiculos->separacoes &&
+      ctx->nave->estado_missao != veiculos->estado_visto) {
+    // Os veículos separados partem do estado da nave neste instante
+    if (ctx->integrador.tipo == INTEGRADOR_DP54)
+      sincronizar_fisica(ctx);
+    veiculos_avancar(veiculos, ctx->tempo);
+    veiculos_separar(veiculos, ctx->nave);
+  }
+  if (veiculos->n > 0 && ctx->passos % ctx->passos_propulsao == 0)
+    veiculos_avancar(veiculos, ctx->tempo);
+}
+
+static void passo_contexto_adaptativo(ContextoSimulacao *ctx) {
+  EstadoNave *nave = ctx->nave;
+
+  // Voo propulsado ou descida controlada: a física acompanha cada ciclo
+  if (nave->empuxo_principal != 0.0 || nave->estado_missao == ALUNISSAGEM ||
+      aguardando_evento(ctx))
+    sincronizar_fisica(ctx);
+
+  double empuxo_anterior = nave->empuxo_principal;
+  executar_subsistemas(ctx);
+
+  // O trecho balístico pendente foi percorrido com o empuxo anterior
+  if (nave->empuxo_principal != empuxo_anterior) {
+    double empuxo_novo = nave->empuxo_principal;
+    nave->empuxo_principal = empuxo_anterior;
+    sincronizar_fisica(ctx);
+    nave->empuxo_principal = empuxo_novo;
+  }
+
+  ctx->tempo += ctx->dt;
+  atualizar_sequenciador_contexto(ctx);
+  ctx->passos++;
+  atualizar_veiculos(ctx);
+}
+
+void passo_contexto(ContextoSimulacao *ctx) {
+  if (ctx->integrador.tipo == INTEGRADOR_DP54) {
+    passo_contexto_adaptativo(ctx);
+    return;
+  }
+
+  EstadoNave *nave = ctx->nave;
+  double dt = ctx->dt;
+
+  // Subsistemas primeiro: o empuxo comandado vale para o passo seguinte
+  executar_subsistemas(ctx);
+
+  integrar_intervalo(nave, dt, &ctx->integrador, &ctx->estado_integrador,
+                     &ctx->eventos);
+  ctx->tempo = nave->tempo_missao;
+  atualizar_sequenciador_contexto(ctx);
+  ctx->passos++;
+  atualizar_veiculos(ctx);
+}
+
+void finalizar_contexto(ContextoSimulacao *ctx) {
+  if (ctx->integrador.tipo == INTEGRADOR_DP54)
+    sincronizar_fisica(ctx);
+}
+
+void estado_atual_contexto(const ContextoSimulacao *ctx, EstadoNave *destino) {
+  *destino = *ctx->nave;
+  double pendente = ctx->tempo - destino->tempo_missao;
+  if (ctx->integrador.tipo != INTEGRADOR_DP54 || pendente <= 0.0)
+    return;
+
+  EstadoIntegrador estado_integrador = ctx->estado_integrador;
+  ContextoEventos eventos = ctx->eventos;
+  integrar_intervalo(destino, pendente, &ctx->integrador, &estado_integrador,
+                     &eventos);
+  destino->tempo_missao = ctx->tempo;
+}
+
+bool contexto_encerrado(const ContextoSimulacao *ctx, double duracao_max) {
+  const EstadoNave *nave = ctx->nave;
+  return nave->estado_missao == FINALIZACAO ||
+         nave->estado_missao == EMERGENCIA || ctx->tempo >= duracao_max;
+}
+
+ModoSequenciador obter_modo_sequenciador(const char *nome, bool *valido) {
+  *valido = true;
+  if (strcmp(nome, "tempo") == 0)
+    return SEQUENCIADOR_TEMPO;
+  if (strcmp(nome, "eventos") == 0)
+    return SEQUENCIADOR_EVENTOS;
+  if (strcmp(nome, "roteiro") == 0)
+    return SEQUENCIADOR_ROTEIRO;
+  *valido = false;
+  return SEQUENCIADOR_TEMPO;
+}
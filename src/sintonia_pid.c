@@ -0,0 +1,239 @@
+#include "sintonia_pid.h"
+#include "physics_engine.h"
+#include "pool_threads.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define PARETO_IMPRESSOS 20 // pontos da fronteira listados
+
+typedef struct {
+  double kp, ki, kd;
+  ResultadoDescida resultado;
+} CandidatoSintonia;
+
+typedef struct {
+  const ConfiguracaoSintonia *config;
+  ControlePropulsao nominal;
+  CandidatoSintonia *candidatos;
+} LoteSintonia;
+
+void configuracao_sintonia_padrao(ConfiguracaoSintonia *config) {
+  config->cenario = (CenarioDescida){.altitude = 1000.0,
+                                     .velocidade_vertical = -20.0,
+                                     .massa_seca = 6800.0,
+                                     .combustivel = 8200.0,
+                                     .tempo_max = 900.0};
+  config->pontos_por_eixo = 16;
+  config->fator_faixa = 10.0;
+  config->velocidade_max = 3.0;
+  config->threads = 0;
+}
+
+// Primeiro instante em (0, ciclo] em que a altitude zera, com aceleração
+// constante a partir de (altitude, velocidade)
+static double instante_toque(double altitude, double velocidade,
+                             double aceleracao) {
+  double discriminante =
+      velocidade * velocidade - 2.0 * aceleracao * altitude;
+  double raiz = sqrt(discriminante > 0.0 ? discriminante : 0.0);
+  // Forma estável: evita a subtração de valores próximos
+  if (velocidade < 0.0)
+    return 2.0 * altitude / (raiz - velocidade);
+  return (-velocidade - raiz) / aceleracao;
+}
+
+void simular_descida(const ControlePropulsao *controle,
+                     const CenarioDescida *cenario,
+                     ResultadoDescida *resultado) {
+  ControladorPID pid = controle->pid_descida;
+  pid.integral_erro = 0.0;
+  pid.erro_anterior = 0.0;
+
+  double ciclo = INTERVALO_PROPULSAO / 1e6;
+  double vazao_por_newton =
+      controle->vazao_lancamento / controle->empuxo_lancamento;
+  double altitude = cenario->altitude;
+  double velocidade = cenario->velocidade_vertical;
+  double combustivel = cenario->combustivel;
+  double tempo = 0.0;
+  *resultado = (ResultadoDescida){0};
+
+  while (tempo < cenario->tempo_max) {
+    // Propulsão primeiro, como no executivo: o PID vê a velocidade do fim
+    // do ciclo anterior
+    double empuxo = passo_pid_descida(&pid, velocidade, ciclo);
+    if (empuxo <= 0.0 || empuxo >= pid.empuxo_max)
+      resultado->tempo_saturado += ciclo;
+    if (combustivel <= 0.0)
+      empuxo = 0.0;
+    combustivel -= empuxo * vazao_por_newton * ciclo;
+    if (combustivel < 0.0)
+      combustivel = 0.0;
+
+    double raio = RAIO_MIN_LUA + altitude;
+    double aceleracao = empuxo / (cenario->massa_seca + combustivel) -
+                        G * M_LUA / (raio * raio);
+
+    double altitude_final =
+        altitude + velocidade * ciclo + 0.5 * aceleracao * ciclo * ciclo;
+    if (altitude_final <= 0.0) {
+      double t = instante_toque(altitude, velocidade, aceleracao);
+      resultado->pousou = true;
+      resultado->velocidade_toque = fabs(velocidade + aceleracao * t);
+      resultado->tempo_descida = tempo + t;
+      break;
+    }
+    altitude = altitude_final;
+    velocidade += aceleracao * ciclo;
+    tempo += ciclo;
+  }
+
+  resultado->combustivel_usado = cenario->combustivel - combustivel;
+  if (!resultado->pousou)
+    resultado->tempo_descida = tempo;
+}
+
+static void avaliar_ganhos(size_t indice, void *arg) {
+  LoteSintonia *lote = arg;
+  CandidatoSintonia *candidato = &lote->candidatos[indice];
+  ControlePropulsao controle = lote->nominal;
+  controle.pid_descida.kp = candidato->kp;
+  controle.pid_descida.ki = candidato->ki;
+  controle.pid_descida.kd = candidato->kd;
+  simular_descida(&controle, &lote->config->cenario, &candidato->resultado);
+}
+
+static bool aprovado(const CandidatoSintonia *c, double velocidade_max) {
+  return c->resultado.pousou &&
+         c->resultado.velocidade_toque <= velocidade_max;
+}
+
+// a não é pior que b em nenhum critério: b é dominado por a, ou idêntico
+static bool cobre(const ResultadoDescida *a, const ResultadoDescida *b) {
+  return a->velocidade_toque <= b->velocidade_toque &&
+         a->combustivel_usado <= b->combustivel_usado &&
+         a->tempo_saturado <= b->tempo_saturado;
+}
+
+// Ordem lexicográfica dos critérios: nenhum candidato domina um anterior
+static int comparar_criterios(const void *a, const void *b) {
+  const CandidatoSintonia *ca = *(const CandidatoSintonia *const *)a;
+  const CandidatoSintonia *cb = *(const CandidatoSintonia *const *)b;
+  const ResultadoDescida *ra = &ca->resultado, *rb = &cb->resultado;
+  if (ra->velocidade_toque != rb->velocidade_toque)
+    return ra->velocidade_toque < rb->velocidade_toque ? -1 : 1;
+  if (ra->combustivel_usado != rb->combustivel_usado)
+    return ra->combustivel_usado < rb->combustivel_usado ? -1 : 1;
+  return (ra->tempo_saturado > rb->tempo_saturado) -
+         (ra->tempo_saturado < rb->tempo_saturado);
+}
+
+static double ponto_log(double nominal, double fator, int n, int i) {
+  if (n < 2)
+    return nominal;
+  return nominal * pow(fator, 2.0 * i / (n - 1) - 1.0);
+}
+
+static void imprimir_descida(const char *rotulo, const ControladorPID *pid,
+                             const ResultadoDescida *r) {
+  printf("  %-8s kp=%10.1f ki=%10.1f kd=%10.1f  ", rotulo, pid->kp, pid->ki,
+         pid->kd);
+  if (r->pousou)
+    printf("toque %6.3f m/s  combustivel %7.1f kg  saturado %6.1f s\n",
+           r->velocidade_toque, r->combustivel_usado, r->tempo_saturado);
+  else
+    printf("sem toque em %.0f s\n", r->tempo_descida);
+}
+
+int executar_sintonia_pid(const ConfiguracaoSintonia *config) {
+  int n = config->pontos_por_eixo;
+  if (n < 1 || config->fator_faixa < 1.0 || config->cenario.altitude <= 0.0) {
+    fprintf(stderr, "sintonia-pid: configuracao invalida\n");
+    return 1;
+  }
+
+  size_t total = (size_t)n * n * n;
+  int threads = config->threads > 0 ? config->threads : obter_numero_nucleos();
+  CandidatoSintonia *candidatos = calloc(total, sizeof(CandidatoSintonia));
+  CandidatoSintonia **fronteira = malloc(total * sizeof(CandidatoSintonia *));
+  if (!candidatos || !fronteira) {
+    fprintf(stderr, "sintonia-pid: memoria insuficiente\n");
+    free(candidatos);
+    free(fronteira);
+    return 1;
+  }
+
+  LoteSintonia lote = {.config = config, .candidatos = candidatos};
+  inicializar_controle_propulsao(&lote.nominal);
+  const ControladorPID *nominal = &lote.nominal.pid_descida;
+  size_t k = 0;
+  for (int i = 0; i < n; i++)
+    for (int j = 0; j < n; j++)
+      for (int l = 0; l < n; l++) {
+        candidatos[k].kp = ponto_log(nominal->kp, config->fator_faixa, n, i);
+        candidatos[k].ki = ponto_log(nominal->ki, config->fator_faixa, n, j);
+        candidatos[k].kd = ponto_log(nominal->kd, config->fator_faixa, n, l);
+        k++;
+      }
+
+  struct timespec inicio, fim;
+  clock_gettime(CLOCK_MONOTONIC, &inicio);
+  executar_em_paralelo(total, threads, avaliar_ganhos, &lote);
+  clock_gettime(CLOCK_MONOTONIC, &fim);
+  double tempo_real =
+      (fim.tv_sec - inicio.tv_sec) + (fim.tv_nsec - inicio.tv_nsec) / 1e9;
+
+  // Fronteira de Pareto entre as descidas aprovadas. Em ordem
+  // lexicográfica, basta comparar cada candidato com a fronteira já
+  // formada: quem é dominado por alguém também é dominado por um ponto dela.
+  // Resultados idênticos entram uma vez só
+  size_t aprovados = 0;
+  for (size_t i = 0; i < total; i++)
+    if (aprovado(&candidatos[i], config->velocidade_max))
+      fronteira[aprovados++] = &candidatos[i];
+  qsort(fronteira, aprovados, sizeof(CandidatoSintonia *), comparar_criterios);
+
+  size_t n_fronteira = 0;
+  for (size_t i = 0; i < aprovados; i++) {
+    bool dominado = false;
+    for (size_t j = 0; j < n_fronteira && !dominado; j++)
+      dominado = cobre(&fronteira[j]->resultado, &fronteira[i]->resultado);
+    if (!dominado)
+      fronteira[n_fronteira++] = fronteira[i];
+  }
+
+  printf("Sintonia PID: %zu descidas em %.3f s (%.0f descidas/s), %d "
+         "threads\n",
+         total, tempo_real, tempo_real > 0 ? total / tempo_real : 0.0,
+         threads);
+  printf("  Cenario: %.0f m a %.1f m/s, %.0f kg + %.0f kg de combustivel\n",
+         config->cenario.altitude, config->cenario.velocidade_vertical,
+         config->cenario.massa_seca, config->cenario.combustivel);
+
+  ResultadoDescida resultado_nominal;
+  simular_descida(&lote.nominal, &config->cenario, &resultado_nominal);
+  imprimir_descida("atual", nominal, &resultado_nominal);
+
+  printf("  Aprovadas (toque <= %.1f m/s): %zu/%zu; fronteira de Pareto: "
+         "%zu\n",
+         config->velocidade_max, aprovados, total, n_fronteira);
+
+  // Fronteira longa: amostra espaçada ao longo da velocidade de toque
+  size_t impressos =
+      n_fronteira < PARETO_IMPRESSOS ? n_fronteira : PARETO_IMPRESSOS;
+  for (size_t i = 0; i < impressos; i++) {
+    size_t indice = impressos > 1 ? i * (n_fronteira - 1) / (impressos - 1) : 0;
+    const CandidatoSintonia *c = fronteira[indice];
+    ControladorPID pid = {.kp = c->kp, .ki = c->ki, .kd = c->kd};
+    imprimir_descida("pareto", &pid, &c->resultado);
+  }
+  if (n_fronteira > 0)
+    printf("  Para testar na missao: --ramo kp=%.1f,ki=%.1f,kd=%.1f\n",
+           fronteira[0]->kp, fronteira[0]->ki, fronteira[0]->kd);
+
+  free(candidatos);
+  free(fronteira);
+  return 0;
+}
@@ -0,0 +1,74 @@
+#include "snapshot_estado.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+// O que é publicado: a nave e o rótulo do veículo, numa única sequência
+typedef struct {
+  EstadoNave nave;
+  RotuloVeiculo rotulo;
+} ConteudoSnapshot;
+
+#define PALAVRAS_SNAPSHOT (sizeof(ConteudoSnapshot) / sizeof(uint64_t))
+
+static_assert(sizeof(ConteudoSnapshot) % sizeof(uint64_t) == 0,
+              "ConteudoSnapshot deve ocupar um número inteiro de palavras");
+
+// O conteúdo é guardado em palavras atômicas acessadas com ordem relaxada:
+// leituras concorrentes com a escrita são bem definidas e descartadas pela
+// verificação da sequência. Sequência e conteúdo começam numa linha de cache
+// própria, fora das linhas de outros dados globais. A sequência é ímpar
+// durante a escrita.
+static alignas(TAM_LINHA_CACHE) atomic_uint sequencia_snapshot = 0;
+static _Atomic uint64_t palavras_snapshot[PALAVRAS_SNAPSHOT];
+
+void publicar_snapshot(const EstadoNave *nave, const RotuloVeiculo *rotulo) {
+  ConteudoSnapshot conteudo;
+  memset(&conteudo, 0, sizeof(conteudo)); // sem bytes indeterminados
+  conteudo.nave = *nave;
+  if (rotulo)
+    conteudo.rotulo = *rotulo;
+  else
+    veiculos_rotulo(NULL, -1, &conteudo.rotulo);
+  uint64_t copia[PALAVRAS_SNAPSHOT];
+  memcpy(copia, &conteudo, sizeof(copia));
+
+  unsigned int seq =
+      atomic_load_explicit(&sequencia_snapshot, memory_order_relaxed);
+  atomic_store_explicit(&sequencia_snapshot, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  for (size_t i = 0; i < PALAVRAS_SNAPSHOT; i++)
+    atomic_store_explicit(&palavras_snapshot[i], copia[i],
+                          memory_order_relaxed);
+
+  atomic_store_explicit(&sequencia_snapshot, seq + 2, memory_order_release);
+}
+
+bool ler_snapshot(EstadoNave *destino, RotuloVeiculo *rotulo) {
+  uint64_t copia[PALAVRAS_SNAPSHOT];
+  unsigned int inicio, fim;
+
+  do {
+    inicio = atomic_load_explicit(&sequencia_snapshot, memory_order_acquire);
+    if (inicio == 0)
+      return false;
+    if (inicio & 1u)
+      continue; // escrita em andamento
+
+    for (size_t i = 0; i < PALAVRAS_SNAPSHOT; i++)
+      copia[i] =
+          atomic_load_explicit(&palavras_snapshot[i], memory_order_relaxed);
+
+    atomic_thread_fence(memory_order_acquire);
+    fim = atomic_load_explicit(&sequencia_snapshot, memory_order_relaxed);
+  } while (inicio & 1u || inicio != fim);
+
+  ConteudoSnapshot conteudo;
+  memcpy(&conteudo, copia, sizeof(copia));
+  *destino = conteudo.nave;
+  if (rotulo)
+    *rotulo = conteudo.rotulo;
+  return true;
+}
@@ -1,151 +1,139 @@
 #include "systems_control.h"
+#include <math.h>
 #include <stdlib.h>
-#include <unistd.h>
-
-#define INTERVALO_PROPULSAO 50000 // 50ms
-#define INTERVALO_ENERGIA 200000  // 200ms
-
-// Variáveis para Controlador PID de Descida
-static double integral_erro_velocidade = 0.0;
-static double erro_velocidade_anterior = 0.0;
-static const double kp = 30000.0; // Ganho proporcional
-static const double ki = 5000.0;  // Ganho integral
-static const double kd = 15000.0; // Ganho derivativo
-
-void *controle_propulsao(void *arg) {
-  (void)arg;
-  double delta_tempo = INTERVALO_PROPULSAO / 1000000.0;
-
-  while (atomic_load(&estado_nave.sistema_ativo)) {
-    pthread_mutex_lock(&mutex_estado);
-
-    int fator_aceleracao = atomic_load(&estado_nave.simulacao_acelerada);
-    double dt_real = delta_tempo * fator_aceleracao;
-
-    switch (estado_nave.estado_missao) {
-    case LANCAMENTO:
-      // Durante o lançamento, usamos empuxo máximo (35 MN)
-      estado_nave.empuxo_principal = 35000000.0;
-      estado_nave.combustivel_principal -= 15000.0 * dt_real;
-      break;
-
-    case ALUNISSAGEM: {
-      // Controlador PID para pouso suave (-2.0 m/s na vertical / eixo Y)
-      double setpoint = -2.0;
-
-      // Considerando velocidade.y como velocidade de descida
-      double velocidade_atual = estado_nave.velocidade.y;
-      double erro = setpoint - velocidade_atual;
-
-      integral_erro_velocidade += erro * dt_real;
-      double derivada_erro = (erro - erro_velocidade_anterior) / dt_real;
-
-      // Calculando força baseada na malha PID
-      double empuxo_pid =
-          (kp * erro) + (ki * integral_erro_velocidade) + (kd * derivada_erro);
-
-      // Limites operacionais do motor de descida (Módulo Lunar: max 45kN)
-      if (empuxo_pid < 0)
-        empuxo_pid = 0;
-      if (empuxo_pid > 45000.0)
-        empuxo_pid = 45000.0;
-
-      estado_nave.empuxo_principal = empuxo_pid;
-      estado_nave.combustivel_principal -=
-          (empuxo_pid / 35000000.0 * 15000.0) *
-          dt_real; // Escala baseada no empuxo real
-
-      erro_velocidade_anterior = erro;
-      break;
-    }
-    default:
-      if (rand() % 100 < 5 && estado_nave.estado_missao != SUPERFICIE_LUNAR &&
-          estado_nave.estado_missao != FINALIZACAO) {
-        estado_nave.empuxo_rcs = 500.0;
-        estado_nave.combustivel_rcs -= 0.1 * dt_real;
-      } else {
-        estado_nave.empuxo_rcs = 0.0;
-      }
-      estado_nave.empuxo_principal = 0.0;
-      break;
-    }
 
-    // Segurança do array de combustíveis
-    if (estado_nave.combustivel_principal < 0)
-      estado_nave.combustivel_principal = 0;
-    if (estado_nave.combustivel_rcs < 0)
-      estado_nave.combustivel_rcs = 0;
+void inicializar_controle_propulsao(ControlePropulsao *controle) {
+  controle->empuxo_lancamento = 35000000.0; // 35 MN
+  controle->vazao_lancamento = 15000.0;     // kg/s
+
+  // Controlador PID de Descida
+  controle->pid_descida.kp = 30000.0; // Ganho proporcional
+  controle->pid_descida.ki = 5000.0;  // Ganho integral
+  controle->pid_descida.kd = 15000.0; // Ganho derivativo
+  controle->pid_descida.empuxo_max = 45000.0;
+  controle->pid_descida.integral_erro = 0.0;
+  controle->pid_descida.erro_anterior = 0.0;
+  controle->autonomia_ciclo = INFINITY;
+  controle->empuxo_roteiro = 0.0;
+}
 
-    pthread_mutex_unlock(&mutex_estado);
-    usleep(INTERVALO_PROPULSAO / fator_aceleracao);
-  }
-  return NULL;
+// Sem combustível não há empuxo. Com menos do que o ciclo consome, o motor
+// apaga no meio dele: a autonomia marca o instante para o evento de
+// esgotamento.
+static void queimar(EstadoNave *nave, ControlePropulsao *controle,
+                    double empuxo, double dt_real) {
+  if (nave->combustivel_principal <= 0.0)
+    empuxo = 0.0;
+  double vazao =
+      empuxo / controle->empuxo_lancamento * controle->vazao_lancamento;
+  double consumo = vazao * dt_real;
+  if (consumo > nave->combustivel_principal)
+    controle->autonomia_ciclo = nave->combustivel_principal / vazao;
+
+  nave->empuxo_principal = empuxo;
+  nave->combustivel_principal -= consumo;
 }
 
-void *controle_energia(void *arg) {
-  (void)arg;
-  double delta_tempo = INTERVALO_ENERGIA / 1000000.0;
-
-  // Semente local / rand em thread separada para não causar deadlocks na base
-  // rand() se usada em paralelos perigosos
-  unsigned int seed = 12345;
-
-  while (atomic_load(&estado_nave.sistema_ativo)) {
-    pthread_mutex_lock(&mutex_estado);
-
-    int fator_aceleracao = atomic_load(&estado_nave.simulacao_acelerada);
-    double dt_real = delta_tempo * fator_aceleracao;
-
-    double consumo_base = 80.0;
-    double consumo_propulsao = estado_nave.empuxo_principal > 0 ? 50.0 : 0.0;
-    double consumo_rcs = estado_nave.empuxo_rcs > 0 ? 20.0 : 0.0;
-    double consumo_computadores = 30.0;
-    double consumo_suporte_vida = 40.0;
-
-    estado_nave.consumo_energia = consumo_base + consumo_propulsao +
-                                  consumo_rcs + consumo_computadores +
-                                  consumo_suporte_vida;
-
-    double energia_consumida = estado_nave.consumo_energia * dt_real / 3600.0;
-    estado_nave.energia_principal -= energia_consumida;
-
-    if (estado_nave.energia_principal <= 0) {
-      estado_nave.energia_reserva += estado_nave.energia_principal;
-      estado_nave.energia_principal = 0;
-
-      if (estado_nave.energia_reserva <= 0) {
-        estado_nave.energia_reserva = 0;
-        if (estado_nave.estado_missao != EMERGENCIA) {
-          pthread_mutex_unlock(&mutex_estado);
-          acionar_emergencia("Energia esgotada");
-          pthread_mutex_lock(&mutex_estado);
-        }
-      }
-    }
+double passo_pid_descida(ControladorPID *pid, double velocidade_vertical,
+                         double dt_real) {
+  // Controlador PID para pouso suave (-2.0 m/s na vertical / eixo Y)
+  double setpoint = VELOCIDADE_DESCIDA_ALVO;
+  double erro = setpoint - velocidade_vertical;
 
-    // Simula flutuações de temperatura
-    double variacao_temp = ((rand_r(&seed) % 100) - 50) / 500.0;
-    estado_nave.temperatura_interna += variacao_temp;
-
-    // Malha termal simulação simples
-    if (estado_nave.temperatura_interna < 20.0) {
-      estado_nave.temperatura_interna += 0.2 * dt_real;
-      estado_nave.consumo_energia += 10.0;
-    } else if (estado_nave.temperatura_interna > 24.0) {
-      estado_nave.temperatura_interna -= 0.2 * dt_real;
-      estado_nave.consumo_energia += 10.0;
-    }
+  pid->integral_erro += erro * dt_real;
+  double derivada_erro = (erro - pid->erro_anterior) / dt_real;
 
-    if (estado_nave.estado_missao == TRANSITO_LUNAR ||
-        estado_nave.estado_missao == ORBITA_LUNAR ||
-        estado_nave.estado_missao == SUPERFICIE_LUNAR) {
-      estado_nave.radiacao = 1.0 + ((rand_r(&seed) % 100) / 100.0);
+  // Calculando força baseada na malha PID
+  double empuxo_pid = (pid->kp * erro) + (pid->ki * pid->integral_erro) +
+                      (pid->kd * derivada_erro);
+
+  // Limites operacionais do motor de descida (Módulo Lunar: max 45kN)
+  if (empuxo_pid < 0)
+    empuxo_pid = 0;
+  if (empuxo_pid > pid->empuxo_max)
+    empuxo_pid = pid->empuxo_max;
+
+  pid->erro_anterior = erro;
+  return empuxo_pid;
+}
+
+void passo_propulsao(EstadoNave *nave, ControlePropulsao *controle,
+                     double dt_real, unsigned int *seed) {
+  controle->autonomia_ciclo = INFINITY;
+  switch (nave->estado_missao) {
+  case LANCAMENTO:
+    // Durante o lançamento, usamos empuxo máximo (35 MN)
+    queimar(nave, controle, controle->empuxo_lancamento, dt_real);
+    break;
+
+  case ALUNISSAGEM: {
+    // Consumo escalado pelo empuxo real
+    double empuxo_pid =
+        passo_pid_descida(&controle->pid_descida, nave->velocidade.y, dt_real);
+    queimar(nave, controle, empuxo_pid, dt_real);
+    break;
+  }
+  default:
+    if (rand_r(seed) % 100 < 5 && nave->estado_missao != SUPERFICIE_LUNAR &&
+        nave->estado_missao != FINALIZACAO) {
+      nave->empuxo_rcs = 500.0;
+      nave->combustivel_rcs -= 0.1 * dt_real;
     } else {
-      estado_nave.radiacao = 0.1 + ((rand_r(&seed) % 50) / 500.0);
+      nave->empuxo_rcs = 0.0;
     }
+    // Motor principal desligado, a não ser numa queima do roteiro
+    queimar(nave, controle, controle->empuxo_roteiro, dt_real);
+    break;
+  }
+
+  // Segurança do array de combustíveis
+  if (nave->combustivel_principal < 0)
+    nave->combustivel_principal = 0;
+  if (nave->combustivel_rcs < 0)
+    nave->combustivel_rcs = 0;
+}
+
+void passo_energia(EstadoNave *nave, double dt_real, unsigned int *seed) {
+  double consumo_base = 80.0;
+  double consumo_propulsao = nave->empuxo_principal > 0 ? 50.0 : 0.0;
+  double consumo_rcs = nave->empuxo_rcs > 0 ? 20.0 : 0.0;
+  double consumo_computadores = 30.0;
+  double consumo_suporte_vida = 40.0;
+
+  nave->consumo_energia = consumo_base + consumo_propulsao + consumo_rcs +
+                          consumo_computadores + consumo_suporte_vida;
+
+  double energia_consumida = nave->consumo_energia * dt_real / 3600.0;
+  nave->energia_principal -= energia_consumida;
+
+  if (nave->energia_principal <= 0) {
+    nave->energia_reserva += nave->energia_principal;
+    nave->energia_principal = 0;
+
+    if (nave->energia_reserva <= 0) {
+      nave->energia_reserva = 0;
+      nave->energia_esgotada = true; // o sequenciador declara a emergência
+    }
+  }
+
+  // Simula flutuações de temperatura
+  double variacao_temp = ((rand_r(seed) % 100) - 50) / 500.0;
+  nave->temperatura_interna += variacao_temp;
+
+  // Malha termal simulação simples
+  if (nave->temperatura_interna < 20.0) {
+    nave->temperatura_interna += 0.2 * dt_real;
+    nave->consumo_energia += 10.0;
+  } else if (nave->temperatura_interna > 24.0) {
+    nave->temperatura_interna -= 0.2 * dt_real;
+    nave->consumo_energia += 10.0;
+  }
 
-    pthread_mutex_unlock(&mutex_estado);
-    usleep(INTERVALO_ENERGIA / fator_aceleracao);
+  if (nave->estado_missao == TRANSITO_LUNAR ||
+      nave->estado_missao == ORBITA_LUNAR ||
+      nave->estado_missao == SUPERFICIE_LUNAR) {
+    nave->radiacao = 1.0 + ((rand_r(seed) % 100) / 100.0);
+  } else {
+    nave->radiacao = 0.1 + ((rand_r(seed) % 50) / 500.0);
   }
-  return NULL;
 }
@@ -0,0 +1,503 @@
+#include "telemetria_binaria.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Pior caso de uma coluna codificada: varints de até 10 bytes mais o valor
+// inicial e o primeiro delta
+#define TAM_MAX_COLUNA (TELEMETRIA_AMOSTRAS_POR_BLOCO * 10 + 20)
+#define TAM_MAX_BLOCO                                                          \
+  (sizeof(CabecalhoBloco) + TELEMETRIA_N_CANAIS * TAM_MAX_COLUNA + 8)
+
+// O arquivo cresce em lotes para amortizar posix_fallocate/mmap
+#define BLOCOS_POR_CRESCIMENTO 64
+
+_Static_assert(sizeof(CabecalhoTelemetria) <= TELEMETRIA_TAM_CABECALHO,
+               "cabecalho de telemetria excede o espaco reservado");
+_Static_assert(sizeof(CabecalhoBloco) % 8 == 0,
+               "cabecalho de bloco deve manter o alinhamento de 8 bytes");
+_Static_assert(TAM_MAX_COLUNA <= UINT16_MAX,
+               "coluna codificada nao cabe em tamanho_coluna");
+
+static const char *nomes_canais[TELEMETRIA_N_CANAIS] = {
+    "Tempo_s",         "Estado",        "PosX_m",         "PosY_m",
+    "PosZ_m",          "VelX_ms",       "VelY_ms",        "VelZ_ms",
+    "AcelX_ms2",       "AcelY_ms2",     "AcelZ_ms2",      "Combustivel_kg",
+    "Comb_RCS_kg",     "Energia_Wh",    "Temperatura_C",  "Empuxo_N",
+    "Empuxo_RCS_N",    "Reserva_Wh",    "Consumo_W",      "Pressao_kPa",
+    "Radiacao_mSvh"};
+
+const char *obter_nome_canal(CanalTelemetria canal) {
+  return canal < TELEMETRIA_N_CANAIS ? nomes_canais[canal] : "?";
+}
+
+void telemetria_amostrar(const EstadoNave *nave,
+                         double valores[TELEMETRIA_N_CANAIS]) {
+  valores[CANAL_TEMPO] = nave->tempo_missao;
+  valores[CANAL_ESTADO] = (double)nave->estado_missao;
+  valores[CANAL_POS_X] = nave->posicao.x;
+  valores[CANAL_POS_Y] = nave->posicao.y;
+  valores[CANAL_POS_Z] = nave->posicao.z;
+  valores[CANAL_VEL_X] = nave->velocidade.x;
+  valores[CANAL_VEL_Y] = nave->velocidade.y;
+  valores[CANAL_VEL_Z] = nave->velocidade.z;
+  valores[CANAL_ACEL_X] = nave->aceleracao.x;
+  valores[CANAL_ACEL_Y] = nave->aceleracao.y;
+  valores[CANAL_ACEL_Z] = nave->aceleracao.z;
+  valores[CANAL_COMBUSTIVEL] = nave->combustivel_principal;
+  valores[CANAL_COMB_RCS] = nave->combustivel_rcs;
+  valores[CANAL_ENERGIA] = nave->energia_principal;
+  valores[CANAL_TEMPERATURA] = nave->temperatura_interna;
+  valores[CANAL_EMPUXO] = nave->empuxo_principal;
+  valores[CANAL_EMPUXO_RCS] = nave->empuxo_rcs;
+  valores[CANAL_ENERGIA_RESERVA] = nave->energia_reserva;
+  valores[CANAL_CONSUMO] = nave->consumo_energia;
+  valores[CANAL_PRESSAO] = nave->pressao_interna;
+  valores[CANAL_RADIACAO] = nave->radiacao;
+}
+
+void telemetria_restaurar_nave(const double valores[TELEMETRIA_N_CANAIS],
+                               EstadoNave *nave) {
+  memset(nave, 0, sizeof(*nave));
+  nave->tempo_missao = valores[CANAL_TEMPO];
+  nave->estado_missao = (EstadoMissao)valores[CANAL_ESTADO];
+  nave->posicao = (Vetor3D){valores[CANAL_POS_X], valores[CANAL_POS_Y],
+                            valores[CANAL_POS_Z]};
+  nave->velocidade = (Vetor3D){valores[CANAL_VEL_X], valores[CANAL_VEL_Y],
+                               valores[CANAL_VEL_Z]};
+  nave->aceleracao = (Vetor3D){valores[CANAL_ACEL_X], valores[CANAL_ACEL_Y],
+                               valores[CANAL_ACEL_Z]};
+  nave->combustivel_principal = valores[CANAL_COMBUSTIVEL];
+  nave->combustivel_rcs = valores[CANAL_COMB_RCS];
+  nave->energia_principal = valores[CANAL_ENERGIA];
+  nave->temperatura_interna = valores[CANAL_TEMPERATURA];
+  nave->empuxo_principal = valores[CANAL_EMPUXO];
+  nave->empuxo_rcs = valores[CANAL_EMPUXO_RCS];
+  nave->energia_reserva = valores[CANAL_ENERGIA_RESERVA];
+  nave->consumo_energia = valores[CANAL_CONSUMO];
+  nave->pressao_interna = valores[CANAL_PRESSAO];
+  nave->radiacao = valores[CANAL_RADIACAO];
+}
+
+// --- Codificação das colunas ---
+
+static inline uint64_t bits_double(double valor) {
+  uint64_t bits;
+  memcpy(&bits, &valor, sizeof(bits));
+  return bits;
+}
+
+static inline double double_bits(uint64_t bits) {
+  double valor;
+  memcpy(&valor, &bits, sizeof(valor));
+  return valor;
+}
+
+static inline uint64_t zigzag(uint64_t v) {
+  return (v << 1) ^ (uint64_t)((int64_t)v >> 63);
+}
+
+static inline uint64_t dezigzag(uint64_t v) {
+  return (v >> 1) ^ (0 - (v & 1));
+}
+
+static size_t escrever_varint(uint8_t *dst, uint64_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    dst[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  dst[n++] = (uint8_t)v;
+  return n;
+}
+
+static bool ler_varint(const uint8_t *src, size_t tamanho, size_t *pos,
+                       uint64_t *v) {
+  uint64_t resultado = 0;
+  for (int deslocamento = 0; deslocamento < 64; deslocamento += 7) {
+    if (*pos >= tamanho)
+      return false;
+    uint8_t byte = src[(*pos)++];
+    resultado |= (uint64_t)(byte & 0x7f) << deslocamento;
+    if (!(byte & 0x80)) {
+      *v = resultado;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Número de bytes não nulos a partir do menos significativo
+static inline int bytes_significativos(uint64_t v) {
+  return v ? 8 - __builtin_clzll(v) / 8 : 0;
+}
+
+// Séries lineares (tempo, consumo a vazão constante) viram zeros
+static size_t codificar_delta2(const double *coluna, uint32_t n,
+                               uint8_t *dst) {
+  uint64_t anterior = bits_double(coluna[0]);
+  memcpy(dst, &anterior, sizeof(anterior));
+  size_t pos = sizeof(anterior);
+  uint64_t delta_anterior = 0;
+  for (uint32_t i = 1; i < n; i++) {
+    uint64_t atual = bits_double(coluna[i]);
+    uint64_t delta = atual - anterior;
+    pos += escrever_varint(dst + pos, zigzag(delta - delta_anterior));
+    delta_anterior = delta;
+    anterior = atual;
+  }
+  return pos;
+}
+
+// Valores suaves compartilham sinal, expoente e mantissa alta com o
+// anterior; apenas os bytes baixos do XOR são gravados, com os tamanhos de
+// duas amostras empacotados em um byte de controle
+static size_t codificar_xor(const double *coluna, uint32_t n, uint8_t *dst) {
+  uint64_t anterior = bits_double(coluna[0]);
+  memcpy(dst, &anterior, sizeof(anterior));
+  size_t pos = sizeof(anterior);
+  for (uint32_t i = 1; i < n; i += 2) {
+    size_t controle = pos++;
+    dst[controle] = 0;
+    for (uint32_t k = 0; k < 2 && i + k < n; k++) {
+      uint64_t atual = bits_double(coluna[i + k]);
+      uint64_t x = atual ^ anterior;
+      int nb = bytes_significativos(x);
+      dst[controle] |= (uint8_t)(nb << (4 * k));
+      for (int b = 0; b < nb; b++)
+        dst[pos++] = (uint8_t)(x >> (8 * b));
+      anterior = atual;
+    }
+  }
+  return pos;
+}
+
+// Escolhe a menor codificação da coluna e a grava em dst
+static size_t codificar_coluna(const double *coluna, uint32_t n, uint8_t *dst,
+                               uint8_t *codificacao) {
+  uint64_t primeiro = bits_double(coluna[0]);
+  uint32_t i = 1;
+  while (i < n && bits_double(coluna[i]) == primeiro)
+    i++;
+  if (i == n) {
+    *codificacao = COLUNA_CONSTANTE;
+    memcpy(dst, &primeiro, sizeof(primeiro));
+    return sizeof(primeiro);
+  }
+
+  uint8_t rascunho[TAM_MAX_COLUNA];
+  size_t tam_delta2 = codificar_delta2(coluna, n, dst);
+  size_t tam_xor = codificar_xor(coluna, n, rascunho);
+  size_t tam_bruta = n * sizeof(double);
+
+  if (tam_delta2 <= tam_xor && tam_delta2 <= tam_bruta) {
+    *codificacao = COLUNA_DELTA2;
+    return tam_delta2;
+  }
+  if (tam_xor <= tam_bruta) {
+    *codificacao = COLUNA_XOR;
+    memcpy(dst, rascunho, tam_xor);
+    return tam_xor;
+  }
+  *codificacao = COLUNA_BRUTA;
+  memcpy(dst, coluna, tam_bruta);
+  return tam_bruta;
+}
+
+static bool decodificar_coluna(uint8_t codificacao, const uint8_t *src,
+                               size_t tamanho, uint32_t n, double *coluna) {
+  uint64_t anterior;
+  if (tamanho < sizeof(anterior))
+    return false;
+  memcpy(&anterior, src, sizeof(anterior));
+  coluna[0] = double_bits(anterior);
+  size_t pos = sizeof(anterior);
+
+  switch (codificacao) {
+  case COLUNA_CONSTANTE:
+    for (uint32_t i = 1; i < n; i++)
+      coluna[i] = coluna[0];
+    return tamanho == pos;
+
+  case COLUNA_DELTA2: {
+    uint64_t delta = 0;
+    for (uint32_t i = 1; i < n; i++) {
+      uint64_t dd;
+      if (!ler_varint(src, tamanho, &pos, &dd))
+        return false;
+      delta += dezigzag(dd);
+      anterior += delta;
+      coluna[i] = double_bits(anterior);
+    }
+    return tamanho == pos;
+  }
+
+  case COLUNA_XOR:
+    for (uint32_t i = 1; i < n; i += 2) {
+      if (pos >= tamanho)
+        return false;
+      uint8_t controle = src[pos++];
+      for (uint32_t k = 0; k < 2 && i + k < n; k++) {
+        int nb = (controle >> (4 * k)) & 0x0f;
+        if (nb > 8 || pos + nb > tamanho)
+          return false;
+        uint64_t x = 0;
+        for (int b = 0; b < nb; b++)
+          x |= (uint64_t)src[pos++] << (8 * b);
+        anterior ^= x;
+        coluna[i + k] = double_bits(anterior);
+      }
+    }
+    return tamanho == pos;
+
+  case COLUNA_BRUTA:
+    if (tamanho != n * sizeof(double))
+      return false;
+    memcpy(coluna, src, tamanho);
+    return true;
+  }
+  return false;
+}
+
+// --- Escritor ---
+
+// Garante que o mapa comporta o pior caso de mais um bloco. O espaço é
+// reservado em disco antes de ser mapeado: com o disco cheio a falha vem
+// aqui, e não como SIGBUS numa escrita no mapa.
+static bool garantir_espaco(EscritorTelemetria *escritor) {
+  size_t necessario = escritor->deslocamento + TAM_MAX_BLOCO;
+  if (necessario <= escritor->tamanho_mapa)
+    return true;
+
+  size_t novo_tamanho =
+      escritor->deslocamento + BLOCOS_POR_CRESCIMENTO * TAM_MAX_BLOCO;
+  int erro = posix_fallocate(escritor->fd, (off_t)escritor->tamanho_mapa,
+                             (off_t)(novo_tamanho - escritor->tamanho_mapa));
+  if (erro != 0) {
+    errno = erro;
+    return false;
+  }
+
+  if (escritor->mapa)
+    munmap(escritor->mapa, escritor->tamanho_mapa);
+  void *mapa = mmap(NULL, novo_tamanho, PROT_READ | PROT_WRITE, MAP_SHARED,
+                    escritor->fd, 0);
+  if (mapa == MAP_FAILED) {
+    escritor->mapa = NULL;
+    escritor->tamanho_mapa = 0;
+    return false;
+  }
+
+  escritor->mapa = mapa;
+  escritor->tamanho_mapa = novo_tamanho;
+  return true;
+}
+
+// Codifica as amostras acumuladas como um novo bloco no fim do arquivo
+static bool gravar_bloco(EscritorTelemetria *escritor) {
+  uint32_t n = escritor->amostras_no_bloco;
+  if (n == 0)
+    return true;
+  if (!garantir_espaco(escritor))
+    return false;
+
+  uint8_t *inicio = escritor->mapa + escritor->deslocamento;
+  CabecalhoBloco cabecalho = {
+      .n_amostras = n,
+      .tempo_inicial = escritor->colunas[CANAL_TEMPO][0],
+      .tempo_final = escritor->colunas[CANAL_TEMPO][n - 1]};
+
+  size_t pos = sizeof(CabecalhoBloco);
+  for (int c = 0; c < TELEMETRIA_N_CANAIS; c++) {
+    size_t tamanho = codificar_coluna(escritor->colunas[c], n, inicio + pos,
+                                      &cabecalho.codificacao[c]);
+    cabecalho.tamanho_coluna[c] = (uint16_t)tamanho;
+    pos += tamanho;
+  }
+  while (pos % 8)
+    inicio[pos++] = 0;
+
+  // O cabeçalho é gravado por último: um leitor concorrente vê o bloco
+  // completo ou um contador zero
+  cabecalho.tamanho = (uint32_t)pos;
+  memcpy(inicio, &cabecalho, sizeof(cabecalho));
+
+  escritor->deslocamento += pos;
+  escritor->n_blocos++;
+  escritor->amostras_gravadas += n;
+  escritor->amostras_no_bloco = 0;
+  return true;
+}
+
+bool telemetria_abrir_escrita(EscritorTelemetria *escritor,
+                              const char *caminho) {
+  memset(escritor, 0, sizeof(*escritor));
+  escritor->deslocamento = TELEMETRIA_TAM_CABECALHO;
+  escritor->fd = open(caminho, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (escritor->fd < 0)
+    return false;
+
+  if (!garantir_espaco(escritor)) {
+    close(escritor->fd);
+    escritor->fd = -1;
+    return false;
+  }
+
+  CabecalhoTelemetria *cabecalho = (CabecalhoTelemetria *)escritor->mapa;
+  memcpy(cabecalho->magica, TELEMETRIA_MAGICA, sizeof(cabecalho->magica));
+  cabecalho->versao = TELEMETRIA_VERSAO;
+  cabecalho->n_canais = TELEMETRIA_N_CANAIS;
+  cabecalho->amostras_por_bloco = TELEMETRIA_AMOSTRAS_POR_BLOCO;
+  for (int c = 0; c < TELEMETRIA_N_CANAIS; c++)
+    strncpy(cabecalho->nomes[c], nomes_canais[c],
+            TELEMETRIA_TAM_NOME_CANAL - 1);
+  return true;
+}
+
+bool telemetria_escrever(EscritorTelemetria *escritor,
+                         const double valores[TELEMETRIA_N_CANAIS]) {
+  if (!escritor->mapa || escritor->erro)
+    return false;
+
+  uint32_t i = escritor->amostras_no_bloco;
+  for (int c = 0; c < TELEMETRIA_N_CANAIS; c++)
+    escritor->colunas[c][i] = valores[c];
+  escritor->amostras_no_bloco = i + 1;
+
+  if (escritor->amostras_no_bloco < TELEMETRIA_AMOSTRAS_POR_BLOCO)
+    return true;
+  if (gravar_bloco(escritor))
+    return true;
+  // O bloco não gravado é descartado e nenhum outro é aceito
+  escritor->erro = errno ? errno : EIO;
+  escritor->amostras_no_bloco = 0;
+  return false;
+}
+
+void telemetria_fechar_escrita(EscritorTelemetria *escritor) {
+  if (escritor->fd < 0)
+    return;
+
+  if (!escritor->erro)
+    gravar_bloco(escritor);
+  size_t tamanho_final = escritor->deslocamento;
+  if (escritor->mapa)
+    munmap(escritor->mapa, escritor->tamanho_mapa);
+
+  // Descarta a área pré-alocada e não utilizada
+  if (ftruncate(escritor->fd, (off_t)tamanho_final) != 0) {
+    // Arquivo permanece válido: a área extra começa com contador zero
+  }
+  close(escritor->fd);
+  escritor->fd = -1;
+  escritor->mapa = NULL;
+  escritor->tamanho_mapa = 0;
+}
+
+// --- Leitor ---
+
+bool telemetria_mapear(LeitorTelemetria *leitor, const char *caminho) {
+  memset(leitor, 0, sizeof(*leitor));
+  leitor->fd = open(caminho, O_RDONLY);
+  if (leitor->fd < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(leitor->fd, &info) != 0 ||
+      (size_t)info.st_size < TELEMETRIA_TAM_CABECALHO)
+    goto falha;
+
+  leitor->tamanho = (size_t)info.st_size;
+  void *mapa =
+      mmap(NULL, leitor->tamanho, PROT_READ, MAP_SHARED, leitor->fd, 0);
+  if (mapa == MAP_FAILED)
+    goto falha;
+  leitor->mapa = mapa;
+  leitor->cabecalho = (const CabecalhoTelemetria *)leitor->mapa;
+
+  const CabecalhoTelemetria *cab = leitor->cabecalho;
+  if (memcmp(cab->magica, TELEMETRIA_MAGICA, sizeof(cab->magica)) != 0 ||
+      cab->versao != TELEMETRIA_VERSAO ||
+      cab->n_canais != TELEMETRIA_N_CANAIS ||
+      cab->amostras_por_bloco != TELEMETRIA_AMOSTRAS_POR_BLOCO)
+    goto falha;
+  return true;
+
+falha:
+  telemetria_fechar_leitura(leitor);
+  return false;
+}
+
+bool telemetria_percorrer_blocos(LeitorTelemetria *leitor) {
+  size_t capacidade = 0;
+  size_t pos = TELEMETRIA_TAM_CABECALHO;
+  leitor->n_blocos = 0;
+  leitor->n_amostras = 0;
+
+  while (pos + sizeof(CabecalhoBloco) <= leitor->tamanho) {
+    const CabecalhoBloco *bloco =
+        (const CabecalhoBloco *)(leitor->mapa + pos);
+    if (bloco->n_amostras == 0 ||
+        bloco->n_amostras > TELEMETRIA_AMOSTRAS_POR_BLOCO ||
+        bloco->tamanho < sizeof(CabecalhoBloco) || bloco->tamanho % 8 ||
+        bloco->tamanho > leitor->tamanho - pos)
+      break;
+
+    if (leitor->n_blocos == capacidade) {
+      capacidade = capacidade ? 2 * capacidade : 256;
+      size_t *novo =
+          realloc(leitor->deslocamentos, capacidade * sizeof(size_t));
+      if (!novo)
+        return false;
+      leitor->deslocamentos = novo;
+    }
+    leitor->deslocamentos[leitor->n_blocos++] = pos;
+    leitor->n_amostras += bloco->n_amostras;
+    pos += bloco->tamanho;
+  }
+  return true;
+}
+
+bool telemetria_abrir_leitura(LeitorTelemetria *leitor, const char *caminho) {
+  if (!telemetria_mapear(leitor, caminho))
+    return false;
+  if (!telemetria_percorrer_blocos(leitor)) {
+    telemetria_fechar_leitura(leitor);
+    return false;
+  }
+  return true;
+}
+
+uint32_t telemetria_ler_bloco(
+    const LeitorTelemetria *leitor, uint64_t bloco,
+    double colunas[TELEMETRIA_N_CANAIS][TELEMETRIA_AMOSTRAS_POR_BLOCO]) {
+  if (bloco >= leitor->n_blocos)
+    return 0;
+
+  const uint8_t *inicio = leitor->mapa + leitor->deslocamentos[bloco];
+  const CabecalhoBloco *cabecalho = (const CabecalhoBloco *)inicio;
+  size_t pos = sizeof(CabecalhoBloco);
+  for (int c = 0; c < TELEMETRIA_N_CANAIS; c++) {
+    size_t tamanho = cabecalho->tamanho_coluna[c];
+    if (pos + tamanho > cabecalho->tamanho ||
+        !decodificar_coluna(cabecalho->codificacao[c], inicio + pos, tamanho,
+                            cabecalho->n_amostras, colunas[c]))
+      return 0;
+    pos += tamanho;
+  }
+  return cabecalho->n_amostras;
+}
+
+void telemetria_fechar_leitura(LeitorTelemetria *leitor) {
+  if (leitor->mapa)
+    munmap((void *)leitor->mapa, leitor->tamanho);
+  if (leitor->fd >= 0)
+    close(leitor->fd);
+  free(leitor->deslocamentos);
+  memset(leitor, 0, sizeof(*leitor));
+  leitor->fd = -1;
+}
@@ -1,13 +1,27 @@
 #include "telemetry_ui.h"
+#include "instrumentacao.h"
+#include "snapshot_estado.h"
+#include "tempo_real.h"
+#include "telemetria_binaria.h"
 #include <math.h>
 #include <ncurses.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
-void desenhar_interface(WINDOW *win) {
-  wclear(win);
-  box(win, 0, 0);
+// Mensagem de status exibida no rodapé (acessada só pela thread da interface)
+static char mensagem_status[80];
+
+// Tecla [I]: alterna entre os painéis de status e o de diagnóstico
+static bool mostrar_diagnostico;
 
-  pthread_mutex_lock(&mutex_estado);
+// Desenha a parte fixa do painel de status: bordas, títulos, separadores e
+// os rótulos à esquerda de cada campo
+static void desenhar_moldura(WINDOW *win) {
+  werase(win);
+  box(win, 0, 0);
 
   int rows, cols;
   getmaxyx(win, rows, cols);
@@ -21,24 +35,10 @@ void desenhar_interface(WINDOW *win) {
   wattroff(win, COLOR_PAIR(1) | A_BOLD);
   mvwhline(win, 2, 1, ACS_HLINE, cols - 2);
 
-  // Estado da Missao
   wattron(win, A_BOLD);
   mvwprintw(win, 3, 2, "ESTADO DA MISSAO: ");
-
-  if (estado_nave.estado_missao == EMERGENCIA) {
-    wattron(win, COLOR_PAIR(2) | A_BLINK);
-    wprintw(win, "%s", obter_nome_estado(estado_nave.estado_missao));
-    wattroff(win, COLOR_PAIR(2) | A_BLINK);
-  } else {
-    wattron(win, COLOR_PAIR(3));
-    wprintw(win, "%s", obter_nome_estado(estado_nave.estado_missao));
-    wattroff(win, COLOR_PAIR(3));
-  }
   wattroff(win, A_BOLD);
-
-  mvwprintw(win, 3, cols - 35, "Tempo de Missao: %.2f horas",
-            estado_nave.tempo_missao / 3600.0);
-
+  mvwprintw(win, 3, cols - 35, "Tempo de Missao: ");
   mvwhline(win, 4, 1, ACS_HLINE, cols - 2);
 
   // ============================================
@@ -49,91 +49,175 @@ void desenhar_interface(WINDOW *win) {
   wattron(win, COLOR_PAIR(4) | A_BOLD);
   mvwprintw(win, 5, 2, " POSICAO E DINAMICA");
   wattroff(win, COLOR_PAIR(4) | A_BOLD);
-  mvwprintw(win, 6, 4, "Posicao (km): X=%9.2f  Y=%9.2f  Z=%9.2f",
-            estado_nave.posicao.x / 1000.0, estado_nave.posicao.y / 1000.0,
-            estado_nave.posicao.z / 1000.0);
-  mvwprintw(win, 7, 4, "Acel. (m/s2): X=%9.2f  Y=%9.2f  Z=%9.2f",
-            estado_nave.aceleracao.x, estado_nave.aceleracao.y,
-            estado_nave.aceleracao.z);
-
-  double vel_total = sqrt(estado_nave.velocidade.x * estado_nave.velocidade.x +
-                          estado_nave.velocidade.y * estado_nave.velocidade.y +
-                          estado_nave.velocidade.z * estado_nave.velocidade.z);
-  mvwprintw(win, 8, 4, "Velocidade total: %9.2f m/s (%9.2f km/h)", vel_total,
-            vel_total * 3.6);
-
+  mvwprintw(win, 6, 4, "Posicao (km): ");
+  mvwprintw(win, 7, 4, "Acel. (m/s2): ");
+  mvwprintw(win, 8, 4, "Velocidade total: ");
   mvwhline(win, 9, 1, ACS_HLINE, cols - 2);
 
   // Propulsão e Massa
   wattron(win, COLOR_PAIR(5) | A_BOLD);
   mvwprintw(win, 10, 2, " SISTEMAS DE PROPULSAO");
   wattroff(win, COLOR_PAIR(5) | A_BOLD);
-  mvwprintw(win, 11, 4, "Combustivel principal: %10.2f kg (%.1f%%)",
-            estado_nave.combustivel_principal,
-            estado_nave.combustivel_principal / 1924000.0 * 100.0);
-  mvwprintw(win, 12, 4, "Combustivel RCS:       %10.2f kg  (%.1f%%)",
-            estado_nave.combustivel_rcs,
-            estado_nave.combustivel_rcs / 500.0 * 100.0);
-  mvwprintw(win, 13, 4, "Empuxo principal:      %10.2f kN",
-            estado_nave.empuxo_principal / 1000.0);
-  mvwprintw(win, 14, 4, "Empuxo RCS:            %10.2f N",
-            estado_nave.empuxo_rcs);
-
+  mvwprintw(win, 11, 4, "Combustivel principal: ");
+  mvwprintw(win, 12, 4, "Combustivel RCS:       ");
+  mvwprintw(win, 13, 4, "Empuxo principal:      ");
+  mvwprintw(win, 14, 4, "Empuxo RCS:            ");
   mvwhline(win, 15, 1, ACS_HLINE, cols - 2);
 
   // Energia
   wattron(win, COLOR_PAIR(6) | A_BOLD);
   mvwprintw(win, 16, 2, " CELULAS DE ENERGIA");
   wattroff(win, COLOR_PAIR(6) | A_BOLD);
-  mvwprintw(win, 17, 4, "Energia principal:     %10.2f Wh (%.1f%%)",
-            estado_nave.energia_principal,
-            estado_nave.energia_principal / 10000.0 * 100.0);
-  mvwprintw(win, 18, 4, "Energia reserva:       %10.2f Wh (%.1f%%)",
-            estado_nave.energia_reserva,
-            estado_nave.energia_reserva / 5000.0 * 100.0);
-  mvwprintw(win, 19, 4, "Consumo atual:         %10.2f W",
-            estado_nave.consumo_energia);
-
+  mvwprintw(win, 17, 4, "Energia principal:     ");
+  mvwprintw(win, 18, 4, "Energia reserva:       ");
+  mvwprintw(win, 19, 4, "Consumo atual:         ");
   mvwhline(win, 20, 1, ACS_HLINE, cols - 2);
 
   // Ambiente e Suporte de Vida
   wattron(win, COLOR_PAIR(7) | A_BOLD);
   mvwprintw(win, 21, 2, " SUPORTE DE VIDA");
   wattroff(win, COLOR_PAIR(7) | A_BOLD);
-  mvwprintw(win, 22, 4, "Temperatura interna: %5.1f °C",
-            estado_nave.temperatura_interna);
-  mvwprintw(win, 23, 4, "Pressao interna:     %5.1f kPa",
-            estado_nave.pressao_interna);
-  mvwprintw(win, 24, 4, "Taxa de Radiacao:    %5.2f mSv/h",
-            estado_nave.radiacao);
+  mvwprintw(win, 22, 4, "Temperatura interna: ");
+  mvwprintw(win, 23, 4, "Pressao interna:     ");
+  mvwprintw(win, 24, 4, "Taxa de Radiacao:    ");
 
   // ============================================
   // SIMULAÇÃO E RODAPÉ
   // ============================================
   mvwhline(win, 25, 1, ACS_HLINE, cols - 2);
-  mvwprintw(win, 26, 2, "VELOCIDADE DE SIMULACAO: %dx",
-            atomic_load(&estado_nave.simulacao_acelerada));
-
-  if (estado_nave.estado_missao == EMERGENCIA) {
-    wattron(win, COLOR_PAIR(2) | A_BLINK | A_BOLD);
-    mvwprintw(win, 27, (cols - 55) / 2,
-              "*** SITUACAO DE EMERGENCIA: SISTEMAS COMPROMETIDOS ***");
-    wattroff(win, COLOR_PAIR(2) | A_BLINK | A_BOLD);
-  }
+}
 
-  wattron(win, A_DIM);
-  mvwprintw(win, 29, 2,
-            "Controles: [A]celerar [D]esacelerar [P]roximo Estado [E]mergencia "
-            "[S]air");
-  wattroff(win, A_DIM);
+// Reescreve um campo se o texto formatado difere do último desenho. O campo
+// ocupa largura colunas a partir de (linha, coluna); o resto é preenchido
+// com espaços para apagar um texto anterior mais longo.
+__attribute__((format(printf, 7, 8))) static bool
+atualizar_campo(PainelStatus *painel, CampoPainel campo, int linha,
+                int coluna, int largura, attr_t atributos, const char *formato,
+                ...) {
+  char texto[TAMANHO_CAMPO_PAINEL];
+  va_list args;
+  va_start(args, formato);
+  vsnprintf(texto, sizeof(texto), formato, args);
+  va_end(args);
+
+  if (painel->moldura_desenhada && strcmp(texto, painel->campos[campo]) == 0)
+    return false;
+  memcpy(painel->campos[campo], texto, sizeof(texto));
+
+  // Espaços sem atributo, depois o texto com os atributos do campo
+  mvwprintw(painel->win, linha, coluna, "%*s", largura, "");
+  wattron(painel->win, atributos);
+  mvwaddnstr(painel->win, linha, coluna, texto, largura);
+  wattroff(painel->win, atributos);
+  return true;
+}
 
-  pthread_mutex_unlock(&mutex_estado);
-  wrefresh(win);
+bool desenhar_interface(PainelStatus *painel, const EstadoNave *nave,
+                        const char *linha_simulacao, const char *status,
+                        const char *controles) {
+  WINDOW *win = painel->win;
+  int rows, cols;
+  getmaxyx(win, rows, cols);
+  (void)rows;
+
+  bool moldura = !painel->moldura_desenhada;
+  if (moldura)
+    desenhar_moldura(win);
+
+  // Largura útil de um campo que começa na coluna dada
+  int largura = cols - 3;
+  bool emergencia = nave->estado_missao == EMERGENCIA;
+  bool alterado = moldura;
+
+  attr_t atributos_estado = emergencia ? (COLOR_PAIR(2) | A_BLINK | A_BOLD)
+                                       : (COLOR_PAIR(3) | A_BOLD);
+  alterado |= atualizar_campo(painel, CAMPO_ESTADO, 3, 20, cols - 56,
+                              atributos_estado, "%s",
+                              obter_nome_estado(nave->estado_missao));
+  alterado |= atualizar_campo(painel, CAMPO_TEMPO, 3, cols - 18, 16, A_NORMAL,
+                              "%.2f horas", nave->tempo_missao / 3600.0);
+
+  alterado |= atualizar_campo(
+      painel, CAMPO_POSICAO, 6, 18, largura - 18, A_NORMAL,
+      "X=%9.2f  Y=%9.2f  Z=%9.2f", nave->posicao.x / 1000.0,
+      nave->posicao.y / 1000.0, nave->posicao.z / 1000.0);
+  alterado |= atualizar_campo(painel, CAMPO_ACELERACAO, 7, 18, largura - 18,
+                              A_NORMAL, "X=%9.2f  Y=%9.2f  Z=%9.2f",
+                              nave->aceleracao.x, nave->aceleracao.y,
+                              nave->aceleracao.z);
+
+  double vel_total = sqrt(nave->velocidade.x * nave->velocidade.x +
+                          nave->velocidade.y * nave->velocidade.y +
+                          nave->velocidade.z * nave->velocidade.z);
+  alterado |= atualizar_campo(painel, CAMPO_VELOCIDADE, 8, 22, largura - 22,
+                              A_NORMAL, "%9.2f m/s (%9.2f km/h)", vel_total,
+                              vel_total * 3.6);
+
+  alterado |= atualizar_campo(
+      painel, CAMPO_COMBUSTIVEL, 11, 27, largura - 27, A_NORMAL,
+      "%10.2f kg (%.1f%%)", nave->combustivel_principal,
+      nave->combustivel_principal / 1924000.0 * 100.0);
+  alterado |= atualizar_campo(painel, CAMPO_RCS, 12, 27, largura - 27,
+                              A_NORMAL, "%10.2f kg  (%.1f%%)",
+                              nave->combustivel_rcs,
+                              nave->combustivel_rcs / 500.0 * 100.0);
+  alterado |= atualizar_campo(painel, CAMPO_EMPUXO, 13, 27, largura - 27,
+                              A_NORMAL, "%10.2f kN",
+                              nave->empuxo_principal / 1000.0);
+  alterado |= atualizar_campo(painel, CAMPO_EMPUXO_RCS, 14, 27, largura - 27,
+                              A_NORMAL, "%10.2f N", nave->empuxo_rcs);
+
+  alterado |= atualizar_campo(
+      painel, CAMPO_ENERGIA, 17, 27, largura - 27, A_NORMAL,
+      "%10.2f Wh (%.1f%%)", nave->energia_principal,
+      nave->energia_principal / 10000.0 * 100.0);
+  alterado |= atualizar_campo(painel, CAMPO_RESERVA, 18, 27, largura - 27,
+                              A_NORMAL, "%10.2f Wh (%.1f%%)",
+                              nave->energia_reserva,
+                              nave->energia_reserva / 5000.0 * 100.0);
+  alterado |= atualizar_campo(painel, CAMPO_CONSUMO, 19, 27, largura - 27,
+                              A_NORMAL, "%10.2f W", nave->consumo_energia);
+
+  alterado |= atualizar_campo(painel, CAMPO_TEMPERATURA, 22, 25, largura - 25,
+                              A_NORMAL, "%5.1f °C", nave->temperatura_interna);
+  alterado |= atualizar_campo(painel, CAMPO_PRESSAO, 23, 25, largura - 25,
+                              A_NORMAL, "%5.1f kPa", nave->pressao_interna);
+  alterado |= atualizar_campo(painel, CAMPO_RADIACAO, 24, 25, largura - 25,
+                              A_NORMAL, "%5.2f mSv/h", nave->radiacao);
+
+  alterado |= atualizar_campo(painel, CAMPO_SIMULACAO, 26, 2, largura, A_NORMAL,
+                              "%s", linha_simulacao);
+  alterado |= atualizar_campo(
+      painel, CAMPO_ALERTA, 27, (cols - 55) / 2, 55,
+      COLOR_PAIR(2) | A_BLINK | A_BOLD, "%s",
+      emergencia ? "*** SITUACAO DE EMERGENCIA: SISTEMAS COMPROMETIDOS ***"
+                 : "");
+  alterado |= atualizar_campo(painel, CAMPO_STATUS, 28, 2, largura, A_NORMAL,
+                              "%s", status ? status : "");
+  alterado |= atualizar_campo(painel, CAMPO_CONTROLES, 29, 2, largura, A_DIM,
+                              "%s", controles);
+
+  painel->moldura_desenhada = true;
+
+  // Sem wclear, o ncurses envia ao terminal só as células que diferem da
+  // tela anterior; sem alterações, nem isso
+  if (alterado)
+    wrefresh(win);
+  return alterado;
 }
 
-void *interface_usuario(void *arg) {
-  (void)arg;
+void invalidar_painel(PainelStatus *painel) {
+  painel->moldura_desenhada = false;
+}
+
+int proximo_intervalo_quadro(int intervalo_ms, bool alterado) {
+  if (alterado)
+    return QUADRO_MIN_MS;
+  intervalo_ms *= 2;
+  return intervalo_ms > QUADRO_MAX_MS ? QUADRO_MAX_MS : intervalo_ms;
+}
 
+void abrir_painel(PainelStatus *painel) {
   // Inicialização do ncurses
   initscr();
   cbreak();
@@ -154,95 +238,289 @@ void *interface_usuario(void *arg) {
     init_pair(7, COLOR_WHITE, -1);   // Suporte vida
   }
 
+  // Limpa a tela já, e não no primeiro getch, que atualiza stdscr e
+  // apagaria a moldura desenhada uma única vez
+  refresh();
+
   // Criar o display fixo principal
-  WINDOW *win = newwin(31, 85, 1, 2);
+  memset(painel, 0, sizeof(*painel));
+  painel->win = newwin(31, 85, 1, 2);
+}
+
+void fechar_painel(PainelStatus *painel) {
+  delwin(painel->win);
+  endwin();
+}
 
-  while (atomic_load(&estado_nave.sistema_ativo)) {
-    desenhar_interface(win);
+#ifdef APOLLO_INSTRUMENTACAO
+static void formatar_duracao(char *destino, size_t tamanho, double ns) {
+  if (ns < 1e3)
+    snprintf(destino, tamanho, "%.0fns", ns);
+  else if (ns < 1e6)
+    snprintf(destino, tamanho, "%.1fus", ns / 1e3);
+  else if (ns < 1e9)
+    snprintf(destino, tamanho, "%.2fms", ns / 1e6);
+  else
+    snprintf(destino, tamanho, "%.2fs", ns / 1e9);
+}
+#endif
 
+// Painel de diagnóstico: resumo dos histogramas de cada thread registrada
+static void desenhar_diagnostico(WINDOW *win, const char *controles) {
+  werase(win);
+  box(win, 0, 0);
+
+  int rows, cols;
+  getmaxyx(win, rows, cols);
+  (void)rows;
+
+  wattron(win, COLOR_PAIR(1) | A_BOLD);
+  mvwprintw(win, 1, (cols - 30) / 2, "DIAGNOSTICO DE INSTRUMENTACAO");
+  wattroff(win, COLOR_PAIR(1) | A_BOLD);
+  mvwhline(win, 2, 1, ACS_HLINE, cols - 2);
+
+#ifdef APOLLO_INSTRUMENTACAO
+  wattron(win, A_BOLD);
+  mvwprintw(win, 3, 2, "%-10s %-12s %9s %9s %9s %9s %9s %9s", "THREAD",
+            "METRICA", "AMOSTRAS", "MEDIA", "P50", "P99", "P99.9", "MAX");
+  wattroff(win, A_BOLD);
+
+  int linha = 4;
+  for (const ConjuntoInstrumentacao *c = instr_conjuntos(); c && linha < 28;
+       c = c->proximo)
+    for (int m = 0; m < N_METRICAS && linha < 28; m++) {
+      ResumoHistograma resumo;
+      instr_resumir(&c->metricas[m], &resumo);
+      if (resumo.total == 0)
+        continue;
+
+      char media[16], p50[16], p99[16], p999[16], max[16];
+      formatar_duracao(media, sizeof(media), resumo.media);
+      formatar_duracao(p50, sizeof(p50), (double)resumo.p50);
+      formatar_duracao(p99, sizeof(p99), (double)resumo.p99);
+      formatar_duracao(p999, sizeof(p999), (double)resumo.p999);
+      formatar_duracao(max, sizeof(max), (double)resumo.max);
+      mvwprintw(win, linha++, 2, "%-10s %-12s %9llu %9s %9s %9s %9s %9s",
+                c->nome, obter_nome_metrica(m),
+                (unsigned long long)resumo.total, media, p50, p99, p999, max);
+    }
+#else
+  mvwprintw(win, 4, 2,
+            "Instrumentacao desabilitada: compile com make INSTRUMENTACAO=1");
+#endif
+
+  wattron(win, A_DIM);
+  mvwprintw(win, 29, 2, "%s", controles);
+  wattroff(win, A_DIM);
+
+  wrefresh(win);
+}
+
+// Pede ao executivo a captura do contexto entre dois quadros; a gravação
+// acontece na thread da interface, quando ele atende, sem atrasar a física
+static Checkpoint *pedir_checkpoint(const ConfiguracaoInterface *config) {
+  Checkpoint *checkpoint = aligned_alloc(TAM_LINHA_CACHE, sizeof(Checkpoint));
+  if (checkpoint)
+    executivo_pedir_checkpoint(config->executivo, checkpoint);
+  return checkpoint;
+}
+
+// Grava o checkpoint que o executivo capturou; um pedido cancelado (o
+// executivo já encerrou) não é gravado
+static void concluir_checkpoint(const ConfiguracaoInterface *config,
+                                Checkpoint *checkpoint,
+                                ResultadoCheckpoint resultado) {
+  if (resultado == CHECKPOINT_CANCELADO)
+    snprintf(mensagem_status, sizeof(mensagem_status),
+             "Checkpoint nao capturado: a simulacao ja encerrou");
+  else if (checkpoint_salvar(checkpoint, config->arquivo_checkpoint))
+    snprintf(mensagem_status, sizeof(mensagem_status),
+             "Checkpoint salvo em %s (t = %.1f s)", config->arquivo_checkpoint,
+             checkpoint->nave.tempo_missao);
+  else
+    snprintf(mensagem_status, sizeof(mensagem_status),
+             "Falha ao salvar checkpoint em %s", config->arquivo_checkpoint);
+  free(checkpoint);
+}
+
+void *interface_usuario(void *arg) {
+  const ConfiguracaoInterface *config = arg;
+  CanalComandos *canal = &config->executivo->canal;
+  const char *controles = "[A]/[D] Veloc. [P]rox. Sal[T]o [E]merg. "
+                          "[V]eiculo [C]heckpoint [I]nstr. [S]air";
+  // No modo estrito o passo é sempre dt por período de dt: sem aceleração
+  bool estrito =
+      config->executivo->config.modo == EXECUTIVO_TEMPO_REAL_ESTRITO;
+  // Lido uma vez: o contexto é escrito pelo executivo a cada quadro
+  double dt = config->executivo->ctx.dt;
+  int aceleracao_max = config->executivo->config.integrador.limiar_kepler > 0.0
+                           ? ACELERACAO_MAX_CONICA
+                           : ACELERACAO_MAX;
+  INSTR_THREAD("interface");
+  PainelStatus painel;
+  abrir_painel(&painel);
+  int intervalo_ms = QUADRO_MIN_MS;
+  Checkpoint *checkpoint_pendente = NULL;
+
+  while (atomic_load(&canal->sistema_ativo)) {
+    INSTR_INICIO(inicio_iteracao);
+
+    if (checkpoint_pendente) {
+      ResultadoCheckpoint resultado =
+          executivo_checkpoint_resultado(config->executivo);
+      if (resultado != CHECKPOINT_PENDENTE) {
+        concluir_checkpoint(config, checkpoint_pendente, resultado);
+        checkpoint_pendente = NULL;
+      }
+    }
+
+    // Lê o snapshot publicado pela física: o redesenho nunca bloqueia
+    // o executivo
+    EstadoNave nave;
+    RotuloVeiculo veiculo;
+    bool alterado = false;
+    if (mostrar_diagnostico) {
+      // Os histogramas mudam a cada quadro
+      desenhar_diagnostico(painel.win, controles);
+      alterado = true;
+    } else if (ler_snapshot(&nave, &veiculo)) {
+      INSTR_INICIO(inicio_desenho);
+      char linha_simulacao[TAMANHO_CAMPO_PAINEL];
+      int escrito;
+      if (estrito)
+        escrito = snprintf(linha_simulacao, sizeof(linha_simulacao),
+                           "TEMPO REAL ESTRITO: %.0f Hz (dt = %g s)",
+                           1.0 / dt, dt);
+      else
+        escrito = snprintf(linha_simulacao, sizeof(linha_simulacao),
+                           "VELOCIDADE DE SIMULACAO: %dx",
+                           atomic_load(&canal->simulacao_acelerada));
+      // Com veículos secundários, qual deles o painel mostra
+      if (veiculo.total > 1 && escrito > 0 &&
+          (size_t)escrito < sizeof(linha_simulacao))
+        snprintf(linha_simulacao + escrito, sizeof(linha_simulacao) - escrito,
+                 "  VEICULO: %s (%u/%u)", veiculo.nome,
+                 (unsigned int)veiculo.posicao, (unsigned int)veiculo.total);
+      alterado = desenhar_interface(&painel, &nave, linha_simulacao,
+                                    mensagem_status, controles);
+      INSTR_FIM(METRICA_TRABALHO, inicio_desenho);
+    }
+
+    // Espera a próxima tecla por até um quadro: uma tecla acorda a
+    // interface na hora, e um painel parado espaça os quadros (mas não com
+    // um checkpoint à espera de ser gravado)
+    intervalo_ms = proximo_intervalo_quadro(
+        intervalo_ms, alterado || checkpoint_pendente != NULL);
+    timeout(intervalo_ms);
+    INSTR_INICIO(inicio_sono);
     int ch = getch();
-    if (ch != ERR) {
+    if (ch == ERR) {
+      INSTR_ATRASO_SONO(inicio_sono, (uint64_t)intervalo_ms * 1000000);
+    } else {
+      intervalo_ms = QUADRO_MIN_MS;
       switch (ch) {
       case 'a':
       case 'A': {
-        int acel = atomic_load(&estado_nave.simulacao_acelerada);
-        if (acel < 8192)
-          atomic_store(&estado_nave.simulacao_acelerada, acel * 2);
+        int acel = atomic_load(&canal->simulacao_acelerada);
+        if (acel < aceleracao_max && !estrito)
+          atomic_store(&canal->simulacao_acelerada, acel * 2);
         break;
       }
       case 'd':
       case 'D': {
-        int acel = atomic_load(&estado_nave.simulacao_acelerada);
+        int acel = atomic_load(&canal->simulacao_acelerada);
         if (acel > 1)
-          atomic_store(&estado_nave.simulacao_acelerada, acel / 2);
+          atomic_store(&canal->simulacao_acelerada, acel / 2);
         break;
       }
       case 'p':
-      case 'P':
-        avancar_estado_missao();
+      case 'P': {
+        // Avançar além da finalização encerra o simulador
+        EstadoNave atual;
+        if (ler_snapshot(&atual, NULL) && atual.estado_missao == FINALIZACAO)
+          atomic_store(&canal->sistema_ativo, false);
+        else
+          executivo_comandar(config->executivo, COMANDO_AVANCAR);
         break;
+      }
       case 'e':
       case 'E':
-        acionar_emergencia("ACIONAMENTO MANUAL DE EMERGENCIA");
+        executivo_comandar(config->executivo, COMANDO_EMERGENCIA);
+        break;
+      case 't':
+      case 'T':
+        executivo_comandar(config->executivo, COMANDO_SALTAR);
+        break;
+      case 'v':
+      case 'V':
+        executivo_comandar(config->executivo, COMANDO_PROXIMO_VEICULO);
+        break;
+      case 'c':
+      case 'C':
+        if (!checkpoint_pendente)
+          checkpoint_pendente = pedir_checkpoint(config);
+        break;
+      case 'i':
+      case 'I':
+        mostrar_diagnostico = !mostrar_diagnostico;
+        invalidar_painel(&painel);
         break;
       case 's':
       case 'S':
       case 'q':
       case 'Q':
-        atomic_store(&estado_nave.sistema_ativo, false);
+        atomic_store(&canal->sistema_ativo, false);
         break;
       }
     }
 
-    usleep(50000); // UI atualiza a 20 FPS (TUI muito responsiva)
+    INSTR_FIM(METRICA_PERIODO, inicio_iteracao);
   }
 
-  delwin(win);
-  endwin();
+  // O executivo atende os pedidos feitos até aqui antes de finalizar; um
+  // feito depois que ele encerrou sozinho é cancelado
+  if (checkpoint_pendente) {
+    ResultadoCheckpoint resultado;
+    while ((resultado = executivo_checkpoint_resultado(config->executivo)) ==
+           CHECKPOINT_PENDENTE)
+      usleep(1000);
+    concluir_checkpoint(config, checkpoint_pendente, resultado);
+  }
+  fechar_painel(&painel);
   return NULL;
 }
 
 void *telemetry_logger(void *arg) {
-  (void)arg;
-  FILE *log_file = fopen("telemetry.csv", "w");
-  if (log_file) {
-    fprintf(log_file, "Tempo_seg,Estado,PosX_km,PosY_km,PosZ_km,VelX_ms,VelY_"
-                      "ms,VelZ_ms,AcelX_ms2,AcelY_ms2,AcelZ_ms2,Combustivel_"
-                      "Princ_kg,Combustivel_RCS_kg,Energia_Wh,Temperatura_C\n");
-  }
-
-  double tempo_ultimo_log = -1.0;
-
-  while (atomic_load(&estado_nave.sistema_ativo)) {
-    pthread_mutex_lock(&mutex_estado);
-    double tempo_atual = estado_nave.tempo_missao;
-
-    // Tentar gravar no log a cada aproximadamente 1 segundo de tempo simulado
-    // ou 1 segundo de tempo real se simulação acelerar
-    if (tempo_atual - tempo_ultimo_log >= 1.0) {
-      if (log_file) {
-        fprintf(log_file,
-                "%.2f,%s,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%."
-                "2f,%.2f,%.2f\n",
-                estado_nave.tempo_missao,
-                obter_nome_estado(estado_nave.estado_missao),
-                estado_nave.posicao.x / 1000.0, estado_nave.posicao.y / 1000.0,
-                estado_nave.posicao.z / 1000.0, estado_nave.velocidade.x,
-                estado_nave.velocidade.y, estado_nave.velocidade.z,
-                estado_nave.aceleracao.x, estado_nave.aceleracao.y,
-                estado_nave.aceleracao.z, estado_nave.combustivel_principal,
-                estado_nave.combustivel_rcs, estado_nave.energia_principal,
-                estado_nave.temperatura_interna);
-        fflush(log_file);
-      }
-      tempo_ultimo_log = tempo_atual;
+  ConfiguracaoLogger *config = arg;
+  FilaTelemetria *fila = config->fila;
+  EscritorTelemetria *escritor = config->escritor;
+  if (config->fixar_cpu && !fixar_thread_cpu(config->cpu))
+    config->fixar_cpu = false;
+  INSTR_THREAD("logger");
+
+  // Esvazia a fila em lotes; só dorme quando ela está vazia. Termina depois
+  // que o executivo fecha a fila e a última amostra foi gravada
+  while (!fila_encerrada(fila)) {
+    const AmostraTelemetria *lote;
+    size_t n = fila_lote(fila, &lote);
+    if (n == 0) {
+      INSTR_INICIO(inicio_sono);
+      usleep(10000);
+      INSTR_ATRASO_SONO(inicio_sono, 10000000);
+      continue;
     }
-    pthread_mutex_unlock(&mutex_estado);
-    usleep(500000); // Analisa a thread logger a cada 500ms real
-  }
 
-  if (log_file) {
-    fclose(log_file);
+    INSTR_INICIO(inicio_lote);
+    // Depois de uma falha o escritor recusa as amostras: a fila continua
+    // sendo esvaziada
+    for (size_t i = 0; i < n; i++)
+      telemetria_escrever(escritor, lote[i].valores);
+    fila_liberar(fila, n);
+    INSTR_FIM(METRICA_TRABALHO, inicio_lote);
   }
+
+  telemetria_fechar_escrita(escritor);
+  config->gravadas = escritor->amostras_gravadas;
+  config->erro = escritor->erro;
   return NULL;
 }
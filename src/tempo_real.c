@@ -0,0 +1,34 @@
+#define _GNU_SOURCE
+#include "tempo_real.h"
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/mman.h>
+
+bool fixar_thread_cpu(int cpu) {
+  if (cpu < 0)
+    return true;
+  if (cpu >= CPU_SETSIZE)
+    return false;
+
+  cpu_set_t conjunto;
+  CPU_ZERO(&conjunto);
+  CPU_SET(cpu, &conjunto);
+  return pthread_setaffinity_np(pthread_self(), sizeof(conjunto),
+                                &conjunto) == 0;
+}
+
+bool solicitar_sched_fifo(int prioridade) {
+  if (prioridade <= 0)
+    return true;
+
+  struct sched_param parametro;
+  memset(&parametro, 0, sizeof(parametro));
+  int maxima = sched_get_priority_max(SCHED_FIFO);
+  parametro.sched_priority = prioridade > maxima ? maxima : prioridade;
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &parametro) == 0;
+}
+
+bool travar_memoria(void) {
+  return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+}
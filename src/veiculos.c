@@ -0,0 +1,317 @@
+#include "veiculos.h"
+#include "efemerides.h"
+#include "physics_engine.h"
+#include "propagador_lote.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+static const char *const NOMES_VEICULO[N_TIPOS_VEICULO] = {
+    "APOLLO", "S-IVB", "CSM", "LM-DESCIDA", "LM-SUBIDA", "SM"};
+
+// Um veículo que se separa (ou se acopla) ao entrar em um estado da missão.
+// Massas aproximadas da Apollo 11; o empuxo é a manobra de afastamento.
+typedef struct {
+  EstadoMissao estado;
+  TipoVeiculo tipo;
+  bool acoplamento; // o veículo do tipo volta para a nave principal
+  double massa_vazia, combustivel; // kg
+  double empuxo, vazao;            // N (ao longo da velocidade), kg/s
+  double energia, consumo;         // Wh, W
+} Separacao;
+
+static const Separacao SEPARACOES[] = {
+    // Após a injeção translunar o S-IVB se afasta com o APS, retrógrado
+    {TRANSITO_LUNAR, VEICULO_SIVB, false, 13500.0, 500.0, -3100.0, 1.1,
+     1500.0, 300.0},
+    // O LM desacopla para a descida e o CSM fica em órbita
+    {ALUNISSAGEM, VEICULO_CSM, false, 26000.0, 2800.0, 0.0, 0.0, 30000.0,
+     1500.0},
+    // Na decolagem o estágio de descida fica; o de subida acopla ao CSM e
+    // é descartado
+    {RETORNO_TERRA, VEICULO_LM_DESCIDA, false, 4500.0, 0.0, 0.0, 0.0, 0.0,
+     0.0},
+    {RETORNO_TERRA, VEICULO_CSM, true, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+    {RETORNO_TERRA, VEICULO_LM_SUBIDA, false, 2400.0, 0.0, 0.0, 0.0, 800.0,
+     300.0},
+    // O SM se afasta com os RCS antes da reentrada do CM
+    {REENTRADA, VEICULO_SM, false, 6100.0, 200.0, -1800.0, 0.65, 500.0,
+     200.0},
+};
+
+#define N_SEPARACOES (sizeof(SEPARACOES) / sizeof(SEPARACOES[0]))
+
+void veiculos_inicializar(TabelaVeiculos *tabela, double tempo,
+                          EstadoMissao estado) {
+  // Zera também as posições livres, lidas pelos kernels vetoriais
+  memset(tabela, 0, sizeof(*tabela));
+  tabela->tempo = tempo;
+  tabela->proximo_id = ID_PRINCIPAL + 1;
+  tabela->estado_visto = estado;
+  tabela->separacoes = false;
+}
+
+long veiculos_criar(TabelaVeiculos *tabela, TipoVeiculo tipo, Vetor3D posicao,
+                    Vetor3D velocidade, double massa_vazia) {
+  if (tabela->n >= VEICULOS_MAX)
+    return -1;
+
+  size_t i = tabela->n++;
+  tabela->px[i] = posicao.x;
+  tabela->py[i] = posicao.y;
+  tabela->pz[i] = posicao.z;
+  tabela->vx[i] = velocidade.x;
+  tabela->vy[i] = velocidade.y;
+  tabela->vz[i] = velocidade.z;
+  tabela->ax_empuxo[i] = 0.0;
+  tabela->ay_empuxo[i] = 0.0;
+  tabela->az_empuxo[i] = 0.0;
+  tabela->massa_vazia[i] = massa_vazia;
+  tabela->combustivel[i] = 0.0;
+  tabela->empuxo[i] = 0.0;
+  tabela->vazao[i] = 0.0;
+  tabela->energia[i] = 0.0;
+  tabela->consumo[i] = 0.0;
+  tabela->id[i] = tabela->proximo_id++;
+  tabela->tipo[i] = tipo;
+  tabela->criados++;
+  return (long)i;
+}
+
+void veiculos_destruir(TabelaVeiculos *tabela, size_t indice) {
+  if (indice >= tabela->n)
+    return;
+  size_t ultimo = --tabela->n;
+  double *arrays[] = {tabela->px,          tabela->py,
+                      tabela->pz,          tabela->vx,
+                      tabela->vy,          tabela->vz,
+                      tabela->ax_empuxo,   tabela->ay_empuxo,
+                      tabela->az_empuxo,   tabela->massa_vazia,
+                      tabela->combustivel, tabela->empuxo,
+                      tabela->vazao,       tabela->energia,
+                      tabela->consumo};
+  for (size_t a = 0; a < sizeof(arrays) / sizeof(arrays[0]); a++) {
+    arrays[a][indice] = arrays[a][ultimo];
+    arrays[a][ultimo] = 0.0; // a vaga volta a ser preenchimento zerado
+  }
+  tabela->id[indice] = tabela->id[ultimo];
+  tabela->tipo[indice] = tabela->tipo[ultimo];
+  tabela->id[ultimo] = 0;
+  tabela->tipo[ultimo] = VEICULO_APOLLO;
+  tabela->destruidos++;
+}
+
+// Aceleração de empuxo de cada veículo para o próximo passo: constante no
+// passo, ao longo da velocidade no início dele
+static void atualizar_empuxo(TabelaVeiculos *tabela) {
+  for (size_t i = 0; i < tabela->n; i++) {
+    double v = sqrt(tabela->vx[i] * tabela->vx[i] +
+                    tabela->vy[i] * tabela->vy[i] +
+                    tabela->vz[i] * tabela->vz[i]);
+    double massa = tabela->massa_vazia[i] + tabela->combustivel[i];
+    double a = 0.0;
+    if (tabela->combustivel[i] > 0.0 && v > 0.0 && massa > 0.0)
+      a = tabela->empuxo[i] / (massa * v);
+    tabela->ax_empuxo[i] = a * tabela->vx[i];
+    tabela->ay_empuxo[i] = a * tabela->vy[i];
+    tabela->az_empuxo[i] = a * tabela->vz[i];
+  }
+}
+
+// Combustível e energia gastos no passo. Sem combustível o motor apaga;
+// sem energia o veículo fica inerte.
+static void consumir(TabelaVeiculos *tabela, double dt) {
+  for (size_t i = 0; i < tabela->n; i++) {
+    if (tabela->combustivel[i] > 0.0 && tabela->empuxo[i] != 0.0) {
+      tabela->combustivel[i] -= tabela->vazao[i] * dt;
+      if (tabela->combustivel[i] <= 0.0) {
+        tabela->combustivel[i] = 0.0;
+        tabela->empuxo[i] = 0.0;
+      }
+    }
+    tabela->energia[i] -= tabela->consumo[i] * dt / 3600.0;
+    if (tabela->energia[i] <= 0.0) {
+      tabela->energia[i] = 0.0;
+      tabela->consumo[i] = 0.0;
+    }
+  }
+}
+
+// Destrói os veículos abaixo da superfície da Terra ou da Lua. Percorre de
+// trás para frente: a destruição move o último para a vaga.
+static void remover_impactos(TabelaVeiculos *tabela) {
+  Vetor3D lua = efemerides_lua(tabela->tempo);
+  for (size_t i = tabela->n; i-- > 0;) {
+    double x = tabela->px[i], y = tabela->py[i], z = tabela->pz[i];
+    double lx = x - lua.x, ly = y - lua.y, lz = z - lua.z;
+    if (x * x + y * y + z * z < RAIO_TERRA * RAIO_TERRA ||
+        lx * lx + ly * ly + lz * lz < RAIO_MIN_LUA * RAIO_MIN_LUA)
+      veiculos_destruir(tabela, i);
+  }
+}
+
+void veiculos_avancar(TabelaVeiculos *tabela, double tempo) {
+  double dt = tempo - tabela->tempo;
+  if (dt <= 0.0)
+    return;
+  if (tabela->n == 0) {
+    tabela->tempo = tempo;
+    return;
+  }
+
+  // O lote é só uma vista dos arrays da tabela
+  atualizar_empuxo(tabela);
+  LoteVeiculos lote = {.n = tabela->n,
+                       .capacidade = VEICULOS_MAX,
+                       .tempo = tabela->tempo,
+                       .px = tabela->px,
+                       .py = tabela->py,
+                       .pz = tabela->pz,
+                       .vx = tabela->vx,
+                       .vy = tabela->vy,
+                       .vz = tabela->vz,
+                       .ax_empuxo = tabela->ax_empuxo,
+                       .ay_empuxo = tabela->ay_empuxo,
+                       .az_empuxo = tabela->az_empuxo};
+  lote_passo_rk4(&lote, dt);
+  tabela->tempo = tempo;
+
+  consumir(tabela, dt);
+  remover_impactos(tabela);
+}
+
+static bool aplicar_separacao(TabelaVeiculos *tabela, const Separacao *sep,
+                              EstadoNave *principal) {
+  if (sep->acoplamento) {
+    long i = veiculos_buscar_tipo(tabela, sep->tipo);
+    if (i < 0)
+      return false;
+    principal->massa_vazia += tabela->massa_vazia[i] + tabela->combustivel[i];
+    veiculos_destruir(tabela, (size_t)i);
+    tabela->destruidos--; // acoplado, não perdido
+    return true;
+  }
+
+  // Sem massa para separar (a nave já é mais leve que o veículo), não há
+  // separação
+  double massa = sep->massa_vazia + sep->combustivel;
+  if (principal->massa_vazia <= massa)
+    return false;
+  long i = veiculos_criar(tabela, sep->tipo, principal->posicao,
+                          principal->velocidade, sep->massa_vazia);
+  if (i < 0)
+    return false;
+  tabela->combustivel[i] = sep->combustivel;
+  tabela->empuxo[i] = sep->empuxo;
+  tabela->vazao[i] = sep->vazao;
+  tabela->energia[i] = sep->energia;
+  tabela->consumo[i] = sep->consumo;
+  principal->massa_vazia -= massa;
+  return true;
+}
+
+void veiculos_separar(TabelaVeiculos *tabela, EstadoNave *principal) {
+  EstadoMissao anterior = tabela->estado_visto;
+  EstadoMissao atual = principal->estado_missao;
+  tabela->estado_visto = atual;
+  if (!tabela->separacoes || atual == anterior || atual == EMERGENCIA)
+    return;
+
+  // Vários estados podem ter sido avançados de uma vez (comandos): as
+  // separações de todos eles acontecem, em ordem
+  for (size_t s = 0; s < N_SEPARACOES; s++)
+    if (SEPARACOES[s].estado > anterior && SEPARACOES[s].estado <= atual)
+      aplicar_separacao(tabela, &SEPARACOES[s], principal);
+}
+
+bool veiculos_separar_tipo(TabelaVeiculos *tabela, EstadoNave *principal,
+                           TipoVeiculo tipo) {
+  for (size_t s = 0; s < N_SEPARACOES; s++)
+    if (SEPARACOES[s].tipo == tipo && !SEPARACOES[s].acoplamento)
+      return aplicar_separacao(tabela, &SEPARACOES[s], principal);
+  return false;
+}
+
+long veiculos_indice(const TabelaVeiculos *tabela, IdVeiculo id) {
+  for (size_t i = 0; i < tabela->n; i++)
+    if (tabela->id[i] == id)
+      return (long)i;
+  return -1;
+}
+
+long veiculos_buscar_tipo(const TabelaVeiculos *tabela, TipoVeiculo tipo) {
+  for (size_t i = 0; i < tabela->n; i++)
+    if (tabela->tipo[i] == tipo)
+      return (long)i;
+  return -1;
+}
+
+IdVeiculo veiculos_proximo(const TabelaVeiculos *tabela, IdVeiculo id) {
+  size_t proximo = (size_t)(veiculos_indice(tabela, id) + 1);
+  return proximo < tabela->n ? tabela->id[proximo] : ID_PRINCIPAL;
+}
+
+void veiculos_como_nave(const TabelaVeiculos *tabela, size_t indice,
+                        const EstadoNave *principal, EstadoNave *destino) {
+  *destino = *principal;
+
+  Vetor3D posicao = {tabela->px[indice], tabela->py[indice],
+                     tabela->pz[indice]};
+  Vetor3D velocidade = {tabela->vx[indice], tabela->vy[indice],
+                        tabela->vz[indice]};
+  Vetor3D gravidade = calcular_aceleracao_gravitacional(
+      posicao, tabela->tempo, GRAVIDADE_PONTUAL);
+  destino->posicao = posicao;
+  destino->velocidade = velocidade;
+  destino->aceleracao =
+      (Vetor3D){gravidade.x + tabela->ax_empuxo[indice],
+                gravidade.y + tabela->ay_empuxo[indice],
+                gravidade.z + tabela->az_empuxo[indice]};
+  double v = sqrt(velocidade.x * velocidade.x + velocidade.y * velocidade.y +
+                  velocidade.z * velocidade.z);
+  if (v > 0.0)
+    destino->orientacao =
+        (Vetor3D){velocidade.x / v, velocidade.y / v, velocidade.z / v};
+  destino->tempo_missao = tabela->tempo;
+
+  destino->massa_vazia = tabela->massa_vazia[indice];
+  destino->combustivel_principal = tabela->combustivel[indice];
+  destino->combustivel_rcs = 0.0;
+  destino->empuxo_principal =
+      tabela->combustivel[indice] > 0.0 ? fabs(tabela->empuxo[indice]) : 0.0;
+  destino->empuxo_rcs = 0.0;
+
+  destino->energia_principal = tabela->energia[indice];
+  destino->energia_reserva = 0.0;
+  destino->consumo_energia = tabela->consumo[indice];
+  destino->energia_esgotada = tabela->energia[indice] <= 0.0;
+}
+
+void veiculos_rotulo(const TabelaVeiculos *tabela, long indice,
+                     RotuloVeiculo *rotulo) {
+  TipoVeiculo tipo = indice < 0 ? VEICULO_APOLLO : tabela->tipo[indice];
+  IdVeiculo id = indice < 0 ? ID_PRINCIPAL : tabela->id[indice];
+  if (tipo == VEICULO_APOLLO)
+    snprintf(rotulo->nome, sizeof(rotulo->nome), "%s", NOMES_VEICULO[tipo]);
+  else
+    snprintf(rotulo->nome, sizeof(rotulo->nome), "%s #%u",
+             NOMES_VEICULO[tipo], (unsigned int)id);
+  rotulo->posicao = (uint32_t)(indice + 2);
+  rotulo->total = (uint32_t)(tabela ? tabela->n + 1 : 1);
+}
+
+const char *obter_nome_veiculo(TipoVeiculo tipo) {
+  if ((unsigned int)tipo >= N_TIPOS_VEICULO)
+    return "DESCONHECIDO";
+  return NOMES_VEICULO[tipo];
+}
+
+TipoVeiculo obter_tipo_veiculo(const char *nome, bool *valido) {
+  *valido = true;
+  for (int t = 0; t < N_TIPOS_VEICULO; t++)
+    if (strcasecmp(nome, NOMES_VEICULO[t]) == 0)
+      return (TipoVeiculo)t;
+  *valido = false;
+  return VEICULO_APOLLO;
+}
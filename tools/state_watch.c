@@ -0,0 +1,99 @@
+// Leitor do estado ao vivo exportado em memória compartilhada
+// (--exportar-estado)
+//
+// Uso: state_watch [nome] [--intervalo <ms>] [--leituras <n>]
+//
+// Imprime a nave principal a cada intervalo (padrão 500 ms) até o simulador
+// terminar ou n leituras. A idade é o tempo desde a publicação lida; ao
+// final sai o custo médio de uma leitura, que não faz chamadas de sistema.
+
+#include "estado_compartilhado.h"
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Leituras seguidas usadas para medir o custo de uma
+#define LEITURAS_MEDIDAS 100000
+
+static void imprimir_uso(const char *programa) {
+  fprintf(stderr, "Uso: %s [nome] [--intervalo <ms>] [--leituras <n>]\n",
+          programa);
+}
+
+static uint64_t relogio_ns(void) {
+  struct timespec agora;
+  clock_gettime(CLOCK_MONOTONIC, &agora);
+  return (uint64_t)agora.tv_sec * 1000000000ULL + (uint64_t)agora.tv_nsec;
+}
+
+static double modulo(Vetor3D v) {
+  return sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+int main(int argc, char *argv[]) {
+  const char *nome = NOME_ESTADO_PADRAO;
+  bool nome_informado = false;
+  long intervalo_ms = 500;
+  long leituras_max = -1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--intervalo") == 0 && i + 1 < argc) {
+      intervalo_ms = atol(argv[++i]);
+    } else if (strcmp(argv[i], "--leituras") == 0 && i + 1 < argc) {
+      leituras_max = atol(argv[++i]);
+    } else if (argv[i][0] == '-' || nome_informado) {
+      imprimir_uso(argv[0]);
+      return 1;
+    } else {
+      nome = argv[i];
+      nome_informado = true;
+    }
+  }
+
+  LeitorEstado leitor;
+  if (!leitor_estado_abrir(&leitor, nome)) {
+    if (errno == EPROTO)
+      fprintf(stderr, "%s: layout de outra versao do simulador\n", nome);
+    else
+      perror(nome);
+    return 1;
+  }
+
+  printf("sequencia,tempo_s,estado,raio_km,velocidade_ms,combustivel_kg,"
+         "energia_Wh,idade_us\n");
+  EstadoExportado estado;
+  uint64_t sequencia;
+  struct timespec pausa = {.tv_sec = intervalo_ms / 1000,
+                           .tv_nsec = (intervalo_ms % 1000) * 1000000L};
+  for (long n = 0; leituras_max < 0 || n < leituras_max; n++) {
+    bool encerrado = leitor_estado_encerrado(&leitor);
+    if (leitor_estado_ler(&leitor, &estado, &sequencia)) {
+      const EstadoNave *nave = &estado.nave;
+      printf("%llu,%.2f,%s,%.3f,%.3f,%.1f,%.1f,%.1f\n",
+             (unsigned long long)sequencia, nave->tempo_missao,
+             obter_nome_estado(nave->estado_missao),
+             modulo(nave->posicao) / 1000.0, modulo(nave->velocidade),
+             nave->combustivel_principal, nave->energia_principal,
+             (relogio_ns() - estado.instante_ns) / 1000.0);
+      fflush(stdout);
+    }
+    if (encerrado)
+      break;
+    nanosleep(&pausa, NULL);
+  }
+
+  uint64_t inicio = relogio_ns();
+  unsigned long lidas = 0;
+  for (int i = 0; i < LEITURAS_MEDIDAS; i++)
+    lidas += leitor_estado_ler(&leitor, &estado, NULL);
+  if (lidas > 0)
+    fprintf(stderr, "Leitura: %.0f ns em media (%lu de %d consistentes)\n",
+            (double)(relogio_ns() - inicio) / LEITURAS_MEDIDAS, lidas,
+            LEITURAS_MEDIDAS);
+
+  leitor_estado_fechar(&leitor);
+  return 0;
+}
@@ -0,0 +1,105 @@
+// Converte um log binário de telemetria (.bin) para CSV
+//
+// Uso: telemetry_export <entrada.bin> [saida.csv] [--casas <n>]
+//
+// Sem --casas os valores saem com precisão completa (%.17g); com --casas 2
+// as colunas do antigo telemetry.csv saem no mesmo formato, seguidas dos
+// canais acrescentados depois dele.
+
+#include "telemetria_binaria.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *CABECALHO_CSV =
+    "Tempo_seg,Estado,PosX_km,PosY_km,PosZ_km,VelX_ms,VelY_ms,VelZ_ms,"
+    "AcelX_ms2,AcelY_ms2,AcelZ_ms2,Combustivel_Princ_kg,Combustivel_RCS_kg,"
+    "Energia_Wh,Temperatura_C,Empuxo_Princ_N,Empuxo_RCS_N,Energia_Reserva_Wh,"
+    "Consumo_W,Pressao_kPa,Radiacao_mSvh\n";
+
+static void imprimir_uso(const char *programa) {
+  fprintf(stderr, "Uso: %s <entrada.bin> [saida.csv] [--casas <n>]\n",
+          programa);
+}
+
+static void escrever_valor(FILE *saida, double valor, int casas) {
+  if (casas < 0)
+    fprintf(saida, "%.17g", valor);
+  else
+    fprintf(saida, "%.*f", casas, valor);
+}
+
+int main(int argc, char *argv[]) {
+  const char *entrada = NULL;
+  const char *caminho_saida = NULL;
+  int casas = -1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--casas") == 0 && i + 1 < argc) {
+      casas = atoi(argv[++i]);
+    } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      imprimir_uso(argv[0]);
+      return 1;
+    } else if (!entrada) {
+      entrada = argv[i];
+    } else if (!caminho_saida) {
+      caminho_saida = argv[i];
+    } else {
+      imprimir_uso(argv[0]);
+      return 1;
+    }
+  }
+  if (!entrada) {
+    imprimir_uso(argv[0]);
+    return 1;
+  }
+
+  LeitorTelemetria leitor;
+  if (!telemetria_abrir_leitura(&leitor, entrada)) {
+    fprintf(stderr, "%s: arquivo de telemetria invalido\n", entrada);
+    return 1;
+  }
+
+  FILE *saida = caminho_saida ? fopen(caminho_saida, "w") : stdout;
+  if (!saida) {
+    perror(caminho_saida);
+    telemetria_fechar_leitura(&leitor);
+    return 1;
+  }
+
+  fputs(CABECALHO_CSV, saida);
+  static double colunas[TELEMETRIA_N_CANAIS][TELEMETRIA_AMOSTRAS_POR_BLOCO];
+  int resultado = 0;
+  for (uint64_t b = 0; b < leitor.n_blocos; b++) {
+    uint32_t n = telemetria_ler_bloco(&leitor, b, colunas);
+    if (n == 0) {
+      fprintf(stderr, "%s: bloco %llu corrompido\n", entrada,
+              (unsigned long long)b);
+      resultado = 1;
+      break;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+      for (int c = 0; c < TELEMETRIA_N_CANAIS; c++) {
+        double valor = colunas[c][i];
+        if (c > 0)
+          fputc(',', saida);
+
+        if (c == CANAL_ESTADO) {
+          fputs(obter_nome_estado((EstadoMissao)valor), saida);
+          continue;
+        }
+        // Posições em km, como no CSV original
+        if (c == CANAL_POS_X || c == CANAL_POS_Y || c == CANAL_POS_Z)
+          valor /= 1000.0;
+        escrever_valor(saida, valor, casas);
+      }
+      fputc('\n', saida);
+    }
+  }
+
+  if (saida != stdout)
+    fclose(saida);
+  telemetria_fechar_leitura(&leitor);
+  return resultado;
+}
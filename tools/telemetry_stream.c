@@ -0,0 +1,120 @@
+// Cliente do servidor de telemetria ao vivo (--servidor-telemetria)
+//
+// Uso: telemetry_stream <endereco> [canais] [--quadros <n>]
+//
+// Assina os canais dados ("Tempo_s,PosX_m,PosY_m"; todos por padrão) e imprime
+// cada quadro recebido como uma linha CSV, precedida pela sequência do
+// servidor. Lacunas na sequência são amostras que este cliente perdeu.
+
+#include "servidor_telemetria.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void imprimir_uso(const char *programa) {
+  fprintf(stderr, "Uso: %s <endereco> [canais] [--quadros <n>]\n", programa);
+}
+
+// Lê exatamente tamanho bytes. Retorna false no fim da conexão.
+static bool ler_tudo(int fd, void *destino, size_t tamanho) {
+  uint8_t *p = destino;
+  while (tamanho > 0) {
+    ssize_t lidos = read(fd, p, tamanho);
+    if (lidos < 0 && errno == EINTR)
+      continue;
+    if (lidos <= 0)
+      return false;
+    p += lidos;
+    tamanho -= (size_t)lidos;
+  }
+  return true;
+}
+
+static void imprimir_cabecalho(uint64_t canais) {
+  printf("sequencia");
+  for (int c = 0; c < TELEMETRIA_N_CANAIS; c++)
+    if (canais & (1ULL << c))
+      printf(",%s", obter_nome_canal(c));
+  printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+  const char *endereco = NULL;
+  const char *filtro = NULL;
+  long quadros_max = -1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--quadros") == 0 && i + 1 < argc) {
+      quadros_max = atol(argv[++i]);
+    } else if (argv[i][0] == '-') {
+      imprimir_uso(argv[0]);
+      return 1;
+    } else if (!endereco) {
+      endereco = argv[i];
+    } else if (!filtro) {
+      filtro = argv[i];
+    } else {
+      imprimir_uso(argv[0]);
+      return 1;
+    }
+  }
+  if (!endereco) {
+    imprimir_uso(argv[0]);
+    return 1;
+  }
+
+  uint64_t canais;
+  if (filtro && !servidor_interpretar_filtro(filtro, &canais)) {
+    fprintf(stderr, "Canal desconhecido em: %s\n", filtro);
+    return 1;
+  }
+
+  int fd = servidor_conectar(endereco);
+  if (fd < 0) {
+    perror(endereco);
+    return 1;
+  }
+  if (filtro) {
+    char linha[TAM_LINHA_FILTRO + 1];
+    int tamanho = snprintf(linha, sizeof(linha), "%s\n", filtro);
+    if (tamanho <= 0 || (size_t)tamanho >= sizeof(linha) ||
+        write(fd, linha, (size_t)tamanho) != tamanho) {
+      fprintf(stderr, "Falha ao enviar o filtro\n");
+      close(fd);
+      return 1;
+    }
+  }
+
+  // Um quadro antes do filtro ser aplicado ainda traz todos os canais: o
+  // cabeçalho CSV é repetido sempre que o conjunto muda
+  uint64_t canais_impressos = 0;
+  double valores[TELEMETRIA_N_CANAIS];
+  CabecalhoQuadro cabecalho;
+  for (long n = 0; quadros_max < 0 || n < quadros_max; n++) {
+    if (!ler_tudo(fd, &cabecalho, sizeof(cabecalho)))
+      break;
+    if (cabecalho.n_valores > TELEMETRIA_N_CANAIS ||
+        cabecalho.tamanho !=
+            sizeof(cabecalho) + cabecalho.n_valores * sizeof(double)) {
+      fprintf(stderr, "Quadro invalido\n");
+      close(fd);
+      return 1;
+    }
+    if (!ler_tudo(fd, valores, cabecalho.n_valores * sizeof(double)))
+      break;
+
+    if (cabecalho.canais != canais_impressos) {
+      imprimir_cabecalho(cabecalho.canais);
+      canais_impressos = cabecalho.canais;
+    }
+    printf("%llu", (unsigned long long)cabecalho.sequencia);
+    for (uint32_t v = 0; v < cabecalho.n_valores; v++)
+      printf(",%.17g", valores[v]);
+    printf("\n");
+  }
+
+  close(fd);
+  return 0;
+}